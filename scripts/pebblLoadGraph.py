@@ -11,6 +11,8 @@ import sys
 from optparse import OptionParser
 import re
 import string
+import struct
+import array
 
 warningIssued = False
 
@@ -45,6 +47,51 @@ def getFloat(string,wantWarning,target) :
   target.append(float(token))
   return string
 
+# Binary load logs (from --loadLogBinary or loadLogMerge) hold the same
+# columns as text logs, stored by column a block at a time; see
+# pebbl/bb/loadLogFile.h.  The column types 'i' and 'd' are also
+# array typecodes; 'q' (int64) is read with struct, since older Pythons
+# have no 'q' arrays.
+
+def readBinaryColumn(infile,typecode,n) :
+  if typecode == 'q' :
+    return list(struct.unpack('=%dq' % n,infile.read(8*n)))
+  a = array.array(typecode)
+  a.fromfile(infile,n)
+  return a.tolist()
+
+def readBinaryLog(infile,columns) :
+  (magic,version,ncols,namelen) = struct.unpack('=4siii',infile.read(16))
+  if version not in (1,2) or ncols <> len(columns) :
+    print "Error: unsupported binary load log format in",filename
+    exit(1)
+  types = infile.read(ncols)
+  infile.read(namelen)
+  start = infile.tell()
+  infile.seek(0,2)
+  end = infile.tell()
+  shift = 0.0
+  if end - start >= 16 :
+    infile.seek(end - 16)
+    (marker,tshift,endmagic) = struct.unpack('=id4s',infile.read(16))
+    if marker == -1 and endmagic == 'PBLL' :
+      shift = tshift
+      end = end - 16
+  infile.seek(start)
+  rows = 0
+  while infile.tell() < end :
+    (n,) = struct.unpack('=i',infile.read(4))
+    if n <= 0 :
+      break
+    for c in range(ncols) :
+      a = readBinaryColumn(infile,types[c],n)
+      if c == 1 :
+        columns[c].extend([t + shift for t in a])
+      else :
+        columns[c].extend(a)
+    rows = rows + n
+  return rows
+
 def plural(value) :
   if value == 1 :
     return ""
@@ -270,7 +317,7 @@ ncolors = len(colors)
 for filename in args :
 
   try :
-    infile = open(filename,'r')
+    infile = open(filename,'rb')
   except :
     print "Error: could not open file",filename
     exit(1)
@@ -278,6 +325,8 @@ for filename in args :
   if options.pname == None :
     if filename.endswith(".loadLog") :
       problemname = filename[0:len(filename)-1-len("loadLog")]
+    elif filename.endswith(".loadLog.bin") :
+      problemname = filename[0:len(filename)-1-len("loadLog.bin")]
     else :
       problemname = filename
   else :
@@ -310,30 +359,40 @@ for filename in args :
 
   records = 0
 
-  for line in infile:
-    line = getInt(line,False,processor)
-    line = getFloat(line,False,time)
-    line = getInt(line,False,bcalls)
-    line = getInt(line,False,sps)
-    line = getInt(line,False,hubsps)
-    line = getInt(line,False,totalsps)
-    line = getInt(line,False,serversps)
-    line = getInt(line,True,gloadest)
-    line = getInt(line,True,cloadest)
-    line = getInt(line,True,release)
-    line = getFloat(line,True,bounds)
-    line = getFloat(line,True,incumbents)
-    line = getFloat(line,True,gbounds)
-    line = getFloat(line,True,cbounds)
-    line = getFloat(line,True,hbounds)
-    line = getFloat(line,True,sbounds)
-    line = getInt(line,True,offers)
-    line = getInt(line,True,admits)
-    line = getInt(line,True,dispatches)
-    line = getInt(line,True,receives)
-    line = getInt(line,True,rebals)
-    line = getInt(line,True,lbrounds)
-    records = records + 1
+  if infile.read(4) == 'PBLL' :
+    infile.seek(0)
+    records = readBinaryLog(infile,
+                            [processor,time,bcalls,sps,hubsps,totalsps,
+                             serversps,gloadest,cloadest,release,bounds,
+                             incumbents,gbounds,cbounds,hbounds,sbounds,
+                             offers,admits,dispatches,receives,rebals,
+                             lbrounds])
+  else :
+    infile.seek(0)
+    for line in infile:
+      line = getInt(line,False,processor)
+      line = getFloat(line,False,time)
+      line = getInt(line,False,bcalls)
+      line = getInt(line,False,sps)
+      line = getInt(line,False,hubsps)
+      line = getInt(line,False,totalsps)
+      line = getInt(line,False,serversps)
+      line = getInt(line,True,gloadest)
+      line = getInt(line,True,cloadest)
+      line = getInt(line,True,release)
+      line = getFloat(line,True,bounds)
+      line = getFloat(line,True,incumbents)
+      line = getFloat(line,True,gbounds)
+      line = getFloat(line,True,cbounds)
+      line = getFloat(line,True,hbounds)
+      line = getFloat(line,True,sbounds)
+      line = getInt(line,True,offers)
+      line = getInt(line,True,admits)
+      line = getInt(line,True,dispatches)
+      line = getInt(line,True,receives)
+      line = getInt(line,True,rebals)
+      line = getInt(line,True,lbrounds)
+      records = records + 1
 
   procs = set(processor)
   nprocs = len(procs)
@@ -35,10 +35,12 @@
 #include <pebbl/utilib/file_util.h>
 
 #include <pebbl/bb/branching.h>
+#include <pebbl/bb/searchThread.h>
 #include <pebbl/misc/gRandom.h>
 
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 
 
 using namespace std;
@@ -74,7 +76,7 @@ string branching::version_info = "Unknown version";
 
 void branchSubId::branchSubIdFromBranching(branching* global)
   {
-  serial = ++(global->probCounter);
+  serial = global->bumpCounter(global->probCounter);
 #ifdef ACRO_HAVE_MPI
   creatingProcessor = uMPI::running() ? uMPI::rank : 0;
 #else
@@ -99,7 +101,7 @@ int coreSPInfo::dynamicSPCompare(const coreSPInfo& sp2) const
 
   // See if we are doing initial diving
   if (this->bGlobal()->initialDive && 
-      (fabs(this->bGlobal()->incumbentValue) == MAXDOUBLE))
+      (fabs(this->bGlobal()->incumbentNow()) == MAXDOUBLE))
     {
       // OK -- we are trying an initial dive and there is no incumbent,
       // so do not use the usual compare method...
@@ -247,6 +249,11 @@ void branching::branchingInitGuts()
   currentSP         = NULL;
   needPruning       = false;
 
+  loadHistBins      = 0;
+  loadHistActive    = false;
+  loadHistOrigin    = 0;
+  loadHistScale     = 1;
+
   vout = 0;
   statusLinePrecision = (int) ceil(-log10(max(relTolerance,1e-16)));
 
@@ -262,6 +269,7 @@ void branching::branchingInitGuts()
 void branching::reset(bool /*resetVB*/)
 {
   gRandomReSeed();
+  setCoarseTiming(coarseTiming);
   branchingInitGuts();
   resetIncumbent();
   if (parameter_initialized("startIncumbent"))
@@ -289,7 +297,7 @@ void branching::reset(bool /*resetVB*/)
   lastSolId.setWorstPossible(sense);
 
   if (enumerating)
-    reposTable.resize(enumHashSize);
+    repository.reset(enumHashSize);
 
   solsOffered  = 0;
   solsAdmitted = 0;
@@ -302,15 +310,10 @@ void branching::reset(bool /*resetVB*/)
   if (pool)
     delete pool;
 
-  if ( depthFirst )
-    pool = new doublyLinkedPool<branchSub,loadObject>(true);  //stack
-  else if ( breadthFirst )
-    pool = new doublyLinkedPool<branchSub,loadObject>(false); //queue
-  else
-    pool = new heapPool<branchSub,loadObject,DynamicSPCompare<branchSub> >();
- 
+  pool = makePool();
   pool->load().init(this);
-  pool->setGlobal(this);
+
+  clearSearchThreads();
 
   // Miscellaneous stuff
 
@@ -320,6 +323,12 @@ void branching::reset(bool /*resetVB*/)
 
   abortReason = NULL;
 
+  // Prepare for checkpointing if need be
+
+  checkpointsEnabled = (checkpointMinutes > 0);
+  checkpointNumber   = 0;
+  restartCPNum       = 0;
+
   // Set up handler on the assumption the user will not supply one
   // So far, users never supply handlers.
 
@@ -346,6 +355,35 @@ void branching::reset(bool /*resetVB*/)
 }
 
 
+// Make an empty pool of the kind selected by the search parameters
+
+branchPool<branchSub,loadObject>* branching::makePool()
+{
+  branchPool<branchSub,loadObject>* newPool;
+
+  if ( depthFirst )
+    newPool = new doublyLinkedPool<branchSub,loadObject>(true);  //stack
+  else if ( breadthFirst )
+    newPool = new doublyLinkedPool<branchSub,loadObject>(false); //queue
+  else if ( boundBuckets )
+    newPool = new bucketPool<branchSub,loadObject>(bucketWidth);
+  else if ( pressurePlunge )
+    newPool = new plungePool<branchSub,loadObject>(plungeSPLimit,
+						   plungeMemoryMB,
+						   plungeResumeFraction);
+  else if ( spillKeep > 0 )
+    newPool = new spillPool<branchSub,loadObject>(spillKeep,spillDir);
+  else if ( arrayHeap )
+    newPool = new arrayHeapPool<branchSub,loadObject>();
+  else
+    newPool = 
+      new heapPool<branchSub,loadObject,DynamicSPCompare<branchSub> >();
+
+  newPool->setGlobal(this);
+  return newPool;
+}
+
+
 // Standard serial read-in code.  Returns true if we can continue, false if
 // we have to bail out.
 
@@ -446,8 +484,13 @@ branching::~branching()
     delete pool;
   if (handler)
     delete handler;
+  if (llWriter)
+    delete llWriter;
+  clearSearchThreads();
+  finishSerialCheckpoint();
   resetIncumbent();
   clearRepository();
+  clearRegisteredSolutions();
 }
 
 
@@ -547,7 +590,7 @@ bool branching::canFathom(double boundValue)
   double denom = gapDenom(boundValue);
 
   DEBUGPR(1000, ucout << "branching::canFathom - Starting test incumbent = " 
-	  << incumbentValue << " bound = " << boundValue 
+	  << incumbentNow() << " bound = " << boundValue 
 	  << " Performing Enumeration: " << enumerating << endl);
 
   // One set of tests if enumerating
@@ -675,7 +718,7 @@ double branching::fathomValue()
   // Pretend the problem is always minization by multiplying the
   // incumbent by "sense"
 
-  double incv = sense*incumbentValue;
+  double incv = sense*incumbentNow();
 
   double fv = MAXDOUBLE;
 
@@ -727,6 +770,10 @@ void branching::foundSolution(solution* sol, syncType sync)
                     << ", hash = " << sol->computeHashValue() 
                     << ':' << (sol->computeHashValue() % enumHashSize) << endl);
     DEBUGPR(250,sol->print(ucout));
+    std::mutex* m = incumbentLock();
+    std::unique_lock<std::mutex> lock;
+    if (m)
+      lock = std::unique_lock<std::mutex>(*m);
     if (sense*(sol->value - incumbentValue) < 0)
     {
        DEBUGPR(10,ucout << "Improves incumbentValue=" << incumbentValue 
@@ -763,11 +810,66 @@ void branching::setIncumbent(solution* sol)
 {
     resetIncumbent();
     incumbent = sol;
-    incumbentValue = sol->value;
+    storeIncumbentValue(sol->value);
     sol->incrementRefs();  
 }
 
 
+// Register a solution representation (giving up ownership)
+
+size_type branching::registerFirstSolution(solution* referenceSolution)
+{
+  clearRegisteredSolutions();
+  return registerSolution(referenceSolution);
+}
+
+
+size_type branching::registerSolution(solution* referenceSolution)
+{
+  size_type id          = numRefSols++;
+  size_type currentSize = refSolArray.size();
+
+  if (numRefSols > currentSize)
+    refSolArray.resize(currentSize + refSolArrayQuantum);
+
+  refSolArray[id] = referenceSolution;
+  referenceSolution->typeId = id;
+  DEBUGPR(5,ucout << "Registered " 
+	  << referenceSolution->typeDescription()
+	  << " as having type " << id 
+	  << ", with buffer size " << referenceSolution->maxBufferSize()
+	  << endl);
+  return id;
+}
+
+
+// Clear the array of registered solutions
+
+void branching::clearRegisteredSolutions()
+{
+  DEBUGPR(5,ucout << "Clearing registered solutions\n");
+  for (size_type i=0; i<numRefSols; i++)
+    refSolArray[i]->dispose();
+  numRefSols = 0;
+}
+
+
+// Unpack a solution by using typeId to index into the reference
+// solution array.
+
+solution* branching::unpackSolution(UnPackBuffer& inBuf)
+{
+  int typeId = -1;
+  inBuf >> typeId;
+  if ((typeId < 0) || ((unsigned) typeId >= numRefSols))
+    EXCEPTION_MNGR(runtime_error,"Unpacked solution type id "
+		   << typeId << " is out of range 0.." << numRefSols-1);
+  solution* sol = refSolArray[typeId]->blankClone();
+  sol->unpack(inBuf);
+  return sol;
+}
+
+
 // Default (and typical) implementation of makeRoot operation.
 
 branchSub* branching::makeRoot() 
@@ -800,7 +902,7 @@ void branchSub::computeBound(double* controlParam)
   if (printSpTimes)
     startBCTime = WallClockSeconds();
   boundComputation(controlParam);
-  bGlobal()->boundCompCalls++;
+  bGlobal()->bumpCounter(bGlobal()->boundCompCalls);
   if (printSpTimes)
     {
       BCTime = WallClockSeconds() - startBCTime;
@@ -846,7 +948,7 @@ int branchSub::splitProblem()
   if (printSpTimes)
     {
       SCTime = WallClockSeconds() - startSCTime;
-      bGlobal()->splitCompCalls++;
+      bGlobal()->bumpCounter(bGlobal()->splitCompCalls);
       bGlobal()->splitCompTime   += SCTime;
       bGlobal()->splitCompTimeSq += SCTime*SCTime;
       if (printSpTimes > 1)
@@ -923,6 +1025,40 @@ void branchSub::recycle()
 }
 
 
+// Serial packing: the generic data, then whatever the application adds.
+// Unpacking does not touch the subproblem counters, since the
+// subproblem is not new.
+
+void branchSub::packSubproblem(PackBuffer& outBuf)
+{
+  outBuf << bound;
+  outBuf << integralityMeasure;
+  outBuf << id.serial << id.creatingProcessor;
+  outBuf << (int) state;
+  outBuf << depth;
+  outBuf << totalChildren;
+  outBuf << childrenLeft;
+  packContents(outBuf);
+}
+
+
+void branchSub::unpackSubproblem(UnPackBuffer& inBuf)
+{
+  int stateInt;
+  inBuf >> bound;
+  inBuf >> integralityMeasure;
+  inBuf >> id.serial >> id.creatingProcessor;
+  inBuf >> stateInt;
+  state = (subState) stateInt;
+  inBuf >> depth;
+  inBuf >> totalChildren;
+  inBuf >> childrenLeft;
+  poolPtr = 0;
+  unpackContents(inBuf);
+  DEBUGPR(150,ucout << "Unpacked " << this << '\n');
+}
+
+
 // Minimal implementation of setRoot() (to tell a problem it's a root).
 // Typically called from a more elaborate, specific setRoot in a
 // derived class.
@@ -966,30 +1102,66 @@ double branching::searchFramework(spHandler* handler_)
       handler->setGlobal(this);
     }
 
-  // Preprocess problem, make a root subproblem, and put it in the pool.
+  checkpointTriggerTime = WallClockSeconds() + checkpointMinutes*60;
+  checkpointTotalTime   = 0;
+
+  // Preprocess problem, then either restart from a checkpoint or make
+  // a root subproblem and put it in the pool.
 
   preprocess();
-  {
-    branchSub *tmp = makeRoot();
-    pool->insert(tmp);
-  }
 
-  // Guess initial solution
+  bool restarted = false;
+  if (restart)
+    {
+      ucout << "Trying to restart from checkpoint\n\n";
+      restarted = serialRestart();
+      if (restarted)
+	ucout << "Checkpoint " << checkpointNumber
+	      << " loaded successfully.\n";
+      else
+	ucout << "Warning: unable to read checkpoint files.  "
+	      << "Starting from the root.\n\n";
+    }
 
-  solution* guessSol = initialGuess();
-  if (guessSol)
+  if (!restarted)
     {
-      DEBUGPR(4,ucout << "Initial guess solution: value = " << guessSol->value 
-	      << ", hash = " << guessSol->computeHashValue() 
-	      << ':' << (guessSol->computeHashValue() % enumHashSize) << endl);
-      setIncumbent(guessSol);
-      reposOrDrop(guessSol);
+      branchSub *tmp = makeRoot();
+      if (checkpointsEnabled && !tmp->packable())
+	{
+	  if (!suppressWarnings)
+	    ucout << "****** Warning ******** checkpointMinutes ignored: "
+		  << "subproblems of this application cannot be packed.\n";
+	  checkpointsEnabled = false;
+	}
+      pool->insert(tmp);
+
+      // Guess initial solution
+
+      solution* guessSol = initialGuess();
+      if (guessSol)
+	{
+	  DEBUGPR(4,ucout << "Initial guess solution: value = " 
+		  << guessSol->value 
+		  << ", hash = " << guessSol->computeHashValue() 
+		  << ':' << (guessSol->computeHashValue() % enumHashSize) 
+		  << endl);
+	  setIncumbent(guessSol);
+	  reposOrDrop(guessSol);
+	}
     }
 
+  prepareCPAbort();
+
   MEMORY_BASELINE;
 
   startLoadLogIfNeeded();
 
+  // With numThreads > 1, the threads process the whole tree and leave
+  // the pool empty, so the loop below has nothing to do.
+
+  if (canUseThreads(handler_))
+    threadedSearch(lastPrint,lastPrintTime);
+
   // The main loop -- process problems until the pool is empty.
 
   while (haveCurrentSP() || (pool->size() > 0))
@@ -1034,6 +1206,9 @@ double branching::searchFramework(spHandler* handler_)
 
       recordLoadLogIfNeeded();
 
+      if (serialCheckpointDue())
+	writeSerialCheckpoint();
+
       DEBUGPR(2000,
 	      ucout << "Pool scan: \n";
 	      int s = pool->size();
@@ -1041,7 +1216,16 @@ double branching::searchFramework(spHandler* handler_)
 	      for(int i=0; i<s; i++)
 	      ucout << "  " << pool->scan() << endl;);
 
-      if (shouldAbort(subCount[beingBounded]))
+      bool abortNow = shouldAbort(subCount[beingBounded]);
+      if ((cpAbortNum > 0) && (checkpointNumber == cpAbortNum))
+	{
+	  finishSerialCheckpoint();
+	  if (!abortReason)
+	    abortReason = "reached abort checkpoint";
+	  abortNow = true;
+	}
+
+      if (abortNow)
 	{
 	  if (haveCurrentSP())
 	    unloadCurrentSPtoPool();
@@ -1058,6 +1242,13 @@ double branching::searchFramework(spHandler* handler_)
 
   searchTime = CPUSeconds() - startTime;
 
+  // A finished search no longer needs its last checkpoint; an aborted
+  // one keeps it so the run can be resumed with --restart.
+
+  finishSerialCheckpoint();
+  if ((checkpointNumber > 0) && !abortReason)
+    remove(serialCheckpointFilename(checkpointNumber).c_str());
+
   finishLoadLogIfNeeded();
 
   if (valLogOutput())
@@ -1084,14 +1275,14 @@ bool branching::shouldAbort(int boundCount)
       return true;
     }
   if ((maxCPUMinutes > 0) && 
-      (CPUSeconds() - startTime > maxCPUMinutes*60))
+      (CoarseCPUSeconds() - startTime > maxCPUMinutes*60))
     {
       if (!abortReason)
 	abortReason = "too much CPU time";
       return true;
     }
   if ((maxWallMinutes > 0) && 
-      (WallClockSeconds() - startWall > maxWallMinutes*60))
+      (CoarseWallClockSeconds() - startWall > maxWallMinutes*60))
     {
       if (!abortReason)
 	abortReason = "too much wall clock time";
@@ -1421,6 +1612,9 @@ loadObject branching::load()
 
 loadObject branching::updatedLoad()
 {
+  if (threadsActive)
+    return threadedLoad();
+
   loadObject l = pool->updatedLoad();
   if (haveCurrentSP())
     l += *currentSP;
@@ -1455,7 +1649,7 @@ void branching::statusPrint(int&        lastPrint,
       (l.boundedSPs >= lastPrint + statusPrintCount))
     needPrint = true;
 
-  double now = WallClockSeconds();
+  double now = CoarseWallClockSeconds();
   if ((statusPrintSeconds > 0) &&
       (now >= lastPrintTime + statusPrintSeconds))
     needPrint = true;
@@ -1556,7 +1750,7 @@ void branching::statusLine(loadObject& l, const char* tag)
 
 int branching::serialNeedEarlyOutput()
 {
-  if (WallClockSeconds() < nextOutputTime)
+  if (CoarseWallClockSeconds() < nextOutputTime)
     return false;
   return sense*(incumbentValue - lastSolValOutput) < 0;
 }
@@ -1659,6 +1853,14 @@ void branching::printTimings(ostream& stream)
   stream.unsetf(ios::floatfield);
   stream.precision(oldPrecision);
 
+  if (checkpointsEnabled)
+    {
+      int cpsWritten = checkpointNumber - restartCPNum;
+      stream << cpsWritten << " checkpoint" << plural(cpsWritten)
+	     << " written, pausing the search for " << checkpointTotalTime
+	     << " seconds" << endl;
+    }
+
   if (printSpTimes)
     printSpTimeStats(stream);
 }
@@ -1699,6 +1901,14 @@ void branching::printAllStatistics(ostream& stream)
   printSPStatistics(stream);
   if (enumerating)
     printReposStatistics(stream);
+  if (searchThreads.size() > 1)
+    {
+      printThreadStatistics(stream);
+      for (size_type i=0; i<searchThreads.size(); i++)
+	searchThreads[i]->pool->printStatistics(stream);
+    }
+  else if (pool)
+    pool->printStatistics(stream);
   printTimings(stream);
 }
 
@@ -1788,7 +1998,9 @@ void branching::printSPLine(ostream&    stream,
 
 ostream* branching::valLogFile()
 {
-  if (validateLog)
+  if (validateLog && validateLogBinary)
+    return new valLogStream("val00000.vbin",ios::out | ios::binary);
+  else if (validateLog)
     return new ofstream("val00000.log",ios::out);
   else
     return 0;
@@ -1799,6 +2011,11 @@ void branching::valLogInit()
 {
   if (!vout)
     return;
+  if (validateLogBinary)
+    {
+      valLogRecord::headerRecord().write(*vout);
+      return;
+    }
   vout->setf(ios::scientific,ios::floatfield);  // Output bounds at very
   vout->precision(20);                          // high precision.
 }
@@ -1806,6 +2023,16 @@ void branching::valLogInit()
 
 void branching::valLogFathomPrint()
 {
+  if (validateLogBinary)
+    {
+      valLogRecord r(valLogRecord::fathoming);
+      r.bound          = incumbentValue;
+      r.count          = sense;
+      r.extraDouble[0] = relTolerance;
+      r.extraDouble[1] = absTolerance;
+      r.write(*vout);
+      return;
+    }
   *vout << "fathoming " << incumbentValue << ' ' << (int) sense << ' ';
   *vout << relTolerance << ' ' << absTolerance << '\n';
 }
@@ -1893,17 +2120,47 @@ void branchSub::valLogWriteID(char separator)
 
 void branchSub::valLogWriteBound(char separator)
 {
-  if ((state == dead) && !(bGlobal()->canFathom(bound)))
-    *vout << bGlobal()->sense*MAXDOUBLE;
-  else
-    *vout << bound;
+  *vout << valLogBound();
   if (separator)
     *vout << separator;
 }
 
 
+double branchSub::valLogBound()
+{
+  if ((state == dead) && !(bGlobal()->canFathom(bound)))
+    return bGlobal()->sense*MAXDOUBLE;
+  return bound;
+}
+
+
+valLogRecord branchSub::valLogRecordFor(valLogRecord::kindType kind)
+{
+  valLogRecord r(kind);
+  r.proc   = valLogProc();
+  r.serial = id.serial;
+  r.bound  = valLogBound();
+  return r;
+}
+
+
+void branchSub::valLogWrite(valLogRecord& r)
+{
+  valLogRecordExtra(r);
+  r.write(*vout);
+}
+
+
 void branchSub::valLogCreatePrint(branchSub* parent)
 {
+  if (valLogBinary())
+    {
+      valLogRecord r = valLogRecordFor(valLogRecord::create);
+      r.parentProc   = parent ? parent->valLogProc() : -1;
+      r.parentSerial = parent ? parent->id.serial    : -1;
+      valLogWrite(r);
+      return;
+    }
   *vout << "create ";
   valLogWriteID(' ');
   valLogWriteBound(' ');
@@ -1918,6 +2175,12 @@ void branchSub::valLogCreatePrint(branchSub* parent)
 
 void branchSub::valLogBoundPrint()
 {
+  if (valLogBinary())
+    {
+      valLogRecord r = valLogRecordFor(valLogRecord::bounding);
+      valLogWrite(r);
+      return;
+    }
   *vout << "bound ";
   valLogWriteID(' ');
   valLogWriteBound();
@@ -1928,6 +2191,13 @@ void branchSub::valLogBoundPrint()
 
 void branchSub::valLogSplitPrint()
 {
+  if (valLogBinary())
+    {
+      valLogRecord r = valLogRecordFor(valLogRecord::split);
+      r.count = totalChildren;
+      valLogWrite(r);
+      return;
+    }
   *vout << "split ";
   valLogWriteID(' ');
   *vout << totalChildren << ' ';
@@ -1939,6 +2209,13 @@ void branchSub::valLogSplitPrint()
 
 void branchSub::valLogDestroyPrint()
 {
+  if (valLogBinary())
+    {
+      valLogRecord r = valLogRecordFor(valLogRecord::destroy);
+      r.count = childrenLeft;
+      valLogWrite(r);
+      return;
+    }
   *vout << "destroy ";
   valLogWriteID(' ');
   *vout << childrenLeft << ' ';
@@ -2045,13 +2322,13 @@ solution::solution(branching* bGlobal) :
   hashComputed(false),
   refCounter(1)
 {
-  serial = ++(bGlobal->solSerialCounter);
+  serial = bGlobal->bumpCounter(bGlobal->solSerialCounter);
 }
 
 
 void solution::creationStamp(branching* bGlobal,int typeId_)
 {
-  serial = ++(bGlobal->solSerialCounter);
+  serial = bGlobal->bumpCounter(bGlobal->solSerialCounter);
 #ifdef ACRO_HAVE_MPI
   owningProcessor = bGlobal->pebblRank();
 #endif
@@ -2088,11 +2365,12 @@ void solutionIdentifier::setWorstPossible(optimType sense_)
 }
 
 
-#ifdef ACRO_HAVE_MPI
-
 void solutionIdentifier::pack(PackBuffer& outBuf) const
 {
-  outBuf << value << serial << (int) sense << owningProcessor;
+  outBuf << value << serial << (int) sense;
+#ifdef ACRO_HAVE_MPI
+  outBuf << owningProcessor;
+#endif
 }
 
 
@@ -2103,7 +2381,9 @@ void solutionIdentifier::unpack(UnPackBuffer& inBuf)
   int temp = 0;
   inBuf >> temp;
   sense = (optimType) temp;
+#ifdef ACRO_HAVE_MPI
   inBuf >> owningProcessor;
+#endif
 }
 
 
@@ -2112,8 +2392,6 @@ int solutionIdentifier::packSize()
   return sizeof(double) + 3*sizeof(int);
 }
 
-#endif
-
 
 // Operator to compare two solutions or solutionIdentifiers
 
@@ -2217,9 +2495,7 @@ bool solution::duplicateOf(solution& other)
 
 solution* branching::worstReposSol()
 {
-  if (repositorySize() == 0)
-    return NULL;
-  return &(reposHeap.top()->key());
+  return repository.worst();
 }
 
 
@@ -2227,7 +2503,7 @@ double branching::worstReposValue()
 {
   if (repositorySize() == 0)
     return -sense*MAXDOUBLE;
-  return reposHeap.top()->key().value;
+  return repository.worst()->value;
 }
 
 
@@ -2250,78 +2526,33 @@ bool branching::localReposOffer(solution* sol)
       return false;
     }
 
-  // Check for a duplicate already in the repository.  Find the list
-  // in the hash table that would have to hold a possible duplicate.
-
-  size_type solHash   = sol->computeHashValue();
-  size_type whichList = solHash % enumHashSize;
-
-  DEBUGPR(20,ucout << "Searching list " << whichList << endl);
+  // Check for a duplicate already in the repository
 
-  // Grab the head of the list and scan the list for a duplicate
-
-  ListItem<solution*>* cursor = reposTable[whichList].head();
-
-  while(cursor)
+  solution* dup = repository.findDuplicate(sol);
+  if (dup)
     {
-      DEBUGPR(100,ucout << "Checking against " << cursor 
-	      << "->" << (void*) cursor->Data 
-	      << "=" << cursor->Data 
-	      << " hash=" << cursor->Data->hashValue << endl);
-      solution* cursorSol  = cursor->Data;
-      size_type cursorHash = cursorSol->hashValue;
-
-      // The list is in hashValue order, so we can give up if the hash
-      // is already too large.  Otherwise, check for a duplicate.
-
-      if (cursorHash > solHash)
-	break;
-      else if ((cursorHash == solHash) && cursorSol->duplicateOf(*sol))
-	{
-	  DEBUGPR(20,ucout << "localReposOffer: duplicate of "
-		  << cursorSol << endl);
-	  sol->dispose();
-	  return false;
-	}
-
-      // Move on to next element in list
-
-      DEBUGPR(200,ucout << "No match\n");
-      cursor = reposTable[whichList].next(cursor);
+      DEBUGPR(20,ucout << "localReposOffer: duplicate of " << dup << endl);
+      sol->dispose();
+      return false;
     }
 
   DEBUGPR(10,ucout << "Admitted to repository\n");
   solsAdmitted++;
 
-  // At this point, cursor is either NULL, indicating that we scanned
-  // the whole ist and found no duplicates, or points to a list item
-  // right after where the new solution should go in the list.  In
-  // either case, the list "add" operation should insert it in the
-  // right place (either the end or the middle, respectively).
-  // Remember where we put the solution in the list, so we don't have
-  // to scan when we delete.
-
-  sol->hashItem = reposTable[whichList].add(sol,cursor);
-
-  // The solution also needs to go into the heap.  If enumCount is
-  // being used and the repository is full, this involves swapping out
-  // and deleting the worse entry in the repository.  Otherwise, we
-  // just insert into the heap.  Note that this case is very unlikely
-  // in parallel, where each processor will normally have only about
-  // 1/p-th of the solutions in the repository.
+  // If enumCount is being used and the repository is full, the new
+  // solution takes the place of the worst one, which is deleted.
+  // Otherwise, we just insert it.  Note that this case is very
+  // unlikely in parallel, where each processor will normally have
+  // only about 1/p-th of the solutions in the repository.
 
   if ((enumCount > 0) && (repositorySize() == (unsigned) enumCount))
     {
-      GenericHeapItem<solution>* oldTop = reposHeap.swapTop(*sol);
-      solution* oldTopSol = &(oldTop->key());
-      DEBUGPR(10,ucout << "Pushes out " << oldTopSol << endl);
-      size_type oldWhichList = oldTopSol->hashValue % enumHashSize;
-      reposTable[oldWhichList].remove(oldTopSol->hashItem);
-      oldTopSol->dispose();
-      delete oldTop;
+      solution* oldWorst = repository.replaceWorst(sol);
+      DEBUGPR(10,ucout << "Pushes out " << oldWorst << endl);
+      oldWorst->dispose();
     }
   else
-    reposHeap.add(*sol);
+    repository.insert(sol);
 
   DEBUGPR(10,ucout << "(Local) repository size now "
 	  << repositorySize() << ", worst value "
@@ -2353,7 +2584,10 @@ void branching::offerToRepository(solution* sol,syncType sync)
       double oldPruneValue = lastSolId.value;
       updateLastSolId(worstReposSol());
       if (lastSolId.value != oldPruneValue)
-	needPruning = true;
+	{
+	  needPruning = true;
+	  pruneEpoch++;
+	}
     }
 
   return;
@@ -2426,18 +2660,7 @@ bool branching::canFathomFromRepository(solutionIdentifier* solPtr)
 
 solution* branching::removeWorstInRepos()
 {
-  GenericHeapItem<solution>* oldTop = reposHeap.top();
-  solution* oldTopSol = &(oldTop->key());
-  bool status = true;
-  reposHeap.remove(oldTop,status);
-#ifdef ACRO_VALIDATING
-  if (!status)
-    EXCEPTION_MNGR(runtime_error,"GenericHeap::remove returned false status"
-		   " to branching::removeWorstInRepos");
-#endif
-  size_type whichList = oldTopSol->hashValue % enumHashSize;
-  reposTable[whichList].remove(oldTopSol->hashItem);
-  return oldTopSol;
+  return repository.removeWorst();
 }
 
 
@@ -2462,34 +2685,11 @@ bool branching::updateLastSolId(solutionIdentifier* sol)
 
 void branching::sortRepository(BasicArray<solution*>& solArray)
 {
-  size_type n = repositorySize();
-  solArray.resize(n);
-
-  if (n == 0)
-    return;
-
-  // Copy the repository heap, so we don't destroy the original
-
-  reposSolHeap heapCopy(reposHeap);
-
-  DEBUGPR(200,ucout << "Copied heap:\n" << reposHeap << endl);
-
-  // Pull things out of the heap copy one-by-one.  Since the heap is
-  // in reverse order, put them in the array from the end, working
-  // backwards.
-
-  while(n > 0)
-    {
-      GenericHeapItem<solution>* topItem = heapCopy.top();
-      solArray[--n] = &(topItem->key());
-      bool status = true;
-      heapCopy.remove(topItem,status);
-#ifdef ACRO_VALIDATING
-      if (!status)
-	EXCEPTION_MNGR(runtime_error,"GenericHeap::remove returned false "
-		       " status to branching::sortRepository");
-#endif
-    }
+  vector<solution*> sorted;
+  repository.sorted(sorted);
+  solArray.resize(sorted.size());
+  for (size_type i=0; i<sorted.size(); i++)
+    solArray[i] = sorted[i];
 }
 
 
@@ -2498,34 +2698,11 @@ void branching::sortRepository(BasicArray<solution*>& solArray)
 
 void branching::sortReposIds(BasicArray<solutionIdentifier>& result)
 {
-  size_type n = repositorySize();
-  result.resize(n);
-
-  if (n == 0)
-    return;
-
-  // Copy the repository heap, so we don't destroy the original
-
-  reposSolHeap heapCopy(reposHeap);
-
-  DEBUGPR(200,ucout << "Copied heap:\n" << reposHeap << endl);
-
-  // Pull things out of the heap copy one-by-one.  Since the heap is
-  // in reverse order, put them in the array from the end, working
-  // backwards.
-
-  while(n > 0)
-    {
-      GenericHeapItem<solution>* topItem = heapCopy.top();
-      result[--n].copy(&(topItem->key()));
-      bool status = true;
-      heapCopy.remove(topItem,status);
-#ifdef ACRO_VALIDATING
-      if (!status)
-	EXCEPTION_MNGR(runtime_error,"GenericHeap::remove returned false "
-		       " status to branching::sortReposIds");
-#endif
-    }
+  vector<solution*> sorted;
+  repository.sorted(sorted);
+  result.resize(sorted.size());
+  for (size_type i=0; i<sorted.size(); i++)
+    result[i].copy(sorted[i]);
 }
 
 
@@ -2597,8 +2774,21 @@ void branching::startLoadLogIfNeeded()
 }
 
 
-void branching::beginLoadLog()
+void branching::beginLoadLog(int proc)
 {
+  loadLogProc = proc;
+  if (loadLogBinary)
+    {
+      if (llWriter)
+	delete llWriter;
+      llWriter = new loadLogWriter(loadLogBinaryFileName(proc));
+      if (!llWriter->good())
+	{
+	  ucout << "****** Warning ******** could not open load log file.\n";
+	  delete llWriter;
+	  llWriter = NULL;
+	}
+    }
   loadLogBaseTime = WallClockSeconds();
   lastLog->time   = loadLogBaseTime;
   lastLLWriteTime = loadLogBaseTime;
@@ -2610,7 +2800,7 @@ void branching::recordLoadLogIfNeeded()
 {
   if (loadLogSeconds > 0)
     {
-      double now = WallClockSeconds();
+      double now = CoarseWallClockSeconds();
       if (now >= lastLog->time + loadLogSeconds)
 	recordLoadLogData(now);
     }
@@ -2620,10 +2810,11 @@ void branching::recordLoadLogIfNeeded()
 void branching::recordLoadLogData(double time)
 {
   loadLogRecord* record = new loadLogRecord(sense);
+  loadObject l = updatedLoad();
   recordSerialLoadData(record,
 		       time,
-		       pool->size(),
-		       updatedLoad().aggregateBound);
+		       threadsActive ? l.count() : pool->size(),
+		       l.aggregateBound);
   if (needToWriteLoadLog(time))
     {
       writeLoadLog();
@@ -2654,15 +2845,24 @@ void branching::recordSerialLoadData(loadLogRecord* record,
   record->admits  = solsAdmitted - lastLog->admits;
   lastLog->admits = solsAdmitted;
 
-  if (depthFirst || breadthFirst)
-    mainBound = -sense*MAXDOUBLE;
   record->bound = mainBound;
 
   record->incVal = incumbentValue;
 
-  // Now stuff the record in the list
+  // Now stuff the record in the list, or write it to the binary log
 
-  loadLogEntries.add(record);
+  if (loadLogBinary)
+    {
+      if (llWriter)
+	{
+	  double row[loadLogColumns::count];
+	  record->writeToRow(row,sense,loadLogBaseTime,loadLogProc);
+	  llWriter->add(row);
+	}
+      delete record;
+    }
+  else
+    loadLogEntries.add(record);
 }
 
 
@@ -2672,6 +2872,11 @@ void branching::finishLoadLogIfNeeded()
     {
       recordLoadLogData(WallClockSeconds());  // Record a final data point.
       writeLoadLog();
+      if (llWriter)
+	{
+	  delete llWriter;                      // Writes the trailer
+	  llWriter = NULL;
+	}
       delete lastLog;
       lastLog = NULL;
     }
@@ -2690,8 +2895,22 @@ std::string branching::loadLogFileName()
 }
 
 
+std::string branching::loadLogBinaryFileName(int proc)
+{
+  std::ostringstream filename;
+  filename << loadLogFileName() << '.' << proc << ".bin";
+  return filename.str();
+}
+
+
 void branching::writeLoadLog()
 {
+  if (loadLogBinary)
+    {
+      if (llWriter)
+	llWriter->flush();
+      return;
+    }
   if (loadLogEntries.empty())
     return;
   std::string filename = loadLogFileName();
@@ -2743,7 +2962,31 @@ void loadLogRecord::writeToStream(ostream& os,
 }
 
 
-#ifdef ACRO_HAVE_MPI
+void loadLogRecord::writeToRow(double* row,
+			       int     sense,
+			       double  baseTime,
+			       int     proc)
+{
+  double dummyBoundVal = sense*MAXDOUBLE;
+
+  for (int c=0; c<loadLogColumns::count; c++)
+    row[c] = 0;                  // Parallel-only stuff stays 0
+
+  row[loadLogColumns::procCol]         = proc;
+  row[loadLogColumns::timeCol]         = time - baseTime;
+  row[loadLogColumns::boundCallsCol]   = boundCalls;
+  row[loadLogColumns::poolCol]         = pool;
+  row[loadLogColumns::totalPoolCol]    = pool;
+  row[loadLogColumns::boundCol]        = bound;
+  row[loadLogColumns::incumbentCol]    = incVal;
+  row[loadLogColumns::globalBoundCol]  = dummyBoundVal;
+  row[loadLogColumns::clusterBoundCol] = dummyBoundVal;
+  row[loadLogColumns::hubBoundCol]     = dummyBoundVal;
+  row[loadLogColumns::serverBoundCol]  = dummyBoundVal;
+  row[loadLogColumns::offersCol]       = offers;
+  row[loadLogColumns::admitsCol]       = admits;
+}
+
 
 void solution::pack(PackBuffer& outBuf) const
 {
@@ -2770,6 +3013,8 @@ int solution::maxBufferSize()
 }
 
 
+#ifdef ACRO_HAVE_MPI
+
 void loadLogRecord::pack(PackBuffer& pb)
 {
   pb << time
@@ -33,13 +33,25 @@
 #include <pebbl/utilib/GenericHeap.h>
 #include <pebbl/utilib/exception_mngr.h>
 #include <pebbl/utilib/ParameterList.h>
-#ifdef   ACRO_HAVE_MPI
 #include <pebbl/utilib/PackBuf.h>
-#endif
 #include <pebbl/misc/memUtil.h>
+#include <pebbl/misc/spillFile.h>
 #include <pebbl/bb/pebblBase.h>
 #include <pebbl/bb/pebblParams.h>
 #include <pebbl/bb/loadObject.h>
+#include <pebbl/bb/solRepository.h>
+#include <pebbl/bb/valLog.h>
+#include <pebbl/bb/loadLogFile.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 extern "C" void pebbl_abort_handler(int code);
 
@@ -54,6 +66,7 @@ class branchSub;
 class branching;
 class solution;
 class spHandler;
+class searchThread;
 
 
 ///
@@ -143,6 +156,10 @@ public:
 
   virtual void myPrint()=0;
 
+  // For pools with something to add to the end-of-run statistics
+
+  virtual void printStatistics(std::ostream& /*stream*/) { };
+
  protected:
 
   LOAD myLoad;
@@ -156,7 +173,9 @@ public:
 //-----------------------------------------------------------------------
 //
 //  Standard pool implementations for depth and
-//  breadth-first. 
+//  breadth-first.  Besides the list itself, the pool keeps a count of
+//  the subproblems at each bound value, so it can report the best
+//  bound in the pool (and hence a gap) in O(log n) time.
 //
 
 template <class SUB, class LOAD> 
@@ -172,6 +191,7 @@ class doublyLinkedPool : public branchPool <SUB,LOAD>
     {
       ListItem<SUB*> *item = list.add(p); 
       p->poolPtr = item; 
+      boundCount[p->bound]++;
       this->myLoad += *p;
       return size();
     };
@@ -252,6 +272,17 @@ class doublyLinkedPool : public branchPool <SUB,LOAD>
 
   ~doublyLinkedPool() { this->clear(); };  
 
+  bool knowsGlobalBound() { return size() > 0; };
+
+  double globalBound()
+    {
+      if (size() == 0)
+	return this->global()->sense*MAXDOUBLE;
+      if (this->global()->sense > 0)
+	return boundCount.begin()->first;
+      return boundCount.rbegin()->first;
+    };
+
   virtual void myPrint()
     {
       std::cout<<"\n======doublyLinkedPool=========\n";
@@ -272,11 +303,21 @@ class doublyLinkedPool : public branchPool <SUB,LOAD>
 
   ListItem< SUB* > *unloadCursor; 
 
+  // Number of subproblems in the pool with each bound value
+
+  std::map<double,int> boundCount;
+
   SUB* removeListItem(ListItem<SUB*> *item)
     {
       SUB *p;
 
       list.remove(item,p);
+      std::map<double,int>::iterator b = boundCount.find(p->bound);
+      if (b == boundCount.end())
+	EXCEPTION_MNGR(std::runtime_error,
+		       "Bound of removed subproblem not found in pool");
+      if (--(b->second) == 0)
+	boundCount.erase(b);
       this->myLoad -= *p;
       return p;
     };
@@ -442,7 +483,997 @@ class heapPool : public branchPool <SUB,LOAD>
       this->myLoad -= *p;
       return p;
     };
- 
+
+};
+
+
+//--------------------------------------------------------------------------
+//
+//  A best-first pool implemented as an ARITY-ary heap stored directly
+//  in an array.  Each slot keeps a copy of the subproblem's sort key
+//  (bound, integrality measure, depth, serial number) next to the
+//  subproblem pointer, so sifting never dereferences the subproblems
+//  or calls the virtual comparison.  The order is the same as
+//  DynamicSPCompare.  A subproblem's key must not change while it is
+//  in the pool.  The slot index is kept in poolPtr for remove(p).
+//
+
+template <class SUB, class LOAD, int ARITY = 4>
+class arrayHeapPool : public branchPool <SUB,LOAD>
+{
+ public:
+
+  int size() { return heap.size(); };
+
+  int insert(SUB* p)
+    {
+      checkOrder();
+      heapSlot s;
+      s.bound       = p->bound;
+      s.intMeasure  = p->integralityMeasure;
+      s.depth       = p->depth;
+      s.serial      = p->id.serial;
+      s.sp          = p;
+      heap.push_back(s);
+      siftUp(heap.size() - 1);
+      this->myLoad += *p;
+      return size();
+    };
+
+  SUB* select()
+    {
+      checkOrder();
+      return heap[0].sp;
+    };
+
+  SUB* remove(SUB* p)
+    {
+      size_type i = (size_type) reinterpret_cast<uintptr_t>(p->poolPtr);
+      if ((i >= heap.size()) || (heap[i].sp != p))
+	EXCEPTION_MNGR(std::runtime_error,"The item was not found in the heap");
+      return removeSlot(i);
+    };
+
+  SUB* remove() { return remove(select()); };
+
+  void clear()
+    {
+      while (heap.size() > 0)
+	removeSlot(heap.size() - 1)->recycle();
+    };
+
+  // Unlike heapPool, this prunes the whole pool: the survivors are
+  // compacted and the heap is rebuilt in linear time.
+
+  int prune()
+    {
+      size_type kept = 0;
+      for (size_type i=0; i<heap.size(); i++)
+	{
+	  SUB* p = heap[i].sp;
+	  if (p->canFathom())
+	    {
+	      this->myLoad -= *p;
+	      p->recycle();
+	    }
+	  else
+	    heap[kept++] = heap[i];
+	}
+      heap.resize(kept);
+      checkOrder();
+      heapify();
+      return size();
+    };
+
+  arrayHeapPool() :
+    diving(false),
+    unloadCursor(0),
+    scanCursor(0)
+    { };
+
+  void reset()
+    {
+      clear();
+      unloadCursor = 0;
+      scanCursor   = 0;
+    };
+
+  virtual ~arrayHeapPool() { clear(); };
+
+  bool knowsGlobalBound() { return !divingNow() && (size() > 0); };
+
+  double globalBound()
+    {
+      if (size() > 0)
+	return select()->bound;
+      return this->global()->sense*MAXDOUBLE;
+    };
+
+  void resetScan() { scanCursor = 0; };
+
+  SUB* scan() { return heap[scanCursor++].sp; };
+
+  SUB* firstToUnload()
+    {
+      unloadCursor = std::min(size(),2) - 1;
+      return nextToUnload();
+    };
+
+  SUB* nextToUnload()
+    {
+      if (size() == 0) return 0;
+      if (unloadCursor < size())
+	return heap[unloadCursor++].sp;
+      return firstToUnload();
+    };
+
+  virtual void myPrint()
+    {
+      std::cout<<"\n=======arrayHeapPool================\n";
+      for(size_type i=0; i<heap.size(); i++)
+	std::cout<<heap[i].sp<<" || ";
+      std::cout<<std::endl<<std::endl;
+    };
+
+ protected:
+
+  struct heapSlot
+  {
+    double bound;
+    double intMeasure;
+    int    depth;
+    int    serial;
+    SUB*   sp;
+  };
+
+  std::vector<heapSlot> heap;
+
+  // Ordering state, refreshed by checkOrder()
+
+  bool diving;
+  int  sense;
+  bool intDive;
+
+  int unloadCursor;
+  int scanCursor;
+
+  bool divingNow()
+    {
+      return this->global()->initialDive && 
+	(std::fabs(this->global()->incumbentNow()) == MAXDOUBLE);
+    };
+
+  // The order changes once diving stops, so rebuild when it does
+
+  void checkOrder()
+    {
+      sense   = this->global()->sense;
+      intDive = this->global()->integralityDive;
+      bool d  = divingNow();
+      if (d != diving)
+	{
+	  diving = d;
+	  heapify();
+	}
+    };
+
+  // Same tests, in the same order, as coreSPInfo::dynamicSPCompare
+
+  bool better(const heapSlot& a,const heapSlot& b) const
+    {
+      if (diving)
+	{
+	  if (intDive && (a.intMeasure != b.intMeasure))
+	    return a.intMeasure < b.intMeasure;
+	  if (a.depth != b.depth)
+	    return a.depth > b.depth;
+	}
+      if (a.bound != b.bound)
+	return sense*(a.bound - b.bound) < 0;
+      if (a.intMeasure != b.intMeasure)
+	return a.intMeasure < b.intMeasure;
+      if (a.serial != b.serial)
+	return a.serial < b.serial;
+      return a.sp->id.creatingProcessor < b.sp->id.creatingProcessor;
+    };
+
+  void place(size_type i,const heapSlot& s)
+    {
+      heap[i] = s;
+      s.sp->poolPtr = reinterpret_cast<void*>((uintptr_t) i);
+    };
+
+  void siftUp(size_type i)
+    {
+      heapSlot s = heap[i];
+      while (i > 0)
+	{
+	  size_type parent = (i - 1)/ARITY;
+	  if (!better(s,heap[parent]))
+	    break;
+	  place(i,heap[parent]);
+	  i = parent;
+	}
+      place(i,s);
+    };
+
+  void siftDown(size_type i)
+    {
+      heapSlot  s = heap[i];
+      size_type n = heap.size();
+      for (;;)
+	{
+	  size_type first = ARITY*i + 1;
+	  if (first >= n)
+	    break;
+	  size_type last = std::min(first + ARITY,n);
+	  size_type best = first;
+	  for (size_type c=first+1; c<last; c++)
+	    if (better(heap[c],heap[best]))
+	      best = c;
+	  if (!better(heap[best],s))
+	    break;
+	  place(i,heap[best]);
+	  i = best;
+	}
+      place(i,s);
+    };
+
+  void heapify()
+    {
+      for (size_type i=heap.size(); i>0; i--)
+	siftDown(i - 1);
+    };
+
+  SUB* removeSlot(size_type i)
+    {
+      SUB* p = heap[i].sp;
+      heapSlot last = heap.back();
+      heap.pop_back();
+      if (i < heap.size())
+	{
+	  place(i,last);
+	  if ((i > 0) && better(last,heap[(i - 1)/ARITY]))
+	    siftUp(i);
+	  else
+	    siftDown(i);
+	}
+      this->myLoad -= *p;
+      return p;
+    };
+
+};
+
+
+//--------------------------------------------------------------------------
+//
+//  A best-first pool that switches to plunging when it is under
+//  pressure, that is, when it holds more than spLimit subproblems or
+//  the process uses more than memLimitMB megabytes of memory.  While
+//  under pressure, the subproblems inserted are also pushed on a
+//  plunge stack, and select() takes from that stack, so the search
+//  dives depth-first from the best subproblem in the heap until the
+//  stack runs out.  Once the pressure drops below resumeFraction of
+//  both limits, the stack is simply forgotten and the order is
+//  best-first again.  Every subproblem stays in the heap the whole
+//  time, so the pool always knows its global bound.  Memory use is
+//  only sampled every memCheckInterval operations.
+//
+
+template <class SUB, class LOAD>
+class plungePool : public arrayHeapPool <SUB,LOAD>
+{
+ public:
+
+  typedef arrayHeapPool<SUB,LOAD> base;
+
+  int insert(SUB* p)
+    {
+      base::insert(p);
+      if (pressure)
+	plunge.push_back(p);
+      checkPressure();
+      return this->size();
+    };
+
+  SUB* select()
+    {
+      if (plunge.size() > 0)
+	return plunge.back();
+      return base::select();
+    };
+
+  SUB* remove(SUB* p)
+    {
+      for (size_type i=plunge.size(); i>0; i--)
+	if (plunge[i-1] == p)
+	  {
+	    plunge.erase(plunge.begin() + (i-1));
+	    break;
+	  }
+      base::remove(p);
+      checkPressure();
+      return p;
+    };
+
+  SUB* remove() { return remove(select()); };
+
+  void clear()
+    {
+      plunge.clear();
+      base::clear();
+    };
+
+  // The heap's prune recycles what it removes, so take the same
+  // subproblems off the plunge stack first.
+
+  int prune()
+    {
+      size_type kept = 0;
+      for (size_type i=0; i<plunge.size(); i++)
+	if (!plunge[i]->canFathom())
+	  plunge[kept++] = plunge[i];
+      plunge.resize(kept);
+      return base::prune();
+    };
+
+  plungePool(int spLimit_ = 0,
+	     double memLimitMB_ = 0,
+	     double resumeFraction_ = 0.9) :
+    spLimit(spLimit_),
+    memLimitMB(memLimitMB_),
+    resumeFraction(resumeFraction_),
+    pressure(false),
+    plungeCount(0),
+    memCountdown(0),
+    lastMemMB(0)
+    { };
+
+  void reset()
+    {
+      plunge.clear();
+      base::reset();
+      pressure     = false;
+      memCountdown = 0;
+    };
+
+  virtual ~plungePool() { clear(); };
+
+  double globalBound()
+    {
+      if (this->size() > 0)
+	return base::select()->bound;
+      return this->global()->sense*MAXDOUBLE;
+    };
+
+  // Number of times the pool has switched to plunging
+
+  int plunges() { return plungeCount; };
+
+  bool underPressure() { return pressure; };
+
+  virtual void myPrint()
+    {
+      std::cout<<"\n=======plungePool (" << (pressure ? "plunging" : "best-first")
+	       << ", " << plunge.size() << " on stack)\n";
+      for(size_type i=0; i<this->heap.size(); i++)
+	std::cout<<this->heap[i].sp<<" || ";
+      std::cout<<std::endl<<std::endl;
+    };
+
+ protected:
+
+  std::vector<SUB*> plunge;
+
+  int    spLimit;
+  double memLimitMB;
+  double resumeFraction;
+
+  bool pressure;
+  int  plungeCount;
+
+  int    memCountdown;
+  double lastMemMB;
+
+  static int memCheckInterval() { return 1024; };
+
+  bool overLimit(double fraction)
+    {
+      if ((spLimit > 0) && (this->size() > fraction*spLimit))
+	return true;
+      if (memLimitMB > 0)
+	{
+	  if (--memCountdown <= 0)
+	    {
+	      lastMemMB    = residentMemoryMB();
+	      memCountdown = memCheckInterval();
+	    }
+	  return lastMemMB > fraction*memLimitMB;
+	}
+      return false;
+    };
+
+  void checkPressure()
+    {
+      if (!pressure)
+	{
+	  if (overLimit(1))
+	    {
+	      pressure = true;
+	      plungeCount++;
+	    }
+	}
+      else if (!overLimit(resumeFraction))
+	{
+	  pressure = false;
+	  plunge.clear();
+	}
+    };
+
+};
+
+
+//--------------------------------------------------------------------------
+//
+//  A best-first pool that keeps at most "keep" subproblems in memory.
+//  When the heap grows past that, the worst quarter of it is packed
+//  with branchSub::packSubproblem, written to a spillFile as one
+//  extent, and deleted; only the bound and file location of each
+//  spilled subproblem stay in memory.  select() reads back the best
+//  spilled subproblems once their bounds beat everything left in the
+//  heap (or, while diving, once the heap is empty), so the order is
+//  still best-first.  prune() drops spilled subproblems by bound
+//  without reading them.  Subproblems whose packable() is false are
+//  never spilled.  Spilled subproblems still count in size() and in
+//  the load, and the pool knows its global bound as usual.  scan()
+//  goes through the heap and then reads the spilled subproblems one
+//  at a time into a scratch subproblem, which is only good until the
+//  next call.  For serial (and threaded) search only, since reloading
+//  uses blankSub().
+//
+
+template <class SUB, class LOAD>
+class spillPool : public arrayHeapPool <SUB,LOAD>
+{
+ public:
+
+  typedef arrayHeapPool<SUB,LOAD> base;
+
+  int size() { return this->heap.size() + spilled.size(); };
+
+  int insert(SUB* p)
+    {
+      base::insert(p);
+      if ((keep > 0) && ((int) this->heap.size() > spillAt))
+	spill(this->heap.size() - (3*keep)/4);
+      return size();
+    };
+
+  SUB* select()
+    {
+      refill();
+      return base::select();
+    };
+
+  void clear()
+    {
+      dropScanSub();
+      while (spilled.size() > 0)
+	dropRecord(spilled.begin());
+      file.clear();
+      base::clear();
+    };
+
+  int prune()
+    {
+      while ((spilled.size() > 0) &&
+	     this->global()->canFathom(worstRecord()->second.bound))
+	{
+	  dropRecord(worstRecord());
+	  prunedCount++;
+	}
+      base::prune();
+      return size();
+    };
+
+  spillPool(int keep_ = 0,const std::string& dir_ = "") :
+    file(dir_),
+    keep(keep_),
+    spillAt(keep_),
+    spillCount(0),
+    reloadCount(0),
+    prunedCount(0),
+    bytesWritten(0),
+    bytesRead(0),
+    maxSpilled(0),
+    scanSub(0)
+    { };
+
+  void reset()
+    {
+      clear();
+      base::reset();
+      spillAt = keep;
+    };
+
+  virtual ~spillPool() { clear(); };
+
+  double globalBound()
+    {
+      double sense = this->global()->sense;
+      double b     = sense*MAXDOUBLE;
+      if (this->heap.size() > 0)
+	{
+	  this->checkOrder();
+	  b = this->heap[0].bound;
+	}
+      if ((spilled.size() > 0) && (sense*spilled.begin()->second.bound < sense*b))
+	b = spilled.begin()->second.bound;
+      return b;
+    };
+
+  // Scanning reads the spilled subproblems straight from the file,
+  // after the heap, and leaves them on disk.  Unloading sees only what
+  // is in memory.
+
+  void resetScan()
+    {
+      dropScanSub();
+      scanRecord = spilled.begin();
+      base::resetScan();
+    };
+
+  SUB* scan()
+    {
+      if (this->scanCursor < (int) this->heap.size())
+	return base::scan();
+      dropScanSub();
+      spillRecord& r = (scanRecord++)->second;
+      inBuf.resize(r.length);
+      file.read(r.offset,&inBuf[0],r.length);
+      UnPackBuffer ub(&inBuf[0],r.length);
+      scanSub = dynamic_cast<SUB*>(this->global()->blankSub());
+      scanSub->unpackSubproblem(ub);
+      return scanSub;
+    };
+
+  SUB* firstToUnload()
+    {
+      this->unloadCursor = std::min((int) this->heap.size(),2) - 1;
+      return nextToUnload();
+    };
+
+  SUB* nextToUnload()
+    {
+      if (this->heap.size() == 0) return 0;
+      if (this->unloadCursor < (int) this->heap.size())
+	return this->heap[this->unloadCursor++].sp;
+      return firstToUnload();
+    };
+
+  int spilledNow() { return spilled.size(); };
+
+  void printStatistics(std::ostream& stream)
+    {
+      if (spillCount == 0)
+	return;
+      const double MB = 1024.0*1024.0;
+      int oldPrecision = stream.precision(1);
+      std::ios::fmtflags oldFlags = stream.setf(std::ios::fixed,
+						std::ios::floatfield);
+      stream << "Spill pool: " << spillCount << " subproblems written ("
+	     << bytesWritten/MB << " MB), " << reloadCount << " read back ("
+	     << bytesRead/MB << " MB), " << prunedCount << " pruned unread\n";
+      stream << "Spill pool: at most " << maxSpilled
+	     << " subproblems on disk, spill file at most "
+	     << file.maxFileSize()/MB << " MB\n";
+      stream.precision(oldPrecision);
+      stream.flags(oldFlags);
+    };
+
+  virtual void myPrint()
+    {
+      std::cout<<"\n=======spillPool (" << spilled.size() << " spilled)\n";
+      for(size_type i=0; i<this->heap.size(); i++)
+	std::cout<<this->heap[i].sp<<" || ";
+      std::cout<<std::endl<<std::endl;
+    };
+
+ protected:
+
+  // What stays in memory for a spilled subproblem.  The load it
+  // contributed is remembered so it can be taken back out exactly.
+
+  struct spillRecord
+  {
+    double bound;
+    size_t offset;
+    size_t length;
+    double loadBound;
+    int    loadMult;
+  };
+
+  // Keyed by sense*bound, so the best record comes first
+
+  typedef std::multimap<double,spillRecord> recordMap;
+
+  recordMap spilled;
+  spillFile file;
+
+  PackBuffer        outBuf;
+  std::vector<char> inBuf;
+
+  int keep;
+  int spillAt;
+
+  int    spillCount;
+  int    reloadCount;
+  int    prunedCount;
+  double bytesWritten;
+  double bytesRead;
+  int    maxSpilled;
+
+  // Where scan() is among the spilled records, and the subproblem it
+  // last read
+
+  typename recordMap::iterator scanRecord;
+  SUB* scanSub;
+
+  void dropScanSub()
+    {
+      delete scanSub;
+      scanSub = 0;
+    };
+
+  typename recordMap::iterator worstRecord()
+    {
+      typename recordMap::iterator it = spilled.end();
+      return --it;
+    };
+
+  struct slotOrder
+  {
+    const spillPool* pool;
+    slotOrder(const spillPool* pool_) : pool(pool_) { };
+    bool operator()(const typename base::heapSlot& a,
+		    const typename base::heapSlot& b) const
+      { return pool->better(a,b); };
+  };
+
+  // Write out the n worst packable subproblems in the heap.  If that
+  // does not bring the heap down to size, wait for it to grow a
+  // quarter of keep before trying again.
+
+  void spill(size_type n)
+    {
+      this->checkOrder();
+      std::vector<typename base::heapSlot> candidates;
+      for (size_type i=0; i<this->heap.size(); i++)
+	if (this->heap[i].sp->packable())
+	  candidates.push_back(this->heap[i]);
+      n = std::min(n,candidates.size());
+      if (n > 0)
+	{
+	  size_type first = candidates.size() - n;
+	  std::nth_element(candidates.begin(),candidates.begin() + first,
+			   candidates.end(),slotOrder(this));
+	  std::vector<spillRecord> records(n);
+	  outBuf.reset();
+	  for (size_type k=0; k<n; k++)
+	    {
+	      SUB* p = candidates[first + k].sp;
+	      spillRecord& r = records[k];
+	      r.bound     = p->bound;
+	      r.offset    = outBuf.size();
+	      r.loadBound = p->boundEstimate();
+	      r.loadMult  = p->loadXFactor();
+	      p->packSubproblem(outBuf);
+	      r.length = outBuf.size() - r.offset;
+	    }
+	  size_t start = file.allocate(outBuf.size());
+	  file.write(start,outBuf.buf(),outBuf.size());
+	  double sense = this->global()->sense;
+	  for (size_type k=0; k<n; k++)
+	    {
+	      SUB* p = candidates[first + k].sp;
+	      spillRecord& r = records[k];
+	      r.offset += start;
+	      spilled.insert(std::make_pair(sense*r.bound,r));
+	      base::remove(p);
+	      this->myLoad.addLoad(r.loadBound,r.loadMult);
+	      delete p;
+	    }
+	  spillCount   += n;
+	  bytesWritten += outBuf.size();
+	  maxSpilled    = std::max(maxSpilled,(int) spilled.size());
+	}
+      spillAt = std::max(keep,(int) this->heap.size() + keep/4);
+    };
+
+  // Bring back spilled subproblems if the best of them is better than
+  // the best in memory.
+
+  void refill()
+    {
+      if (spilled.size() == 0)
+	return;
+      this->checkOrder();
+      if (this->heap.size() > 0)
+	{
+	  if (this->diving)
+	    return;
+	  double sense = this->global()->sense;
+	  if (spilled.begin()->first >= sense*this->heap[0].bound)
+	    return;
+	}
+      reload(std::max(1,keep/4));
+    };
+
+  void reload(size_type n)
+    {
+      for (size_type k=0; (k<n) && (spilled.size() > 0); k++)
+	{
+	  typename recordMap::iterator it = spilled.begin();
+	  spillRecord& r = it->second;
+	  inBuf.resize(r.length);
+	  file.read(r.offset,&inBuf[0],r.length);
+	  UnPackBuffer ub(&inBuf[0],r.length);
+	  SUB* p = dynamic_cast<SUB*>(this->global()->blankSub());
+	  p->unpackSubproblem(ub);
+	  bytesRead += r.length;
+	  reloadCount++;
+	  dropRecord(it);
+	  base::insert(p);
+	}
+    };
+
+  void dropRecord(typename recordMap::iterator it)
+    {
+      spillRecord& r = it->second;
+      file.release(r.offset,r.length);
+      this->myLoad.subtractLoad(r.loadBound,r.loadMult);
+      spilled.erase(it);
+    };
+
+};
+
+
+//--------------------------------------------------------------------------
+//
+//  A pool that sorts subproblems into buckets by bound.  Bucket k holds
+//  the subproblems whose bound times sense lies in [k*width,(k+1)*width),
+//  in a last-in, first-out list.  select() takes from the best
+//  nonempty bucket, so the order is best-first to within the bucket
+//  width.  Each bucket remembers the best bound ever inserted into it,
+//  which prune() uses to throw away whole buckets at the worst end of
+//  the pool without testing their members one by one; only the first
+//  bucket that survives is scanned.  The cost of pruning is thus
+//  proportional to the number of subproblems pruned rather than to the
+//  pool size.  If no width is given, the first finite bound inserted
+//  fixes it at absTolerance or relTolerance times the bound, whichever
+//  is larger.  Initial diving is ignored.
+//
+
+template <class SUB, class LOAD>
+class bucketPool : public branchPool <SUB,LOAD>
+{
+ public:
+
+  int size() { return count; };
+
+  int insert(SUB* p)
+    {
+      chooseWidth(p->bound);
+      bucket& b = buckets[keyOf(p->bound)];
+      if (b.list.size() == 0)
+	{
+	  b.list.stack_mode();
+	  b.best = p->bound;
+	}
+      else if (sense()*(p->bound - b.best) < 0)
+	b.best = p->bound;
+      p->poolPtr = b.list.add(p);
+      count++;
+      this->myLoad += *p;
+      return size();
+    };
+
+  SUB* select() { return buckets.begin()->second.list.top(); };
+
+  SUB* remove(SUB* p)
+    {
+      typename bucketMap::iterator it = buckets.find(keyOf(p->bound));
+      if (it == buckets.end())
+	EXCEPTION_MNGR(std::runtime_error,"The item was not found in the pool");
+      return removeItem(it,(ListItem<SUB*>*) p->poolPtr);
+    };
+
+  SUB* remove() { return remove(select()); };
+
+  int prune()
+    {
+      // Whole buckets whose best bound can be fathomed
+
+      while (buckets.size() > 0)
+	{
+	  typename bucketMap::iterator it = buckets.end();
+	  --it;
+	  if (!this->global()->canFathom(it->second.best))
+	    break;
+	  LinkedList<SUB*>& list = it->second.list;
+	  while (list.size() > 0)
+	    removeItem(it,list.head(),false)->recycle();
+	  buckets.erase(it);
+	}
+
+      // The boundary bucket, one subproblem at a time
+
+      if (buckets.size() > 0)
+	{
+	  typename bucketMap::iterator it = buckets.end();
+	  --it;
+	  ListItem<SUB*>* l1 = it->second.list.head();
+	  while (l1)
+	    {
+	      ListItem<SUB*>* l2 = it->second.list.next(l1);
+	      if (l1->data()->canFathom())
+		removeItem(it,l1,false)->recycle();
+	      l1 = l2;
+	    }
+	  if (it->second.list.size() == 0)
+	    buckets.erase(it);
+	}
+
+      return size();
+    };
+
+  bucketPool(double width_ = 0) :
+    fixedWidth(width_),
+    width(width_),
+    count(0)
+    { };
+
+  void reset()
+    {
+      this->clear();
+      width = fixedWidth;
+    };
+
+  virtual ~bucketPool() { this->clear(); };
+
+  bool knowsGlobalBound() { return size() > 0; };
+
+  // The best bound inserted into the best bucket; it may since have
+  // been removed, so this is a valid, if sometimes weak, bound.
+
+  double globalBound()
+    {
+      if (size() > 0)
+	return buckets.begin()->second.best;
+      return this->global()->sense*MAXDOUBLE;
+    };
+
+  void resetScan()
+    {
+      scanBucket = buckets.begin();
+      scanItem   = (size() > 0) ? scanBucket->second.list.head() : 0;
+    };
+
+  SUB* scan()
+    {
+      SUB* toReturn = scanItem->data();
+      advance(scanBucket,scanItem);
+      return toReturn;
+    };
+
+  SUB* firstToUnload()
+    {
+      if (size() == 0)
+	return NULL;
+      unloadBucket = buckets.begin();
+      unloadItem   = unloadBucket->second.list.head();
+      if (size() > 1)
+	advance(unloadBucket,unloadItem);
+      return nextToUnload();
+    };
+
+  SUB* nextToUnload()
+    {
+      if (size() == 0) return 0;
+      if (unloadItem == 0)
+	return firstToUnload();
+      SUB* toReturn = unloadItem->data();
+      advance(unloadBucket,unloadItem);
+      return toReturn;
+    };
+
+  virtual void myPrint()
+    {
+      std::cout<<"\n=======bucketPool===================\n";
+      typename bucketMap::iterator it = buckets.begin();
+      for (; it != buckets.end(); ++it)
+	{
+	  std::cout << '[' << it->first << "] ";
+	  ListItem<SUB*>* l = it->second.list.head();
+	  while (l)
+	    {
+	      std::cout << l->data() << " | ";
+	      l = it->second.list.next(l);
+	    }
+	  std::cout << std::endl;
+	}
+      std::cout<<std::endl;
+    };
+
+ protected:
+
+  struct bucket
+  {
+    double           best;
+    LinkedList<SUB*> list;
+  };
+
+  typedef std::map<long long,bucket> bucketMap;
+
+  bucketMap buckets;
+
+  double fixedWidth;
+  double width;
+  int    count;
+
+  typename bucketMap::iterator scanBucket;
+  ListItem<SUB*>*              scanItem;
+  typename bucketMap::iterator unloadBucket;
+  ListItem<SUB*>*              unloadItem;
+
+  int sense() { return this->global()->sense; };
+
+  void chooseWidth(double bound)
+    {
+      if ((width > 0) || (std::fabs(bound) == MAXDOUBLE))
+	return;
+      width = std::max(this->global()->absTolerance,
+		       this->global()->relTolerance*std::fabs(bound));
+      if (width <= 0)
+	width = 1;
+    };
+
+  // Infinite and enormous bounds share the two extreme buckets
+
+  long long keyOf(double bound)
+    {
+      if (width <= 0)
+	return (bound*sense() < 0) ? -maxKey() : maxKey();
+      double k = std::floor(sense()*bound/width);
+      return (long long) std::max(-maxKey(),std::min(k,maxKey()));
+    };
+
+  static double maxKey() { return 1e15; };
+
+  void advance(typename bucketMap::iterator& it,ListItem<SUB*>*& item)
+    {
+      item = it->second.list.next(item);
+      if (item == 0)
+	{
+	  ++it;
+	  if (it != buckets.end())
+	    item = it->second.list.head();
+	}
+    };
+
+  SUB* removeItem(typename bucketMap::iterator it,
+		  ListItem<SUB*>* item,
+		  bool eraseEmpty = true)
+    {
+      SUB* p;
+      it->second.list.remove(item,p);
+      if (eraseEmpty && (it->second.list.size() == 0))
+	buckets.erase(it);
+      count--;
+      this->myLoad -= *p;
+      return p;
+    };
+
 };
 
 
@@ -567,12 +1598,12 @@ class solutionIdentifier : public pebblBase
 
   int owningProcessor;
 
+#endif
+
   virtual void pack(PackBuffer& OutBuf) const;
   virtual void unpack(UnPackBuffer& InBuf);
   static int packSize();
 
-#endif
-
 };
 
 
@@ -591,8 +1622,6 @@ class solution : public solutionIdentifier
   size_type hashValue;
   bool      hashComputed;   // Flag that says whether hashValue is initialized
 
-  ListItem<solution*>* hashItem;   // Location in repository hash tables
-
   // Printout-related stuff
 
   virtual const char* typeDescription() const { return "Generic solution"; };
@@ -667,23 +1696,19 @@ class solution : public solutionIdentifier
 
   virtual bool duplicateOf(solution& other);
 
-  // Parallel-environment methods
-
-#ifdef ACRO_HAVE_MPI
+  // Packing, for parallel messages and checkpoints
 
   virtual solution* blankClone() { return new solution(this); };
 
   void pack(PackBuffer& outBuf) const;
-  virtual void packContents(PackBuffer& outBuf) const { };
+  virtual void packContents(PackBuffer& /*outBuf*/) const { };
 
   void unpack(UnPackBuffer& inBuf);
-  virtual void unpackContents(UnPackBuffer& inBuf) { };
+  virtual void unpackContents(UnPackBuffer& /*inBuf*/) { };
 
   int maxBufferSize();
   virtual int maxContentsBufSize() { return 0; };
 
-#endif
-
   // Internal stuff related to duplicate detection
 
 protected:
@@ -728,6 +1753,12 @@ class loadLogRecord
 			     int           sense, 
 			     double        baseTime,
 			     int           proc = 0);
+
+  // Same, as a row of loadLogColumns::count values for a binary log
+  virtual void writeToRow(double* row,
+			  int     sense,
+			  double  baseTime,
+			  int     proc = 0);
 #ifdef ACRO_HAVE_MPI
 
   // Pack to buffer
@@ -751,6 +1782,7 @@ class branching : public pebblBase, public pebblParams
   friend class branchSubId;
   friend class solutionIdentifier;
   friend class loadObject;
+  friend class searchThread;
 
 public:
 
@@ -769,6 +1801,63 @@ public:
 
   bool needPruning;
 
+  // Shared-memory threads (numThreads > 1).  While threadsActive is
+  // set, incumbent changes are serialized by incumbentMutex.  Every
+  // pruning request advances pruneEpoch so each thread knows to prune
+  // its pool.  While countersShared is set (by the serial threads or
+  // the parallel compute threads), the counters below must be changed
+  // through bumpCounter.
+
+  bool              threadsActive;
+  bool              countersShared;
+  std::mutex        incumbentMutex;
+  std::atomic<int>  pruneEpoch;
+
+  // Lock that serializes incumbent changes, or NULL if none is needed
+
+  virtual std::mutex* incumbentLock()
+    {
+      return threadsActive ? &incumbentMutex : NULL;
+    };
+
+  // Threads test subproblems against incumbentValue while another
+  // thread may be changing it.  Such reads and writes go through
+  // these, so a reader sees either the old value or the new one.
+
+  double incumbentNow()
+    {
+#ifdef __GNUC__
+      double value;
+      __atomic_load(&incumbentValue,&value,__ATOMIC_RELAXED);
+      return value;
+#else
+      return incumbentValue;
+#endif
+    };
+
+  void storeIncumbentValue(double value)
+    {
+#ifdef __GNUC__
+      __atomic_store(&incumbentValue,&value,__ATOMIC_RELAXED);
+#else
+      incumbentValue = value;
+#endif
+    };
+
+  int bumpCounter(int& counter,int delta = 1)
+    {
+      if (countersShared)
+	{
+#ifdef __GNUC__
+	  return __atomic_add_fetch(&counter,delta,__ATOMIC_RELAXED);
+#else
+	  std::lock_guard<std::mutex> lock(counterMutex);
+	  return counter += delta;
+#endif
+	}
+      return counter += delta;
+    };
+
   int probCounter;
   int subCount[numStates];
 
@@ -791,6 +1880,19 @@ public:
       incumbent(NULL),
       pool(NULL),
       handler(NULL),
+      threadsActive(false),
+      countersShared(false),
+      pruneEpoch(0),
+      numRefSols(0),
+      checkpointsEnabled(false),
+      checkpointNumber(0),
+      restartCPNum(0),
+      checkpointTriggerTime(0),
+      checkpointStartTime(0),
+      checkpointTotalTime(0),
+      cpAbortNum(0),
+      checkpointWriteOK(true),
+      llWriter(NULL),
       enumerating(false),
       usingEnumCutoff(false),
       solSerialCounter(0),
@@ -801,7 +1903,7 @@ public:
     }
 
   double absGap(double boundValue) 
-    { return (incumbentValue - boundValue)*sense; };
+    { return (incumbentNow() - boundValue)*sense; };
 
   virtual double relGap(double boundValue);
   virtual double relGap(loadObject& l);
@@ -839,6 +1941,7 @@ public:
   virtual void signalIncumbent() 
     {
       needPruning = true; 
+      pruneEpoch++;
     };
 
   // Do any operations that all go along with the acquisition 
@@ -849,7 +1952,7 @@ public:
 
   virtual bool haveIncumbentHeuristic() { return false; };
 
-  bool haveIncumbent() {return (incumbentValue != sense * MAXDOUBLE);};
+  bool haveIncumbent() {return (incumbentNow() != sense * MAXDOUBLE);};
 
   double searchFramework(spHandler *handler_ = NULL);
 
@@ -867,12 +1970,26 @@ public:
   virtual void unloadCurrentSP();
   virtual void eraseCurrentSP();
 
+  // Unload first, since a spilling pool may write the subproblem out
+  // and delete it as soon as it is inserted.
+
   virtual void unloadCurrentSPtoPool()
     {
-      pool->insert(currentSP);
+      branchSub* p = currentSP;
       unloadCurrentSP();
+      pool->insert(p);
     };
 
+  /// Called at the start of a threaded search with the number of
+  /// threads, so applications can set up per-thread workspace.
+  virtual void threadSetup(int /*n*/) { };
+
+  /// Index of the search thread making the call (0 outside threaded search)
+  virtual int threadNum();
+
+  /// Identifier of the last subproblem unloaded by the calling thread
+  virtual branchSubId& lastSPId();
+
   virtual std::ostream* openSolutionFile();
   virtual void closeSolutionFile(std::ostream* fileStream);
 
@@ -911,6 +2028,8 @@ public:
 
   void printAbortStatistics(loadObject& load);
 
+  virtual void printThreadStatistics(std::ostream& stream = std::cout);
+
   virtual ~branching();  // Note: default action is to delete the pool.
 
   /// Initialize base classes and reset the state of the solver
@@ -951,10 +2070,78 @@ public:
   /// Stands in for processor rank when in serial; overridden in parallel
   virtual int pebblRank() { return 0; };
 
+  // Reference solutions, one per solution type, which are cloned to
+  // unpack solutions from messages and checkpoints
+
+  BasicArray<solution*> refSolArray;
+  size_type             numRefSols;
+
+  size_type registerFirstSolution(solution* referenceSolution);
+  size_type registerSolution(solution* referenceSolution);
+  void      clearRegisteredSolutions();
+
+  solution* unpackSolution(UnPackBuffer& inBuf);
+
+  // Checkpointing.  The serial layer writes one file per checkpoint;
+  // see pbCheckpoint.cpp for the parallel layer.
+
+  // These are used to write application-dependent state when
+  // checkpointing
+
+  virtual void appCheckpointWrite(PackBuffer& /*outBuf*/) { };
+  virtual void appCheckpointRead(UnPackBuffer& /*inBuf*/) { };
+
+  bool checkpointsEnabled;      // Checkpoints being used on this run
+
+  int checkpointNumber;         // Sequence number of this checkpoint
+  int restartCPNum;             // Sequence number of checkpoint restarted from
+
+  double checkpointTriggerTime; // When to start next checkpoint
+  double checkpointStartTime;   // When current checkpoint began
+  double checkpointTotalTime;   // Total time spent writing checkpoints
+
+  int cpAbortNum;               // Number of the checkpoint we will
+                                // abort at (0 if no planned abort)
+
+  // Figures out what checkpoint we should abort at, if any
+
+  void prepareCPAbort();
+
+  static bool stringMatch(std::string& str,int& cursor,const char* pattern);
+  static bool intFromString(std::string& s,int& cursor,int& result);
+
  protected:
 
+  // Serial checkpoints are packed into memory by the search loop and
+  // written to disk by a background thread, so the search only pauses
+  // while the snapshot is taken.  Asynchronous parallel checkpoints
+  // (asyncCheckpoint) use the same members.
+
+  std::thread checkpointWriter;
+  std::string checkpointData;
+  bool        checkpointWriteOK;
+
+  bool serialCheckpointDue()
+    {
+      return checkpointsEnabled &&
+	(CoarseWallClockSeconds() >= checkpointTriggerTime);
+    };
+
+  static void writeCheckpointFile(const std::string* data,
+				  std::string        name,
+				  std::string        previous,
+				  bool*              ok,
+				  std::atomic<bool>* done);
+
+  void writeSerialCheckpoint();
+  void finishSerialCheckpoint();
+  bool serialRestart();
+
+  std::string serialCheckpointFilename(int k);
+  bool serialCheckpointFileMatch(std::string& filename,int& k);
+
   double gapDenom(double boundValue)
-    { return std::max(std::fabs(boundValue),std::fabs(incumbentValue)); };
+    { return std::max(std::fabs(boundValue),std::fabs(incumbentNow())); };
  
   virtual void statusPrint(int&        lastPrint, 
 			   double&     lastPrintTime,
@@ -971,6 +2158,24 @@ public:
   virtual loadObject load();
   virtual loadObject updatedLoad();
 
+  branchPool<branchSub,loadObject>* makePool();
+
+  // Threaded search machinery; see searchThread.h
+
+  BasicArray<searchThread*> searchThreads;
+
+  std::atomic<long> threadSPCount;   // Subproblems not yet disposed of
+  std::atomic<bool> threadAbort;
+
+#ifndef __GNUC__
+  std::mutex counterMutex;
+#endif
+
+  bool canUseThreads(spHandler* handler_);
+  void threadedSearch(int& lastPrint,double& lastPrintTime);
+  loadObject threadedLoad();
+  void clearSearchThreads();
+
   void branchingInit(optimType   direction = minimization,
 		    double      relTolSet = -1.0,
 		    double      absTolSet = -1.0,
@@ -1009,6 +2214,8 @@ public:
 
   std::string loadLogFileName();
 
+  std::string loadLogBinaryFileName(int proc);
+
   virtual void recordLoadLogData(double time);
 
   virtual void writeLoadLog();
@@ -1023,7 +2230,11 @@ public:
   loadLogRecord*  lastLog;
 
   // Generic code to start recording of log (shared by parallel layer)
-  void beginLoadLog();
+  void beginLoadLog(int proc = 0);
+
+  // With loadLogBinary, records go straight to this, not the list
+  loadLogWriter* llWriter;
+  int            loadLogProc;
 
   double loadLogBaseTime;
   bool   needLLAppend;
@@ -1042,22 +2253,40 @@ public:
   double startTime;
   double startWall;
 
-  // Enumeration stuff, including repository of solutions
-
  public:
 
+  // Histogram of subproblem bounds kept by load objects (only the
+  // parallel layer turns it on).  There are loadHistBins bins of equal
+  // width, running from loadHistOrigin to loadHistOrigin +
+  // sense*loadHistScale, plus a last bin for anything beyond.  The
+  // bins must not change once loadHistActive is set, since loads are
+  // subtracted from the bins they were added to.
+
+  int    loadHistBins;
+  bool   loadHistActive;
+  double loadHistOrigin;
+  double loadHistScale;
+
+  int loadHistBin(double bound)
+    {
+      double d = sense*(bound - loadHistOrigin)/loadHistScale;
+      if (!(d > 0))
+	return 0;
+      if (d >= 1)
+	return loadHistBins - 1;
+      return (int) (d*(loadHistBins - 1));
+    };
+
+  // Enumeration stuff, including repository of solutions
+
   bool enumerating;
   bool usingEnumCutoff;
 
   int solSerialCounter;
 
-  // The repository consists of a heap of (references to) solutions in
-  // *reverse* bound order, and a hash table of pointers to solutions.
-  // Each list in the hash table is sorted in increasing hashValue
-  // order.
-
-  typedef GenericHeap<solution,Reverse<GenericHeapCompare<solution> > >
-    reposSolHeap;
+  // The repository holds (references to) solutions in an
+  // open-addressing hash table, for duplicate checks, and in a heap
+  // with the worst solution on top; see solRepository.h.
 
  protected:
 
@@ -1069,9 +2298,7 @@ public:
         sol->dispose();
   }
 
-  reposSolHeap reposHeap;
-
-  BasicArray< LinkedList<solution*> > reposTable;
+  solRepository repository;
 
   // This is used when enumCount is active, and represents the worst
   // solution that is currently being stored.  Any solution that does
@@ -1088,7 +2315,7 @@ public:
 
   // Basic repository functions
 
-  size_type repositorySize() { return reposHeap.size(); };
+  size_type repositorySize() { return repository.size(); };
 
   solution* worstReposSol();
 
@@ -1320,7 +2547,7 @@ public:
       // that might never go into the tree.  We don't want them to skew
       // the subproblem statistics.
       if (id.serial > 0 && state != newState) 
-	(globalP->subCount[newState])++;
+	globalP->bumpCounter(globalP->subCount[newState]);
 
       state = newState;
     }
@@ -1359,6 +2586,29 @@ public:
   virtual void valLogSplitExtra()                   { }
   virtual void valLogDestroyExtra()                 { }
 
+  // Binary validation log (validateLogBinary).  valLogRecordExtra
+  // fills in the extra fields of any kind of record; see valLog.h.
+
+  bool         valLogBinary() { return bGlobal()->validateLogBinary; };
+  double       valLogBound();
+  valLogRecord valLogRecordFor(valLogRecord::kindType kind);
+  void         valLogWrite(valLogRecord& r);
+
+  virtual void valLogRecordExtra(valLogRecord& /*r*/) { }
+
+  // Serial packing, for pools that move subproblems out of memory.  An
+  // application whose subproblems can be written out and read back
+  // overrides packable(), packContents(), and unpackContents().
+  // unpackSubproblem() fills in an object made by blankSub().
+
+  virtual bool packable() { return false; };
+
+  virtual void packContents(PackBuffer& /*outBuf*/)    { };
+  virtual void unpackContents(UnPackBuffer& /*inBuf*/) { };
+
+  void packSubproblem(PackBuffer& outBuf);
+  void unpackSubproblem(UnPackBuffer& inBuf);
+
   // This has to be moved back to private after we fix the constructor-
   // calling problem
 
@@ -1370,7 +2620,7 @@ public:
     {
       totalChildren = childrenLeft = 0;
       state = initialState;
-      (master->subCount[state])++;
+      master->bumpCounter(master->subCount[state]);
       poolPtr = 0;
     };
 
@@ -1504,11 +2754,9 @@ public solution
   
   // Communication-related methods
 
-#ifdef ACRO_HAVE_MPI
-
   virtual solution* blankClone() { return new arraySolution<T>(this); };
 
-  virtual void packContents(PackBuffer& outBuf)    { outBuf << array; };
+  virtual void packContents(PackBuffer& outBuf) const { outBuf << array; };
 
   virtual void unpackContents(UnPackBuffer& inBuf) { inBuf >> array;  };
 
@@ -1525,8 +2773,6 @@ public solution
       return sizeof(size_type) + array.size()*sizeof(T);
     };
 
-#endif
-
   // Sequence representation
 
 protected:
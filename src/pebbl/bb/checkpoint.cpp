@@ -0,0 +1,348 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// checkpoint.cpp
+//
+// Serial checkpoints, and the checkpoint bookkeeping shared with the
+// parallel layer (pbCheckpoint.cpp).
+//
+
+#include <pebbl_config.h>
+#include <sys/types.h>
+#include <dirent.h>
+
+#include <pebbl/utilib/nicePrint.h>
+#include <pebbl/bb/branching.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+using namespace utilib;
+
+namespace pebbl {
+
+  // Does a little bookkeeping to set the time of a possible checkpoint abort.
+
+  void branching::prepareCPAbort()
+  {
+    cpAbortNum = 0;
+    if (abortCheckpointCount > 0)
+      cpAbortNum = checkpointNumber + abortCheckpointCount;
+    if ((abortCheckpoint > checkpointNumber) &&
+	((abortCheckpoint < cpAbortNum) || (cpAbortNum == 0)))
+      cpAbortNum = abortCheckpoint;
+  }
+
+
+  //  Try to match a substring at position 'cursor'.  If it matches
+  //  return true and advance 'cursor' to matach.
+
+  bool branching::stringMatch(string& str,
+			      int& cursor,
+			      const char* pattern)
+  {
+    size_type sublen = strlen(pattern);
+    if (str.substr(cursor,sublen) != pattern)
+      return false;
+    cursor += sublen;
+    return true;
+  }
+
+
+  //  Read an unsigned integer of at most 9 digits starting from
+  //  position "cursor" of a string, and place the result in "result"
+  //  Return true if it worked.
+
+  bool branching::intFromString(string& s,int& cursor,int& result)
+  {
+    result = 0;
+    int i = cursor;
+    int len = min((int) s.length(),cursor+9);
+    for(; i<len; i++)
+      {
+	int d = ((int) s[i]) - '0';
+	if ((d < 0) || (d > 9))
+	  break;
+	result = 10*result + d;
+      }
+    if (i == cursor)
+      return false;
+    cursor = i;
+    return true;
+  }
+
+
+  // Serial checkpoint files are <problemName>.cp<k>.bdat, so they
+  // cannot be confused with the per-processor parallel files.
+
+  string branching::serialCheckpointFilename(int k)
+  {
+    stringstream s;
+    s << checkpointDir;
+    int n = checkpointDir.length();
+    if ((n > 0) && (checkpointDir[n-1] != '/'))
+      s << '/';
+    s << problemName << ".cp" << k << ".bdat";
+    return s.str();
+  }
+
+
+  bool branching::serialCheckpointFileMatch(string& filename,int& k)
+  {
+    int cursor = problemName.size();
+    if (filename.substr(0,cursor) != problemName)
+      return false;
+    if (!stringMatch(filename,cursor,".cp"))
+      return false;
+    if (!intFromString(filename,cursor,k))
+      return false;
+    if (!stringMatch(filename,cursor,".bdat"))
+      return false;
+    return ((size_type) cursor == filename.size());
+  }
+
+
+  // Body of the writer thread.  The data go to a scratch name that is
+  // renamed once complete, so there is always a whole checkpoint on
+  // disk; only then is the previous one (if named) removed.  The
+  // parallel layer also uses this, with "done" to poll for the end.
+
+  void branching::writeCheckpointFile(const string*      data,
+				      string             name,
+				      string             previous,
+				      bool*              ok,
+				      std::atomic<bool>* done)
+  {
+    string scratch = name + ".part";
+    ofstream bstream(scratch.c_str(),(ios::out | ios::binary));
+    bstream.write(data->data(),data->size());
+    bstream.close();
+    *ok = !bstream.fail() && (rename(scratch.c_str(),name.c_str()) == 0);
+    if (!*ok)
+      remove(scratch.c_str());
+    else if (previous.size() > 0)
+      remove(previous.c_str());
+    if (done)
+      *done = true;
+  }
+
+
+  // Take a snapshot of the search and hand it to a background thread
+  // to write.  The format follows the parallel checkpoints: global
+  // data, application data, the subproblems, and the repository.
+
+  void branching::writeSerialCheckpoint()
+  {
+    finishSerialCheckpoint();
+
+    checkpointStartTime = WallClockSeconds();
+    checkpointNumber++;
+    DEBUGPR(2,ucout << "Writing checkpoint " << checkpointNumber << endl);
+
+    ostringstream bstream(ios::out | ios::binary);
+    PackBuffer cpBuf;
+
+    // Write global data
+
+    cpBuf << incumbentValue << probCounter << solSerialCounter;
+    cpBuf << (int) (incumbent != NULL);
+    if (incumbent)
+      incumbent->pack(cpBuf);
+    cpBuf.writeBinary(bstream);
+
+    // Write application-specific data
+
+    appCheckpointWrite(cpBuf);
+    cpBuf.writeBinary(bstream);
+
+    // Write the current subproblem, if any, and the pool
+
+    pool->resetScan();
+    int pCount = pool->size();
+    int tCount = pCount + (haveCurrentSP() ? 1 : 0);
+    bstream.write((char *) &tCount,sizeof(int));
+    if (haveCurrentSP())
+      {
+	currentSP->packSubproblem(cpBuf);
+	cpBuf.writeBinary(bstream);
+      }
+    for(int i=0; i<pCount; i++)
+      {
+	pool->scan()->packSubproblem(cpBuf);
+	cpBuf.writeBinary(bstream);
+      }
+
+    // Write the repository (just "0" if not enumerating)
+
+    int rsize = 0;
+    if (enumerating)
+      rsize = repositorySize();
+    bstream.write((char *) &rsize,sizeof(int));
+    for(int s=0; s<rsize; s++)
+      {
+	repository.member(s)->pack(cpBuf);
+	cpBuf.writeBinary(bstream);
+      }
+
+    checkpointData = bstream.str();
+
+    string previous;
+    if (checkpointNumber > 1)
+      previous = serialCheckpointFilename(checkpointNumber-1);
+    checkpointWriter = std::thread(writeCheckpointFile,
+				   &checkpointData,
+				   serialCheckpointFilename(checkpointNumber),
+				   previous,
+				   &checkpointWriteOK,
+				   (std::atomic<bool>*) NULL);
+
+    double cpEndTime = WallClockSeconds();
+    double cpTime    = cpEndTime - checkpointStartTime;
+
+    checkpointTriggerTime = max(checkpointStartTime + checkpointMinutes*60,
+				cpEndTime + checkpointMinInterval*60);
+
+    checkpointTotalTime += cpTime;
+
+    ucout << "Checkpoint " << checkpointNumber << ": " << tCount
+	  << " subproblem" << plural(tCount) << ", "
+	  << checkpointData.size() << " bytes, search paused "
+	  << cpTime << " seconds.\n";
+  }
+
+
+  // Wait for the writer thread, if there is one, and report failure.
+
+  void branching::finishSerialCheckpoint()
+  {
+    if (!checkpointWriter.joinable())
+      return;
+    checkpointWriter.join();
+    string().swap(checkpointData);
+    if (!checkpointWriteOK)
+      {
+	ucout << "****** Warning ******** Could not write checkpoint file "
+	      << serialCheckpointFilename(checkpointNumber) << endl;
+	checkpointNumber--;
+      }
+  }
+
+
+  // Read the most recent serial checkpoint.  Returns false if there
+  // is none.
+
+  bool branching::serialRestart()
+  {
+    DEBUGPR(10,ucout << "serialRestart called\n");
+
+    string scanDir = checkpointDir;
+    if (scanDir.size() == 0)
+      scanDir = ".";
+
+    DIR* dirHandle = opendir(scanDir.c_str());
+    if (!dirHandle)
+      return false;
+    struct dirent* fileHandle;
+    int k = 0;
+    while((fileHandle = readdir(dirHandle)))
+      {
+	string filename(fileHandle->d_name);
+	int thisK = 0;
+	if (serialCheckpointFileMatch(filename,thisK) && (thisK > k))
+	  k = thisK;
+      }
+    closedir(dirHandle);
+
+    if (k == 0)
+      return false;
+
+    ifstream bstream(serialCheckpointFilename(k).c_str(),
+		     (ios::in | ios::binary));
+    if (!bstream)
+      return false;
+
+    UnPackBuffer cpBuf;
+
+    // Read global information
+
+    cpBuf.readBinary(bstream);
+    int haveIncumbent = 0;
+    cpBuf >> incumbentValue >> probCounter >> solSerialCounter;
+    cpBuf >> haveIncumbent;
+    if (haveIncumbent)
+      {
+	solution* sol = unpackSolution(cpBuf);
+	setIncumbent(sol);
+	sol->dispose();
+      }
+    DEBUGPR(10,ucout << "incumbentValue=" << incumbentValue << endl);
+
+    // Read application information
+
+    cpBuf.readBinary(bstream);
+    appCheckpointRead(cpBuf);
+
+    // Read the subproblems
+
+    int numSPs = -1;
+    bstream.read((char *) &numSPs,sizeof(int));
+    DEBUGPR(10,ucout << "Reading " << numSPs << " subproblems...\n");
+    for (int i=0; i<numSPs; i++)
+      {
+	cpBuf.readBinary(bstream);
+	branchSub* sp = blankSub();
+	sp->unpackSubproblem(cpBuf);
+	if (sp->canFathom())
+	  sp->recycle();
+	else
+	  pool->insert(sp);
+      }
+
+    // Read the repository
+
+    int rsize = -1;
+    bstream.read((char *) &rsize,sizeof(int));
+    for(int s=0; s<rsize; s++)
+      {
+	cpBuf.readBinary(bstream);
+	solution* sol = unpackSolution(cpBuf);
+	if (enumerating)
+	  localReposOffer(sol);
+	else
+	  sol->dispose();
+      }
+
+    if (bstream.fail())
+      EXCEPTION_MNGR(runtime_error,"Checkpoint file "
+		     << serialCheckpointFilename(k) << " is truncated");
+
+    checkpointNumber = k;
+    restartCPNum     = k;
+
+    // Deal with any side effects from an incumbent that might have
+    // been loaded with the checkpoint.  Set the pool to think it's
+    // been pruned at least once (so --initialDive will work properly).
+
+    if (abs(incumbentValue) != MAXDOUBLE)
+      {
+	newIncumbentEffect(incumbentValue);
+	pool->pretendPrunedOnce();
+      }
+
+    DEBUGPR(2,ucout << "serialRestart done\n");
+
+    return true;
+  }
+
+} // namespace pebbl
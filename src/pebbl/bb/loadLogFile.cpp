@@ -0,0 +1,274 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// loadLogFile.cpp
+//
+// Writing and reading binary load logs.
+//
+
+#include <pebbl_config.h>
+#include <pebbl/bb/loadLogFile.h>
+#include <pebbl/utilib/exception_mngr.h>
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+namespace pebbl {
+
+
+// Counts are int64, since bound calls and pool sizes can pass 2^31 in
+// long runs
+
+const char loadLogColumns::types[count + 1] = "idqqqqqqqqddddddqqqqqq";
+
+const char* loadLogColumns::names[count] =
+  { "proc", "time", "boundCalls", "pool", "hubPool", "totalPool",
+    "serverPool", "gLoad", "cLoad", "releases", "bound", "incumbent",
+    "globalBound", "clusterBound", "hubBound", "serverBound", "offers",
+    "admits", "dispatch", "reception", "rebal", "lbRounds" };
+
+
+namespace {
+
+void writeInt(ostream& s,int32_t value)
+{
+  s.write((const char*) &value,sizeof(value));
+}
+
+int32_t readInt(istream& s)
+{
+  int32_t value = 0;
+  s.read((char*) &value,sizeof(value));
+  return value;
+}
+
+size_t columnBytes(char type)
+{
+  return (type == 'i') ? sizeof(int32_t) : 8;
+}
+
+
+// Version 1 stored every count as int32
+
+const char version1Types[loadLogColumns::count + 1] = "idiiiiiiiiddddddiiiiii";
+
+} // namespace
+
+
+loadLogWriter::loadLogWriter(const string& fileName,int blockRows_) :
+  file(fileName.c_str(),ios::out | ios::binary),
+  blockRows(blockRows_),
+  rows(0),
+  buffer(blockRows_*loadLogColumns::count),
+  columnBuffer(blockRows_*sizeof(double)),
+  timeShift(0)
+{
+  if (!file)
+    return;
+  string allNames;
+  for (int c=0; c<loadLogColumns::count; c++)
+    {
+      if (c > 0)
+	allNames += ',';
+      allNames += loadLogColumns::names[c];
+    }
+  writeInt(file,loadLogColumns::magic);
+  writeInt(file,loadLogColumns::version);
+  writeInt(file,loadLogColumns::count);
+  writeInt(file,allNames.size());
+  file.write(loadLogColumns::types,loadLogColumns::count);
+  file.write(allNames.data(),allNames.size());
+}
+
+
+void loadLogWriter::add(const double* row)
+{
+  memcpy(&buffer[rows*loadLogColumns::count],row,
+	 loadLogColumns::count*sizeof(double));
+  if (++rows == blockRows)
+    writeBlock();
+}
+
+
+void loadLogWriter::flush()
+{
+  writeBlock();
+  file.flush();
+}
+
+
+void loadLogWriter::close()
+{
+  if (!file.is_open())
+    return;
+  writeBlock();
+  writeInt(file,-1);
+  file.write((const char*) &timeShift,sizeof(timeShift));
+  writeInt(file,loadLogColumns::magic);
+  file.close();
+}
+
+
+// Write the buffered rows, transposed to columns
+
+void loadLogWriter::writeBlock()
+{
+  if ((rows == 0) || !file.is_open())
+    return;
+  writeInt(file,rows);
+  for (int c=0; c<loadLogColumns::count; c++)
+    {
+      char type = loadLogColumns::types[c];
+      if (type == 'i')
+	{
+	  int32_t* out = (int32_t*) &columnBuffer[0];
+	  for (int r=0; r<rows; r++)
+	    out[r] = (int32_t) buffer[r*loadLogColumns::count + c];
+	}
+      else if (type == 'q')
+	{
+	  int64_t* out = (int64_t*) &columnBuffer[0];
+	  for (int r=0; r<rows; r++)
+	    out[r] = (int64_t) buffer[r*loadLogColumns::count + c];
+	}
+      else
+	{
+	  double* out = (double*) &columnBuffer[0];
+	  for (int r=0; r<rows; r++)
+	    out[r] = buffer[r*loadLogColumns::count + c];
+	}
+      file.write(&columnBuffer[0],rows*columnBytes(type));
+    }
+  rows = 0;
+}
+
+
+loadLogReader::loadLogReader(const string& fileName) :
+  name(fileName),
+  file(fileName.c_str(),ios::in | ios::binary),
+  dataEnd(0),
+  rows(0),
+  cursor(0),
+  timeShift(0)
+{
+  if (!file)
+    EXCEPTION_MNGR(runtime_error,"Cannot open load log " << name);
+
+  int32_t magic   = readInt(file);
+  int32_t version = readInt(file);
+  int32_t columns = readInt(file);
+  int32_t nameLength = readInt(file);
+  if (!file || (magic != loadLogColumns::magic))
+    EXCEPTION_MNGR(runtime_error,name << " is not a binary load log");
+  if ((version < 1) || (version > loadLogColumns::version))
+    EXCEPTION_MNGR(runtime_error,name << " is load log version " << version
+		   << "; expected at most " << loadLogColumns::version);
+
+  vector<char> fileTypes(columns + 1,'\0');
+  file.read(&fileTypes[0],columns);
+  types = &fileTypes[0];
+  const char* expected = (version == 1) ? version1Types : loadLogColumns::types;
+  if ((columns != loadLogColumns::count) || (types != expected))
+    EXCEPTION_MNGR(runtime_error,name << " has unexpected load log columns");
+  file.seekg(nameLength,ios::cur);
+  streamoff dataStart = file.tellg();
+
+  // The trailer, if the run got that far
+
+  file.seekg(0,ios::end);
+  dataEnd = file.tellg();
+  const streamoff trailerSize = 2*sizeof(int32_t) + sizeof(double);
+  if (dataEnd - dataStart >= trailerSize)
+    {
+      file.seekg(dataEnd - trailerSize);
+      int32_t marker = readInt(file);
+      double  shift  = 0;
+      file.read((char*) &shift,sizeof(shift));
+      if ((marker == -1) && (readInt(file) == loadLogColumns::magic))
+	{
+	  timeShift = shift;
+	  dataEnd  -= trailerSize;
+	}
+    }
+  file.clear();
+  file.seekg(dataStart);
+
+  block.resize(loadLogColumns::count);
+  columnBuffer.resize(sizeof(double));
+}
+
+
+bool loadLogReader::next(double* row)
+{
+  if ((cursor == rows) && !readBlock())
+    return false;
+  memcpy(row,&block[cursor*loadLogColumns::count],
+	 loadLogColumns::count*sizeof(double));
+  row[loadLogColumns::timeCol] += timeShift;
+  cursor++;
+  return true;
+}
+
+
+// Read a block and transpose it back to rows
+
+bool loadLogReader::readBlock()
+{
+  if (file.tellg() >= dataEnd)
+    return false;
+  int32_t blockSize = readInt(file);
+  if (!file || (blockSize <= 0))
+    return false;
+  if ((streamoff) (blockSize*loadLogColumns::count*sizeof(int32_t)) >
+      dataEnd - file.tellg())
+    {
+      cerr << "Warning: " << name << " ends in the middle of a block\n";
+      return false;
+    }
+  rows   = blockSize;
+  cursor = 0;
+  block.resize(rows*loadLogColumns::count);
+  columnBuffer.resize(rows*sizeof(double));
+  for (int c=0; c<loadLogColumns::count; c++)
+    {
+      file.read(&columnBuffer[0],rows*columnBytes(types[c]));
+      if (!file)
+	{
+	  cerr << "Warning: " << name << " ends in the middle of a block\n";
+	  rows = 0;
+	  return false;
+	}
+      if (types[c] == 'i')
+	{
+	  const int32_t* in = (const int32_t*) &columnBuffer[0];
+	  for (int r=0; r<rows; r++)
+	    block[r*loadLogColumns::count + c] = in[r];
+	}
+      else if (types[c] == 'q')
+	{
+	  const int64_t* in = (const int64_t*) &columnBuffer[0];
+	  for (int r=0; r<rows; r++)
+	    block[r*loadLogColumns::count + c] = in[r];
+	}
+      else
+	{
+	  const double* in = (const double*) &columnBuffer[0];
+	  for (int r=0; r<rows; r++)
+	    block[r*loadLogColumns::count + c] = in[r];
+	}
+    }
+  return true;
+}
+
+
+} // namespace pebbl
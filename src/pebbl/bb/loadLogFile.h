@@ -0,0 +1,135 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+
+/**
+ * \file loadLogFile.h
+ *
+ * The binary load log format (loadLogBinary).  Each processor writes
+ * its own file as the run goes, holding at most one block of rows in
+ * memory.  The file has the same columns as a text load log, stored
+ * a block at a time by column, in the machine's byte order:
+ *
+ *   header:  "PBLL", int32 version, int32 columns, int32 name length,
+ *            one type character per column ('i' int32, 'q' int64,
+ *            'd' double), the column names separated by commas
+ *   blocks:  int32 rows (> 0), then each column's rows values
+ *   trailer: int32 -1, double time shift, "PBLL"
+ *
+ * Times in the blocks are seconds from the processor's own start;
+ * adding the time shift, written when the run ends, puts them on the
+ * clock of the search I/O processor.  A file with no trailer (from a
+ * run that did not finish) has no shift.  loadLogMerge merges the
+ * files of a run in time order into one file of the same format, and
+ * pebblLoadGraph.py reads either kind.  Version 1 files, which
+ * stored the counts as int32, can still be read.
+ */
+
+#ifndef pebbl_loadLogFile_h
+#define pebbl_loadLogFile_h
+
+#include <pebbl_config.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace pebbl {
+
+
+// The columns, in text load log order
+
+struct loadLogColumns
+{
+  enum column { procCol, timeCol, boundCallsCol, poolCol, hubPoolCol,
+		totalPoolCol, serverPoolCol, gLoadCol, cLoadCol,
+		releasesCol, boundCol, incumbentCol, globalBoundCol,
+		clusterBoundCol, hubBoundCol, serverBoundCol, offersCol,
+		admitsCol, dispatchCol, receptionCol, rebalCol,
+		lbRoundsCol, count };
+  enum { magic = 0x4c4c4250, version = 2 };   // "PBLL"
+
+  static const char  types[count + 1];
+  static const char* names[count];
+};
+
+
+// Buffers rows and writes them a block at a time
+
+class loadLogWriter
+{
+public:
+
+  loadLogWriter(const std::string& fileName,int blockRows_ = 1024);
+
+  ~loadLogWriter() { close(); };
+
+  bool good() const { return file.good(); };
+
+  /// Add a row of loadLogColumns::count values.  Integer columns are
+  /// converted to int32 or int64 when written.
+  void add(const double* row);
+
+  /// Write the buffered rows and flush the file.
+  void flush();
+
+  /// Set the shift written in the trailer.
+  void setTimeShift(double shift) { timeShift = shift; };
+
+  /// Write the buffered rows and the trailer, and close the file.
+  void close();
+
+protected:
+
+  void writeBlock();
+
+  std::ofstream       file;
+  int                 blockRows;
+  int                 rows;
+  std::vector<double> buffer;
+  std::vector<char>   columnBuffer;
+  double              timeShift;
+};
+
+
+// Reads a file a block at a time
+
+class loadLogReader
+{
+public:
+
+  loadLogReader(const std::string& fileName);
+
+  double getTimeShift() const { return timeShift; };
+
+  /// Get the next row, with the time shift applied.  Returns false at
+  /// the end of the file.
+  bool next(double* row);
+
+protected:
+
+  bool readBlock();
+
+  std::string         name;
+  std::ifstream       file;
+  std::streamoff      dataEnd;
+  int                 rows;
+  int                 cursor;
+  std::vector<double> block;
+  std::vector<char>   columnBuffer;
+  std::string         types;
+  double              timeShift;
+};
+
+
+} // namespace pebbl
+
+#endif
@@ -41,7 +41,7 @@ void loadObject::reset()
 
   if (bGlobal)
     {
-      incumbentValue = bGlobal->incumbentValue;
+      incumbentValue = bGlobal->incumbentNow();
       if (bGlobal->enumerating)
 	fathomValue = bGlobal->fathomValue();
       else
@@ -69,7 +69,10 @@ void loadObject::init(branching* bGlobal_, bool useSPCounts_)
 {
   bGlobal = bGlobal_;
   if (bGlobal_)
-    powerSum.resize(bGlobal_->loadMeasureDegree);
+    {
+      powerSum.resize(bGlobal_->loadMeasureDegree);
+      boundHist.resize(bGlobal_->loadHistBins);
+    }
   useSPCounts = useSPCounts_;
   reset();
 }
@@ -77,7 +80,7 @@ void loadObject::init(branching* bGlobal_, bool useSPCounts_)
 
 void loadObject::update()
 {
-  incumbentValue = bGlobal->incumbentValue;
+  incumbentValue = bGlobal->incumbentNow();
   if (bGlobal->enumerating)
     {
       fathomValue    = bGlobal->fathomValue();
@@ -160,6 +163,49 @@ void loadObject::resetSums()
 {
   for(unsigned int p=0; p<powerSum.size(); p++)
     powerSum[p] = 0;
+  for(unsigned int i=0; i<boundHist.size(); i++)
+    boundHist[i] = 0;
+}
+
+
+bool loadObject::histActive() const
+{
+  return (boundHist.size() > 0) && bGlobal && bGlobal->loadHistActive;
+}
+
+
+// Loads added before the histogram is turned on are not in it, so
+// subtracting them later can take a bin below zero.  Such bins are
+// read as empty.
+
+void loadObject::addToHist(double bound,int multiplicity)
+{
+  if (histActive())
+    boundHist[bGlobal->loadHistBin(bound)] += multiplicity;
+}
+
+
+int loadObject::histCutoff(double fraction) const
+{
+  int    bins  = boundHist.size();
+  double total = histCount(bins - 1);
+  double sum   = 0;
+  for(int i=0; i<bins; i++)
+    {
+      sum += std::max(boundHist[i],0.0);
+      if ((sum > 0) && (sum >= fraction*total))
+	return i;
+    }
+  return bins - 1;
+}
+
+
+double loadObject::histCount(int cutoff) const
+{
+  double sum = 0;
+  for(int i=0; i<=cutoff; i++)
+    sum += std::max(boundHist[i],0.0);
+  return sum;
 }
 
 
@@ -172,6 +218,7 @@ void loadObject::addLoad(double bound,int multiplicity)
       product *= bound;
       powerSum[p] += product;
     }
+  addToHist(bound,multiplicity);
   updateAggBound(bound);
 }
 
@@ -199,6 +246,13 @@ void loadObject::operator+=(const loadObject& other)
   for(int p=0; p<bGlobal->loadMeasureDegree; p++)
     powerSum[p] += other.powerSum[p];
 
+  for(unsigned int i=0; i<other.boundHist.size(); i++)
+    {
+      if (i == boundHist.size())
+	boundHist.push_back(0);
+      boundHist[i] += other.boundHist[i];
+    }
+
   boundedSPs += other.boundedSPs;
   createdSPs += other.createdSPs;
   
@@ -259,6 +313,7 @@ void loadObject::subtractLoad(double bound,int multiplicity)
       product *= bound;
       powerSum[p] -= product;
     }
+  addToHist(bound,-multiplicity);
 }
 
 
@@ -284,6 +339,13 @@ void loadObject::dump(std::ostream& stream,const char* name)
 #ifdef MEMUTIL_PRESENT
   stream << "memUsed = "  << memUsed << endl;
 #endif
+  if (histActive())
+    {
+      stream << "boundHist =";
+      for(unsigned int i=0; i<boundHist.size(); i++)
+	stream << ' ' << boundHist[i];
+      stream << endl;
+    }
 }
 
 
@@ -110,6 +110,18 @@ public:
   /// Does not attempt to update aggregateBound!
   void operator-=(const coreSPInfo& sp);
 
+  /// Is the bound histogram being kept?
+  bool histActive() const;
+
+  /// Return the first histogram bin by which at least the given
+  /// fraction of the subproblems have been counted, starting from the
+  /// best bounds
+  int histCutoff(double fraction) const;
+
+  /// Return the number of subproblems in histogram bins up to and
+  /// including bin cutoff
+  double histCount(int cutoff) const;
+
   /// Return true if it looks like some information is missing
   virtual bool countIncomplete() { return false; }
 
@@ -249,6 +261,9 @@ protected:
   ///
   DoubleVector powerSum;
 
+  /// Subproblem counts by bin of bound (see branching::loadHistBin)
+  DoubleVector boundHist;
+
   ///
   char flags;
 
@@ -257,6 +272,9 @@ protected:
   ///
   void resetSums();
 
+  ///
+  void addToHist(double bound,int multiplicity);
+
 };
 
 } // namespace pebbl
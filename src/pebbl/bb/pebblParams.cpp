@@ -18,6 +18,8 @@
 #include <pebbl/bb/pebblBase.h>
 #include <pebbl/misc/gRandom.h>
 
+#include <cstdlib>
+
 
 namespace pebbl {
 
@@ -32,20 +34,33 @@ extern size_t randomSeed;
 pebblParams::pebblParams()
   : statusPrintCount(100000),
     statusPrintSeconds(10.0),
+    coarseTiming(true),
     depthFirst(false),
     breadthFirst(false),
+    arrayHeap(false),
+    boundBuckets(false),
+    bucketWidth(0.0),
+    pressurePlunge(false),
+    plungeSPLimit(1000000),
+    plungeMemoryMB(0.0),
+    plungeResumeFraction(0.9),
+    spillKeep(0),
+    spillDir(""),
     initialDive(false),
     integralityDive(true),
     lazyBounding(false),
     eagerBounding(false),
+    numThreads(1),
     relTolerance(1e-7),
     absTolerance(0.0),
     earlyOutputMinutes(0.0),
     startIncumbent(0.0),
     validateLog(false),    
+    validateLogBinary(false),
     heurLog(false),
     loadLogSeconds(0),
     loadLogWriteSeconds(0),
+    loadLogBinary(false),
     maxSPBounds(0),
     maxCPUMinutes(0.0),
     maxWallMinutes(0.0),
@@ -67,7 +82,14 @@ pebblParams::pebblParams()
 #else
     use_abort(false),
 #endif    
-    printSpTimes(0)
+    printSpTimes(0),
+    checkpointMinutes(0),
+    checkpointMinInterval(1),
+    checkpointDir(""),
+    restart(false),
+    abortCheckpoint(0),
+    abortCheckpointCount(0),
+    refSolArrayQuantum(8)
 
 {
 /// GENERAL
@@ -157,6 +179,13 @@ pebblParams::pebblParams()
 		"Output",
 		ParameterNonnegative<double>());
 
+  create_categorized_parameter("coarseTiming",coarseTiming,
+		"<bool>","true",
+		"Time the periodic checks of the search loop (status\n\t"
+		"lines, aborts, checkpoints, load logs) with a cheap clock\n\t"
+		"that may lag by a few milliseconds",
+		"Output");
+
   create_categorized_parameter("earlyOutputMinutes",earlyOutputMinutes,
 		"<double>","0",
 		"If this much time elapses, make sure current incumbent\n\t"
@@ -169,6 +198,12 @@ pebblParams::pebblParams()
 		"Output validation log files val*.log for logAnalyze",
 		"Debugging");
 
+  create_categorized_parameter("validateLogBinary",validateLogBinary,
+		"<bool>","false",
+		"Write validation logs as binary val*.vbin files,\n\t"
+		"which are faster to write and to analyze",
+		"Debugging");
+
   create_categorized_parameter("loadLogSeconds",loadLogSeconds,
 		"<double>","0",
 		"Seconds between load log records (0 means no load log)",
@@ -184,6 +219,12 @@ pebblParams::pebblParams()
 		"Debugging",
 		ParameterNonnegative<double>());
 
+  create_categorized_parameter("loadLogBinary",loadLogBinary,
+		"<bool>","false",
+		"Write the load log as one binary file per processor,\n\t"
+		"a block at a time; merge them with loadLogMerge",
+		"Debugging");
+
 
 /// SEARCH
 
@@ -197,6 +238,67 @@ pebblParams::pebblParams()
 		"Use breadth-first search",
 		"Search");
 
+  create_categorized_parameter("arrayHeap",arrayHeap,
+		"<bool>","false",
+		"For best-first search, keep subproblems in a 4-ary\n\t"
+		"array heap with the sort keys stored inline",
+		"Search");
+
+  create_categorized_parameter("boundBuckets",boundBuckets,
+		"<bool>","false",
+		"For best-first search, sort subproblems into buckets\n\t"
+		"by bound, so pruning can discard whole buckets",
+		"Search");
+
+  create_categorized_parameter("bucketWidth",bucketWidth,
+		"<double>","0",
+		"Range of bound values per bucket for boundBuckets.\n\t"
+		"If 0, chosen from relTolerance and absTolerance",
+		"Search",
+		utilib::ParameterNonnegative<double>());
+
+  create_categorized_parameter("pressurePlunge",pressurePlunge,
+		"<bool>","false",
+		"Best-first search that plunges depth-first from the\n\t"
+		"best subproblem while the pool is over plungeSPLimit\n\t"
+		"subproblems or memory use is over plungeMemoryMB",
+		"Search");
+
+  create_categorized_parameter("plungeSPLimit",plungeSPLimit,
+		"<int>","1000000",
+		"Pool size beyond which pressurePlunge starts plunging\n\t"
+		"(0 means no limit)",
+		"Search",
+		utilib::ParameterNonnegative<int>());
+
+  create_categorized_parameter("plungeMemoryMB",plungeMemoryMB,
+		"<double>","0",
+		"Resident memory in megabytes beyond which\n\t"
+		"pressurePlunge starts plunging (0 means no limit)",
+		"Search",
+		utilib::ParameterNonnegative<double>());
+
+  create_categorized_parameter("plungeResumeFraction",plungeResumeFraction,
+		"<double>","0.9",
+		"pressurePlunge returns to best-first once below this\n\t"
+		"fraction of both limits",
+		"Search",
+		utilib::ParameterBounds<double>(0.0,1.0));
+
+  create_categorized_parameter("spillKeep",spillKeep,
+		"<int>","0",
+		"For best-first search, keep at most this many subproblems\n\t"
+		"in memory and spill the worst ones to a scratch file\n\t"
+		"(0 means never spill)",
+		"Search",
+		utilib::ParameterNonnegative<int>());
+
+  create_categorized_parameter("spillDir",spillDir,
+		"<string>","",
+		"Directory for spillKeep's scratch files.  The default is\n\t"
+		"$TMPDIR, or /tmp",
+		"Search");
+
   create_categorized_parameter("initialDive",initialDive,
 		"<bool>","false",
 		"Use depth-first-like 'dive' until first incumbent found",
@@ -218,6 +320,14 @@ pebblParams::pebblParams()
 		"Bound problems as soon as possible",
 		"Search");
 
+  create_categorized_parameter("numThreads",numThreads,
+		"<int>","1",
+		"Number of shared-memory threads used to process\n\t"
+		"subproblems in serial search.  Each thread keeps its\n\t"
+		"own pool and steals work from the others when idle",
+		"Search",
+		utilib::ParameterPositive<int>());
+
 /// TERMINATION
 
   create_categorized_parameter("relTolerance",relTolerance,
@@ -275,11 +385,65 @@ pebblParams::pebblParams()
 		"Value of some known feasible solution",
 		"Incumbent");
 
+  create_categorized_parameter("refSolArrayQuantum",refSolArrayQuantum,
+                "<int>","8",
+		"Expansion quantum for array of reference solutions",
+		"Incumbent",
+		utilib::ParameterPositive<int>());
+
   create_categorized_parameter("heurLog",heurLog,
 		"<bool>","false",
 		"Output log for debugging incumbent heuristics",
 		"Debugging");
 
+/// CHECKPOINTING
+
+  create_categorized_parameter("checkpointMinutes",checkpointMinutes,
+		"<double>","0",
+		"Desired minutes between starting to write checkpoints\n\t"
+		"(0 disables checkpointing)",
+		"Checkpointing",
+		ParameterNonnegative<double>());
+
+  create_categorized_parameter("checkpointMinInterval",checkpointMinInterval,
+		"<double>","0",
+		"Lower bound on computing time between checkpoints",
+		"Checkpointing",
+		ParameterNonnegative<double>());
+
+  const char* envVarName = "PEBBL_CHECKPOINT_DIR";
+  const char* envDir = getenv(envVarName);
+  std::string explanation("Directory to place checkpoint files\n\t"
+			  "Default value ");
+  if (envDir != NULL)
+    {
+      checkpointDir = envDir;
+      explanation += "was set from";
+    }
+  else
+    explanation += "may be set via";
+  explanation += " environment variable ";
+  explanation += envVarName;
+  create_categorized_parameter("checkpointDir",checkpointDir,"<string>",
+		checkpointDir.c_str(),explanation.c_str(),
+		"Checkpointing");
+
+  create_categorized_parameter("restart",restart,"<bool>","false",
+		"Restart from a previously saved checkpoint",
+		"Checkpointing");
+
+  create_categorized_parameter("abortCheckpoint",abortCheckpoint,"<int>","0",
+		"Debug: abort at the checkpoint with this sequence "
+		"number",
+		"Checkpointing",
+		ParameterNonnegative<int>());
+
+  create_categorized_parameter("abortCheckpointCount",abortCheckpointCount,
+		"<int>","0",
+		"Debug: abort after writing this many checkpoints",
+		"Checkpointing",
+		ParameterNonnegative<int>());
+
 /// ENUMERATION
 
   create_categorized_parameter("enumRelTol",
@@ -315,7 +479,8 @@ pebblParams::pebblParams()
 	     utilib::ParameterNonnegative<int>());
 
   create_categorized_parameter("enumHashSize",enumHashSize,"<int>","1024",
-	    "Size of hash table used to check for duplicate solutions.",
+	    "Initial size of hash table used to check for duplicate\n\t"
+	    "solutions (it grows as needed)",
 	    "Enumeration",
 	    utilib::ParameterPositive<int>());
 
@@ -40,12 +40,42 @@ public:
   ///
   double statusPrintSeconds;
 
+  /// Use the cheap clocks of utilib/seconds.h for periodic checks
+  bool coarseTiming;
+
   ///
   bool depthFirst;
 
   ///
   bool breadthFirst;
 
+  ///
+  bool arrayHeap;
+
+  ///
+  bool boundBuckets;
+
+  ///
+  double bucketWidth;
+
+  ///
+  bool pressurePlunge;
+
+  ///
+  int plungeSPLimit;
+
+  ///
+  double plungeMemoryMB;
+
+  ///
+  double plungeResumeFraction;
+
+  ///
+  int spillKeep;
+
+  ///
+  std::string spillDir;
+
   ///
   bool initialDive;
 
@@ -58,6 +88,9 @@ public:
   ///
   bool eagerBounding;
 
+  /// Number of threads used by the serial (non-MPI) search
+  int numThreads;
+
   ///
   double relTolerance;
 
@@ -73,6 +106,9 @@ public:
   ///
   bool validateLog;
 
+  ///
+  bool validateLogBinary;
+
   ///
   bool heurLog;
 
@@ -82,6 +118,9 @@ public:
   ///
   double loadLogWriteSeconds;
 
+  ///
+  bool loadLogBinary;
+
   ///
   int maxSPBounds;
 
@@ -145,6 +184,27 @@ public:
   ///
   int printSpTimes;
 
+  ///
+  double checkpointMinutes;
+
+  ///
+  double checkpointMinInterval;
+
+  ///
+  std::string checkpointDir;
+
+  ///
+  bool restart;
+
+  ///
+  int abortCheckpoint;
+
+  ///
+  int abortCheckpointCount;
+
+  ///
+  int refSolArrayQuantum;
+
 };
 
 } // namespace pebbl
@@ -0,0 +1,492 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// searchThread.cpp
+//
+// Shared-memory threaded version of the serial search loop.
+//
+
+
+#include <pebbl_config.h>
+
+#include <pebbl/utilib/seconds.h>
+
+#include <pebbl/bb/searchThread.h>
+#include <pebbl/misc/gRandom.h>
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+
+using namespace std;
+
+namespace pebbl {
+
+
+// The thread object for the calling thread, if any
+
+static thread_local searchThread* runningThread = NULL;
+
+
+searchThread* searchThread::current()
+{
+  return runningThread;
+}
+
+
+searchThread::searchThread(branching* global_,int threadNum_) :
+  threadNum(threadNum_),
+  spsProcessed(0),
+  steals(0),
+  stealTries(0),
+  global(global_),
+  currentSP(NULL),
+  busy(false),
+  currentBound(0),
+  pendingRemovals(0),
+  seenPruneEpoch(global_->pruneEpoch),
+  lastPrint(0),
+  lastPrintTime(0)
+{
+  // Thread 0 works directly out of the main pool, which already holds
+  // the root.  The other threads start with empty pools.
+
+  if (threadNum == 0)
+    pool = global->pool;
+  else
+    {
+      pool = global->makePool();
+      pool->load().init(global,false);
+    }
+  handler = makeHandler();
+}
+
+
+searchThread::~searchThread()
+{
+  if (threadNum > 0)
+    delete pool;
+  delete handler;
+}
+
+
+spHandler* searchThread::makeHandler()
+{
+  threadSPHandler* h;
+  if (global->lazyBounding)
+    h = new threadLazyHandler;
+  else if (global->eagerBounding)
+    h = new threadEagerHandler;
+  else
+    h = new threadHybridHandler;
+  h->setThread(this);
+  return h;
+}
+
+
+// Main loop for one thread.  Mirrors the loop in
+// branching::searchFramework, but gets its work from its own pool or,
+// failing that, from other threads' pools.
+
+void searchThread::run()
+{
+  runningThread = this;
+
+  // Give each thread a different random number stream
+
+  if (threadNum > 0)
+    gRandomReSeed(randomSeed + 7919*threadNum);
+
+  try
+    {
+      while (!global->threadAbort)
+	{
+	  if (!currentSP && !loadLocal())
+	    {
+	      flushRemovals();
+	      if (finished())
+		break;
+	      if (!steal())
+		{
+		  if (threadNum == 0)
+		    maintenance();
+		  std::this_thread::yield();
+		  continue;
+		}
+	    }
+
+	  if (currentSP->canFathom())
+	    eraseCurrentSP();
+	  else
+	    {
+	      DEBUGPR(5,ucout << "Thread " << threadNum << " executing "
+		      << currentSP->id.creatingProcessor
+		      << ":" << currentSP->id.serial
+		      << " bound=" << currentSP->bound
+		      << " state=" << currentSP->state
+		      << " depth=" << currentSP->depth << "\n");
+	      handler->execute();
+	      spsProcessed++;
+	      if (currentSP && !(currentSP->forceStayCurrent()))
+		unloadCurrentSPtoPool();
+	    }
+
+	  pruneIfNeeded();
+
+	  if (threadNum == 0)
+	    maintenance();
+	}
+    }
+  catch (...)
+    {
+      error = std::current_exception();
+      global->threadAbort = true;
+    }
+
+  if (currentSP)
+    unloadCurrentSPtoPool();
+  flushRemovals();
+
+  // List items are cached per thread; free this thread's cache before
+  // it exits.
+
+  if (threadNum > 0)
+    utilib::CachedAllocator<utilib::ListItem<branchSub*> >::delete_unused();
+
+  runningThread = NULL;
+}
+
+
+// Take the next subproblem out of this thread's own pool
+
+bool searchThread::loadLocal()
+{
+  branchSub* p;
+  {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (pool->size() == 0)
+      return false;
+    p = pool->remove();
+    currentBound = p->boundEstimate();
+    busy = true;
+  }
+  loadCurrentSP(p);
+  return true;
+}
+
+
+// Try to take a subproblem from another thread's pool.  Victims are
+// tried in rotating order, starting with a different one each time.
+
+bool searchThread::steal()
+{
+  int n = global->searchThreads.size();
+  if (n < 2)
+    return false;
+
+  stealTries++;
+  for (int k=0; k<n-1; k++)
+    {
+      int offset = 1 + (stealTries + k) % (n - 1);
+      searchThread* victim = global->searchThreads[(threadNum + offset) % n];
+      branchSub* p = NULL;
+      {
+	std::lock_guard<std::mutex> lock(victim->poolMutex);
+	if (victim->pool->size() > 0)
+	  {
+	    p = victim->pool->remove();
+	    currentBound = p->boundEstimate();
+	    busy = true;
+	  }
+      }
+      if (p)
+	{
+	  DEBUGPR(20,ucout << "Thread " << threadNum << " stole " << p
+		  << " from thread " << victim->threadNum << '\n');
+	  steals++;
+	  loadCurrentSP(p);
+	  return true;
+	}
+    }
+  return false;
+}
+
+
+void searchThread::loadCurrentSP(branchSub* p)
+{
+  currentSP   = p;
+  currentSPId = p->id;
+  p->makeCurrentEffect();
+}
+
+
+void searchThread::unloadCurrentSP()
+{
+  previousSPId = currentSPId;
+  currentSP->noLongerCurrentEffect();
+  currentSP = NULL;
+  busy = false;
+}
+
+
+void searchThread::eraseCurrentSP()
+{
+  branchSub* p = currentSP;
+  unloadCurrentSP();
+  p->recycle();
+  pendingRemovals++;
+}
+
+
+// Unload first, since another thread may pick the subproblem up as
+// soon as it is in the pool.
+
+void searchThread::unloadCurrentSPtoPool()
+{
+  branchSub* p = currentSP;
+  unloadCurrentSP();
+  std::lock_guard<std::mutex> lock(poolMutex);
+  pool->insert(p);
+}
+
+
+// Insert a new child.  The count of outstanding subproblems must never
+// drop below the true number, so a removal this thread has not yet
+// reported is simply cancelled against the new subproblem.
+
+void searchThread::insert(branchSub* p)
+{
+  if (pendingRemovals > 0)
+    pendingRemovals--;
+  else
+    global->threadSPCount++;
+  std::lock_guard<std::mutex> lock(poolMutex);
+  pool->insert(p);
+}
+
+
+void searchThread::flushRemovals()
+{
+  if (pendingRemovals > 0)
+    {
+      global->threadSPCount -= pendingRemovals;
+      pendingRemovals = 0;
+    }
+}
+
+
+bool searchThread::finished()
+{
+  return (global->threadSPCount == 0) || global->threadAbort;
+}
+
+
+// Prune this thread's pool if some thread has signalled a new
+// incumbent since the last time we looked.
+
+void searchThread::pruneIfNeeded()
+{
+  int epoch = global->pruneEpoch;
+  if (epoch == seenPruneEpoch)
+    return;
+  seenPruneEpoch = epoch;
+  DEBUGPR(20,ucout << "Thread " << threadNum << " pruning.\n");
+  std::lock_guard<std::mutex> lock(poolMutex);
+  int oldSize = pool->size();
+  pool->prune();
+  pendingRemovals += oldSize - pool->size();
+}
+
+
+// Periodic chores from the serial loop, done only by thread 0.  The
+// status line test is repeated here so the other pools are only
+// locked when a line is actually due.
+
+void searchThread::maintenance()
+{
+  if ((global->earlyOutputMinutes > 0) && global->serialNeedEarlyOutput())
+    {
+      std::lock_guard<std::mutex> lock(global->incumbentMutex);
+      global->directSolutionToFile();
+      global->recordEarlyOutput(global->incumbentValue);
+    }
+
+  int bounded = global->subCount[beingBounded];
+
+  if (global->hlog ||
+      ((global->statusPrintCount > 0) &&
+       (bounded >= lastPrint + global->statusPrintCount)) ||
+      ((global->statusPrintSeconds > 0) &&
+       (CoarseWallClockSeconds() >=
+	lastPrintTime + global->statusPrintSeconds)))
+    global->statusPrint(lastPrint,lastPrintTime);
+
+  global->recordLoadLogIfNeeded();
+
+  if (global->shouldAbort(bounded))
+    global->threadAbort = true;
+}
+
+
+// Load in this thread's pool, without the spCount information.
+// Caller must hold poolMutex.
+
+loadObject searchThread::poolLoad()
+{
+  loadObject l = pool->updatedLoad();
+  l.boundedSPs = 0;
+  l.createdSPs = 0;
+  return l;
+}
+
+
+//  Threaded search methods of the branching class
+
+
+bool branching::canUseThreads(spHandler* handler_)
+{
+  if (numThreads <= 1)
+    return false;
+
+  const char* reason = NULL;
+  if (handler_)
+    reason = "a user-supplied handler";
+  else if (enumerating)
+    reason = "enumeration";
+  else if (valLogOutput())
+    reason = "validation logging";
+  else if (checkpointMinutes > 0)
+    reason = "checkpointing";
+
+  if (reason)
+    {
+      if (!suppressWarnings)
+	ucout << "****** Warning ******** numThreads ignored with "
+	      << reason << "; using one thread.\n";
+      return false;
+    }
+
+  return true;
+}
+
+
+void branching::threadedSearch(int& lastPrint,double& lastPrintTime)
+{
+  DEBUGPR(1,ucout << "Threaded search with " << numThreads << " threads\n");
+
+  clearSearchThreads();
+  threadSetup(numThreads);
+
+  searchThreads.resize(numThreads);
+  for (int i=0; i<numThreads; i++)
+    searchThreads[i] = new searchThread(this,i);
+  searchThreads[0]->lastPrint     = lastPrint;
+  searchThreads[0]->lastPrintTime = lastPrintTime;
+
+  threadSPCount = pool->size();
+  threadAbort   = false;
+  threadsActive  = true;
+  countersShared = true;
+
+  std::vector<std::thread> workers;
+  for (int i=1; i<numThreads; i++)
+    workers.push_back(std::thread(&searchThread::run,searchThreads[i]));
+  searchThreads[0]->run();
+  for (size_type i=0; i<workers.size(); i++)
+    workers[i].join();
+
+  lastPrint     = searchThreads[0]->lastPrint;
+  lastPrintTime = searchThreads[0]->lastPrintTime;
+
+  std::exception_ptr error;
+  for (int i=0; i<numThreads; i++)
+    if (searchThreads[i]->error && !error)
+      error = searchThreads[i]->error;
+
+  if (threadAbort && !error)
+    {
+      loadObject l = updatedLoad();
+      printAbortStatistics(l);
+    }
+
+  threadsActive  = false;
+  countersShared = false;
+
+  // On an abort, subproblems may be left in any of the pools
+
+  for (int i=0; i<numThreads; i++)
+    searchThreads[i]->pool->clear();
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+
+// Combined load of all the thread pools and the subproblems the
+// threads are working on.
+
+loadObject branching::threadedLoad()
+{
+  loadObject l(this);
+  l.update();
+  for (size_type i=0; i<searchThreads.size(); i++)
+    {
+      searchThread* t = searchThreads[i];
+      {
+	std::lock_guard<std::mutex> lock(t->poolMutex);
+	l += t->poolLoad();
+      }
+      if (t->busy)
+	l.addLoad(t->currentBound,1);
+    }
+  return l;
+}
+
+
+void branching::clearSearchThreads()
+{
+  for (size_type i=0; i<searchThreads.size(); i++)
+    delete searchThreads[i];
+  searchThreads.resize(0);
+}
+
+
+int branching::threadNum()
+{
+  searchThread* t = searchThread::current();
+  return t ? t->threadNum : 0;
+}
+
+
+branchSubId& branching::lastSPId()
+{
+  searchThread* t = searchThread::current();
+  return t ? t->previousSPId : previousSPId;
+}
+
+
+void branching::printThreadStatistics(ostream& stream)
+{
+  stream << endl;
+  for (size_type i=0; i<searchThreads.size(); i++)
+    {
+      searchThread* t = searchThreads[i];
+      stream << "Thread " << setw(3) << i << ": "
+	     << setw(10) << t->spsProcessed << " subproblems processed, "
+	     << t->steals << " steals in "
+	     << t->stealTries << " attempts\n";
+    }
+  stream << endl;
+}
+
+} // namespace pebbl
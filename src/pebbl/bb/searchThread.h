@@ -0,0 +1,203 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+
+/**
+ * \file searchThread.h
+ *
+ * Shared-memory threads for the serial branching framework.  When
+ * numThreads > 1, branching::searchFramework hands the pool to a set
+ * of searchThread objects.  Each thread has its own pool, current
+ * subproblem, and handler; a thread that runs out of work steals a
+ * subproblem from another thread's pool.  Thread 0 runs on the
+ * calling thread and takes care of status lines, early output, load
+ * logging, and abort checks.
+ */
+
+#ifndef pebbl_searchThread_h
+#define pebbl_searchThread_h
+
+#include <pebbl_config.h>
+#include <pebbl/bb/branching.h>
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+
+
+namespace pebbl {
+
+
+class searchThread : public pebblBase
+{
+  friend class branching;
+  friend class threadSPHandler;
+
+public:
+
+  REFER_DEBUG(global)
+
+  searchThread(branching* global_,int threadNum_);
+
+  virtual ~searchThread();
+
+  // The searchThread running on the calling thread, or NULL if no
+  // threaded search is in progress there.
+
+  static searchThread* current();
+
+  int threadNum;
+
+  // Statistics
+
+  int spsProcessed;
+  int steals;
+  int stealTries;
+
+protected:
+
+  branching* global;
+
+  branchPool<branchSub,loadObject>* pool;
+  std::mutex                        poolMutex;
+
+  spHandler* handler;
+
+  branchSub*  currentSP;
+  branchSubId currentSPId;
+  branchSubId previousSPId;
+
+  // Bound of the current subproblem, readable by other threads when
+  // they add up the load.
+
+  std::atomic<bool>   busy;
+  std::atomic<double> currentBound;
+
+  // Subproblems this thread has disposed of, but not yet subtracted
+  // from the shared outstanding count.
+
+  long pendingRemovals;
+
+  int seenPruneEpoch;
+
+  // Exception that stopped this thread, rethrown by the caller
+
+  std::exception_ptr error;
+
+  // Thread 0 only: status line bookkeeping
+
+  int    lastPrint;
+  double lastPrintTime;
+
+  void run();
+
+  bool loadLocal();
+  bool steal();
+
+  void loadCurrentSP(branchSub* p);
+  void unloadCurrentSP();
+  void eraseCurrentSP();
+  void unloadCurrentSPtoPool();
+
+  void insert(branchSub* p);
+
+  void pruneIfNeeded();
+  void flushRemovals();
+
+  void maintenance();
+
+  bool finished();
+
+  loadObject poolLoad();
+
+  spHandler* makeHandler();
+};
+
+
+// Handler mix-in that redirects subproblem traffic to the search
+// thread rather than the branching object.
+
+class threadSPHandler : virtual public spHandler
+{
+ public:
+
+  virtual ~threadSPHandler() { };
+
+  void setThread(searchThread* thread_)
+    {
+      thread = thread_;
+      setGlobal(thread_->global);
+    };
+
+ protected:
+
+  searchThread* thread;
+
+  void setProblem()  { p = thread->currentSP;  };
+  void erase()       { thread->eraseCurrentSP(); };
+  void insertChild() { thread->insert(c);      };
+
+};
+
+
+class threadLazyHandler :
+  virtual public threadSPHandler,
+  virtual public lazyHandler
+{
+ public:
+
+  void execute() { lazyHandler::execute(); };
+
+ protected:
+
+  void setProblem()  { threadSPHandler::setProblem();  };
+  void erase()       { threadSPHandler::erase();       };
+  void insertChild() { threadSPHandler::insertChild(); };
+
+};
+
+
+class threadHybridHandler :
+  virtual public threadSPHandler,
+  virtual public hybridHandler
+{
+ public:
+
+  void execute() { hybridHandler::execute(); };
+
+ protected:
+
+  void setProblem()  { threadSPHandler::setProblem();  };
+  void erase()       { threadSPHandler::erase();       };
+  void insertChild() { threadSPHandler::insertChild(); };
+
+};
+
+
+class threadEagerHandler :
+  virtual public threadSPHandler,
+  virtual public eagerHandler
+{
+ public:
+
+  void execute() { eagerHandler::execute(); };
+
+ protected:
+
+  void setProblem()  { threadSPHandler::setProblem();  };
+  void erase()       { threadSPHandler::erase();       };
+  void insertChild() { threadSPHandler::insertChild(); };
+
+};
+
+
+} // namespace pebbl
+
+#endif
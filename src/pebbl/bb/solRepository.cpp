@@ -0,0 +1,237 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// solRepository.cpp
+//
+
+#include <pebbl_config.h>
+#include <pebbl/bb/solRepository.h>
+#include <pebbl/bb/branching.h>
+
+#include <algorithm>
+#include <stdint.h>
+
+using namespace std;
+
+namespace pebbl {
+
+
+solRepository::solRepository() :
+  tableBits(0)
+{
+  reset(1);
+}
+
+
+void solRepository::reset(size_type initialSize)
+{
+  if (heap.size() > 0)
+    EXCEPTION_MNGR(runtime_error,"solRepository::reset called on a "
+		   "repository holding " << heap.size() << " solutions");
+
+  // Keep the table at most half full
+
+  tableBits = 1;
+  while (((size_type) 1 << tableBits) < 2*initialSize)
+    tableBits++;
+
+  hashSlot empty = { 0, NULL };
+  table.assign((size_type) 1 << tableBits,empty);
+}
+
+
+// Multiplicative (Fibonacci) hashing, so the table index depends on
+// all the bits of the solution's hash value.
+
+size_type solRepository::home(size_type hash) const
+{
+  uint64_t h = (uint64_t) hash * (uint64_t) 0x9E3779B97F4A7C15ULL;
+  return (size_type) (h >> (64 - tableBits));
+}
+
+
+solution* solRepository::findDuplicate(solution* sol)
+{
+  size_type hash = sol->computeHashValue();
+  size_type mask = table.size() - 1;
+  for (size_type i=home(hash); table[i].sol; i=(i + 1) & mask)
+    if ((table[i].hash == hash) && table[i].sol->duplicateOf(*sol))
+      return table[i].sol;
+  return NULL;
+}
+
+
+void solRepository::insert(solution* sol)
+{
+  if (2*(heap.size() + 1) > table.size())
+    grow();
+  tableInsert(sol->computeHashValue(),sol);
+  heap.push_back(makeSlot(sol));
+  siftUp(heap.size() - 1);
+}
+
+
+solution* solRepository::replaceWorst(solution* sol)
+{
+  solution* oldWorst = heap[0].sol;
+  tableRemove(oldWorst);
+  tableInsert(sol->computeHashValue(),sol);
+  heap[0] = makeSlot(sol);
+  siftDown(0);
+  return oldWorst;
+}
+
+
+solution* solRepository::removeWorst()
+{
+  solution* oldWorst = heap[0].sol;
+  tableRemove(oldWorst);
+  heap[0] = heap.back();
+  heap.pop_back();
+  if (heap.size() > 0)
+    siftDown(0);
+  return oldWorst;
+}
+
+
+namespace {
+
+  bool betterSolution(solution* a,solution* b)
+  {
+    return a->compare(*b) < 0;
+  }
+
+} // namespace
+
+
+void solRepository::sorted(vector<solution*>& result) const
+{
+  result.resize(heap.size());
+  for (size_type i=0; i<heap.size(); i++)
+    result[i] = heap[i].sol;
+  sort(result.begin(),result.end(),betterSolution);
+}
+
+
+void solRepository::tableInsert(size_type hash,solution* sol)
+{
+  size_type mask = table.size() - 1;
+  size_type i    = home(hash);
+  while (table[i].sol)
+    i = (i + 1) & mask;
+  table[i].hash = hash;
+  table[i].sol  = sol;
+}
+
+
+// Remove by backward shifting: each later entry in the run is moved
+// into the hole unless its home lies cyclically in (hole, entry].
+
+void solRepository::tableRemove(solution* sol)
+{
+  size_type mask = table.size() - 1;
+  size_type i    = home(sol->hashValue);
+  while (table[i].sol != sol)
+    {
+      if (!table[i].sol)
+	EXCEPTION_MNGR(runtime_error,"solRepository: solution " << sol
+		       << " is not in the hash table");
+      i = (i + 1) & mask;
+    }
+
+  size_type hole = i;
+  for (size_type j=(hole + 1) & mask; table[j].sol; j=(j + 1) & mask)
+    {
+      size_type k = home(table[j].hash);
+      if (((j - k) & mask) >= ((j - hole) & mask))
+	{
+	  table[hole] = table[j];
+	  hole = j;
+	}
+    }
+  table[hole].sol = NULL;
+}
+
+
+void solRepository::grow()
+{
+  vector<hashSlot> oldTable;
+  oldTable.swap(table);
+  tableBits++;
+  hashSlot empty = { 0, NULL };
+  table.assign((size_type) 1 << tableBits,empty);
+  for (size_type i=0; i<oldTable.size(); i++)
+    if (oldTable[i].sol)
+      tableInsert(oldTable[i].hash,oldTable[i].sol);
+}
+
+
+solRepository::heapSlot solRepository::makeSlot(solution* sol) const
+{
+  heapSlot s;
+  s.value  = sol->value;
+  s.serial = sol->serial;
+  s.sol    = sol;
+  return s;
+}
+
+
+// Same tests, in the same order, as solutionIdentifier::compare; only
+// an exact tie on value and serial needs the solutions themselves.
+
+bool solRepository::worse(const heapSlot& a,const heapSlot& b) const
+{
+  if (a.value != b.value)
+    return a.sol->sense*(a.value - b.value) > 0;
+  if (a.serial != b.serial)
+    return a.serial > b.serial;
+  return a.sol->compare(*b.sol) > 0;
+}
+
+
+void solRepository::siftUp(size_type i)
+{
+  heapSlot s = heap[i];
+  while (i > 0)
+    {
+      size_type parent = (i - 1)/arity;
+      if (!worse(s,heap[parent]))
+	break;
+      heap[i] = heap[parent];
+      i = parent;
+    }
+  heap[i] = s;
+}
+
+
+void solRepository::siftDown(size_type i)
+{
+  heapSlot  s = heap[i];
+  size_type n = heap.size();
+  for (;;)
+    {
+      size_type first = arity*i + 1;
+      if (first >= n)
+	break;
+      size_type last  = min(first + arity,n);
+      size_type worst = first;
+      for (size_type c=first+1; c<last; c++)
+	if (worse(heap[c],heap[worst]))
+	  worst = c;
+      if (!worse(heap[worst],s))
+	break;
+      heap[i] = heap[worst];
+      i = worst;
+    }
+  heap[i] = s;
+}
+
+} // namespace pebbl
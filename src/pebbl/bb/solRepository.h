@@ -0,0 +1,129 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+
+/**
+ * \file solRepository.h
+ *
+ * Defines the pebbl::solRepository class, which holds the solutions
+ * kept when enumerating.
+ */
+
+#ifndef pebbl_solRepository_h
+#define pebbl_solRepository_h
+
+#include <pebbl_config.h>
+#include <pebbl/utilib/_generic.h>
+
+#include <vector>
+
+
+namespace pebbl {
+
+class solution;
+
+
+//
+//  The solutions stored by enumeration.  There are two structures,
+//  both plain arrays:
+//
+//  - An open-addressing hash table (linear probing, power-of-two
+//    size, at most half full) used to find duplicates.  Each slot
+//    holds a solution's hash value, so the virtual duplicateOf is only
+//    called for solutions whose hashes match.  The table doubles when
+//    it fills, and deletions shift later entries back rather than
+//    leaving markers.
+//
+//  - A 4-ary heap with the *worst* solution on top, so the solution
+//    to evict or prune is always at hand.  Each slot holds the value
+//    and serial number, the keys of solutionIdentifier::compare.
+//
+//  The repository does not own its solutions; the caller disposes of
+//  them once they are removed.
+//
+
+class solRepository
+{
+public:
+
+  solRepository();
+
+  /// Number of solutions stored.
+  size_type size() const { return heap.size(); };
+
+  /// Discard the (empty) table and make one with room for at least
+  /// \c initialSize solutions.
+  void reset(size_type initialSize);
+
+  /// The worst solution stored, or NULL if there is none.
+  solution* worst() const { return heap.empty() ? NULL : heap[0].sol; };
+
+  /// A stored solution that duplicates \c sol, or NULL.
+  solution* findDuplicate(solution* sol);
+
+  /// Store a solution, which must not duplicate one already stored.
+  void insert(solution* sol);
+
+  /// Store \c sol in place of the worst solution, which is returned.
+  solution* replaceWorst(solution* sol);
+
+  /// Remove the worst solution and return it.
+  solution* removeWorst();
+
+  /// The i-th stored solution, in no particular order.
+  solution* member(size_type i) const { return heap[i].sol; };
+
+  /// All the stored solutions, best first.
+  void sorted(std::vector<solution*>& result) const;
+
+  /// Number of slots in the hash table.
+  size_type capacity() const { return table.size(); };
+
+protected:
+
+  enum { arity = 4 };
+
+  struct hashSlot
+  {
+    size_type hash;
+    solution* sol;      // NULL if the slot is empty
+  };
+
+  struct heapSlot
+  {
+    double    value;
+    int       serial;
+    solution* sol;
+  };
+
+  std::vector<hashSlot> table;
+  std::vector<heapSlot> heap;
+
+  int tableBits;        // table.size() == 2^tableBits
+
+  size_type home(size_type hash) const;
+
+  void tableInsert(size_type hash,solution* sol);
+  void tableRemove(solution* sol);
+  void grow();
+
+  heapSlot makeSlot(solution* sol) const;
+
+  // True if a ranks behind b in the repository
+
+  bool worse(const heapSlot& a,const heapSlot& b) const;
+
+  void siftUp(size_type i);
+  void siftDown(size_type i);
+};
+
+} // namespace pebbl
+
+#endif
@@ -0,0 +1,126 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+
+/**
+ * \file valLog.h
+ *
+ * The binary validation log format (validateLogBinary).  Each
+ * processor writes a file val<n>.vbin of fixed-size valLogRecords in
+ * the machine's byte order, through a large stream buffer.  Every
+ * time the file is opened it gets a header record, so a file appended
+ * to after a restart is still valid.  logAnalyze reads these files as
+ * well as the text val<n>.log files.
+ *
+ * Application data that the text log gets from the valLog...Extra()
+ * methods goes in the extra fields, filled in by
+ * branchSub::valLogRecordExtra().  For logAnalyze --fromMIP, create
+ * and unpack records carry the branch type and depth in extraInt[0]
+ * and extraInt[1], and split records carry the branching variable in
+ * extraInt[0] and its value in extraDouble[0].
+ */
+
+#ifndef pebbl_valLog_h
+#define pebbl_valLog_h
+
+#include <pebbl_config.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace pebbl {
+
+
+struct valLogRecord
+{
+  enum kindType { header, create, packChild, pack, bounding, split, destroy,
+		  unpack, fathoming, numKinds };
+
+  // "PBVL", in header records' otherProc
+  enum { magic = 0x4c564250, version = 1 };
+
+  int32_t kind;
+
+  // The subproblem
+  int32_t proc;
+  int32_t serial;
+
+  // The parent for create and packChild; unused otherwise
+  int32_t parentProc;
+  int32_t parentSerial;
+
+  // Children for split and destroy, children left for unpack, the
+  // sense for fathoming, and the record size for the header
+  int32_t count;
+
+  int32_t extraInt[2];
+
+  // The bound, or the incumbent value for fathoming
+  double  bound;
+
+  // The relative and absolute tolerances for fathoming
+  double  extraDouble[2];
+
+  valLogRecord(kindType kind_ = header)
+    {
+      std::memset(this,0,sizeof(valLogRecord));
+      kind = kind_;
+    };
+
+  static valLogRecord headerRecord()
+    {
+      valLogRecord r(header);
+      r.parentProc = magic;
+      r.serial     = version;
+      r.count      = sizeof(valLogRecord);
+      return r;
+    };
+
+  bool isHeader() const
+    {
+      return (kind == header) && (parentProc == magic);
+    };
+
+  void write(std::ostream& s) const
+    {
+      s.write((const char*) this,sizeof(valLogRecord));
+    };
+};
+
+
+// An output file stream with a large buffer of its own, for logs that
+// are written a few bytes at a time.
+
+class valLogStream : public std::ofstream
+{
+public:
+
+  valLogStream(const char* name,std::ios::openmode mode,
+	       size_t bufferSize = 1 << 20) :
+    buffer(bufferSize)
+    {
+      rdbuf()->pubsetbuf(&buffer[0],buffer.size());
+      open(name,mode);
+    };
+
+  // Flush while the buffer still exists
+  ~valLogStream() { close(); };
+
+protected:
+
+  std::vector<char> buffer;
+};
+
+
+} // namespace pebbl
+
+#endif
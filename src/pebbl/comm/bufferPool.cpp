@@ -0,0 +1,113 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// bufferPool.cpp
+//
+// Size-classed pool of PackBuffers for outgoing messages.
+//
+
+#include <pebbl_config.h>
+#include <pebbl/comm/bufferPool.h>
+
+using namespace std;
+
+namespace pebbl {
+
+
+packBufferPool::packBufferPool() :
+  requests(0),
+  reuses(0),
+  allocations(0),
+  bytesAllocated(0),
+  discards(0)
+{ }
+
+
+PackBuffer* packBufferPool::get(size_t bytes)
+{
+  lock_guard<mutex> lock(mtx);
+  requests++;
+
+  int c = 0;
+  while ((c < numClasses - 1) && (classBytes(c) < bytes))
+    c++;
+
+  if (classBytes(c) >= bytes)
+    {
+      for (int k=c; (k<=c+1) && (k<numClasses); k++)
+	if (!freeList[k].empty())
+	  {
+	    PackBuffer* buf = freeList[k].back();
+	    freeList[k].pop_back();
+	    reuses++;
+	    return buf;
+	  }
+      bytes = classBytes(c);
+    }
+
+  allocations++;
+  bytesAllocated += bytes;
+  return new PackBuffer(bytes);
+}
+
+
+void packBufferPool::put(PackBuffer* buf)
+{
+  if (!buf)
+    return;
+
+  size_t cap = buf->capacity();
+  if (cap < classBytes(0))
+    {
+      lock_guard<mutex> lock(mtx);
+      discards++;
+      delete buf;
+      return;
+    }
+
+  int c = 0;
+  while ((c < numClasses - 1) && (classBytes(c + 1) <= cap))
+    c++;
+
+  buf->reset();
+  lock_guard<mutex> lock(mtx);
+  if (freeList[c].size() >= (size_t) maxPerClass)
+    {
+      discards++;
+      delete buf;
+      return;
+    }
+  freeList[c].push_back(buf);
+}
+
+
+void packBufferPool::clear()
+{
+  lock_guard<mutex> lock(mtx);
+  for (int c=0; c<numClasses; c++)
+    {
+      for (size_t i=0; i<freeList[c].size(); i++)
+	delete freeList[c][i];
+      freeList[c].clear();
+    }
+}
+
+
+// Made on first use and never destroyed, so outBufferQueues that are
+// destroyed during static destruction can still return their buffers.
+
+packBufferPool& bufferPool()
+{
+  static packBufferPool* pool = new packBufferPool;
+  return *pool;
+}
+
+} // namespace pebbl
@@ -0,0 +1,97 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+
+/**
+ * \file bufferPool.h
+ *
+ * Defines the pebbl::packBufferPool class, which keeps PackBuffers
+ * whose sends have completed so that later messages can reuse them.
+ */
+
+#ifndef pebbl_bufferPool_h
+#define pebbl_bufferPool_h
+
+#include <pebbl_config.h>
+#include <pebbl/utilib/PackBuf.h>
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace pebbl {
+
+using utilib::PackBuffer;
+
+
+// Free PackBuffers, sorted into size classes that are powers of two
+// starting at 2^minClassBits bytes.  A request for n bytes is served
+// from the smallest class that holds n bytes, or failing that the
+// class above it, before a new buffer is made; a returned buffer goes
+// to the largest class it can serve.  Queues ask for their starting
+// size, but buffers often grow while being packed, so a buffer that
+// has grown a little can serve the next request, while much larger
+// buffers are kept for requests of their own size.  Each class keeps
+// at most maxPerClass buffers, and buffers larger than the top class
+// are treated as top-class buffers.
+// There is one pool per process, shared by all outBufferQueues, and it
+// may be used by several threads.
+
+class packBufferPool
+{
+public:
+
+  enum { minClassBits = 8, numClasses = 16, maxPerClass = 64 };
+
+  packBufferPool();
+
+  ~packBufferPool() { clear(); };
+
+  // An empty buffer with room for at least 'bytes' bytes.  The caller
+  // owns it.
+
+  PackBuffer* get(size_t bytes);
+
+  // Return a buffer to the pool, or delete it if it is smaller than
+  // the smallest class or its class is full.
+
+  void put(PackBuffer* buf);
+
+  // Delete all pooled buffers.
+
+  void clear();
+
+  // Statistics: buffers requested, requests served from the pool,
+  // buffers made, bytes in the buffers made, and buffers deleted
+  // by put().
+
+  int    requests;
+  int    reuses;
+  int    allocations;
+  double bytesAllocated;
+  int    discards;
+
+protected:
+
+  static size_t classBytes(int c) { return ((size_t) 1) << (c + minClassBits); };
+
+  std::mutex mtx;
+
+  std::vector<PackBuffer*> freeList[numClasses];
+};
+
+
+// The process-wide pool.
+
+packBufferPool& bufferPool();
+
+} // namespace pebbl
+
+#endif
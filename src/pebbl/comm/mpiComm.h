@@ -271,6 +271,15 @@ public:
             EXCEPTION_MNGR(std::runtime_error, "MPI_Irecv failed, code " << errorCode);
     }
 
+  /// Create a persistent receive request; MPI_Start posts it.
+  void recvInit(void* buffer,int count,MPI_Datatype datatype,int source,
+                int tag,MPI_Request* request)
+    {
+        errorCode = MPI_Recv_init(buffer,count,datatype,source,tag,comm,request);
+        if (errorCode)
+            EXCEPTION_MNGR(std::runtime_error, "MPI_Recv_init failed, code " << errorCode);
+    }
+
   /// Perform a Recv.
   void recv(void* buffer,int count,MPI_Datatype datatype,int source,int tag,
             MPI_Status* status)
@@ -21,6 +21,7 @@
 #include <pebbl/utilib/exception_mngr.h>
 #include <pebbl/utilib/mpiUtil.h>
 #include <pebbl/comm/outBufferQ.h>
+#include <pebbl/comm/bufferPool.h>
 
 
 #ifdef ACRO_HAVE_MPI
@@ -37,7 +38,7 @@ outBufferQElt::~outBufferQElt()
 	  ", tag " << tag << '\n');
   uMPI::killSendRequest(&request);
   if (buffer)
-    delete buffer;                         // Now it's OK to recycle the buffer
+    bufferPool().put(buffer);              // Now it's OK to recycle the buffer
 };
 
 
@@ -56,13 +57,28 @@ void outBufferQueue::send(PackBuffer* buffer,int dest,int tag)
 	  << sendObj->request << '\n');
 
   queue.add(sendObj);     
+
+  // Beyond the scavengeSize buffers we keep for ourselves, give the
+  // buffers of the oldest completed sends back to the pool, where
+  // other queues can use them.
+
+  while (queue.size() > static_cast<size_type>(scavengeSize))
+    {
+      ListItem<outBufferQElt*>* item = queue.head();
+      if (!uMPI::testSend(&(item->data()->request)))
+	break;
+      outBufferQElt* done;
+      queue.remove(item,done);
+      delete done;
+    }
 }
 
 
 //  To get a free buffer.  If the number of buffers in use is >= scavengeSize,
 //  we try to scavenge a buffer that has already been sent and is now 
 //  now available.  If fewer than that many buffers are in use, or none are 
-//  free, we return a new PackBuffer of size startingBufferSize.
+//  free, we take one with room for startingBufferSize bytes from the
+//  process-wide buffer pool.
 
 PackBuffer* outBufferQueue::getFree()
 {
@@ -77,7 +93,9 @@ PackBuffer* outBufferQueue::getFree()
 	      // Now the caller owns the buffer.
 	      PackBuffer* toReturn = item->data()->buffer;  
 	      item->data()->buffer = 0;
-	      queue.remove(item);     
+	      outBufferQElt* done;
+	      queue.remove(item,done);     
+	      delete done;
 	      DEBUGPR(170,ucout << "Recycling buffer.\n");
 	      toReturn->reset();                      // Reset and return the
 	      return toReturn;                        // buffer.
@@ -85,8 +103,8 @@ PackBuffer* outBufferQueue::getFree()
 	  item = queue.next(item);
 	}
     }
-  DEBUGPR(100,ucout << "Making new buffer.\n");
-  return new PackBuffer(startingBufferSize);
+  DEBUGPR(100,ucout << "Taking buffer from pool.\n");
+  return bufferPool().get(startingBufferSize);
 };
 
 
@@ -102,7 +120,9 @@ void outBufferQueue::completeAll(int tag)
 	{
 	  MPI_Status status;
 	  uMPI::wait(&(item->data()->request),&status,true/*kill request*/);
-	  queue.remove(item);
+	  outBufferQElt* done;
+	  queue.remove(item,done);
+	  delete done;
 	  
 	}
       item = item2;
@@ -223,9 +243,10 @@ void multiOutBufferQueue::segmentDone(int dest)
 }
 
 
-void multiOutBufferQueue::sendOnly(int dest)
+void multiOutBufferQueue::sendOnly(int dest,int sendTag)
 {
-  DEBUGPR(100,ucout << "SendOnly called for " << dest << endl);
+  DEBUGPR(100,ucout << "SendOnly called for " << dest << ", tag "
+	  << sendTag << endl);
 
   DEBUGPR(1000,
   if (buffer[dest] == NULL)
@@ -237,7 +258,7 @@ void multiOutBufferQueue::sendOnly(int dest)
 
   // Send the buffer.
 
-  sendBuffer(dest);
+  sendBuffer(dest,sendTag);
 
   // Unlink it from the list of partially full buffers.
 
@@ -260,7 +281,7 @@ void multiOutBufferQueue::sendOnly(int dest)
 }
 
 
-void multiOutBufferQueue::sendBuffer(int dest)
+void multiOutBufferQueue::sendBuffer(int dest,int sendTag)
 {
   // Write a last-segment marker.
 
@@ -271,7 +292,7 @@ void multiOutBufferQueue::sendBuffer(int dest)
   DEBUGPR(100,ucout << "Sending buffer at " << buffer[dest] << 
 	  ", containing " << buffer[dest]->size() << " bytes to "
 	  << dest << ".\n");
-  bufferQ.send(buffer[dest],dest,tag);
+  bufferQ.send(buffer[dest],dest,sendTag);
 
   // Mark it empty.
 
@@ -289,7 +310,7 @@ void multiOutBufferQueue::flush()
 
   for(int dest=firstProc; dest!=noProcessor; )
     {
-      sendBuffer(dest);
+      sendBuffer(dest,tag);
       DEBUGPR(100,ucout << "Buffer sent to " << dest << ".\n");
       prevProc[dest] = noProcessor;
       int temp = nextProc[dest];
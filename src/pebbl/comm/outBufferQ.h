@@ -69,7 +69,8 @@ public:
       clear();
     }
 
-  // To get an empty buffer.  The buffer is now owned by the caller.
+  // To get an empty buffer, either one whose send has completed or
+  // one from bufferPool().  The buffer is now owned by the caller.
 
   PackBuffer* getFree();
 
@@ -166,7 +167,11 @@ class multiOutBufferQueue : public CommonIO
 
   // Call when you are done writing a segment, and you want *just*
   // this buffer to be sent immediately even if it is not full.
-  void sendOnly(int dest);
+  void sendOnly(int dest) { sendOnly(dest,tag); };
+
+  // The same, but send the buffer with sendTag rather than the
+  // queue's usual tag.
+  void sendOnly(int dest,int sendTag);
 
   // Call this when you want *all* (non-empty) buffers sent regardless of
   // whether they are full or not.
@@ -183,7 +188,7 @@ class multiOutBufferQueue : public CommonIO
   
  private:
 
-  void sendBuffer(int dest);
+  void sendBuffer(int dest,int sendTag);
 
   // These are essentially random medium-sized integers to help catch errors.
   enum { segmentSeparator = 5187, lastSegmentMarker = 21505 };
@@ -0,0 +1,147 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// clockBench.cpp
+//
+// Benchmark for the clocks used by the periodic checks of the search
+// loop.  First times a call to each of the exact and coarse clocks in
+// utilib/seconds.h, then solves a knapsack problem serially with
+// --coarseTiming=false (the exact clocks) and --coarseTiming=true, and
+// reports the subproblem rate of each.  The runs set CPU and wall
+// clock limits that are never reached, so every clock read by the
+// loop is exercised.  Both runs must bound the same number of
+// subproblems.
+//
+// Usage: clockBench <knapsack file> [reps] [calls]
+//
+
+#include <pebbl_config.h>
+#include <pebbl/utilib/seconds.h>
+#include <pebbl/example/serialKnapsack.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using namespace pebbl;
+using namespace std;
+
+
+namespace {
+
+// Nanoseconds per call of one clock
+
+double timeClock(double (*clock)(),int calls)
+{
+  double sum = 0;
+  double t0  = WallClockSeconds();
+  for (int i=0; i<calls; i++)
+    sum += clock();
+  double t1 = WallClockSeconds();
+  if (sum == 0)                   // Keep the loop from being optimized out
+    cout << "";
+  return 1e9*(t1 - t0)/calls;
+}
+
+
+// Solve the problem once, returning the wall clock time taken and
+// the number of subproblems bounded.
+
+double solveOnce(const char* filename,bool coarse,int& bounded)
+{
+  // The parameter parser edits argv in place, so it gets copies
+
+  vector<string> args;
+  args.push_back("clockBench");
+  args.push_back(coarse ? "--coarseTiming=true" : "--coarseTiming=false");
+  args.push_back("--maxCPUMinutes=100000");
+  args.push_back("--maxWallMinutes=100000");
+  args.push_back("--statusPrintCount=0");
+  args.push_back(filename);
+
+  vector<char*> argvStore;
+  for (size_t i=0; i<args.size(); i++)
+    argvStore.push_back(&args[i][0]);
+  argvStore.push_back(NULL);
+  int    argc = args.size();
+  char** argv = &argvStore[0];
+
+  binaryKnapsack instance;
+  if (!instance.setup(argc,argv))
+    exit(1);
+  instance.reset();
+
+  double t0 = WallClockSeconds();
+  instance.search();
+  double t1 = WallClockSeconds();
+
+  bounded = instance.subCount[pebblBase::beingBounded];
+  return t1 - t0;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+  InitializeTiming();
+
+  if (argc < 2)
+    {
+      cerr << "Usage: clockBench <knapsack file> [reps] [calls]" << endl;
+      return 1;
+    }
+
+  const char* filename = argv[1];
+  int reps  = (argc > 2) ? atoi(argv[2]) : 3;
+  int calls = (argc > 3) ? atoi(argv[3]) : 1000000;
+
+  cout << "Clock cost (nanoseconds per call, " << calls << " calls):"
+       << endl;
+  cout << setw(24) << "CPUSeconds"
+       << setw(10) << timeClock(CPUSeconds,calls) << endl;
+  cout << setw(24) << "WallClockSeconds"
+       << setw(10) << timeClock(WallClockSeconds,calls) << endl;
+  cout << setw(24) << "CoarseCPUSeconds"
+       << setw(10) << timeClock(CoarseCPUSeconds,calls) << endl;
+  cout << setw(24) << "CoarseWallClockSeconds"
+       << setw(10) << timeClock(CoarseWallClockSeconds,calls) << endl;
+
+  // Alternate the two settings and keep the best time of each, so
+  // both see the same machine conditions.
+
+  double best[2]    = { MAXDOUBLE, MAXDOUBLE };
+  int    bounded[2] = { 0, 0 };
+  for (int r=0; r<reps; r++)
+    for (int c=0; c<2; c++)
+      best[c] = min(best[c],solveOnce(filename,c == 1,bounded[c]));
+
+  cout << endl << "Search of " << filename << " (best of " << reps
+       << "):" << endl
+       << setw(24) << "clocks" << setw(12) << "bounded"
+       << setw(10) << "seconds" << setw(14) << "nodes/second" << endl;
+  const char* names[] = { "exact", "coarse" };
+  for (int c=0; c<2; c++)
+    cout << setw(24) << names[c] << setw(12) << bounded[c]
+	 << setw(10) << best[c]
+	 << setw(14) << (int) (bounded[c]/max(best[c],1e-9)) << endl;
+
+  if (bounded[0] != bounded[1])
+    {
+      cout << "ERROR: the runs bounded different numbers of subproblems"
+	   << endl;
+      return 1;
+    }
+
+  return 0;
+}
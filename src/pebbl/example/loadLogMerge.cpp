@@ -0,0 +1,174 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+//  loadLogMerge.cpp
+//
+//  Merges the per-processor binary load logs of a run (written with
+//  --loadLogBinary, see pebbl/bb/loadLogFile.h) into one file, in time
+//  order, with each processor's times shifted to the common clock.
+//  Only one block of each input is in memory at a time.  The output
+//  is a binary load log, or with --text the tab-separated text format
+//  that PEBBL writes without --loadLogBinary.
+//
+
+#include <pebbl_config.h>
+#include <pebbl/utilib/ParameterList.h>
+#include <pebbl/bb/loadLogFile.h>
+
+#include <fstream>
+#include <queue>
+#include <string>
+#include <vector>
+
+using namespace utilib;
+using namespace std;
+using pebbl::loadLogColumns;
+using pebbl::loadLogReader;
+using pebbl::loadLogWriter;
+
+
+// One input and its current row
+
+struct mergeInput
+{
+  mergeInput(const char* fileName) : reader(fileName) { };
+
+  bool advance() { return reader.next(row); };
+
+  loadLogReader reader;
+  double        row[loadLogColumns::count];
+};
+
+
+struct laterRow
+{
+  bool operator()(const mergeInput* a,const mergeInput* b) const
+  {
+    const int t = loadLogColumns::timeCol;
+    const int p = loadLogColumns::procCol;
+    if (a->row[t] != b->row[t])
+      return a->row[t] > b->row[t];
+    return a->row[p] > b->row[p];
+  }
+};
+
+
+void writeTextRow(ostream& os,const double* row)
+{
+  for (int c=0; c<loadLogColumns::count; c++)
+    {
+      if (c > 0)
+	os << '\t';
+      if (loadLogColumns::types[c] != 'd')
+	os << (long long) row[c];
+      else
+	os << row[c];
+    }
+  os << '\n';
+}
+
+
+// problem.loadLog.3.bin gives problem.loadLog.bin, or problem.loadLog
+// for text output
+
+string defaultOutputName(const string& input,bool text)
+{
+  string base = input;
+  size_t pos  = base.rfind(".loadLog.");
+  if (pos == string::npos)
+    base = "merged";
+  else
+    base.erase(pos);
+  base += ".loadLog";
+  if (!text)
+    base += ".bin";
+  return base;
+}
+
+
+int main(int argc,char** argv)
+{
+  utilib::exception_mngr::set_mode(utilib::exception_mngr::Abort);
+
+  string outputName;
+  bool   text = false;
+
+  ParameterSet params;
+  params.create_parameter("output",outputName,"<string>","",
+			  "Merged file (default: the input name without "
+			  "its processor number)");
+  params.create_parameter("text",text,"<bool>","false",
+			  "Write the merged log as text");
+
+  ParameterList plist;
+  plist.register_parameters(params);
+  plist.process_parameters(argc,argv,1);
+  params.set_parameters(plist,false);
+
+  if (params.get_parameter<bool>("help") || (argc < 2))
+    {
+      cout << "Usage: loadLogMerge {--parameter=value ...} "
+	   << "loadLog1 {loadLog2 ...}\n";
+      params.write_parameters(cout);
+      return -1;
+    }
+
+  if (outputName == "")
+    outputName = defaultOutputName(argv[1],text);
+
+  vector<mergeInput*> inputs;
+  priority_queue<mergeInput*,vector<mergeInput*>,laterRow> heap;
+  for (int i=1; i<argc; i++)
+    {
+      mergeInput* input = new mergeInput(argv[i]);
+      inputs.push_back(input);
+      if (input->advance())
+	heap.push(input);
+    }
+
+  ofstream*      textFile = 0;
+  loadLogWriter* binFile  = 0;
+  if (text)
+    textFile = new ofstream(outputName.c_str());
+  else
+    binFile  = new loadLogWriter(outputName);
+  if (text ? !*textFile : !binFile->good())
+    {
+      cerr << "Cannot open " << outputName << endl;
+      return 1;
+    }
+
+  long rows = 0;
+  while (!heap.empty())
+    {
+      mergeInput* input = heap.top();
+      heap.pop();
+      if (text)
+	writeTextRow(*textFile,input->row);
+      else
+	binFile->add(input->row);
+      rows++;
+      if (input->advance())
+	heap.push(input);
+    }
+
+  delete textFile;
+  delete binFile;
+  for (size_t i=0; i<inputs.size(); i++)
+    delete inputs[i];
+
+  cout << rows << " load log record" << (rows == 1 ? "" : "s")
+       << " from " << inputs.size() << " file"
+       << (inputs.size() == 1 ? "" : "s") << " written to "
+       << outputName << ".\n";
+
+  return 0;
+}
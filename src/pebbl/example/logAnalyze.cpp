@@ -18,6 +18,18 @@
 //
 //  Not the most elegant C++ ever written, but it's not part of the
 //  main library for PEBBL.
+//
+//  The logs may be text (val*.log) or binary (val*.vbin, see
+//  pebbl/bb/valLog.h), in any mix.  They are read as streams, in two
+//  passes that each use several threads.  The scan pass reads the
+//  files, a file per thread at a time, and deals each event out to a
+//  bucket by the subproblem it is about; each creation also sends a
+//  "child of" event to its parent's bucket.  Buckets go to scratch
+//  files.  The check pass then takes one bucket per thread, sorts it
+//  by subproblem, and checks each subproblem.  Only one bucket per
+//  thread is in memory at a time; the number of buckets is chosen from
+//  the sizes of the logs so that each fits in about memoryMB
+//  megabytes.
 
 // CAP: The proper way to modify this to do MIP-specific things is to
 // derive MIP-specific data structures and then have a separate
@@ -34,22 +46,30 @@
 #include <pebbl_config.h>
 #include <pebbl/utilib/math_basic.h>
 #include <pebbl/utilib/ParameterList.h>
-
-#if defined(NO_STRING_STREAM)
-#define ISSTREAM istrstream
-#define OSSTREAM ostrstream
-#else
-#define ISSTREAM std::istringstream
-#define OSSTREAM std::ostringstream
-#endif
+#include <pebbl/bb/valLog.h>
+#include <pebbl/misc/spillFile.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace utilib;
 using namespace std;
+using pebbl::valLogRecord;
+using pebbl::spillFile;
 
 int    minChildren=1;
 int    maxChildren=MAXINT;
 bool   testObjective=false;
 double trueObjective=0.0;
+int    numThreads=0;
+int    memoryMB=64;
+string tempDir;
 
 
 // If the validation logs were from MIP, they'll have some extra information
@@ -68,7 +88,7 @@ int printTreeDepth=5;
 
 //  Globals (ugh).  I never said it was elegant.
 
-int errorCount = 0;
+atomic<int> errorCount(0);
 int fathomRead = false;
 double sol     = 0;
 double sense   = 1;
@@ -79,6 +99,17 @@ double eqTol   = 1e-5;
 int processors = 0;
 int lowestPNWithSubproblems;
 
+vector<int> spCount;
+
+// Where error messages go; each thread of a pass collects its own.
+
+thread_local ostream* errors = &cerr;
+
+// Events sent to a parent's bucket when a child is made.  parentProc
+// and parentSerial hold the child's ID, and count is 1 for packchild.
+
+const int childOf = valLogRecord::numKinds;
+
 
 //  This class stores information about a subproblem.
 
@@ -113,14 +144,14 @@ public:
   double branchValue;
   int depth; // used to control tree size in output graph
 
-  void writeName(OSSTREAM& bufferStream, int this_p, int this_serial);
+  void writeName(ostringstream& bufferStream, int this_p, int this_serial);
 
   // end MIP-specific stuff
 
   spRecord();                 // Constructor.
 
   void check(int p,int s);    // Check internal consistency.
-  
+
 };
 
 
@@ -137,31 +168,34 @@ spRecord::spRecord()
   parentPN     = -1;
   parentSerial = -1;
 
+  creationBound = 0;
+  bound         = 0;
+  splitBound    = 0;
+
   children          = 0;
   childrenMade      = 0;
   childrenDestroyed = 0;
 
   destroyBound = -sense*MAXDOUBLE;
+
+  branchVariable = -1;
+  branchType     = no_branch;
+  branchValue    = 0;
+  depth          = 0;
 }
 
 
-void spRecord::writeName(OSSTREAM& bufferStream, int this_p, int this_serial)
+void spRecord::writeName(ostringstream& bufferStream,
+			 int this_p,
+			 int this_serial)
 {
   bufferStream << "[";
   if (processors > 1)
     bufferStream << this_p << ", ";
   bufferStream << this_serial<< "]\\nbound = " << bound << "\\n";
-  bufferStream << char(0);  //Terminate the string (especially since we reuse
-                            // the buffers
 }
 
 
-//  More globals...
-
-spRecord** sp = 0;
-int* spCount = 0;
-
-
 //  Global routines.
 
 const char* plural(int count,const char* suffix="s")
@@ -211,10 +245,10 @@ void countCheck(int count,
     }
   else
     return;
-  mistakeSP(cerr << diff << adjective << string << plural(diff,suffix),p,s);
-  cerr << "Count=" << count 
-       << ", target=[" << minVal << ',' << maxVal << "]\n";  // DBG
-  
+  mistakeSP(*errors << diff << adjective << string << plural(diff,suffix),p,s);
+  *errors << "Count=" << count
+	  << ", target=[" << minVal << ',' << maxVal << "]\n";  // DBG
+
 }
 
 
@@ -244,12 +278,12 @@ void sequenceCheck(double b1,
 		   int s)
 {
   if (!inSequence(b1,b2))
-    mistakeSP(cerr << name2 << ' ' << b2 << ' ' 
+    mistakeSP(*errors << name2 << ' ' << b2 << ' '
 	      << (sense==1 ? '<' : '>') << ' ' << name1 << ' ' << b1,
 	      p,s);
 }
 
-      
+
 int canFathom(double bound)
 {
   double absGap = (sol - bound)*sense;
@@ -262,406 +296,493 @@ int canFathom(double bound)
 }
 
 
-int root(int p, int s) 
-{ 
+int root(int p, int s)
+{
   return (p == lowestPNWithSubproblems) && (s == 1);
 }
 
 
-//  This base class reads through the logs and parses them.  Each
-//  pass of the analysis is implemented as a different derived class.
+int validID(int p,int s)
+{
+  return (p >= 0) && (p < processors) && (s > 0) && (s <= spCount[p]);
+}
+
+
+size_t numBuckets = 1;
 
-class readLog
+size_t bucketOf(int p,int s)
 {
-public:
+  uint64_t key = ((uint64_t) (uint32_t) p << 32) | (uint32_t) s;
+  return ((key*0x9E3779B97F4A7C15ULL) >> 32) % numBuckets;
+}
 
-  void execute(int argc,char** argv);
-
-  virtual void check() { };
-
-  virtual void createInfo(int /*packchild*/,
-			  double /*bound*/,
-			  int /*parentPN*/,
-			  int /*parentSerial*/,
-			  // for MIP only
-			  branch_type /*branchType*/,
-			  int /*depth*/) 
-    { }
-  virtual void packInfo() { };
-  virtual void boundInfo(double /*bound*/) { };
-  // The last two inputs are for MIP only
-  virtual void splitInfo(int /*nChildren*/,double /*bound*/, int /*branchVariable*/,
-			 double /*branchValue*/) { };
-  virtual void destroyInfo(int /*nChildren*/,double /*bound*/) { };
-  virtual void unpackInfo(int /*nChildren*/, branch_type /*branchType*/, int /*depth*/) { };
-			   
-  virtual void endOfPass() { };
 
-  int pn;
-  int serial;
+bool byID(const valLogRecord& a,const valLogRecord& b)
+{
+  if (a.proc != b.proc)
+    return a.proc < b.proc;
+  return a.serial < b.serial;
+}
 
-};
 
+//  Translate one line of a text log into a record.  Returns false for
+//  blank lines and lines that cannot be understood.
 
-void readLog::execute(int argc,char** argv)
+bool parseLine(const string& line,valLogRecord& r,const char* fileName)
 {
-  int fileCount = 0;
-  for(int arg=1; arg<argc; arg++)
+  if (line.empty() || (line[0] == '\0'))
+    return false;
+
+  istringstream lineStream(line);
+  string verb;
+  lineStream >> verb;
+  if (verb.empty())
+    return false;
+
+  r = valLogRecord();
+  if (verb == "fathoming")
     {
-      ifstream log;
-      log.open(argv[arg]);
-      if (!log)
-	{
-	  mistake(cerr << "Can't open file " << argv[arg]);
-	  if (*argv[arg] == '-') 
-	    cerr << "Option syntax is '--parameter=value' "
-		 << "(using two hyphens).\n";
-	  return;
-	}
-      fileCount++;
-      while(!log.eof())
-	{
-	  char verb[256];
-	  double bound       = nan("");   // Initializations to make clang happy
-          double branchValue = nan("");
-	  int nChildren      = -1; 
-          int branchVariable = -1;
-	  int branch_tmp     = -1;
-          int depth          = -1;
-
-#if defined(NO_STRING_STREAM)
-	  char line[2048];
-	  log.getline(line,255);
-	  if ((line[0] == '\0') && log.eof())
-	    break;
-	  istrstream lineStream(line,255);
-#else
-	  string line;
-	  getline(log, line);
-	  //log.getline(line.c_str(),255);
-	  if ((line[0] == '\0') && log.eof())
-	    break;
-	  istringstream lineStream(line);
-#endif
-	  lineStream >> verb;
-	  if (!strcmp(verb,"fathoming"))
-	    {
-	      lineStream >> sol >> sense >> relTol >> absTol;
-	      fathomRead = true;
-	    }
-	  else
-	    {
-	      lineStream >> pn >> serial;
-	      check();
-	      int packchild = !strcmp(verb,"packchild");
-	      if (packchild || !strcmp(verb,"create"))
-		{
-		  int parentPN;
-		  int parentSerial;
-		  lineStream >> bound >> parentPN >> parentSerial;
-		      
-		  // packed children will give branchtype on unpacking
-		  if (fromMIP && !packchild)
-		    lineStream >> branch_tmp >> depth;
-		  createInfo(packchild,
-			     bound,
-			     parentPN,
-			     parentSerial, 
-			     (branch_type) branch_tmp, 
-			     depth);
-		}
-	      else if (!strcmp(verb,"pack"))
-		packInfo();
-	      else if (!strcmp(verb,"bound"))
-		{
-		  lineStream >> bound;
-		  boundInfo(bound);
-		}
-	      else if (!strcmp(verb,"split"))
-		{
-		  lineStream >> nChildren >> bound;
-		  if (fromMIP)
-		    lineStream >> branchVariable >> branchValue;
-		  splitInfo(nChildren,bound, branchVariable, branchValue);
-		}
-	      else if (!strcmp(verb,"destroy"))
-		{
-		  lineStream >> nChildren >> bound;
-		  destroyInfo(nChildren,bound);
-		}
-	      else if (!strcmp(verb,"unpack"))
-		{
-		  lineStream >> nChildren;
-		  if (fromMIP)
-		    lineStream >> branch_tmp >> depth;
-		  unpackInfo(nChildren, (branch_type)branch_tmp, depth);
-		}
-	      else
-		mistake(cerr << "Unrecognized event '" 
-			<< verb << "' in log file " << argv[arg]);
-	    }
-	}
+      double s = 1;
+      lineStream >> r.bound >> s >> r.extraDouble[0] >> r.extraDouble[1];
+      r.kind  = valLogRecord::fathoming;
+      r.count = (int) s;
+      return true;
     }
 
-  if (fileCount == 0)
-    mistake(cerr << "Arguments should contain at least one "
-	    << "log file or '--help'");
+  lineStream >> r.proc >> r.serial;
+  r.extraInt[0] = -1;
+  r.extraInt[1] = -1;
+  int packchild = (verb == "packchild");
+  if (packchild || (verb == "create"))
+    {
+      r.kind = packchild ? valLogRecord::packChild : valLogRecord::create;
+      lineStream >> r.bound >> r.parentProc >> r.parentSerial;
+      // packed children will give branchtype on unpacking
+      if (fromMIP && !packchild)
+	lineStream >> r.extraInt[0] >> r.extraInt[1];
+    }
+  else if (verb == "pack")
+    r.kind = valLogRecord::pack;
+  else if (verb == "bound")
+    {
+      r.kind = valLogRecord::bounding;
+      lineStream >> r.bound;
+    }
+  else if (verb == "split")
+    {
+      r.kind = valLogRecord::split;
+      lineStream >> r.count >> r.bound;
+      if (fromMIP)
+	lineStream >> r.extraInt[0] >> r.extraDouble[0];
+    }
+  else if (verb == "destroy")
+    {
+      r.kind = valLogRecord::destroy;
+      lineStream >> r.count >> r.bound;
+    }
+  else if (verb == "unpack")
+    {
+      r.kind = valLogRecord::unpack;
+      lineStream >> r.count;
+      if (fromMIP)
+	lineStream >> r.extraInt[0] >> r.extraInt[1];
+    }
   else
-    endOfPass();
-
+    {
+      mistake(*errors << "Unrecognized event '"
+	      << verb << "' in log file " << fileName);
+      return false;
+    }
+  return true;
 }
 
 
-//  The first pass just figures out how many processors there are,
-//  and barfs at any illegal processor codes.
-		  
-class pass1object : public readLog
+//  The scan pass.  Each thread has one of these, which reads whole
+//  files and writes their events to its own scratch file, in runs of
+//  up to chunkRecords events of the same bucket.
+
+class logScanner
 {
 public:
 
-  void check()
-    {
-      if (pn < 0)
-	mistake(cerr << "Processor number " << pn << " is illegal");
-      else if (pn >= processors)
-	processors = pn + 1;
-    };
+  logScanner(size_t chunkRecords_) :
+    fathomRead(false),
+    sol(0),
+    sense(1),
+    relTol(1e-7),
+    absTol(0),
+    lowestPN(MAXINT),
+    spill(tempDir),
+    chunkRecords(chunkRecords_),
+    buffers(numBuckets),
+    runs(numBuckets)
+  { };
 
-  void endOfPass()
-    {
-      cout << processors << " processor" << plural(processors) << ".\n";
-      if (processors == 0)
-	mistake(cerr << "Input appears to be empty");
-      else if (!fathomRead) 
-	{
-	  cout << "Solution value is unknown.\n";
-	  mistake(cerr << "No information on solution or fathoming criteria");
-	}
-      else
-	{
-	  cout << "Solution value is " << sol << ".\n";
-	  if (testObjective && tooDifferent(sol,trueObjective))
-	    mistake(cerr << "Incorrect objective: obtained " << sol
-		    << " instead of correct value of " << trueObjective);
-	  sp = new spRecord*[processors];
-	  spCount = new int[processors];
-	  for (pn = 0; pn < processors; pn++)
-	    spCount[pn] = 0;
-	}
-    };
-};
+  void scanFile(const char* fileName);
 
+  void finish();
 
-//  The second pass figures out how many subproblems happened on each
-//  processor.
+  // Append bucket b's events to recs, and free their space.
 
-class pass2object : public readLog
-{
-public:
-  
-  void check()
-    {
-      if (serial <= 0)
-	mistake(cerr << "Invalid subproblem ID " << pn << ':' << serial);
-      else if (serial > spCount[pn])
-	spCount[pn] = serial;
-      if (pn < lowestPNWithSubproblems)
-	lowestPNWithSubproblems = pn;
-    };
-
-  void endOfPass()
-    {
-      int totalSPs = 0;
-      for (pn = 0; pn < processors; pn++)
-	{
-	  totalSPs += spCount[pn];
-	  sp[pn] = new spRecord[spCount[pn] + 1];
-	  if (sp[pn] == 0)
-	    {
-	      mistake(cerr << "Ran out of memory at " << totalSPs 
-		      << " subproblems");
-	      return;
-	    }
-	}
-      cout << totalSPs << " subproblem" << plural(totalSPs) << ".\n";
-    };
-};
+  void readBucket(size_t b,vector<valLogRecord>& recs);
 
+  ostringstream errorText;
 
-//  Pass 3 does most of the real work.
+  bool   fathomRead;
+  double sol;
+  double sense;
+  double relTol;
+  double absTol;
 
-class pass3object : public readLog
-{
-public:
-  
-  void createInfo(int packchild,
-		  double bound,
-		  int parentPN,
-		  int parentSerial, 
-		  branch_type branchType, 
-		  int depth);
+  int         lowestPN;
+  vector<int> spCount;
+
+protected:
 
-  void packInfo();
+  spillFile spill;
+  mutex     spillMutex;
 
-  void boundInfo(double bound);
+  size_t chunkRecords;
 
-  void splitInfo(int nChildren,
-		 double bound, 
-		 int branchVariable,
-		 double branchValue);
+  vector<vector<valLogRecord> > buffers;
 
-  void destroyInfo(int nChildren,double bound);
+  // Offsets and lengths, in records, of runs in the scratch file
+  vector<vector<pair<size_t,size_t> > > runs;
 
-  void unpackInfo(int nChildren, branch_type branchType, int depth);
+  void add(const valLogRecord& r,const char* fileName);
+  void addToBucket(const valLogRecord& r,size_t b);
+  void flush(size_t b);
+};
 
-  void endOfPass();
 
-  int validID(int p,int s)
+void logScanner::scanFile(const char* fileName)
+{
+  ifstream log(fileName,ios::in | ios::binary);
+  if (!log)
     {
-      return (p >= 0) && (p < processors) && (s > 0) && (s <= spCount[p]);
-    };
+      mistake(*errors << "Can't open file " << fileName);
+      if (*fileName == '-')
+	*errors << "Option syntax is '--parameter=value' "
+		<< "(using two hyphens).\n";
+      return;
+    }
 
-};
+  valLogRecord r;
+  log.read((char*) &r,sizeof(valLogRecord));
+  if ((log.gcount() == sizeof(valLogRecord)) && r.isHeader())
+    {
+      if (r.count != sizeof(valLogRecord))
+	{
+	  mistake(*errors << "Log file " << fileName << " has " << r.count
+		  << "-byte records, not " << sizeof(valLogRecord));
+	  return;
+	}
+      vector<valLogRecord> block(4096);
+      while (log)
+	{
+	  log.read((char*) &block[0],block.size()*sizeof(valLogRecord));
+	  size_t bytes = log.gcount();
+	  for (size_t i=0; i<bytes/sizeof(valLogRecord); i++)
+	    if (!block[i].isHeader())
+	      add(block[i],fileName);
+	  if (bytes % sizeof(valLogRecord) != 0)
+	    mistake(*errors << "Log file " << fileName << " ends with a "
+		    << "partial record");
+	}
+      return;
+    }
+
+  log.clear();
+  log.seekg(0);
+  string line;
+  while (getline(log,line))
+    if (parseLine(line,r,fileName))
+      add(r,fileName);
+}
 
 
-void pass3object::createInfo(int packchild,
-			     double bound,
-			     int parentPN,
-			     int parentSerial,
-			     branch_type branchType,
-			     int depth)
+void logScanner::add(const valLogRecord& r,const char* fileName)
 {
-  if (packchild)
-    sp[pn][serial].packedChild++;
-  else
+  if ((r.kind <= valLogRecord::header) || (r.kind >= valLogRecord::numKinds))
     {
-    sp[pn][serial].created++;
-    sp[pn][serial].branchType = branchType;
-    sp[pn][serial].depth = depth;
+      mistake(*errors << "Unrecognized event " << r.kind
+	      << " in log file " << fileName);
+      return;
     }
-  sp[pn][serial].creationBound = bound;
-  if (!packchild && root(pn,serial))
-    return;
-  if (!validID(parentPN,parentSerial))
-    mistakeSP(cerr << "Invalid parent " << parentPN << ':' << parentSerial,
-	      pn,serial);
-  else
+  if (r.kind == valLogRecord::fathoming)
+    {
+      sol    = r.bound;
+      sense  = r.count;
+      relTol = r.extraDouble[0];
+      absTol = r.extraDouble[1];
+      fathomRead = true;
+      return;
+    }
+  if (r.proc < 0)
+    {
+      mistake(*errors << "Processor number " << r.proc << " is illegal");
+      return;
+    }
+  if (r.serial <= 0)
     {
-      sp[parentPN][parentSerial].childrenMade++;
-      sp[pn][serial].parentPN = parentPN;
-      sp[pn][serial].parentSerial = parentSerial;
+      mistake(*errors << "Invalid subproblem ID " << r.proc << ':'
+	      << r.serial);
+      return;
+    }
+
+  if (r.proc >= (int) spCount.size())
+    spCount.resize(r.proc + 1,0);
+  spCount[r.proc] = max(spCount[r.proc],(int) r.serial);
+  lowestPN = min(lowestPN,(int) r.proc);
+
+  addToBucket(r,bucketOf(r.proc,r.serial));
+
+  if (((r.kind == valLogRecord::create) ||
+       (r.kind == valLogRecord::packChild)) &&
+      (r.parentProc >= 0) && (r.parentSerial > 0))
+    {
+      valLogRecord c;
+      c.kind         = childOf;
+      c.proc         = r.parentProc;
+      c.serial       = r.parentSerial;
+      c.parentProc   = r.proc;
+      c.parentSerial = r.serial;
+      c.count        = (r.kind == valLogRecord::packChild);
+      c.bound        = r.bound;
+      addToBucket(c,bucketOf(c.proc,c.serial));
     }
 }
 
 
-void pass3object::packInfo()
+void logScanner::addToBucket(const valLogRecord& r,size_t b)
 {
-  sp[pn][serial].packed++;
+  buffers[b].push_back(r);
+  if (buffers[b].size() >= chunkRecords)
+    flush(b);
 }
 
 
-void pass3object::boundInfo(double bound)
+void logScanner::flush(size_t b)
 {
-  sp[pn][serial].bounded++;
-  sp[pn][serial].bound = bound;
+  size_t n = buffers[b].size();
+  if (n == 0)
+    return;
+  size_t offset = spill.allocate(n*sizeof(valLogRecord));
+  spill.write(offset,(const char*) &buffers[b][0],n*sizeof(valLogRecord));
+  runs[b].push_back(make_pair(offset,n));
+  buffers[b].clear();
 }
 
 
-void pass3object::splitInfo(int nChildren,double bound, int branchVariable,
-			    double branchValue)
+void logScanner::finish()
 {
-  sp[pn][serial].split++;
-  sp[pn][serial].children = nChildren;
-  sp[pn][serial].splitBound = bound;
-  sp[pn][serial].branchVariable = branchVariable;
-  sp[pn][serial].branchValue = branchValue;
+  for (size_t b=0; b<numBuckets; b++)
+    {
+      flush(b);
+      vector<valLogRecord>().swap(buffers[b]);
+    }
 }
 
 
-void pass3object::destroyInfo(int nChildren,double bound)
+void logScanner::readBucket(size_t b,vector<valLogRecord>& recs)
 {
-  sp[pn][serial].destroyed++;
-  sp[pn][serial].childrenDestroyed += nChildren;
-  if (sense*(sp[pn][serial].destroyBound - bound) < 0)
-    sp[pn][serial].destroyBound = bound;
+  lock_guard<mutex> lock(spillMutex);
+  for (size_t i=0; i<runs[b].size(); i++)
+    {
+      size_t offset = runs[b][i].first;
+      size_t n      = runs[b][i].second;
+      size_t start  = recs.size();
+      recs.resize(start + n);
+      spill.read(offset,(char*) &recs[start],n*sizeof(valLogRecord));
+      spill.release(offset,n*sizeof(valLogRecord));
+    }
+  runs[b].clear();
 }
 
 
-void pass3object::unpackInfo(int nChildren, branch_type branchType, int depth)
+//  Nodes for the picture of the top of the tree
+
+struct dotNode
 {
-  sp[pn][serial].unpacked++;
-  sp[pn][serial].childrenDestroyed -= nChildren;
-  sp[pn][serial].branchType = branchType;
-  sp[pn][serial].depth = depth;
-}
+  int pn;
+  int serial;
+  spRecord sp;
+};
 
 
-void pass3object::endOfPass()
+//  The check pass.  One bucket's events are sorted by subproblem, so
+//  that each subproblem's events, and the "child of" events from its
+//  children, are together.
+
+void checkBucket(size_t b,
+		 vector<logScanner*>& scanners,
+		 vector<dotNode>& dots)
 {
-  ofstream graphFile("tree.dot");  // open with default modes
+  vector<valLogRecord> recs;
+  for (size_t t=0; t<scanners.size(); t++)
+    scanners[t]->readBucket(b,recs);
+  stable_sort(recs.begin(),recs.end(),byID);
 
-#if defined(NO_STRING_STREAM)
-  // For file output.  512 is the max size of a node label
-  char *nameBuffer = new char[512];
-  ostrstream nameStream(nameBuffer, 512);
-  char *nameBuffer2 = new char[512];
-  ostrstream nameStream2(nameBuffer2, 512);
-#else
-  string nameBuffer;
-  ostringstream nameStream(nameBuffer);
-  string nameBuffer2;
-  ostringstream nameStream2(nameBuffer2);
-#endif
-  // To keep node labels small.  Change this if you want more precision
-  nameStream.precision(5);
- 
-  nameStream2.precision(5);
+  size_t i = 0;
+  while (i < recs.size())
+    {
+      int pn     = recs[i].proc;
+      int serial = recs[i].serial;
+      size_t end = i;
+      while ((end < recs.size()) &&
+	     (recs[end].proc == pn) && (recs[end].serial == serial))
+	end++;
 
-  spRecord *parent;
+      // A parent that does not exist; the child reports it
 
-  if (makeDot)
-    graphFile << "digraph treeGraph {\n";
-  for(pn = 0; pn < processors; pn++)
-    for(serial = 1; serial <= spCount[pn]; serial++)
-      {
-	spRecord* p = &(sp[pn][serial]);
-	p->check(pn,serial);
-	if (!root(pn,serial) && 
-	    (p->created + p->packedChild > 0) &&
-	    validID(p->parentPN,p->parentSerial))
-	  sequenceCheck(sp[p->parentPN][p->parentSerial].splitBound,
-			p->creationBound,
-			"parent bound",
-			"Creation bound",
-			pn,serial);
- // output edge from parent to this processor
-	if (makeDot && !root(pn,serial) && p->depth <= printTreeDepth)
-	  {
-	  parent = &sp[p->parentPN][p->parentSerial];
-	  nameStream.seekp(ios::beg); //reuse from the beginning
-	  nameStream2.seekp(ios::beg); //reuse from the beginning
-	  parent->writeName(nameStream, p->parentPN, p->parentSerial);
-	  p->writeName(nameStream2, pn, serial);
-	  graphFile << "\"" << nameBuffer << "\" -> \"" << nameBuffer2 << "\" [label=\"";
-	  // Now Edge label, of form branchVariable <= (or >=) val
-	  graphFile << "var " << parent->branchVariable;
-	  if (p->branchType == branch_up)
-	    graphFile << " >= " << ceil(p->branchValue) << "\"];\n";
-	  else graphFile << " <= " << floor(p->branchValue) << "\"]\n;";
-	  }
-      }
-  if (makeDot) graphFile << "size = \"12,14\";\n}\n";
+      if (!validID(pn,serial))
+	{
+	  i = end;
+	  continue;
+	}
 
+      spRecord p;
+      for (size_t k=i; k<end; k++)
+	{
+	  const valLogRecord& r = recs[k];
+	  switch (r.kind)
+	    {
+	    case valLogRecord::create:
+	    case valLogRecord::packChild:
+	      {
+		int packchild = (r.kind == valLogRecord::packChild);
+		if (packchild)
+		  p.packedChild++;
+		else
+		  {
+		    p.created++;
+		    p.branchType = (branch_type) r.extraInt[0];
+		    p.depth      = r.extraInt[1];
+		  }
+		p.creationBound = r.bound;
+		if (!packchild && root(pn,serial))
+		  break;
+		if (!validID(r.parentProc,r.parentSerial))
+		  mistakeSP(*errors << "Invalid parent " << r.parentProc
+			    << ':' << r.parentSerial,pn,serial);
+		else
+		  {
+		    p.parentPN     = r.parentProc;
+		    p.parentSerial = r.parentSerial;
+		  }
+		break;
+	      }
+	    case valLogRecord::pack:
+	      p.packed++;
+	      break;
+	    case valLogRecord::bounding:
+	      p.bounded++;
+	      p.bound = r.bound;
+	      break;
+	    case valLogRecord::split:
+	      p.split++;
+	      p.children       = r.count;
+	      p.splitBound     = r.bound;
+	      p.branchVariable = r.extraInt[0];
+	      p.branchValue    = r.extraDouble[0];
+	      break;
+	    case valLogRecord::destroy:
+	      p.destroyed++;
+	      p.childrenDestroyed += r.count;
+	      if (sense*(p.destroyBound - r.bound) < 0)
+		p.destroyBound = r.bound;
+	      break;
+	    case valLogRecord::unpack:
+	      p.unpacked++;
+	      p.childrenDestroyed -= r.count;
+	      p.branchType = (branch_type) r.extraInt[0];
+	      p.depth      = r.extraInt[1];
+	      break;
+	    case childOf:
+	      if (r.count || !root(r.parentProc,r.parentSerial))
+		p.childrenMade++;
+	      break;
+	    }
+	}
+
+      p.check(pn,serial);
+
+      // Children's creation bounds against this splitting bound
+
+      if (p.created + p.packedChild > 0)
+	for (size_t k=i; k<end; k++)
+	  if ((recs[k].kind == childOf) &&
+	      (recs[k].count || !root(recs[k].parentProc,recs[k].parentSerial)))
+	    sequenceCheck(p.splitBound,
+			  recs[k].bound,
+			  "parent bound",
+			  "Creation bound",
+			  recs[k].parentProc,
+			  recs[k].parentSerial);
+
+      if (makeDot && (p.depth <= printTreeDepth))
+	{
+	  dotNode node;
+	  node.pn     = pn;
+	  node.serial = serial;
+	  node.sp     = p;
+	  dots.push_back(node);
+	}
+
+      i = end;
+    }
+}
+
+
+//  Output the top of the tree for dot.
+
+void writeDot(vector<dotNode>& dots)
+{
+  ofstream graphFile("tree.dot");  // open with default modes
+
+  map<pair<int,int>,size_t> where;
+  for (size_t i=0; i<dots.size(); i++)
+    where[make_pair(dots[i].pn,dots[i].serial)] = i;
+
+  // To keep node labels small.  Change this if you want more precision
+  graphFile << "digraph treeGraph {\n";
+  map<pair<int,int>,size_t>::iterator it;
+  for (it = where.begin(); it != where.end(); it++)
+    {
+      dotNode& node = dots[it->second];
+      spRecord* p = &node.sp;
+      if (root(node.pn,node.serial))
+	continue;
+      map<pair<int,int>,size_t>::iterator parentIt =
+	where.find(make_pair(p->parentPN,p->parentSerial));
+      if (parentIt == where.end())
+	continue;
+      spRecord* parent = &(dots[parentIt->second].sp);
+      ostringstream nameStream;
+      ostringstream nameStream2;
+      nameStream.precision(5);
+      nameStream2.precision(5);
+      parent->writeName(nameStream, p->parentPN, p->parentSerial);
+      p->writeName(nameStream2, node.pn, node.serial);
+      graphFile << "\"" << nameStream.str() << "\" -> \""
+		<< nameStream2.str() << "\" [label=\"";
+      // Now Edge label, of form branchVariable <= (or >=) val
+      graphFile << "var " << parent->branchVariable;
+      if (p->branchType == branch_up)
+	graphFile << " >= " << ceil(p->branchValue) << "\"];\n";
+      else graphFile << " <= " << floor(p->branchValue) << "\"]\n;";
+    }
+  graphFile << "size = \"12,14\";\n}\n";
 }
 
 
 void spRecord::check(int p,int s)
 {
-  // When doing a "reconfigure" restart from a checkpoint, 
+  // When doing a "reconfigure" restart from a checkpoint,
   // certain subproblem ID's may be skipped completely.
   // Detect completely skipped ID's and don't check them.
 
-  if ((created == 0) && (packedChild==0) && (packed==0) && (bounded == 0) && 
+  if ((created == 0) && (packedChild==0) && (packed==0) && (bounded == 0) &&
       (split==0) && (destroyed==0) && (unpacked==0))
     return;
 
@@ -678,9 +799,9 @@ void spRecord::check(int p,int s)
 
   if (!split)
     splitBound = bound;
-  else 
+  else
     sequenceCheck(bound,splitBound,"bound","Splitting bound",p,s);
-  
+
   if (!destroyed)
     destroyBound = splitBound;
   else
@@ -693,9 +814,9 @@ void spRecord::check(int p,int s)
     countCheck(split,!canFathom(bound),1,"split operation",p,s);
 
   if (split && !canFathom(splitBound) && (children < minChildren))
-    mistakeSP(cerr << "Split operation produced too few children",p,s);
+    mistakeSP(*errors << "Split operation produced too few children",p,s);
   if (split && (children > maxChildren))
-    mistakeSP(cerr << "Split operation produced too many children",p,s);
+    mistakeSP(*errors << "Split operation produced too many children",p,s);
   countCheck(childrenDestroyed,0,canFathom(destroyBound)*children,
 	     "destroyed child",p,s,"ren");
   int childrenToMake = children - childrenDestroyed;
@@ -722,6 +843,149 @@ void dumpArgs(char* notation,int argc,char** argv)
 #endif
 
 
+//  Run the scan pass over the files, then the check pass over the
+//  buckets.
+
+void analyze(int argc,char** argv)
+{
+  if (argc < 2)
+    {
+      mistake(cerr << "Arguments should contain at least one "
+	      << "log file or '--help'");
+      return;
+    }
+
+  // Enough buckets that each fits in memoryMB, guessing 32 bytes per
+  // line of text logs and allowing for the "child of" events
+
+  double estimate = 0;
+  for (int arg=1; arg<argc; arg++)
+    {
+      ifstream log(argv[arg],ios::in | ios::binary);
+      if (!log)
+	continue;
+      valLogRecord r;
+      log.read((char*) &r,sizeof(valLogRecord));
+      bool binary = (log.gcount() == sizeof(valLogRecord)) && r.isHeader();
+      log.clear();
+      log.seekg(0,ios::end);
+      double bytes = (double) log.tellg();
+      estimate += 1.5*sizeof(valLogRecord)*
+	bytes/(binary ? sizeof(valLogRecord) : 32.0);
+    }
+  double bucketBytes = max(memoryMB,1)*1048576.0;
+  numBuckets = (size_t) min(65536.0,max(1.0,ceil(estimate/bucketBytes)));
+
+  int threads = numThreads;
+  if (threads <= 0)
+    threads = max(1,(int) thread::hardware_concurrency());
+
+  // Each scanner holds a chunk per bucket at a time
+
+  size_t chunkRecords = bucketBytes/(4*numBuckets*sizeof(valLogRecord));
+  chunkRecords = max((size_t) 256,min((size_t) 4096,chunkRecords));
+
+  // Scan pass
+
+  int scanThreads = min(threads,argc - 1);
+  vector<logScanner*> scanners(scanThreads);
+  for (int t=0; t<scanThreads; t++)
+    scanners[t] = new logScanner(chunkRecords);
+  atomic<int> nextFile(1);
+  vector<thread> workers;
+  for (int t=0; t<scanThreads; t++)
+    workers.push_back(thread([&,t]()
+      {
+	errors = &(scanners[t]->errorText);
+	for (int arg = nextFile++; arg < argc; arg = nextFile++)
+	  scanners[t]->scanFile(argv[arg]);
+	scanners[t]->finish();
+      }));
+  for (int t=0; t<scanThreads; t++)
+    workers[t].join();
+  workers.clear();
+
+  // Combine what the scanners found
+
+  lowestPNWithSubproblems = MAXINT;
+  for (int t=0; t<scanThreads; t++)
+    {
+      logScanner* s = scanners[t];
+      cerr << s->errorText.str();
+      if (s->fathomRead)
+	{
+	  fathomRead = true;
+	  sol    = s->sol;
+	  sense  = s->sense;
+	  relTol = s->relTol;
+	  absTol = s->absTol;
+	}
+      if (s->spCount.size() > spCount.size())
+	spCount.resize(s->spCount.size(),0);
+      for (size_t p=0; p<s->spCount.size(); p++)
+	spCount[p] = max(spCount[p],s->spCount[p]);
+      lowestPNWithSubproblems = min(lowestPNWithSubproblems,s->lowestPN);
+    }
+  processors = spCount.size();
+
+  cout << processors << " processor" << plural(processors) << ".\n";
+  if (processors == 0)
+    mistake(cerr << "Input appears to be empty");
+  else if (!fathomRead)
+    {
+      cout << "Solution value is unknown.\n";
+      mistake(cerr << "No information on solution or fathoming criteria");
+    }
+  else
+    {
+      cout << "Solution value is " << sol << ".\n";
+      if (testObjective && tooDifferent(sol,trueObjective))
+	mistake(cerr << "Incorrect objective: obtained " << sol
+		<< " instead of correct value of " << trueObjective);
+    }
+
+  if (errorCount == 0)
+    {
+      size_t totalSPs = 0;
+      for (int p=0; p<processors; p++)
+	totalSPs += spCount[p];
+      cout << totalSPs << " subproblem" << plural(totalSPs) << ".\n";
+
+      // Check pass; errors are printed in bucket order
+
+      vector<string>          bucketErrors(numBuckets);
+      vector<vector<dotNode> > dots(threads);
+      atomic<size_t> nextBucket(0);
+      for (int t=0; t<threads; t++)
+	workers.push_back(thread([&,t]()
+	  {
+	    for (size_t b = nextBucket++; b < numBuckets; b = nextBucket++)
+	      {
+		ostringstream text;
+		errors = &text;
+		checkBucket(b,scanners,dots[t]);
+		bucketErrors[b] = text.str();
+	      }
+	  }));
+      for (int t=0; t<threads; t++)
+	workers[t].join();
+      for (size_t b=0; b<numBuckets; b++)
+	cerr << bucketErrors[b];
+
+      if (makeDot)
+	{
+	  vector<dotNode> allDots;
+	  for (int t=0; t<threads; t++)
+	    allDots.insert(allDots.end(),dots[t].begin(),dots[t].end());
+	  writeDot(allDots);
+	}
+    }
+
+  for (int t=0; t<scanThreads; t++)
+    delete scanners[t];
+}
+
+
 //  This thing runs it all.
 
 int main(int argc,char** argv)
@@ -746,6 +1010,17 @@ int main(int argc,char** argv)
   params.create_parameter("printTreeDepth",printTreeDepth,"<int>","5",
 			  "Depth of tree picture",
 			  ParameterBounds<int>(0,1000));
+  params.create_parameter("threads",numThreads,"<int>","0",
+			  "Threads for reading and checking logs "
+			  "(0 for one per core)",
+			  ParameterNonnegative<int>());
+  params.create_parameter("memoryMB",memoryMB,"<int>","64",
+			  "Approximate memory per thread for checking; "
+			  "larger logs are checked in pieces",
+			  ParameterPositive<int>());
+  params.create_parameter("tempDir",tempDir,"<string>","",
+			  "Directory for scratch files (default: TMPDIR "
+			  "or /tmp)");
 
   ParameterList plist;
   plist.register_parameters(params);
@@ -754,7 +1029,7 @@ int main(int argc,char** argv)
   // dumpArgs("After process_parameters",argc,argv);
   params.set_parameters(plist,false);
 
-  if (params.get_parameter<bool>("help")) 
+  if (params.get_parameter<bool>("help"))
     {
       cout << "Usage: logAnalyze {--parameter=value ...} "
 	   << "logfile1 {logfile2 ...}\n";
@@ -764,19 +1039,7 @@ int main(int argc,char** argv)
 
   testObjective = params.parameter_initialized("trueObjective");
 
-  pass1object pass1;
-  pass1.execute(argc,argv);
-  if (errorCount == 0)
-    {
-      lowestPNWithSubproblems = processors;
-      pass2object pass2;
-      pass2.execute(argc,argv);
-      if (errorCount == 0)
-	{
-	  pass3object pass3;
-	  pass3.execute(argc,argv);
-	}
-    }
+  analyze(argc,argv);
 
   if (errorCount == 0)
     cout << "No";
@@ -787,4 +1050,3 @@ int main(int argc,char** argv)
   return errorCount;
 
 }
-
@@ -0,0 +1,259 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// packBench.cpp
+//
+// Microbenchmark for PackBuffer and UnPackBuffer.  Collects subproblems
+// of a knapsack and a monomial problem by bounding and splitting
+// breadth-first from the root.  Each subproblem is packed into a reused
+// PackBuffer, the way subproblems are packed for sending, and then
+// unpacked into a blank subproblem.  Reports bytes per second and
+// nanoseconds per subproblem for packing and for unpacking.  In an MPI
+// build this is done both with byte copies and with MPI_Pack (see
+// PackBuffer::use_mpi_pack).  Every unpacked subproblem must pack to
+// the same bytes as the original.
+//
+// Usage: packBench <knapsack file> <monomial file> [count] [reps]
+//
+
+#include <pebbl_config.h>
+#include <pebbl/utilib/seconds.h>
+#include <pebbl/utilib/PackBuf.h>
+#include <pebbl/example/serialKnapsack.h>
+#include <pebbl/example/serialMonomial.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using namespace pebbl;
+using namespace std;
+
+
+namespace {
+
+// Set up and preprocess a serial instance from a file name
+
+bool setupInstance(branching& instance,const char* filename)
+{
+  // The parameter parser edits argv in place, so it gets copies
+
+  vector<string> args;
+  args.push_back("packBench");
+  args.push_back(filename);
+
+  vector<char*> argvStore;
+  for (size_t i=0; i<args.size(); i++)
+    argvStore.push_back(&args[i][0]);
+  argvStore.push_back(NULL);
+  int    argc = args.size();
+  char** argv = &argvStore[0];
+
+  if (!instance.setup(argc,argv))
+    return false;
+  instance.reset();
+  instance.preprocess();
+  return true;
+}
+
+
+// Bound and split breadth-first from the root until count subproblems
+// that are still alive have been collected.
+
+void collect(branching& instance,vector<branchSub*>& sps,size_t count)
+{
+  deque<branchSub*> queue;
+  queue.push_back(instance.makeRoot());
+  while (!queue.empty() && (sps.size() < count))
+    {
+      branchSub* p = queue.front();
+      queue.pop_front();
+      p->computeBound();
+      if ((p->state == pebblBase::bounded) && !p->canFathom())
+	p->splitProblem();
+      if ((p->state != pebblBase::separated) || p->canFathom())
+	{
+	  p->recycle();
+	  continue;
+	}
+      sps.push_back(p);
+      while (p->childrenLeft > 0)
+	queue.push_back(p->child());
+    }
+  for (size_t i=0; i<queue.size(); i++)
+    queue[i]->recycle();
+}
+
+
+// Results of one packing mode
+
+struct packStats
+{
+  packStats() : bytes(0), packSeconds(MAXDOUBLE), unpackSeconds(MAXDOUBLE),
+		matched(true) { };
+
+  double bytes;
+  double packSeconds;
+  double unpackSeconds;
+  bool   matched;
+};
+
+
+// Pack and unpack every subproblem reps times, keeping the best time
+// of each.
+
+packStats timeMode(branching& instance,vector<branchSub*>& sps,int reps)
+{
+  packStats stats;
+  size_t n = sps.size();
+  PackBuffer buf;
+
+  vector<vector<char> > packed(n);
+  for (size_t i=0; i<n; i++)
+    {
+      buf.reset();
+      sps[i]->packSubproblem(buf);
+      packed[i].assign(buf.buf(),buf.buf() + buf.size());
+      stats.bytes += buf.size();
+    }
+
+  for (int r=0; r<reps; r++)
+    {
+      double t0 = WallClockSeconds();
+      for (size_t i=0; i<n; i++)
+	{
+	  buf.reset();
+	  sps[i]->packSubproblem(buf);
+	}
+      double t1 = WallClockSeconds();
+      stats.packSeconds = min(stats.packSeconds,t1 - t0);
+
+      vector<branchSub*> blanks(n);
+      for (size_t i=0; i<n; i++)
+	blanks[i] = instance.blankSub();
+
+      t0 = WallClockSeconds();
+      for (size_t i=0; i<n; i++)
+	{
+	  UnPackBuffer inBuf(&packed[i][0],packed[i].size());
+	  blanks[i]->unpackSubproblem(inBuf);
+	}
+      t1 = WallClockSeconds();
+      stats.unpackSeconds = min(stats.unpackSeconds,t1 - t0);
+
+      for (size_t i=0; i<n; i++)
+	{
+	  buf.reset();
+	  blanks[i]->packSubproblem(buf);
+	  if ((buf.size() != packed[i].size()) ||
+	      (memcmp(buf.buf(),&packed[i][0],buf.size()) != 0))
+	    stats.matched = false;
+	  blanks[i]->recycle();
+	}
+    }
+
+  return stats;
+}
+
+
+bool runProblem(const char* name,branching& instance,size_t count,int reps)
+{
+  vector<branchSub*> sps;
+  collect(instance,sps,count);
+  if (sps.empty())
+    {
+      cout << "ERROR: no " << name << " subproblems to pack" << endl;
+      return false;
+    }
+
+  bool ok = true;
+
+#ifdef UTILIB_HAVE_MPI
+  int numModes = 2;
+#else
+  int numModes = 1;
+#endif
+  const char* modeNames[] = { "memcpy", "MPI_Pack" };
+
+  bool savedMode = PackBuffer::use_mpi_pack;
+  for (int m=0; m<numModes; m++)
+    {
+      PackBuffer::use_mpi_pack = (m == 1);
+      packStats stats = timeMode(instance,sps,reps);
+      double n = sps.size();
+      cout << setw(10) << name << setw(10) << modeNames[m]
+	   << setw(8) << sps.size()
+	   << setw(10) << (int) (stats.bytes/n)
+	   << setw(10) << (int) (1e9*stats.packSeconds/n)
+	   << setw(10) << (int) (stats.bytes/max(stats.packSeconds,1e-9)/1e6)
+	   << setw(10) << (int) (1e9*stats.unpackSeconds/n)
+	   << setw(12) << (int) (stats.bytes/max(stats.unpackSeconds,1e-9)/1e6)
+	   << endl;
+      if (!stats.matched)
+	{
+	  cout << "ERROR: unpacked " << name << " subproblems did not pack "
+	       << "to the same bytes with " << modeNames[m] << endl;
+	  ok = false;
+	}
+    }
+  PackBuffer::use_mpi_pack = savedMode;
+
+  for (size_t i=0; i<sps.size(); i++)
+    sps[i]->recycle();
+
+  return ok;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+  InitializeTiming();
+
+#ifdef ACRO_HAVE_MPI
+  uMPI::init(&argc,&argv,MPI_COMM_WORLD);
+#endif
+
+  if (argc < 3)
+    {
+      cerr << "Usage: packBench <knapsack file> <monomial file> "
+	   << "[count] [reps]" << endl;
+      return 1;
+    }
+
+  size_t count = (argc > 3) ? atoi(argv[3]) : 2000;
+  int    reps  = (argc > 4) ? atoi(argv[4]) : 5;
+
+  binaryKnapsack  knapsack;
+  pebblMonom::maxMonomialData monomial;
+  if (!setupInstance(knapsack,argv[1]) || !setupInstance(monomial,argv[2]))
+    return 1;
+
+  cout << "Best of " << reps << " passes:" << endl
+       << setw(10) << "problem" << setw(10) << "mode"
+       << setw(8)  << "subs" << setw(10) << "bytes/sp"
+       << setw(10) << "packNs" << setw(10) << "packMB/s"
+       << setw(10) << "unpackNs" << setw(12) << "unpackMB/s" << endl;
+
+  bool ok = runProblem("knapsack",knapsack,count,reps);
+  ok = runProblem("monomial",monomial,count,reps) && ok;
+
+#ifdef ACRO_HAVE_MPI
+  uMPI::done();
+#endif
+
+  return ok ? 0 : 1;
+}
@@ -55,31 +55,7 @@ void parallelBinaryKnapsack::unpack(UnPackBuffer& inBuffer)
 
 void parBinKnapSub::pack(PackBuffer& outBuffer)
 {
-  DEBUGPRXP(150,global(),"numIn=" << numIn << ": ");
-  outBuffer << numIn;
-  for(int i=0; i<numIn; i++)
-    {
-      outBuffer << inList[i];
-      DEBUGPRXP(150,global(),inList[i] << ' ');
-    }
-  DEBUGPRX(150,global(),'\n');
-  outBuffer << numOut;
-  DEBUGPRXP(150,global(),"numOut=" << numOut << ": ");
-  for(int j=0; j<numOut; j++)
-    {
-      outBuffer << outList[j];
-      DEBUGPRXP(150,global(),outList[j] << ' ');
-    }
-  DEBUGPRX(150,global(),'\n');
-  if ((state == bounded) || (state == separated))
-    {
-      outBuffer << splitItem;
-      if (bGlobal()->enumerating)
-	{
-	  outBuffer << tSplitInitial;
-	  outBuffer << tSplitGenItem;
-	}
-    }
+  packContents(outBuffer);
 }
 
 
@@ -91,39 +67,7 @@ int parallelBinaryKnapsack::spPackSize()
 
 void parBinKnapSub::unpack(UnPackBuffer& inBuffer)
 {
-  inBuffer >> numIn;
-  DEBUGPRXP(150,global(),"numIn=" << numIn << ':');
-  inList.resize(numIn);
-  for(int i=0; i<numIn; i++)
-    {
-      int item;
-      inBuffer >> item;
-      inList[i] = item;
-      capBase -= itemWeight(item);
-      DEBUGPRXP(150,global(), ' ' << inList[i]);
-    }      
-  DEBUGPRX(150,global(),".\n");
-  DEBUGPRX(150,global(),"capBase = " << capBase << ".\n");
-  inBuffer >> numOut;
-  DEBUGPRXP(150,global(),"numOut=" << numOut << ": ");
-  outList.resize(numOut);
-  for(int j=0; j<numOut; j++)
-    {
-      inBuffer >> outList[j];
-      DEBUGPRXP(250,global(),outList[j] << ' ');
-    }
-    DEBUGPRX(250,global(),".\n");
-  if ((state == bounded) || (state == separated))
-    {
-      inBuffer >> splitItem;
-      if (bGlobal()->enumerating)
-	{
-	  inBuffer >> tSplitInitial;
-	  inBuffer >> tSplitGenItem;
-	}
-    }
-  else
-    splitItem = notSplit;
+  unpackContents(inBuffer);
 }
 
 
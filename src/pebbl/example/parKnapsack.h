@@ -148,7 +148,6 @@ public:
   void reset(bool VBflag=true)
     {
       binaryKnapsack::reset();
-      registerFirstSolution(new binKnapSolution(this));
       parallelBranching::reset();
     }
 
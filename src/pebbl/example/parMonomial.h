@@ -81,7 +81,6 @@ namespace pebblMonom {
       void reset(bool VBflag=true)
       {
 	maxMonomialData::reset();
-	registerFirstSolution(new maxMonomSolution(this));
 	parallelBranching::reset();
       }
 
@@ -93,6 +92,9 @@ namespace pebblMonom {
 	          && parallelBranching::continueRampUp();
       }
 
+      // Ramp-up splitting divides the branching choice among processors
+      bool collectiveRampUp() { return true; };
+
       void setWeight(const double vec[], size_type len);
 
       // In parallel, restrict writing to verification log to processor
@@ -0,0 +1,36 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// parSynth.cpp
+//
+// Parallel synthetic tree methods.
+//
+
+#include <pebbl_config.h>
+#include <pebbl/example/parSynth.h>
+
+#ifdef ACRO_HAVE_MPI
+
+using namespace std;
+
+namespace pebbl {
+
+
+// The key is two ints, followed by the padding.
+
+int parallelSynthTree::spPackSize()
+{
+  return 2*sizeof(int) + synthPackBytes;
+}
+
+} // namespace pebbl
+
+#endif
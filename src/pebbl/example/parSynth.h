@@ -0,0 +1,127 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+
+/**
+ * \file parSynth.h
+ *
+ * Parallel version of the synthetic tree problem.  The tree is
+ * defined entirely by parameters, which every processor reads, so
+ * there is nothing to broadcast.
+ */
+
+#ifndef pebbl_parSynth_h
+#define pebbl_parSynth_h
+
+#include <pebbl_config.h>
+#include <pebbl/example/serialSynth.h>
+#ifdef ACRO_HAVE_MPI
+#include <pebbl/pbb/parBranching.h>
+
+namespace pebbl {
+
+
+class parSynthSub;                  // Forward reference
+
+class parallelSynthTree : public parallelBranching, public synthTree
+{
+public:
+
+  void pack(PackBuffer& /*outBuffer*/) { };
+  void unpack(UnPackBuffer& /*inBuffer*/) { };
+  int  spPackSize();
+
+  parallelBranchSub* blankParallelSub();
+
+  parallelSynthTree(MPI_Comm /*comm_*/ = MPI_COMM_WORLD) :
+    synthTree()
+    {
+      branchingInit(minimization, relTolerance, absTolerance);
+    };
+
+  bool setup(int& argc,char**& argv)
+    {
+      return parallelBranching::setup(argc,argv);
+    }
+
+  void solve() { parallelBranching::solve(); };
+
+  void printSolution(const char* header = "",
+		     const char* footer = "",
+		     std::ostream& outStream = ucout)
+    {
+      parallelBranching::printSolution(header,footer,outStream);
+    }
+
+  void reset(bool /*VBflag*/=true)
+    {
+      synthTree::reset();
+      parallelBranching::reset();
+    }
+
+};
+
+
+class parSynthSub : public parallelBranchSub, public synthSub
+{
+public:
+
+  parSynthSub() {};
+
+  void parSynthSubFromParSynthTree(parallelSynthTree* master_)
+    {
+      globalPtr = master_;
+      synthSubFromSynthTree(master_);
+    };
+
+  void parSynthSubAsChildOf(parSynthSub* parent,int whichChild)
+    {
+      globalPtr = parent->globalPtr;
+      synthSubAsChildOf(parent,whichChild);
+    };
+
+  ~parSynthSub() { };
+
+  parallelSynthTree* global()  const { return globalPtr; };
+  parallelBranching* pGlobal() const { return globalPtr; };
+
+  void pack(PackBuffer& outBuffer)     { packContents(outBuffer); };
+  void unpack(UnPackBuffer& inBuffer)  { unpackContents(inBuffer); };
+
+  parallelBranchSub* makeParallelChild(int whichChild)
+    {
+      parSynthSub* temp = new parSynthSub;
+      temp->parSynthSubAsChildOf(this,whichChild);
+      return temp;
+    }
+
+ protected:
+
+  void valLogDestroyPrint() { parallelBranchSub::valLogDestroyPrint(); };
+
+ private:
+
+  parallelSynthTree* globalPtr;
+
+};
+
+
+inline parallelBranchSub* parallelSynthTree::blankParallelSub()
+{
+  parSynthSub* temp = new parSynthSub;
+  temp->parSynthSubFromParSynthTree(this);
+  return temp;
+};
+
+} // namespace pebbl
+
+#endif
+
+#endif
@@ -0,0 +1,147 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// poolBench.cpp
+//
+// Microbenchmark for the best-first subproblem pools.  Fills a pool
+// with n subproblems with random bounds, then does a steady-state
+// phase where each step removes the best subproblem and inserts two
+// children (as in a best-first search), then drains the pool.
+// Reports throughput for heapPool and arrayHeapPool, and checks that
+// both pools hand back subproblems in the same order.
+//
+// Usage: poolBench [n] [steadyOps] [seed]
+//
+
+#include <pebbl_config.h>
+#include <pebbl/utilib/seconds.h>
+#include <pebbl/utilib/PM_LCG.h>
+#include <pebbl/utilib/Uniform.h>
+#include <pebbl/example/serialCore.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace pebbl;
+using namespace std;
+
+
+namespace {
+
+typedef branchPool<branchSub,loadObject> spPool;
+
+
+// Fill in the fields the pools look at
+
+branchSub* makeSP(pebbl_CoreExample::coreBranching* global,
+		  utilib::Uniform& rand,
+		  int serial)
+{
+  branchSub* p = global->blankSub();
+  p->bound              = (double) (int) (1000*rand());
+  p->integralityMeasure = (double) (int) (10*rand());
+  p->depth              = 1 + (int) (50*rand());
+  p->id.serial          = serial;
+  p->id.creatingProcessor = 0;
+  return p;
+}
+
+
+// Run the three phases on one pool.  Records the serial numbers in the
+// order they were removed.
+
+void runPool(const char* name,
+	     spPool* pool,
+	     pebbl_CoreExample::coreBranching* global,
+	     int n,
+	     int steadyOps,
+	     int seed,
+	     vector<int>& order)
+{
+  utilib::PM_LCG  lcg(seed);
+  utilib::Uniform rand(&lcg);
+  int serial = 0;
+
+  pool->setGlobal(global);
+  pool->load().init(global,false);
+
+  double t0 = WallClockSeconds();
+  for (int i=0; i<n; i++)
+    pool->insert(makeSP(global,rand,++serial));
+
+  double t1 = WallClockSeconds();
+  for (int i=0; i<steadyOps; i++)
+    {
+      branchSub* p = pool->remove();
+      order.push_back(p->id.serial);
+      double parentBound = p->bound;
+      delete p;
+      for (int c=0; c<2; c++)
+	{
+	  branchSub* child = makeSP(global,rand,++serial);
+	  child->bound = parentBound + (double) (int) (10*rand());
+	  pool->insert(child);
+	}
+    }
+
+  double t2 = WallClockSeconds();
+  while (pool->size() > 0)
+    {
+      branchSub* p = pool->remove();
+      order.push_back(p->id.serial);
+      delete p;
+    }
+  double t3 = WallClockSeconds();
+
+  cout << setw(14) << name
+       << setw(12) << (int) (n/max(t1 - t0,1e-9))
+       << setw(12) << (int) (3.0*steadyOps/max(t2 - t1,1e-9))
+       << setw(12) << (int) ((n + steadyOps)/max(t3 - t2,1e-9))
+       << endl;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+  InitializeTiming();
+
+  int n         = (argc > 1) ? atoi(argv[1]) : 1000000;
+  int steadyOps = (argc > 2) ? atoi(argv[2]) : 1000000;
+  int seed      = (argc > 3) ? atoi(argv[3]) : 1;
+
+  pebbl_CoreExample::coreBranching global;
+
+  cout << "Pool benchmark: " << n << " subproblems, "
+       << steadyOps << " steady-state steps" << endl
+       << "Operations per second:" << endl
+       << setw(14) << "pool" << setw(12) << "insert"
+       << setw(12) << "steady" << setw(12) << "drain" << endl;
+
+  vector<int> heapOrder, arrayOrder;
+
+  heapPool<branchSub,loadObject,DynamicSPCompare<branchSub> > hp;
+  runPool("heapPool",&hp,&global,n,steadyOps,seed,heapOrder);
+
+  arrayHeapPool<branchSub,loadObject> ap;
+  runPool("arrayHeapPool",&ap,&global,n,steadyOps,seed,arrayOrder);
+
+  if (heapOrder != arrayOrder)
+    {
+      cout << "ERROR: pools removed subproblems in different orders" << endl;
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,23 @@
+#
+# Runs a test command COUNT times, and fails at the first run that
+# fails.  Used for stress variants of tests whose failures depend on
+# thread timing.
+#
+#   cmake -DCOUNT=<n> -DTEST_COMMAND=<command;arg;...> -P repeatTest.cmake
+#
+
+if(NOT COUNT OR NOT TEST_COMMAND)
+  message(FATAL_ERROR "repeatTest.cmake needs COUNT and TEST_COMMAND")
+endif()
+
+foreach(run RANGE 1 ${COUNT})
+  execute_process(COMMAND ${TEST_COMMAND}
+                  RESULT_VARIABLE result
+                  OUTPUT_VARIABLE output
+                  ERROR_VARIABLE output)
+  if(NOT result EQUAL 0)
+    message("${output}")
+    message(FATAL_ERROR "Run ${run} of ${COUNT} failed: ${result}")
+  endif()
+endforeach()
+message("${COUNT} runs passed")
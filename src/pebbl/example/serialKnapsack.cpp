@@ -49,6 +49,24 @@ CHUNK_ALLOCATOR_DEF(knapsackItem,100);
 }
 
 
+//  Make one working solution for each thread other than thread 0,
+//  which uses workingSol.
+
+void binaryKnapsack::threadSetup(int n)
+{
+  for (size_type t=1; t<threadWorkingSol.size(); t++)
+    threadWorkingSol[t]->dispose();
+  threadWorkingSol.resize(n);
+  threadWorkingSol[0] = &workingSol;
+  for (int t=1; t<n; t++)
+    {
+      threadWorkingSol[t] = new binKnapSolution(this);
+      threadWorkingSol[t]->serial = 0;
+      threadWorkingSol[t]->sense  = maximization;
+    }
+}
+
+
 //  To read in the problem.  This routine now makes use of UTILIB
 //  containers.
 
@@ -211,7 +229,7 @@ binKnapSolution::binKnapSolution(binKnapSolution* toCopy)
   DEBUGPRX(200,toCopy->global,"Copy constructing binKnapSolution at "
 	   << (void*) this << " from " << toCopy << endl);
   copy(toCopy);
-  serial = ++(global->solSerialCounter);
+  serial = global->bumpCounter(global->solSerialCounter);
 }
 
 
@@ -280,6 +298,19 @@ void binKnapSub::binKnapSubFromKnapsack(binaryKnapsack* master)
 }
 
 
+// Children normally share list memory with their parents.  The sharing
+// bookkeeping is not thread safe, so copy instead when other threads may
+// be working on relatives of this subproblem.
+
+void binKnapSub::shareList(IntVector& list,IntVector& parentList)
+{
+  if (bGlobal()->numThreads > 1)
+    list << parentList;
+  else
+    list &= parentList;
+}
+
+
 void binKnapSub::binKnapSubAsChildOf(binKnapSub* parent,int whichChild)
 {
   capBase = parent->capBase;
@@ -332,7 +363,7 @@ void binKnapSub::binKnapSubAsChildOf(binKnapSub* parent,int whichChild)
       numIn = parentNumIn + 1;
       growList(inList,parent->inList,splitter);
       numOut = parent->numOut;
-      outList &= parent->outList;
+      shareList(outList,parent->outList);
       capBase -= itemWeight(splitter);
       if (capBase < 0)
 	{
@@ -346,7 +377,7 @@ void binKnapSub::binKnapSubAsChildOf(binKnapSub* parent,int whichChild)
   else if (whichChild == 1)
     {
       numIn = parent->numIn;              // The "out" child
-      inList &= parent->inList;
+      shareList(inList,parent->inList);
       int parentNumOut = parent->numOut;
       numOut = parentNumOut + 1;
       growList(outList,parent->outList,splitter);
@@ -408,6 +439,71 @@ void binKnapSub::dumpLists(const char* extraString)
 }
 
 
+// Pack and unpack the item lists.  Used by spilling pools, and by
+// parBinKnapSub to send subproblems between processors.  Unpacking
+// assumes capBase starts at the full capacity, as from blankSub().
+
+void binKnapSub::packContents(PackBuffer& outBuffer)
+{
+  outBuffer.reserve((numIn + numOut + 5)*sizeof(int));
+  DEBUGPRXP(150,global(),"numIn=" << numIn << ": ");
+  outBuffer << numIn;
+  outBuffer.pack(inList.data(),numIn);
+  for(int i=0; i<numIn; i++)
+    DEBUGPRXP(150,global(),inList[i] << ' ');
+  DEBUGPRX(150,global(),'\n');
+  outBuffer << numOut;
+  outBuffer.pack(outList.data(),numOut);
+  DEBUGPRXP(150,global(),"numOut=" << numOut << ": ");
+  for(int j=0; j<numOut; j++)
+    DEBUGPRXP(150,global(),outList[j] << ' ');
+  DEBUGPRX(150,global(),'\n');
+  if ((state == bounded) || (state == separated))
+    {
+      outBuffer << splitItem;
+      if (bGlobal()->enumerating)
+	{
+	  outBuffer << tSplitInitial;
+	  outBuffer << tSplitGenItem;
+	}
+    }
+}
+
+
+void binKnapSub::unpackContents(UnPackBuffer& inBuffer)
+{
+  inBuffer >> numIn;
+  DEBUGPRXP(150,global(),"numIn=" << numIn << ':');
+  inList.resize(numIn);
+  inBuffer.unpack(inList.data(),numIn);
+  for(int i=0; i<numIn; i++)
+    {
+      capBase -= itemWeight(inList[i]);
+      DEBUGPRXP(150,global(), ' ' << inList[i]);
+    }      
+  DEBUGPRX(150,global(),".\n");
+  DEBUGPRX(150,global(),"capBase = " << capBase << ".\n");
+  inBuffer >> numOut;
+  DEBUGPRXP(150,global(),"numOut=" << numOut << ": ");
+  outList.resize(numOut);
+  inBuffer.unpack(outList.data(),numOut);
+  for(int j=0; j<numOut; j++)
+    DEBUGPRXP(250,global(),outList[j] << ' ');
+  DEBUGPRX(250,global(),".\n");
+  if ((state == bounded) || (state == separated))
+    {
+      inBuffer >> splitItem;
+      if (bGlobal()->enumerating)
+	{
+	  inBuffer >> tSplitInitial;
+	  inBuffer >> tSplitGenItem;
+	}
+    }
+  else
+    splitItem = notSplit;
+}
+
+
 void binKnapSub::boundComputation(double* controlParam) 
 {
   *controlParam = 1;
@@ -573,7 +669,8 @@ void binKnapSolution::squeezeInGreedy()
   if (genItems > 0)
     {
       binKnapSolution temp(global);  // Make a temporary solution.
-      --(global->solSerialCounter);  // but don't use up a serial number
+      global->bumpCounter(global->solSerialCounter,-1);  // but don't use up
+                                                         // a serial number
       temp.reset(initialSequence);
       int changesMade = false;
       itemListCursor alreadyIn(genItems,&genItem);
@@ -652,7 +749,7 @@ void binKnapSub::incumbentHeuristic()
 void binKnapSub::makeCurrentEffect()
 {
   DEBUGPR(150,ucout << "Making " << this << " current problem.\n");
-  if ((state == bounded) && !(id == bGlobal()->previousSPId))
+  if ((state == bounded) && !(id == bGlobal()->lastSPId()))
     {
       DEBUGPR(20,ucout << "Regenerating solution...\n");
       double junk = 1;
@@ -665,13 +762,13 @@ void binKnapSub::makeCurrentEffect()
 void binKnapSolution::heuristic()
 {
   completeGreedy();
-  if (value > global->incumbentValue) 
+  if (value > global->incumbentNow()) 
     foundKnapsackSolution(synchronous);
   while(gRandom() <= global->randomSearchPersistence)
     {
       backTrack(chooseBackTrackItem());
       completeRandom();
-      if (value > global->incumbentValue) 
+      if (value > global->incumbentNow()) 
 	foundKnapsackSolution(notSynchronous);
     }
   DEBUGPRX(210,global,"Heuristic: shared= " << genItem.shared_mem() << '\n');
@@ -799,8 +896,6 @@ void binKnapSub::printMemDetails()
 
 #endif
 
-#ifdef ACRO_HAVE_MPI
-
 void binKnapSolution::packContents(PackBuffer& outBuf) const
 {
   outBuf << initialSequence;
@@ -836,8 +931,6 @@ int binKnapSolution::maxContentsBufSize()
   return (global->numItems + 2)*sizeof(int);
 }
 
-#endif // ACRO_HAVE_MPI
-
 
 } // namespace pebbl
 
@@ -197,16 +197,12 @@ public binKnapBase, public solution
 
   void printContents(std::ostream& s);
 
-#ifdef ACRO_HAVE_MPI
-
   void packContents(PackBuffer& outBuf) const;
   void unpackContents(UnPackBuffer& inBuf);
   int  maxContentsBufSize();
 
   solution* blankClone() { return new binKnapSolution(global); };
 
-#endif
-
   // Publically accessible data members.
 
   double left;
@@ -296,15 +292,37 @@ public:
 
   binKnapSolution workingSol;
 
+  // With numThreads > 1, threads other than 0 each get their own
+  // working solution.
+
+  BasicArray<binKnapSolution*> threadWorkingSol;
+
+  binKnapSolution* workingSolution()
+    {
+      int t = threadNum();
+      return (t == 0) ? &workingSol : threadWorkingSol[t];
+    };
+
+  void threadSetup(int n);
+
   binaryKnapsack(); 
                 
   ~binaryKnapsack() 
   { 
+    threadSetup(1);
     workingSol.decrementRefs();  // binKnapSolution is derived from solution,
   };                             // so it's reference-counted.
 
   bool setupProblem(int& argc,char**& argv);
 
+  // Registering the solution type lets checkpoints be read back
+
+  void reset(bool VBflag=true)
+    {
+      branching::reset(VBflag);
+      registerFirstSolution(new binKnapSolution(this));
+    }
+
   void preprocess();
   double aPrioriBound() { return sumOfAllValues; };
   solution* initialGuess();
@@ -378,7 +396,7 @@ public:
 
   double capBase;
 
-  binKnapSolution* workingSol() { return &(globalPtr->workingSol); };
+  binKnapSolution* workingSol() { return globalPtr->workingSolution(); };
 
   IntVector inList;
   IntVector outList;
@@ -435,6 +453,11 @@ public:
 
   void makeCurrentEffect();
 
+  bool packable() { return true; };
+
+  void packContents(PackBuffer& outBuffer);
+  void unpackContents(UnPackBuffer& inBuffer);
+
 #ifdef MEMORY_TRACKING
   void printMemDetails();
 #endif
@@ -447,6 +470,8 @@ protected:
 		       IntVector& oldList, 
 		       int newElement);
 
+  void shareList(IntVector& list,IntVector& parentList);
+
   inline int         numItems()        { return global()->numItems;       };
   inline double      itemWeight(int i) { return global()->item[i].weight; };
   inline double      itemValue(int i)  { return global()->item[i].value;  };
@@ -279,8 +279,6 @@ namespace pebblMonom {
     return true;
   }
 
-#ifdef ACRO_HAVE_MPI
-
   void monomialObj::pack(PackBuffer & outBuff) const
   {
     outBuff << _lastSetIdx << _vars; 
@@ -300,7 +298,16 @@ namespace pebblMonom {
 	  _varIdxs.insert(_varIdxs.end(),i);
       }   
   }
-#endif
+
+  void monomialObj::packExact(PackBuffer & outBuff) const
+  {
+    outBuff << _lastSetIdx << _vars << _notInMonom << _varIdxs;
+  }
+
+  void monomialObj::unpackExact(UnPackBuffer & inBuff)
+  {
+    inBuff >> _lastSetIdx >> _vars >> _notInMonom >> _varIdxs;
+  }
 
   ////////////////////// maxMonomialData object //////////////////////
 
@@ -845,6 +852,15 @@ namespace pebblMonom {
   }
 
 
+  // Also registers the reference solution that unpackSolution() clones
+
+  void maxMonomialData::reset(bool VBflag)
+  {
+    branching::reset(VBflag);
+    registerFirstSolution(new maxMonomSolution(this));
+  }
+
+
   //  maxMonomialData::preprocess - fills the positive, 
   // negative and variable coverage index lists
 
@@ -1908,6 +1924,93 @@ namespace pebblMonom {
   }
 
 
+  // maxMonomSub::packContents - serial packing.  Much the same data as
+  // parMaxMonomSubThreeWay::pack, but the monomials are copied exactly
+  // (so all branching schemes work) and the associated solution goes
+  // along, since children still need it when they are bounded.
+
+  void maxMonomSub::packContents(PackBuffer & outBuffer)
+  {
+    outBuffer << _posCovg << _negCovg << _posCovgIdx << _negCovgIdx
+	      << _insepWt;
+    _monom.packExact(outBuffer);
+    outBuffer << (bool) (_assocSoln != NULL);
+    if (_assocSoln)
+      {
+	_assocSoln->getMonomialObj().packExact(outBuffer);
+	outBuffer << _assocSoln->value;
+      }
+    outBuffer << (size_t) _children.size();
+    childrenVecType::iterator it = _children.begin();
+    for (; it != _children.end(); it++)
+      {
+	outBuffer << (bool) (*it != NULL);
+	if (*it)
+	  (*it)->packSubproblem(outBuffer);
+      }
+    DEBUGPR(20,ucout << "maxMonomSub::packContents packed " << _monom
+	    << " with " << _children.size() << " children" << endl);
+  }
+
+
+  // maxMonomSub::unpackContents - fills in a subproblem made by
+  // blankSub(), so throw away what that set up first
+
+  void maxMonomSub::unpackContents(UnPackBuffer & inBuffer)
+  {
+    if (_assocSoln != NULL)
+      {
+	_assocSoln->dispose();
+	_assocSoln = NULL;
+      }
+
+    inBuffer >> _posCovg >> _negCovg >> _posCovgIdx >> _negCovgIdx
+	     >> _insepWt;
+    _monom.unpackExact(inBuffer);
+
+    bool haveSoln;
+    inBuffer >> haveSoln;
+    if (haveSoln)
+      {
+	monomialObj solnMonom;
+	solnMonom.unpackExact(inBuffer);
+	_assocSoln = new maxMonomSolution(solnMonom);
+	inBuffer >> _assocSoln->value;
+      }
+
+    size_t childNum;
+    inBuffer >> childNum;
+    _children.resize(childNum);
+    for (size_t i = 0; i < childNum; i++)
+      {
+	bool nonNull;
+	inBuffer >> nonNull;
+	_children[i] = NULL;
+	if (nonNull)
+	  {
+	    _children[i] = dynamic_cast<maxMonomSub*>(global()->blankSub());
+	    _children[i]->unpackSubproblem(inBuffer);
+	  }
+      }
+    DEBUGPR(20,ucout << "maxMonomSub::unpackContents unpacked " << _monom
+	    << " with " << childNum << " children" << endl);
+  }
+
+
+  void maxMonomSubThreeWay::packContents(PackBuffer & outBuffer)
+  {
+    maxMonomSub::packContents(outBuffer);
+    outBuffer << _branchChoice.branchVar;
+  }
+
+
+  void maxMonomSubThreeWay::unpackContents(UnPackBuffer & inBuffer)
+  {
+    maxMonomSub::unpackContents(inBuffer);
+    inBuffer >> _branchChoice.branchVar;
+  }
+
+
   // maxMonomSub::boundComputation
   void maxMonomSub::boundComputation(double* controlParam) 
   {
@@ -2621,8 +2724,6 @@ namespace pebblMonom {
   }
 
 
-#ifdef ACRO_HAVE_MPI
-
   void maxMonomSolution::packContents(PackBuffer & outBuf) const
   {
     _monom.pack(outBuf);
@@ -2637,6 +2738,5 @@ namespace pebblMonom {
   {
     return (_monom.maxDegree() + 1)*sizeof(size_type) + 200;
   }
-#endif
 
 } // namespace pebblMonom
@@ -30,10 +30,7 @@
 #include <pebbl/utilib/math_basic.h>
 #include <pebbl/utilib/ParameterSet.h>
 #include <pebbl/bb/branching.h>
-
-#ifdef ACRO_HAVE_MPI
 #include <pebbl/utilib/PackBuf.h>
-#endif
 
 
 using namespace std;
@@ -186,10 +183,13 @@ namespace pebblMonom {
     void printInMonom(std::ostream& os) const;
     void printNotInMonom(std::ostream& os) const;
 
-#ifdef ACRO_HAVE_MPI
     void pack(PackBuffer & buff) const;
     void unpack(UnPackBuffer &buff);
-#endif
+
+    // unpack() rebuilds the index sets from _vars, which is only right
+    // for ternary branching; these copy them as they are
+    void packExact(PackBuffer & buff) const;
+    void unpackExact(UnPackBuffer &buff);
 
     bool covers(const vector<variable_val_t> target) const;
 
@@ -359,6 +359,10 @@ namespace pebblMonom {
     // get data file name to initialize data matrix
     bool setupProblem(int& argc,char**& argv);
 
+    // Registering the solution type lets checkpoints be read back
+
+    void reset(bool VBflag=true);
+
     // write data to a file, including weights, to a file that 
     // can be read by setupProble (added by JE)
     void writeWeightedData(ostream& os);
@@ -605,13 +609,11 @@ namespace pebblMonom {
 
     size_type highestIdx() const {return _monom.highestIdx();}
 
-#ifdef ACRO_HAVE_MPI
     void packContents(PackBuffer & outBuf) const;
 
     void unpackContents(UnPackBuffer & inBuf);
 
     int maxContentsBufSize();
-#endif
 
   protected:
 
@@ -723,6 +725,13 @@ namespace pebblMonom {
 
     void setGlobalInfo(maxMonomialData* glbl) {globalPtr = glbl;}  
 
+    // Serial packing, so spilling pools can move subproblems to disk.
+    // The children already made by boundComputation go along.
+
+    bool packable() { return true; };
+    void packContents(PackBuffer & outBuffer);
+    void unpackContents(UnPackBuffer & inBuffer);
+
   protected:
 
     double findMostNonSeparating(const vector<size_type> & outOfMonom, 
@@ -815,6 +824,9 @@ namespace pebblMonom {
 
   size_type getBranchVar() const { return _branchChoice.branchVar; };
 
+  void packContents(PackBuffer & outBuffer);
+  void unpackContents(UnPackBuffer & inBuffer);
+
   protected:
     virtual maxMonomSub * allocateObject() const 
     {
@@ -0,0 +1,189 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// serialSynth.cpp
+//
+// Larger methods of the synthetic tree problem.
+//
+
+#include <pebbl_config.h>
+#include <pebbl/utilib/seconds.h>
+#include <pebbl/example/serialSynth.h>
+
+#include <cmath>
+#include <sstream>
+
+using namespace utilib;
+using namespace std;
+
+namespace pebbl {
+
+
+namespace {
+
+  // The SplitMix64 finalizer: a cheap, well-mixed 64-bit hash
+
+  inline uint64_t mix64(uint64_t z)
+  {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+} // namespace
+
+
+synthTree::synthTree() :
+  rootKey(0),
+  exponential(false)
+{
+  version_info += ", synthetic tree example 1.0";
+  min_num_required_args = 0;
+  branchingInit(minimization, relTolerance, absTolerance);
+}
+
+
+// There is no input file; the problem is named after the tree.
+
+bool synthTree::setupProblem(int& /*argc*/,char**& /*argv*/)
+{
+  if ((synthDistribution != "uniform") &&
+      (synthDistribution != "exponential"))
+    {
+      cerr << "Unknown synthDistribution \"" << synthDistribution
+	   << "\": use uniform or exponential\n";
+      return false;
+    }
+  stringstream s;
+  s << "synth" << synthBranching << 'x' << synthDepth << 's' << synthSeed;
+  setName(s.str().c_str());
+  return true;
+}
+
+
+// Called on every processor, so the derived data are set here rather
+// than in setupProblem.
+
+void synthTree::preprocess()
+{
+  rootKey     = mix64(0x9E3779B97F4A7C15ULL*(uint64_t) (synthSeed + 1));
+  exponential = (synthDistribution == "exponential");
+  padding.assign(synthPackBytes,0);
+}
+
+
+uint64_t synthTree::childKey(uint64_t parentKey,int whichChild) const
+{
+  return mix64(parentKey + 0x9E3779B97F4A7C15ULL*(uint64_t) (whichChild + 1));
+}
+
+
+double synthTree::boundIncrement(uint64_t key) const
+{
+  // 53 high bits give a uniform value in [0,1)
+
+  double u = (double) (mix64(key) >> 11) * (1.0/9007199254740992.0);
+  if (exponential)
+    return -synthSpread*log(1 - u);
+  return synthSpread*u;
+}
+
+
+void synthSub::boundComputation(double* controlParam)
+{
+  *controlParam = 1;
+
+  double busyTime = global()->synthBoundMicroseconds;
+  if (busyTime > 0)
+    {
+      double targetTime = WallClockSeconds() + 1e-6*busyTime;
+      while (WallClockSeconds() < targetTime) { };
+    }
+
+  if (depth > 1)
+    bound += global()->boundIncrement(key);
+
+  DEBUGPR(20,ucout << "Bound of " << key << " at depth " << depth
+	  << " is " << bound << endl);
+
+  setState(bounded);
+}
+
+
+void synthSub::packContents(PackBuffer& outBuffer)
+{
+  outBuffer << (int) (key >> 32) << (int) (key & 0xffffffff);
+  vector<char>& padding = global()->padding;
+  if (padding.size() > 0)
+    outBuffer.pack(&padding[0],padding.size());
+}
+
+
+void synthSub::unpackContents(UnPackBuffer& inBuffer)
+{
+  int high = 0;
+  int low  = 0;
+  inBuffer >> high >> low;
+  key = ((uint64_t) (unsigned int) high << 32) | (unsigned int) low;
+  vector<char>& padding = global()->padding;
+  if (padding.size() > 0)
+    inBuffer.unpack(&padding[0],padding.size());
+}
+
+
+// Solutions
+
+synthSolution::synthSolution(synthTree* global_) :
+  solution(global_),
+  key(0),
+  global(global_)
+{ }
+
+
+synthSolution::synthSolution(synthTree* global_,uint64_t key_,double value_) :
+  solution(global_),
+  key(key_),
+  global(global_)
+{
+  value = value_;
+}
+
+
+synthSolution::synthSolution(synthSolution* toCopy) :
+  solution(toCopy),
+  key(toCopy->key),
+  global(toCopy->global)
+{
+  serial = global->bumpCounter(global->solSerialCounter);
+}
+
+
+void synthSolution::printContents(ostream& s)
+{
+  s << "leaf " << key << endl;
+}
+
+
+void synthSolution::packContents(PackBuffer& outBuf) const
+{
+  outBuf << (int) (key >> 32) << (int) (key & 0xffffffff);
+}
+
+
+void synthSolution::unpackContents(UnPackBuffer& inBuf)
+{
+  int high = 0;
+  int low  = 0;
+  inBuf >> high >> low;
+  key = ((uint64_t) (unsigned int) high << 32) | (unsigned int) low;
+}
+
+} // namespace pebbl
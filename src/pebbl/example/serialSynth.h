@@ -0,0 +1,274 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+
+/**
+ * \file serialSynth.h
+ *
+ *  A synthetic minimization problem for measuring the framework
+ *  itself.  The search tree is generated from the command-line
+ *  parameters: every subproblem has synthBranching children, the
+ *  leaves are at depth synthDepth, and each child's bound exceeds its
+ *  parent's by a random increment drawn from a seeded hash of the
+ *  child's position in the tree.  Leaves are solutions whose value is
+ *  their bound.  The tree therefore does not depend on the order in
+ *  which it is explored, so every pool and handler finds the same
+ *  optimum.  The bound computation can be made to cost a fixed number
+ *  of microseconds, and subproblems can carry padding when packed.
+ */
+
+#ifndef pebbl_serialSynth_h
+#define pebbl_serialSynth_h
+
+#include <pebbl_config.h>
+#include <pebbl/bb/branching.h>
+#include <pebbl/utilib/ParameterSet.h>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+namespace pebbl {
+
+using namespace utilib;
+
+
+// Class for parameters
+
+class synthTreeParams : virtual public ParameterSet
+{
+public:
+
+  synthTreeParams() :
+    synthBranching(2),
+    synthDepth(20),
+    synthSpread(1.0),
+    synthDistribution("uniform"),
+    synthBoundMicroseconds(0),
+    synthPackBytes(0),
+    synthSeed(1)
+    {
+      create_categorized_parameter("synthBranching",synthBranching,
+				   "<int>","2",
+				   "Number of children of each subproblem",
+				   "Synthetic tree",
+				   ParameterLowerBound<int>(2));
+
+      create_categorized_parameter("synthDepth",synthDepth,
+				   "<int>","20",
+				   "Depth of the leaves (the root has depth 1)",
+				   "Synthetic tree",
+				   ParameterLowerBound<int>(1));
+
+      create_categorized_parameter("synthSpread",synthSpread,
+				   "<double>","1.0",
+				   "Scale of the bound increment from parent "
+				   "to child",
+				   "Synthetic tree",
+				   ParameterNonnegative<double>());
+
+      create_categorized_parameter("synthDistribution",synthDistribution,
+				   "<string>","uniform",
+				   "Distribution of the bound increments:\n\t"
+				   "uniform on [0,synthSpread], or exponential\n\t"
+				   "with mean synthSpread",
+				   "Synthetic tree");
+
+      create_categorized_parameter("synthBoundMicroseconds",
+				   synthBoundMicroseconds,
+				   "<double>","0",
+				   "Busy-wait this long in each bound "
+				   "computation",
+				   "Synthetic tree",
+				   ParameterNonnegative<double>());
+
+      create_categorized_parameter("synthPackBytes",synthPackBytes,
+				   "<int>","0",
+				   "Padding added to each packed subproblem",
+				   "Synthetic tree",
+				   ParameterNonnegative<int>());
+
+      create_categorized_parameter("synthSeed",synthSeed,
+				   "<int>","1",
+				   "Seed that selects the tree",
+				   "Synthetic tree");
+    };
+
+  int         synthBranching;
+  int         synthDepth;
+  double      synthSpread;
+  std::string synthDistribution;
+  double      synthBoundMicroseconds;
+  int         synthPackBytes;
+  int         synthSeed;
+
+};
+
+
+class synthTree;
+
+
+// A solution is identified by the key of its leaf
+
+class synthSolution : public solution
+{
+public:
+
+  const char* typeDescription() const { return "Synthetic tree leaf"; };
+
+  void printContents(std::ostream& s);
+
+  void packContents(PackBuffer& outBuf) const;
+  void unpackContents(UnPackBuffer& inBuf);
+  int  maxContentsBufSize() { return 2*sizeof(int); };
+
+  solution* blankClone() { return new synthSolution(global); };
+
+  uint64_t key;
+
+  synthSolution(synthTree* global_);
+
+  synthSolution(synthTree* global_,uint64_t key_,double value_);
+
+  synthSolution(synthSolution* toCopy);
+
+protected:
+
+  synthTree* global;
+
+  size_type sequenceLength() { return 2; };
+
+  double sequenceData()
+    {
+      return (double) ((sequenceCursor++ == 0) ? (key >> 32)
+		       : (key & 0xffffffff));
+    };
+
+};
+
+
+//  The branching class...
+
+class synthTree :
+virtual public branching,
+public synthTreeParams
+{
+public:
+
+  synthTree();
+
+  bool setupProblem(int& argc,char**& argv);
+
+  void preprocess();
+
+  double aPrioriBound() { return 0; };
+
+  branchSub* blankSub();
+
+  void reset(bool VBflag=true)
+    {
+      branching::reset(VBflag);
+      registerFirstSolution(new synthSolution(this));
+    }
+
+  // The key of a child, and the increment from its parent's bound
+
+  uint64_t childKey(uint64_t parentKey,int whichChild) const;
+  double   boundIncrement(uint64_t key) const;
+
+  uint64_t rootKey;
+
+  bool exponential;
+
+  // Padding packed with each subproblem
+
+  std::vector<char> padding;
+
+};
+
+
+//  The branchSub class...
+
+class synthSub : virtual public branchSub
+{
+public:
+
+  inline synthTree* global() const { return globalPtr; };
+
+  branching* bGlobal() const { return global(); };
+
+  REFER_DEBUG(global())
+
+  uint64_t key;
+
+  synthSub() {};
+
+  void synthSubFromSynthTree(synthTree* master)
+    {
+      globalPtr = master;
+      key       = 0;
+    };
+
+  void synthSubAsChildOf(synthSub* parent,int whichChild)
+    {
+      globalPtr = parent->global();
+      key       = globalPtr->childKey(parent->key,whichChild);
+      branchSubAsChildOf(parent);
+    };
+
+  virtual ~synthSub() {};
+
+  void setRootComputation() { key = global()->rootKey; };
+
+  void boundComputation(double* controlParam);
+
+  int splitComputation()
+    {
+      setState(separated);
+      return candidateSolution() ? 0 : global()->synthBranching;
+    };
+
+  branchSub* makeChild(int whichChild)
+    {
+      synthSub* temp = new synthSub;
+      temp->synthSubAsChildOf(this,whichChild);
+      return temp;
+    };
+
+  bool candidateSolution() { return depth >= global()->synthDepth; };
+
+  solution* extractSolution()
+    {
+      return new synthSolution(global(),key,bound);
+    };
+
+  bool packable() { return true; };
+
+  void packContents(PackBuffer& outBuffer);
+  void unpackContents(UnPackBuffer& inBuffer);
+
+protected:
+
+  synthTree* globalPtr;
+
+};
+
+
+inline branchSub* synthTree::blankSub()
+{
+  synthSub* temp = new synthSub();
+  temp->synthSubFromSynthTree(this);
+  return temp;
+}
+
+} // namespace pebbl
+
+#endif
@@ -0,0 +1,560 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// treeBench.cpp
+//
+// Node-throughput benchmark on the synthetic tree problem.  Solves the
+// tree with every serial pool (heap, arrayHeap, depthFirst,
+// breadthFirst, boundBuckets, pressurePlunge, spillKeep) under every
+// handler (lazy, eager, hybrid), and reports for each combination:
+//
+//   - subproblems bounded per second, with each search repeated until
+//     minSeconds have been spent on it;
+//   - the mean cost of a pool insert and a pool remove in nanoseconds,
+//     and the fraction of the search spent inside the pool.  These
+//     come from one extra search in which the pool is wrapped by a
+//     timing pool that forwards every call, so they do not slow down
+//     the throughput runs.  The cost of reading the clock is measured
+//     and subtracted.
+//
+// All the searches must find the same optimum.
+//
+// When run under MPI with more than one processor, processor 0 first
+// solves each combination serially, then all the processors solve it
+// in parallel, and the scaling efficiency T(1)/(p T(p)) is reported
+// as well.  The parallel framework has no spill pool, so that
+// combination is only run serially.
+//
+// Usage: treeBench [minSeconds] [parameters...]
+//
+// The parameters (e.g. --synthDepth=16) are passed on to every search.
+//
+
+#include <pebbl_config.h>
+#include <pebbl/utilib/seconds.h>
+#include <pebbl/utilib/mpiUtil.h>
+#include <pebbl/example/parSynth.h>
+
+#include <time.h>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+using namespace pebbl;
+using namespace std;
+
+
+namespace {
+
+typedef branchPool<branchSub,loadObject> spPool;
+
+
+// Monotonic clock in nanoseconds; WallClockSeconds() is too coarse to
+// time a single pool operation.
+
+inline double nowNs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return 1e9*ts.tv_sec + ts.tv_nsec;
+}
+
+
+// Time recorded by a timed section with nothing in it
+
+double clockOverheadNs()
+{
+  const int calls = 100000;
+  double sum = 0;
+  for (int i=0; i<calls; i++)
+    {
+      double start = nowNs();
+      sum += nowNs() - start;
+    }
+  return sum/calls;
+}
+
+
+// Time spent in each kind of pool call
+
+struct poolStats
+{
+  enum { insertOp, removeOp, pruneOp, numOps };
+
+  poolStats()
+    {
+      for (int i=0; i<numOps; i++)
+	{
+	  calls[i] = 0;
+	  ns[i]    = 0;
+	}
+    };
+
+  long   calls[numOps];
+  double ns[numOps];
+};
+
+
+// A pool that passes every call on to another pool, timing insertion,
+// removal and pruning.  The load object is copied back from the inner
+// pool after each call that can change it, since branching reads the
+// outer pool's load() directly.
+
+class timedPool : public spPool
+{
+public:
+
+  timedPool(spPool* inner_) :
+    inner(inner_)
+    {
+      setGlobal(inner->global());
+      sync();
+    };
+
+  ~timedPool() { delete inner; };
+
+  void reset() { inner->reset(); sync(); };
+
+  int size() { return inner->size(); };
+
+  int insert(branchSub* p)
+    {
+      double start = nowNs();
+      int result = inner->insert(p);
+      record(poolStats::insertOp,start);
+      return result;
+    };
+
+  branchSub* select() { return inner->select(); };
+
+  branchSub* remove(branchSub* p)
+    {
+      double start = nowNs();
+      branchSub* result = inner->remove(p);
+      record(poolStats::removeOp,start);
+      return result;
+    };
+
+  branchSub* remove()
+    {
+      double start = nowNs();
+      branchSub* result = inner->remove();
+      record(poolStats::removeOp,start);
+      return result;
+    };
+
+  int kill(branchSub* p)
+    {
+      int result = inner->kill(p);
+      sync();
+      return result;
+    };
+
+  void clear() { inner->clear(); sync(); };
+
+  int prune()
+    {
+      double start = nowNs();
+      int result = inner->prune();
+      record(poolStats::pruneOp,start);
+      return result;
+    };
+
+  void pretendPrunedOnce() { inner->pretendPrunedOnce(); };
+
+  void resetScan()          { inner->resetScan(); };
+  branchSub* scan()         { return inner->scan(); };
+  branchSub* firstToUnload() { return inner->firstToUnload(); };
+  branchSub* nextToUnload()  { return inner->nextToUnload(); };
+
+  double loadMeasure()      { return inner->loadMeasure(); };
+  bool   knowsGlobalBound() { return inner->knowsGlobalBound(); };
+  double globalBound()      { return inner->globalBound(); };
+
+  void myPrint() { inner->myPrint(); };
+
+  void printStatistics(ostream& stream) { inner->printStatistics(stream); };
+
+  poolStats stats;
+
+protected:
+
+  spPool* inner;
+
+  void sync() { myLoad = inner->load(); };
+
+  void record(int op,double start)
+    {
+      stats.ns[op] += nowNs() - start;
+      stats.calls[op]++;
+      sync();
+    };
+};
+
+
+// Swallows the solver's own output
+
+class nullBuf : public streambuf
+{
+protected:
+  int overflow(int c) { return c; };
+};
+
+nullBuf quietBuf;
+
+
+// The argument list for one search.  The parameter parser edits argv
+// in place, so each search gets fresh copies.
+
+class argList
+{
+public:
+
+  argList(const vector<string>& args_) :
+    args(args_)
+    {
+      for (size_t i=0; i<args.size(); i++)
+	store.push_back(&args[i][0]);
+      store.push_back(NULL);
+      argc = args.size();
+      argv = &store[0];
+    };
+
+  int    argc;
+  char** argv;
+
+protected:
+
+  vector<string> args;
+  vector<char*>  store;
+};
+
+
+struct poolKind
+{
+  const char* name;
+  const char* flag;
+  bool        parallel;    // Also available to the parallel framework
+};
+
+const poolKind pools[] =
+  {
+    { "heap",           "",                                   true  },
+    { "arrayHeap",      "--arrayHeap",                        true  },
+    { "depthFirst",     "--depthFirst",                       true  },
+    { "breadthFirst",   "--breadthFirst",                     true  },
+    { "boundBuckets",   "--boundBuckets",                     true  },
+    { "pressurePlunge", "--pressurePlunge --plungeSPLimit=1000", true },
+    { "spillKeep",      "--spillKeep=1000",                   false }
+  };
+
+const int numPools = sizeof(pools)/sizeof(poolKind);
+
+const char* handlerNames[] = { "lazy", "eager", "hybrid" };
+const char* handlerFlags[] = { "--lazyBounding", "--eagerBounding", "" };
+
+const int numHandlers = 3;
+
+
+struct searchResult
+{
+  searchResult() : seconds(0), bounded(0), value(0), searches(0) { };
+
+  double seconds;
+  double bounded;
+  double value;
+  int    searches;
+};
+
+
+vector<string> makeArgs(const vector<string>& userArgs,
+			const poolKind& pool,
+			int handler)
+{
+  vector<string> args;
+  args.push_back("treeBench");
+  args.push_back("--statusPrintCount=0");
+  string flags = string(pool.flag) + " " + handlerFlags[handler];
+  size_t start = 0;
+  while (start < flags.size())
+    {
+      size_t end = flags.find(' ',start);
+      if (end == string::npos)
+	end = flags.size();
+      if (end > start)
+	args.push_back(flags.substr(start,end - start));
+      start = end + 1;
+    }
+  for (size_t i=0; i<userArgs.size(); i++)
+    args.push_back(userArgs[i]);
+  return args;
+}
+
+
+// One serial search.  If statsOut is non-null, the instance's pool is
+// wrapped in a timing pool and its counts are returned there.
+
+bool serialSearch(const vector<string>& args,
+		  searchResult& result,
+		  poolStats* statsOut = NULL)
+{
+  argList a(args);
+  synthTree instance;
+  streambuf* saved = cout.rdbuf(&quietBuf);
+  bool ok = instance.setup(a.argc,a.argv);
+  if (ok)
+    {
+      instance.reset();
+      timedPool* timed = NULL;
+      if (statsOut)
+	{
+	  timed = new timedPool(instance.pool);
+	  instance.pool = timed;
+	}
+      double t0 = WallClockSeconds();
+      instance.search();
+      result.seconds += WallClockSeconds() - t0;
+      result.bounded += instance.subCount[pebblBase::beingBounded];
+      result.value    = instance.incumbentValue;
+      result.searches++;
+      if (timed)
+	*statsOut = timed->stats;
+    }
+  ucout << Flush;
+  cout.rdbuf(saved);
+  return ok;
+}
+
+
+// Repeat the search until at least minSeconds have been spent on it
+
+bool repeatSerial(const vector<string>& args,
+		  double minSeconds,
+		  searchResult& result)
+{
+  do
+    if (!serialSearch(args,result))
+      return false;
+  while (result.seconds < minSeconds);
+  return true;
+}
+
+
+#ifdef ACRO_HAVE_MPI
+
+// One parallel search on all processors.  The time is that of the
+// slowest processor, and the subproblem counts are summed.
+
+bool parallelSearch(const vector<string>& args,searchResult& result)
+{
+  argList a(args);
+  parallelSynthTree instance(MPI_COMM_WORLD);
+  streambuf* saved = cout.rdbuf(&quietBuf);
+  bool ok = instance.setup(a.argc,a.argv);
+  if (ok)
+    {
+      instance.reset();
+      MPI_Barrier(MPI_COMM_WORLD);
+      double t0 = WallClockSeconds();
+      instance.search();
+      double elapsed = WallClockSeconds() - t0;
+      double bounded = instance.subCount[pebblBase::beingBounded];
+      double value   = instance.incumbentValue;
+      double sums[2];
+      MPI_Allreduce(&elapsed,&sums[0],1,MPI_DOUBLE,MPI_MAX,MPI_COMM_WORLD);
+      MPI_Allreduce(&bounded,&sums[1],1,MPI_DOUBLE,MPI_SUM,MPI_COMM_WORLD);
+      MPI_Allreduce(&value,&result.value,1,MPI_DOUBLE,MPI_MIN,
+		    MPI_COMM_WORLD);
+      result.seconds += sums[0];
+      result.bounded += sums[1];
+      result.searches++;
+    }
+  ucout << Flush;
+  cout.rdbuf(saved);
+  return ok;
+}
+
+
+bool repeatParallel(const vector<string>& args,
+		    double minSeconds,
+		    searchResult& result)
+{
+  do
+    if (!parallelSearch(args,result))
+      return false;
+  while (result.seconds < minSeconds);
+  return true;
+}
+
+#endif
+
+
+double rate(const searchResult& r)
+{
+  return r.bounded/max(r.seconds,1e-9);
+}
+
+
+double nsPerOp(const poolStats& stats,int op,double overhead)
+{
+  if (stats.calls[op] == 0)
+    return 0;
+  return max(stats.ns[op]/stats.calls[op] - overhead,0.0);
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+  InitializeTiming();
+
+  int nprocs = 1;
+  int rank   = 0;
+#ifdef ACRO_HAVE_MPI
+  uMPI::init(&argc,&argv,MPI_COMM_WORLD);
+  nprocs = uMPI::size;
+  rank   = uMPI::rank;
+  if (nprocs > 1)
+    {
+      CommonIO::begin();
+      CommonIO::setIOFlush(1);
+    }
+#endif
+
+  double minSeconds = 0.5;
+  int    firstArg   = 1;
+  if ((argc > 1) && (strncmp(argv[1],"--",2) != 0))
+    {
+      minSeconds = atof(argv[1]);
+      firstArg   = 2;
+    }
+  vector<string> userArgs;
+  for (int i=firstArg; i<argc; i++)
+    userArgs.push_back(argv[i]);
+
+  bool ok = true;
+
+  double overhead = clockOverheadNs();
+  if (rank == 0)
+    {
+      cout << "Clock overhead " << overhead
+	   << " ns per timed pool call (subtracted)" << endl << endl;
+      cout << setw(15) << "pool" << setw(8) << "handler"
+	   << setw(10) << "bounded" << setw(12) << "nodes/sec"
+	   << setw(10) << "insertNs" << setw(10) << "removeNs"
+	   << setw(8) << "pool%";
+      if (nprocs > 1)
+	cout << setw(12) << "parBounded" << setw(12) << "parNodes/s"
+	     << setw(12) << "efficiency";
+      cout << endl;
+    }
+
+  double reference  = 0;
+  bool   haveRef    = false;
+  bool   agree      = true;
+
+  for (int p=0; (p<numPools) && ok; p++)
+    for (int h=0; (h<numHandlers) && ok; h++)
+      {
+	vector<string> args = makeArgs(userArgs,pools[p],h);
+
+	searchResult serial;
+	poolStats    stats;
+	searchResult timedRun;
+	if (rank == 0)
+	  ok = repeatSerial(args,minSeconds,serial) &&
+	       serialSearch(args,timedRun,&stats);
+
+#ifdef ACRO_HAVE_MPI
+	if (nprocs > 1)
+	  {
+	    int flag = ok;
+	    MPI_Bcast(&flag,1,MPI_INT,0,MPI_COMM_WORLD);
+	    ok = flag;
+	  }
+#endif
+	if (!ok)
+	  break;
+
+	searchResult par;
+#ifdef ACRO_HAVE_MPI
+	if ((nprocs > 1) && pools[p].parallel)
+	  ok = repeatParallel(args,minSeconds,par);
+#endif
+
+	if (rank != 0)
+	  continue;
+
+	double poolNs = 0;
+	for (int i=0; i<poolStats::numOps; i++)
+	  poolNs += stats.ns[i] - stats.calls[i]*overhead;
+	double poolFraction = 100*max(poolNs,0.0)/
+	  max(1e9*timedRun.seconds,1.0);
+
+	cout << setw(15) << pools[p].name << setw(8) << handlerNames[h]
+	     << setw(10) << (long) (serial.bounded/serial.searches)
+	     << setw(12) << (long) rate(serial)
+	     << setw(10) << setprecision(3)
+	     << nsPerOp(stats,poolStats::insertOp,overhead)
+	     << setw(10) << nsPerOp(stats,poolStats::removeOp,overhead)
+	     << setw(8) << setprecision(2) << poolFraction;
+	if (nprocs > 1)
+	  {
+	    if (par.searches > 0)
+	      cout << setw(12) << (long) (par.bounded/par.searches)
+		   << setw(12) << (long) rate(par)
+		   << setw(12) << setprecision(3)
+		   << (serial.seconds/serial.searches)/
+		      (nprocs*par.seconds/par.searches);
+	    else
+	      cout << setw(12) << "-" << setw(12) << "-" << setw(12) << "-";
+	  }
+	cout << setprecision(6) << endl;
+
+	// Every search must reach the same optimum, to within the
+	// default tolerances
+
+	double values[] = { serial.value, timedRun.value, par.value };
+	int    numValues = (par.searches > 0) ? 3 : 2;
+	if (!haveRef)
+	  {
+	    reference = serial.value;
+	    haveRef   = true;
+	  }
+	for (int i=0; i<numValues; i++)
+	  if (fabs(values[i] - reference) > 1e-6*max(1.0,fabs(reference)))
+	    {
+	      cout << "ERROR: " << pools[p].name << '/' << handlerNames[h]
+		   << " found " << values[i] << ", expected " << reference
+		   << endl;
+	      agree = false;
+	    }
+      }
+
+#ifdef ACRO_HAVE_MPI
+  if (nprocs > 1)
+    {
+      int flag = ok;
+      MPI_Bcast(&flag,1,MPI_INT,0,MPI_COMM_WORLD);
+      ok = flag;
+      CommonIO::end();
+    }
+  uMPI::done();
+#endif
+
+  return (ok && agree) ? 0 : 1;
+}
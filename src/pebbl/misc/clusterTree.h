@@ -91,6 +91,64 @@ public:
 
 };
 
+
+// A blockTree of cluster leaders: hubs at level l of the tree head
+// aligned blocks of radix^l consecutive clusters.
+
+class blockClusterTree : public blockTree
+{
+private:
+  
+  clusterObj* cluster;
+
+  int clusterNumberOf(int where)
+    {
+      int whereCluster = cluster->whichCluster(where);
+#ifdef ACRO_VALIDATING
+      if (where != cluster->leaderOfCluster(whereCluster))
+	EXCEPTION_MNGR(std::runtime_error,"Cluster tree finding address of non-leader");
+#endif
+      return whereCluster;
+    };
+ 
+public:
+
+  int currentChild()
+    {
+      return cluster->leaderOfCluster(blockTree::currentChild());
+    };
+
+  int parent()
+    {
+      return cluster->leaderOfCluster(blockTree::parent());
+    };
+
+  int advanceChild()
+    {
+      return cluster->leaderOfCluster(blockTree::advanceChild());
+    };
+
+  int validChild(int where)
+    {
+      return blockTree::validChild(clusterNumberOf(where));
+    };
+
+  int whichChild(int where)
+    {
+      return blockTree::whichChild(clusterNumberOf(where));
+    };
+
+  blockClusterTree(clusterObj& cluster_,
+		   int radix_) :
+  blockTree(radix_,
+	    cluster_.clusterNumber,
+	    cluster_.numClusters
+	    ),
+  cluster(&cluster_)
+    { };
+
+};
+
 } // namespace pebbl
 
 #endif
@@ -37,11 +37,14 @@ using namespace utilib;
 namespace pebbl {
 
 
-PM_LCG  gRandomLCG(1);
-Uniform gRandom(&gRandomLCG);
+// Thread-local so that threaded serial search (numThreads > 1) gives
+// each thread its own generator.
 
+thread_local PM_LCG  gRandomLCG(1);
+thread_local Uniform gRandom(&gRandomLCG);
 
-seed_t randomSeed=1;
+
+size_t randomSeed=1;
 
 
 RNG* gRandomRNG() {return &gRandomLCG;}
@@ -28,7 +28,7 @@ namespace pebbl {
 
 
 utilib::RNG*    gRandomRNG();
-extern utilib::Uniform gRandom;
+extern thread_local utilib::Uniform gRandom;   // One stream per thread
 extern size_t randomSeed;
 
 // The following commented-out code is the functionality we want.
@@ -36,7 +36,7 @@ extern size_t randomSeed;
 
 // void gRandomReSeed(int seed=(int) randomSeed(),int processorVariation=1);
 
-void gRandomReSeed(int seed, int processorVariation=1);
+void gRandomReSeed(utilib::seed_t seed, bool processorVariation=true);
 
 void gRandomReSeed();
 
@@ -21,6 +21,11 @@
 #include <pebbl/utilib/CommonIO.h>
 #include <pebbl/misc/memUtil.h>
 
+#include <cstdio>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
 #ifdef COUGAR
 
 // removed extern after talking w/ WEH
@@ -96,6 +101,30 @@ void memUtil::trackPrint(const char* string)
 #endif
 
 
+// Resident memory, for code that wants to react to memory pressure.
+// On Linux this is the resident set size from /proc; elsewhere we
+// fall back on memUtil if it is available.
+
+double residentMemoryMB()
+{
+#if defined(__linux__)
+  long pages = 0, resident = 0;
+  FILE* statm = fopen("/proc/self/statm","r");
+  if (!statm)
+    return -1;
+  int got = fscanf(statm,"%ld %ld",&pages,&resident);
+  fclose(statm);
+  if (got != 2)
+    return -1;
+  return resident*(sysconf(_SC_PAGESIZE)/(1024.0*1024.0));
+#elif defined(MEMUTIL_PRESENT)
+  return memUtil::inUse();
+#else
+  return -1;
+#endif
+}
+
+
 //
 // Here is the code for the small chunk allocator.
 //
@@ -83,6 +83,11 @@ protected:
 #endif
 
 
+/// Resident memory of this process in megabytes, or a negative number
+/// if it cannot be determined on this platform.
+double residentMemoryMB();
+
+
 #ifdef MEMORY_TRACKING
 #define MEMORY_IF(i) \
    if ((memUtil::memTrack() > 0) && \
@@ -0,0 +1,233 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// spillFile.cpp
+//
+// Scratch file for data that has been moved out of memory.
+//
+
+#include <pebbl_config.h>
+#include <pebbl/utilib/exception_mngr.h>
+#include <pebbl/misc/spillFile.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PEBBL_SPILL_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace pebbl {
+
+
+spillFile::spillFile(const string& dir_) :
+  dir(dir_),
+  fd(-1),
+  stream(NULL),
+  end(0),
+  maxEnd(0),
+  used(0),
+  fileLength(0)
+{ }
+
+
+spillFile::~spillFile()
+{
+#ifdef PEBBL_SPILL_MMAP
+  if (fd >= 0)
+    close(fd);
+#endif
+  if (stream)
+    fclose(stream);
+}
+
+
+// First fit from the released extents, or else the end of the file
+
+size_t spillFile::allocate(size_t length)
+{
+  used += length;
+  map<size_t,size_t>::iterator it;
+  for (it = freeExtents.begin(); it != freeExtents.end(); it++)
+    if (it->second >= length)
+      {
+	size_t offset   = it->first;
+	size_t leftOver = it->second - length;
+	freeExtents.erase(it);
+	if (leftOver > 0)
+	  freeExtents[offset + length] = leftOver;
+	return offset;
+      }
+  size_t offset = end;
+  end   += length;
+  maxEnd = max(maxEnd,end);
+  return offset;
+}
+
+
+void spillFile::release(size_t offset,size_t length)
+{
+  if (length == 0)
+    return;
+  used -= length;
+
+  map<size_t,size_t>::iterator it =
+    freeExtents.insert(make_pair(offset,length)).first;
+
+  map<size_t,size_t>::iterator next = it;
+  next++;
+  if ((next != freeExtents.end()) && (next->first == offset + length))
+    {
+      it->second += next->second;
+      freeExtents.erase(next);
+    }
+
+  if (it != freeExtents.begin())
+    {
+      map<size_t,size_t>::iterator prev = it;
+      prev--;
+      if (prev->first + prev->second == it->first)
+	{
+	  prev->second += it->second;
+	  freeExtents.erase(it);
+	  it = prev;
+	}
+    }
+
+  // Give the tail of the file back
+
+  if (it->first + it->second == end)
+    {
+      end = it->first;
+      freeExtents.erase(it);
+      if (fileLength > 2*end)
+	setLength(end);
+    }
+}
+
+
+void spillFile::clear()
+{
+  freeExtents.clear();
+  end  = 0;
+  used = 0;
+  setLength(0);
+}
+
+
+void spillFile::open()
+{
+#ifdef PEBBL_SPILL_MMAP
+  string path = dir;
+  if (path.empty())
+    {
+      const char* tmp = getenv("TMPDIR");
+      path = tmp ? tmp : "/tmp";
+    }
+  path += "/pebblSpillXXXXXX";
+  char* name = new char[path.size() + 1];
+  strcpy(name,path.c_str());
+  fd = mkstemp(name);
+  if (fd >= 0)
+    unlink(name);
+  delete[] name;
+  if (fd < 0)
+    EXCEPTION_MNGR(runtime_error,"Cannot create spill file " << path);
+#else
+  stream = tmpfile();
+  if (!stream)
+    EXCEPTION_MNGR(runtime_error,"Cannot create spill file");
+#endif
+}
+
+
+void spillFile::setLength(size_t length)
+{
+#ifdef PEBBL_SPILL_MMAP
+  if ((fd >= 0) && (ftruncate(fd,length) != 0))
+    EXCEPTION_MNGR(runtime_error,"Cannot resize spill file to "
+		   << length << " bytes");
+#endif
+  fileLength = length;
+}
+
+
+#ifdef PEBBL_SPILL_MMAP
+
+// Map just the pages that hold the extent
+
+namespace {
+
+char* mapExtent(int fd,size_t offset,size_t length,int prot,
+		void*& base,size_t& mapLength)
+{
+  static const size_t pageSize = sysconf(_SC_PAGESIZE);
+  size_t start = offset - offset % pageSize;
+  mapLength = offset + length - start;
+  base = mmap(NULL,mapLength,prot,MAP_SHARED,fd,start);
+  if (base == MAP_FAILED)
+    EXCEPTION_MNGR(runtime_error,"Cannot map " << length
+		   << " bytes of spill file at offset " << offset);
+  return (char*) base + (offset - start);
+}
+
+} // namespace
+
+#endif
+
+
+void spillFile::write(size_t offset,const char* data,size_t length)
+{
+  if (length == 0)
+    return;
+  if ((fd < 0) && !stream)
+    open();
+#ifdef PEBBL_SPILL_MMAP
+  if (offset + length > fileLength)
+    setLength(offset + length);
+  void*  base;
+  size_t mapLength;
+  memcpy(mapExtent(fd,offset,length,PROT_READ | PROT_WRITE,base,mapLength),
+	 data,length);
+  munmap(base,mapLength);
+#else
+  if ((fseek(stream,offset,SEEK_SET) != 0) ||
+      (fwrite(data,1,length,stream) != length))
+    EXCEPTION_MNGR(runtime_error,"Cannot write " << length
+		   << " bytes to spill file at offset " << offset);
+#endif
+}
+
+
+void spillFile::read(size_t offset,char* data,size_t length)
+{
+  if (length == 0)
+    return;
+#ifdef PEBBL_SPILL_MMAP
+  void*  base;
+  size_t mapLength;
+  memcpy(data,mapExtent(fd,offset,length,PROT_READ,base,mapLength),length);
+  munmap(base,mapLength);
+#else
+  if ((fseek(stream,offset,SEEK_SET) != 0) ||
+      (fread(data,1,length,stream) != length))
+    EXCEPTION_MNGR(runtime_error,"Cannot read " << length
+		   << " bytes from spill file at offset " << offset);
+#endif
+}
+
+} // namespace pebbl
@@ -0,0 +1,88 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+
+/**
+ * \file spillFile.h
+ *
+ * Scratch file for data that has been moved out of memory.  Space is
+ * handed out in extents; released extents are merged with their
+ * neighbors and reused, and the file shrinks when its tail is freed.
+ * On POSIX systems the file is unlinked as soon as it is created and
+ * extents are read and written through memory mappings; elsewhere a
+ * temporary stdio file is used.
+ */
+
+#ifndef pebbl_spillFile_h
+#define pebbl_spillFile_h
+
+#include <pebbl_config.h>
+
+#include <cstdio>
+#include <map>
+#include <string>
+
+namespace pebbl {
+
+
+class spillFile
+{
+public:
+
+  /// The file is created in dir_ (or the system temporary directory if
+  /// dir_ is empty) the first time anything is written.
+  spillFile(const std::string& dir_ = "");
+
+  ~spillFile();
+
+  /// Reserve length bytes and return their offset.
+  size_t allocate(size_t length);
+
+  /// Give back an extent obtained from allocate().
+  void release(size_t offset,size_t length);
+
+  void write(size_t offset,const char* data,size_t length);
+
+  void read(size_t offset,char* data,size_t length);
+
+  /// Forget all extents.
+  void clear();
+
+  /// Bytes in extents that have not been released
+  size_t inUse() const { return used; };
+
+  /// Current length of the file, and the most it has ever been
+  size_t fileSize() const { return end; };
+  size_t maxFileSize() const { return maxEnd; };
+
+protected:
+
+  std::string dir;
+
+  int         fd;
+  std::FILE*  stream;
+
+  size_t end;
+  size_t maxEnd;
+  size_t used;
+  size_t fileLength;
+
+  // Released extents, by offset
+
+  std::map<size_t,size_t> freeExtents;
+
+  void open();
+  void setLength(size_t length);
+
+};
+
+} // namespace pebbl
+
+#endif
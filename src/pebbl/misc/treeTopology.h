@@ -29,6 +29,7 @@
 #ifdef ACRO_HAVE_MPI
 
 #include <pebbl/utilib/math_basic.h>
+#include <vector>
 
 namespace pebbl {
 
@@ -38,7 +39,8 @@ namespace pebbl {
 ///
 /// treeTopology is an abstract class for handling trees of processors.
 /// nAryTree is a derived class describing a balanced tree with arbitrary
-/// root and radix.
+/// root and radix.  blockTree is a tree rooted at 0 in which every
+/// subtree is a contiguous block of nodes.
 ///
 class treeTopology 
 {
@@ -168,6 +170,107 @@ public:
 };
 
 
+///
+/// A tree on nodes 0..size-1, rooted at 0, in which the subtree of each
+/// node is a contiguous block.  A node whose number is a multiple of
+/// radix^l but not radix^(l+1) is at level l, and its subtree is the
+/// block of radix^l nodes starting at it; the root's level is the
+/// smallest l with radix^l >= size.  The children of a node at level l
+/// are node + t*radix^j for j < l and 0 < t < radix, in increasing
+/// order, so the children at levels below any j come first.  Each block
+/// of radix^j nodes starting at a multiple of radix^j is therefore the
+/// subtree of its first node, cut off below level j.
+///
+class blockTree : public treeTopology
+{
+
+protected:
+
+  int radix;
+  int nodeLevel;
+  int count;
+  std::vector<int> kids;
+
+public:
+
+  int numChildren()  { return kids.size(); };
+  int childrenLeft() { return count; };
+  int currentChild() { return kids[kids.size() - count]; };
+
+  void resetChildren() { count = kids.size(); };
+
+  int advanceChild() { return kids[kids.size() - count--]; };
+
+  int parent() { return node - node % blockSize(nodeLevel + 1); };
+
+  int validChild(int where) { return blockTree::whichChild(where) >= 0; };
+
+  int whichChild(int where)
+    {
+      for (size_t i=0; i<kids.size(); i++)
+	if (kids[i] == where)
+	  return i;
+      return -1;
+    };
+
+  // Level of this node, and of the root.
+
+  int level() { return nodeLevel; };
+
+  int numLevels()
+    {
+      int l = 0;
+      while (blockSize(l) < size)
+	l++;
+      return l;
+    };
+
+  int blockSize(int l)
+    {
+      int b = 1;
+      for (int i=0; i<l; i++)
+	b *= radix;
+      return b;
+    };
+
+  // How many children lie in this node's block at level l, that is,
+  // are below level l.
+
+  int childrenBelowLevel(int l)
+    {
+      int n = 0;
+      while ((n < (int) kids.size()) && (kids[n] - node < blockSize(l)))
+	n++;
+      return n;
+    };
+
+  blockTree(int radix_,
+	    int node_,
+	    int size_) :
+  treeTopology(0,node_,size_),
+  radix(radix_)
+    {
+      if (node == 0)
+	nodeLevel = numLevels();
+      else
+	{
+	  nodeLevel = 0;
+	  while (node % blockSize(nodeLevel + 1) == 0)
+	    nodeLevel++;
+	}
+      for (int j=0; j<nodeLevel; j++)
+	for (int t=1; t<radix; t++)
+	  {
+	    int c = node + t*blockSize(j);
+	    if (c < size)
+	      kids.push_back(c);
+	  }
+      resetChildren();
+    };
+
+};
+
+
 } // namespace pebbl
 
 #endif
@@ -0,0 +1,531 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// computeThread.cpp
+//
+// Operating-system threads that bound subproblems for a parallel worker.
+//
+
+#include <pebbl_config.h>
+#include <pebbl/pbb/computeThread.h>
+
+#ifdef ACRO_HAVE_MPI
+
+#include <pebbl/utilib/mpiUtil.h>
+#include <pebbl/misc/gRandom.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+
+using namespace std;
+
+namespace pebbl {
+
+
+  // Simplification of worker debug output.
+
+#define WORKERDEBUG(level,action)  if (workerDebug >= level) { action; }
+
+
+// The thread object for the calling thread, if any
+
+static thread_local computeThread* runningThread = NULL;
+
+
+computeThread* computeThread::current()
+{
+  return runningThread;
+}
+
+
+computeThread::computeThread(parallelBranching* global_,int threadNum_) :
+  threadNum(threadNum_),
+  spsProcessed(0),
+  global(global_),
+  currentSP(NULL),
+  busy(false),
+  currentBound(0)
+{
+  handler = makeHandler();
+}
+
+
+computeThread::~computeThread()
+{
+  delete handler;
+}
+
+
+parSPHandler* computeThread::makeHandler()
+{
+  computeSPHandler* h;
+  if (global->lazyBounding)
+    h = new computeLazyHandler;
+  else if (global->eagerBounding)
+    h = new computeEagerHandler;
+  else
+    h = new computeHybridHandler;
+  h->setThread(this);
+  return h;
+}
+
+
+// Main loop for one thread.  Mirrors parallelBranching::processSubproblem.
+
+void computeThread::run()
+{
+  runningThread = this;
+
+  gRandomReSeed(randomSeed + 7919*threadNum);
+
+  try
+    {
+      while (takeWork())
+	{
+	  if (currentSP->canFathom())
+	    eraseCurrentSP();
+	  else
+	    {
+	      DEBUGPR(10,ucout << "Compute thread " << threadNum
+		      << " looking at " << currentSP << '\n');
+	      handler->execute();
+	      spsProcessed++;
+	      if (currentSP && !(currentSP->forceStayCurrent()))
+		unloadCurrentSPtoPool();
+	    }
+	}
+    }
+  catch (...)
+    {
+      error = std::current_exception();
+      std::lock_guard<std::mutex> lock(global->workerMutex);
+      global->callMainThread();
+    }
+
+  if (currentSP)
+    unloadCurrentSPtoPool();
+
+  // List items are cached per thread; free this thread's cache before
+  // it exits.
+
+  utilib::CachedAllocator<utilib::ListItem<parallelBranchSub*> >::
+    delete_unused();
+
+  runningThread = NULL;
+}
+
+
+// Wait for a subproblem while a slice is open, and take it from the
+// worker pool.  Returns false when the thread should stop.  A
+// subproblem that must stay current is simply kept.
+
+bool computeThread::takeWork()
+{
+  std::unique_lock<std::mutex> lock(global->workerMutex);
+  if (error)
+    return false;
+  if (currentSP)
+    return !global->computeStop;
+
+  for (;;)
+    {
+      if (global->computeStop)
+	return false;
+      if (global->computeSliceOpen &&
+	  (global->workerPool->size() > 0) &&
+	  !global->suspending())
+	break;
+      global->endSliceIfDone();
+      global->computeWake.wait(lock);
+    }
+
+  parallelBranchSub* p = global->workerPool->remove();
+  currentBound = p->bound;
+  busy         = true;
+  global->computeSPCount++;
+  lock.unlock();
+
+  loadCurrentSP(p);
+  return true;
+}
+
+
+void computeThread::loadCurrentSP(parallelBranchSub* p)
+{
+  currentSP   = p;
+  currentSPId = p->id;
+  p->makeCurrentEffect();
+}
+
+
+void computeThread::unloadCurrentSP()
+{
+  previousSPId = currentSPId;
+  currentSP->noLongerCurrentEffect();
+  currentSP = NULL;
+}
+
+
+void computeThread::eraseCurrentSP()
+{
+  if (!currentSP)                // Already released
+    return;
+  parallelBranchSub* p = currentSP;
+  unloadCurrentSP();
+  std::lock_guard<std::mutex> lock(global->workerMutex);
+  global->workerDisposeSP(p);
+  busy = false;
+  global->computeSPCount--;
+  global->endSliceIfDone();
+}
+
+
+void computeThread::unloadCurrentSPtoPool()
+{
+  parallelBranchSub* p = currentSP;
+  unloadCurrentSP();
+  std::lock_guard<std::mutex> lock(global->workerMutex);
+  global->workerPool->insert(p);
+  busy = false;
+  global->computeSPCount--;
+  global->endSliceIfDone();
+}
+
+
+// Bound without the lock, using up to what is left of the slice's
+// work quota, and charge the work to the slice.
+
+void computeThread::computeBound(parallelBranchSub* p)
+{
+  double control;
+  {
+    std::lock_guard<std::mutex> lock(global->workerMutex);
+    control = std::max(1.0,global->computeWorkLimit - global->computeWorkUsed);
+  }
+#ifdef EVENT_LOGGING_THREAD_SAFE
+  UTILIB_LOG_EVENTX(global,1,start,global->boundLogState);
+#endif
+  p->computeBound(&control);
+#ifdef EVENT_LOGGING_THREAD_SAFE
+  UTILIB_LOG_EVENTX(global,1,end,global->boundLogState);
+#endif
+  std::lock_guard<std::mutex> lock(global->workerMutex);
+  global->computeWorkUsed += control;
+  global->endSliceIfDone();
+}
+
+
+// Release a whole subproblem, which this thread no longer works on,
+// to the worker's hub.  If the hub message is full, wait for the main
+// thread to send it.  Disposing of the subproblem in the same
+// critical section puts it in the server pool before the main thread
+// can be asked to deliver it.  wasCurrent says the subproblem was
+// taken from the pool, and so is in computeSPCount.
+//
+// The handler decided to release p without the mutex.  A better
+// incumbent may have come since, and the main thread may already have
+// pruned the server pool for it.  A fathomable subproblem put there
+// now would never be pruned (its token dies at the hub), and would
+// stay in the server pool until the search object is destroyed.  So
+// test p again here, where the incumbent cannot change.
+
+void computeThread::release(parallelBranchSub* p,bool wasCurrent)
+{
+  std::unique_lock<std::mutex> lock(global->workerMutex);
+  while (!global->iAmHub() &&
+	 (global->releaseProbCount >= global->maxTokensInHubMsg) &&
+	 !global->computeStop)
+    {
+      global->callMainThread();
+      global->computeWake.wait(lock);
+    }
+  if (!global->computeStop && !p->canFathom())
+    global->workerRelease(p,self,1,global->myHub());
+  global->workerDisposeSP(p);
+  if (wasCurrent)
+    {
+      busy = false;
+      global->computeSPCount--;
+      global->endSliceIfDone();
+    }
+}
+
+
+//  Compute thread handler methods
+
+
+bool computeSPHandler::shouldRelease()
+{
+  std::lock_guard<std::mutex> lock(pGlobal->workerMutex);
+  return pGlobal->workerShouldRelease();
+}
+
+
+// Make the child, then release it whole, rather than releasing a
+// token that points into the subproblem this thread is working on.
+
+void computeSPHandler::releaseChild()
+{
+  getChild();
+  if (pc->canFathom())
+    eraseChild();
+  else
+    thread->release(pc);
+}
+
+
+void computeSPHandler::insertChild()
+{
+  std::lock_guard<std::mutex> lock(pGlobal->workerMutex);
+  pGlobal->workerPool->insert(pc);
+  pGlobal->computeWake.notify_one();
+}
+
+
+void computeSPHandler::eraseChild()
+{
+  if (childReleased)
+    {
+      childReleased = false;
+      return;
+    }
+  std::lock_guard<std::mutex> lock(pGlobal->workerMutex);
+  pGlobal->workerDisposeSP(pc);
+}
+
+
+void computeSPHandler::releaseSP(parallelBranchSub* sp,int whichChild)
+{
+  if (whichChild != self)
+    {
+      sp = sp->parallelChild(whichChild);
+      thread->release(sp);
+      return;
+    }
+
+  if (sp != thread->currentSP)
+    {
+      childReleased = (sp == pc);
+      thread->release(sp);
+      return;
+    }
+
+  thread->unloadCurrentSP();
+  thread->release(sp,true);
+}
+
+
+void computeSPHandler::feedIncumbentThread(parallelBranchSub* sp)
+{
+  std::lock_guard<std::mutex> lock(pGlobal->workerMutex);
+  sp->feedToIncumbentThread();
+}
+
+
+//  Compute thread methods of the parallel branching class
+
+
+bool parallelBranching::canUseComputeThreads()
+{
+  if (computeThreads <= 0)
+    return false;
+
+  const char* reason = NULL;
+  if (enumerating)
+    reason = "enumeration";
+  else if (valLogOutput())
+    reason = "validation logging";
+  else if (checkpointMinutes > 0)
+    reason = "checkpointing";
+  else if (uMPI::threadLevel() < MPI_THREAD_FUNNELED)
+    reason = "an MPI library without thread support";
+
+  if (reason)
+    {
+      if (iDoSearchIO && !suppressWarnings)
+	{
+	  CommonIO::end_tagging();
+	  ucout << "****** Warning ******** computeThreads ignored with "
+		<< reason << ".\n";
+	  CommonIO::begin_tagging();
+	}
+      return false;
+    }
+
+  return iAmWorker();
+}
+
+
+// Called by the main thread after ramp-up.  From here on the
+// scheduler holds workerMutex only while it polls and runs its threads.
+
+void parallelBranching::startComputeThreads()
+{
+  DEBUGPR(1,ucout << "Starting " << computeThreads << " compute threads\n");
+
+  threadSetup(computeThreads + 1);
+
+  computeSPCount          = 0;
+  computeSliceOpen        = false;
+  computeWorkLimit        = 0;
+  computeWorkUsed         = 0;
+  computeAttention        = false;
+  computeIncumbentPending = false;
+  computeStop             = false;
+  countersShared          = true;
+
+  sched.setRunLock(&workerMutex);
+
+  computeThreadObjs.resize(computeThreads);
+  for (int i=0; i<computeThreads; i++)
+    computeThreadObjs[i] = new computeThread(this,i + 1);
+  for (int i=0; i<computeThreads; i++)
+    computeThreadObjs[i]->osThread =
+      std::thread(&computeThread::run,computeThreadObjs[i]);
+}
+
+
+void parallelBranching::stopComputeThreads()
+{
+  if (!usingComputeThreads())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(workerMutex);
+    computeStop = true;
+  }
+  computeWake.notify_all();
+
+  for (size_type i=0; i<computeThreadObjs.size(); i++)
+    computeThreadObjs[i]->osThread.join();
+
+  sched.setRunLock(NULL);
+  countersShared = false;
+
+  for (size_type i=0; i<computeThreadObjs.size(); i++)
+    {
+      DEBUGPR(1,ucout << "Compute thread " << i + 1 << ": "
+	      << computeThreadObjs[i]->spsProcessed
+	      << " subproblems processed\n");
+      delete computeThreadObjs[i];
+    }
+  computeThreadObjs.resize(0);
+}
+
+
+// The worker's share of the scheduler: let the compute threads take
+// work until the slice is done or timeSlice has passed, then take care
+// of whatever they could not do themselves.  Work they finish between
+// slices is charged to the next one.
+
+void parallelBranching::computeSlice()
+{
+  computeWorkLimit = workLeft;
+  computeAttention = false;
+  computeSliceOpen = true;
+  endSliceIfDone();
+  computeWake.notify_all();
+
+  schedulerWake.wait_for(sched.runGuard(),
+			 std::chrono::duration<double>(timeSlice),
+			 [this] { return !computeSliceOpen; });
+  computeSliceOpen = false;
+
+  workUsed  = computeWorkUsed;
+  workLeft -= workUsed;
+  computeWorkUsed = 0;
+
+  WORKERDEBUG(40,ucout << "Compute slice: work " << workUsed
+	      << ", " << computeSPCount << " subproblems in threads, pool "
+	      << workerPool->size() << '\n');
+
+  for (size_type i=0; i<computeThreadObjs.size(); i++)
+    if (computeThreadObjs[i]->error)
+      std::rethrow_exception(computeThreadObjs[i]->error);
+
+  if (computeIncumbentPending)
+    {
+      computeIncumbentPending = false;
+      UTILIB_LOG_EVENT(1,start,foundIncLogState);
+      announceIncumbent();
+    }
+
+  pruneIfNeeded();
+
+  if (!iAmHub() && (releaseProbCount >= maxTokensInHubMsg))
+    workerCommunicateWithHub();
+}
+
+
+// Caller must hold workerMutex.
+
+bool parallelBranching::computeSliceDone()
+{
+  return computeAttention ||
+    (computeWorkUsed >= computeWorkLimit) ||
+    ((computeSPCount == 0) &&
+     ((workerPool->size() == 0) || suspending()));
+}
+
+
+void parallelBranching::endSliceIfDone()
+{
+  if (computeSliceOpen && computeSliceDone())
+    {
+      computeSliceOpen = false;
+      schedulerWake.notify_one();
+    }
+}
+
+
+void parallelBranching::callMainThread()
+{
+  computeAttention = true;
+  endSliceIfDone();
+}
+
+
+// The subproblems the compute threads are working on, at the bounds
+// they had when taken from the pool.  Caller must hold workerMutex.
+
+void parallelBranching::addComputeThreadLoad(loadObject& l)
+{
+  for (size_type i=0; i<computeThreadObjs.size(); i++)
+    if (computeThreadObjs[i]->busy)
+      l.addLoad(computeThreadObjs[i]->currentBound,1);
+}
+
+
+std::mutex* parallelBranching::incumbentLock()
+{
+  return computeThread::current() ? &workerMutex : NULL;
+}
+
+
+int parallelBranching::threadNum()
+{
+  computeThread* t = computeThread::current();
+  return t ? t->threadNum : branching::threadNum();
+}
+
+
+branchSubId& parallelBranching::lastSPId()
+{
+  computeThread* t = computeThread::current();
+  return t ? t->previousSPId : branching::lastSPId();
+}
+
+} // namespace pebbl
+
+#endif
@@ -0,0 +1,264 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+
+/**
+ * \file computeThread.h
+ *
+ * Operating-system threads that bound subproblems for a parallel
+ * worker (computeThreads > 0).  After ramp-up, each worker processor
+ * starts computeThreads of these.  They take subproblems from the
+ * shared workerPool and run a handler on them.  The processor's main
+ * thread keeps running the scheduler, and so does all the MPI
+ * communication and hub work.
+ *
+ * workerMutex guards the shared worker state (the pool, the server
+ * pool, the release buffer, the incumbent).  It is the scheduler's run
+ * lock: the main thread holds it while it polls for messages and
+ * while it runs a scheduler thread or checks one's state, since those
+ * reach into that state all over (and compute threads may recycle MPI
+ * send buffers, which must not overlap an MPI_Testsome).  It drops the
+ * mutex while it idles and while it waits in
+ * parallelBranching::computeSlice, which is what the worker "thread"
+ * does in place of processing subproblems itself.  Compute threads take
+ * the mutex only to touch shared state, and drop it while bounding and
+ * splitting.  They take new subproblems only while a slice is open,
+ * but can finish the ones they hold while the main thread idles.  A
+ * slice ends when the threads have used the work quota, when
+ * timeSlice has passed, when a compute thread needs the main thread (a
+ * new incumbent to broadcast, a full hub message), or when there is
+ * nothing left to do.
+ *
+ * Compute threads never make tokens that point into a subproblem they
+ * are still working on: a child chosen for release is made first and
+ * then released whole, and released subproblems go to the worker's
+ * own hub.
+ */
+
+#ifndef pebbl_computeThread_h
+#define pebbl_computeThread_h
+
+#include <pebbl_config.h>
+#include <pebbl/pbb/parBranching.h>
+
+#ifdef ACRO_HAVE_MPI
+
+#include <exception>
+#include <thread>
+
+
+namespace pebbl {
+
+
+class computeThread : public pebblBase, public parallelPebblBase
+{
+  friend class parallelBranching;
+  friend class computeSPHandler;
+
+public:
+
+  REFER_DEBUG(global)
+
+  computeThread(parallelBranching* global_,int threadNum_);
+
+  virtual ~computeThread();
+
+  // The computeThread running on the calling thread, or NULL.
+
+  static computeThread* current();
+
+  // Numbered from 1; the main thread is 0.
+
+  int threadNum;
+
+  int spsProcessed;
+
+protected:
+
+  parallelBranching* global;
+
+  parSPHandler* handler;
+
+  parallelBranchSub* currentSP;
+  branchSubId        currentSPId;
+  branchSubId        previousSPId;
+
+  // Bound of currentSP when it was taken from the pool, used for the
+  // load.  Guarded by workerMutex.
+
+  bool   busy;
+  double currentBound;
+
+  std::exception_ptr error;
+
+  std::thread osThread;
+
+  void run();
+
+  bool takeWork();
+
+  void loadCurrentSP(parallelBranchSub* p);
+  void unloadCurrentSP();
+  void eraseCurrentSP();
+  void unloadCurrentSPtoPool();
+
+  void computeBound(parallelBranchSub* p);
+  void release(parallelBranchSub* p,bool wasCurrent = false);
+
+  parSPHandler* makeHandler();
+};
+
+
+// Handler mix-in for compute threads.  Subproblem traffic goes through
+// the compute thread, which takes workerMutex where needed.
+
+class computeSPHandler : virtual public parSPHandler
+{
+ public:
+
+  computeSPHandler() : childReleased(false) { };
+
+  virtual ~computeSPHandler() { };
+
+  void setThread(computeThread* thread_)
+    {
+      thread = thread_;
+      setPGlobal(thread_->global);
+    };
+
+ protected:
+
+  computeThread* thread;
+
+  // Set when the eager bounding code releases the current child, which
+  // is then no longer ours to erase.
+
+  bool childReleased;
+
+  void setProblem()    { pp = thread->currentSP;  p = pp; };
+  void erase()         { thread->eraseCurrentSP();        };
+  bool shouldRelease();
+  void releaseChild();
+  void insertChild();
+  void eraseChild();
+
+  void boundOperation(parallelBranchSub* sp) { thread->computeBound(sp); };
+
+  void releaseSP(parallelBranchSub* sp,int whichChild);
+
+  void feedIncumbentThread(parallelBranchSub* sp);
+
+};
+
+
+class computeLazyHandler :
+  virtual public computeSPHandler,
+  virtual public parLazyHandler
+{
+ public:
+
+  void execute() { lazyHandler::execute(); };
+
+ protected:
+
+  void setProblem()    { computeSPHandler::setProblem();           };
+  void erase()         { computeSPHandler::erase();                };
+  bool shouldRelease() { return computeSPHandler::shouldRelease(); };
+  void releaseChild()  { computeSPHandler::releaseChild();         };
+  void insertChild()   { computeSPHandler::insertChild();          };
+  void eraseChild()    { computeSPHandler::eraseChild();           };
+
+  void boundOperation(parallelBranchSub* sp)
+    {
+      computeSPHandler::boundOperation(sp);
+    };
+  void releaseSP(parallelBranchSub* sp,int whichChild)
+    {
+      computeSPHandler::releaseSP(sp,whichChild);
+    };
+  void feedIncumbentThread(parallelBranchSub* sp)
+    {
+      computeSPHandler::feedIncumbentThread(sp);
+    };
+
+};
+
+
+class computeHybridHandler :
+  virtual public computeSPHandler,
+  virtual public parHybridHandler
+{
+ public:
+
+  void execute() { hybridHandler::execute(); };
+
+ protected:
+
+  void setProblem()    { computeSPHandler::setProblem();           };
+  void erase()         { computeSPHandler::erase();                };
+  bool shouldRelease() { return computeSPHandler::shouldRelease(); };
+  void releaseChild()  { computeSPHandler::releaseChild();         };
+  void insertChild()   { computeSPHandler::insertChild();          };
+  void eraseChild()    { computeSPHandler::eraseChild();           };
+
+  void boundOperation(parallelBranchSub* sp)
+    {
+      computeSPHandler::boundOperation(sp);
+    };
+  void releaseSP(parallelBranchSub* sp,int whichChild)
+    {
+      computeSPHandler::releaseSP(sp,whichChild);
+    };
+  void feedIncumbentThread(parallelBranchSub* sp)
+    {
+      computeSPHandler::feedIncumbentThread(sp);
+    };
+
+};
+
+
+class computeEagerHandler :
+  virtual public computeSPHandler,
+  virtual public parEagerHandler
+{
+ public:
+
+  void execute() { eagerHandler::execute(); };
+
+ protected:
+
+  void setProblem()    { computeSPHandler::setProblem();           };
+  void erase()         { computeSPHandler::erase();                };
+  bool shouldRelease() { return computeSPHandler::shouldRelease(); };
+  void releaseChild()  { computeSPHandler::releaseChild();         };
+  void insertChild()   { computeSPHandler::insertChild();          };
+  void eraseChild()    { computeSPHandler::eraseChild();           };
+
+  void boundOperation(parallelBranchSub* sp)
+    {
+      computeSPHandler::boundOperation(sp);
+    };
+  void releaseSP(parallelBranchSub* sp,int whichChild)
+    {
+      computeSPHandler::releaseSP(sp,whichChild);
+    };
+  void feedIncumbentThread(parallelBranchSub* sp)
+    {
+      computeSPHandler::feedIncumbentThread(sp);
+    };
+
+};
+
+
+} // namespace pebbl
+
+#endif
+
+#endif
@@ -0,0 +1,52 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// cpWriter.cpp
+//
+// This thread finishes asynchronous checkpoints in the background.
+//
+
+#include <pebbl_config.h>
+#include <pebbl/pbb/parBranching.h>
+
+#ifdef ACRO_HAVE_MPI
+
+using namespace std;
+
+namespace pebbl {
+
+
+cpWriterObj::cpWriterObj(parallelBranching* global_) :
+parBranchingThreadObj(global_,
+		      "Checkpoint Writer",
+		      "CP Write",
+		      "SlateBlue",
+		      3,100)
+{ }
+
+
+ThreadObj::RunStatus cpWriterObj::runWithinLogging(double* /*controlParam*/)
+{
+  global->advanceAsyncCheckpoint();
+  return RunOK;
+}
+
+
+ThreadObj::ThreadState cpWriterObj::state()
+{
+  if (global->asyncCheckpointReady())
+    return ThreadReady;
+  return ThreadBlocked;
+}
+
+} // namespace pebbl
+
+#endif
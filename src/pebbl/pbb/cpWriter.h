@@ -0,0 +1,51 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+
+/**
+ * \file cpWriter.h
+ *
+ * This thread moves an asynchronous checkpoint (asyncCheckpoint) along
+ * once the search no longer needs to: it notices when the background
+ * writer has finished the file, starts the reduction that tells every
+ * processor all files are written, and finishes the checkpoint when
+ * that completes.  It runs on every processor, and is blocked whenever
+ * there is nothing to do.
+ */
+
+#ifndef pebbl_cpWriter_h
+#define pebbl_cpWriter_h
+
+#include <pebbl_config.h>
+
+#include <pebbl/pbb/parBranchThreads.h>
+
+
+#ifdef ACRO_HAVE_MPI
+
+namespace pebbl {
+
+
+class cpWriterObj : public parBranchingThreadObj
+{
+public:
+
+  cpWriterObj(parallelBranching* global_);
+
+  RunStatus runWithinLogging(double* controlParam);
+
+  ThreadState state();
+};
+
+} // namespace pebbl
+
+#endif
+
+#endif
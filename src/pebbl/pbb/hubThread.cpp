@@ -43,7 +43,9 @@ messageTriggeredPBThread(global_,
 			 2,100,
 			 computeBufferSize(global_),
 			 global_->hubTag)
-{ }
+{
+  ringSlots = global_->recvRingSlots;
+}
 
 
 // Sizing the input buffer is a little complicated here.
@@ -38,22 +38,24 @@ incumbCastObj::incumbCastObj(parallelBranching* global_) :
 		    "Inc Bcast",
 		    "cyan",
 		    1,30,
-		    sizeof(double) + sizeof(int),
+		    2*sizeof(double) + sizeof(int),
 		    global_->incumbCastTag,
-		    global_->incumbTreeRadix),
-  minOrMax(global->sense)     // (for efficiency later).
+		    global_->incumbTreeRadix)
 { }
 
 
 // Run method.  This is only invoked if a message arrives.  Check that
 // it improves on the current incumbent, and if so, relay it down
-// the tree.
+// the tree.  With rmaIncumbent, we may already have read it from the
+// window; relay it anyway, since our part of the tree may not have.
 
 bool incumbCastObj::unloadBuffer()
 {
   double value;
+  double foundTime;
   inBuf >> value;
   inBuf >> originator;
+  inBuf >> foundTime;
   DEBUGPR(20,ucout << "Incumbent message received from "
 	  << status.MPI_SOURCE 
 	  << ", value " 
@@ -63,28 +65,20 @@ bool incumbCastObj::unloadBuffer()
 	  << ", time="
 	  << MPI_Wtime() - global->baseTime
 	  << '\n');
-  if (((value - global->incumbentValue)*minOrMax < 0) ||
-      ((value == global->incumbentValue) &&
-       (originator < global->incumbentSource)))
+  bool alreadyHave = (value == global->incumbentValue) &&
+                     (originator == global->incumbentSource);
+  if (global->adoptIncumbent(value,originator))
+    global->incumbentFoundTime = foundTime;
+  else if (!alreadyHave || !global->rmaIncumbentUnrelayed)
     {
-      // The incumbent is better than one we already have; replace it.
-      global->resetIncumbent();
-      global->incumbentValue  = value;
-      global->newIncumbentEffect(value);
-      global->incumbentSource = originator;
-      global->needPruning     = true;
-      if (global->iAmHub())
-	      global->needHubPruning = true;
-      DEBUGPR(10,ucout << "Using new incumbent (" 
-	      << global->incumbentValue 
-	      << ',' 
-	      << global->incumbentSource
-	      << ")\n");
-       return true;
+      DEBUGPR(25,ucout << "Does not improve current incumbent.  "
+	      "Discarding.\n");
+      return false;
     }
-  else
-    DEBUGPR(25,ucout << "Does not improve current incumbent.  Discarding.\n");
-  return false;
+  global->rmaIncumbentUnrelayed = false;
+  global->treeIncumbentCount++;
+  global->treeIncumbentLatency += WallClockSeconds() - foundTime;
+  return true;
 }
 
 
@@ -95,6 +89,7 @@ void incumbCastObj::relayLoadBuffer(PackBuffer* buf)
 {
   *buf << global->incumbentValue;
   *buf << originator;
+  *buf << global->incumbentFoundTime;
 }
 
 
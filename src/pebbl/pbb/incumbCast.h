@@ -41,10 +41,6 @@ public:
   void relayLoadBuffer(PackBuffer* buf);
 
   void preExitAction();  // This thread has an exit action to activate the hub.
-  
-private:
-
-  optimType minOrMax;
 };
 
 }  // namespace pebbl
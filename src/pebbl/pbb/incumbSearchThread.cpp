@@ -54,8 +54,13 @@ ThreadObj::RunStatus incumbSearchObj::runWithinLogging(double* controlParam)
     return RunOK;
   global->parallelIncumbentHeuristic(controlParam);
   bias = global->incumbentThreadBias();
-  nextRunTime = CPUSeconds() + 
-    (global->incThreadGapSlices)*(global->timeSlice);
+  // When the scheduler may sleep between idle passes, use the wall
+  // clock, since the CPU clock barely moves while it sleeps
+  if (global->idleSleepMax > 0)
+    nextRunTime = WallClockSeconds();
+  else
+    nextRunTime = CPUSeconds();
+  nextRunTime += (global->incThreadGapSlices)*(global->timeSlice);
   return RunOK;
 };
 
@@ -64,7 +69,9 @@ ThreadObj::RunStatus incumbSearchObj::runWithinLogging(double* controlParam)
 
 ThreadObj::ThreadState incumbSearchObj::state()
 {
-  if (global->suspending() || (CPUSeconds() < nextRunTime))
+  double now = (global->idleSleepMax > 0) ? CoarseWallClockSeconds()
+                                           : CoarseCPUSeconds();
+  if (global->suspending() || (now < nextRunTime))
     return ThreadObj::ThreadBlocked;
   return global->incumbentHeuristicState();
 };
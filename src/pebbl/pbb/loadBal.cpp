@@ -85,12 +85,14 @@ void loadBalSurvey::rootAction()
   global->logTransition();
   global->setHubBusyFractions();
   global->statusPrint(lastPrint,lastPrintTime,load,"g");
-  if (global->shouldAbort(load.boundedSPs))
+  if (global->shouldAbort(load.boundedSPs) || global->checkpointAbortDue())
     global->setupAbort();
   else if ((load.count() > 0) && global->checkpointDue())
     global->setupCheckpoint();
   outBuf << load << global->aborting;
-  if (global->checkpointsEnabled)
+  if (global->usingAsyncCheckpoints)
+    outBuf << global->checkpointNumber;
+  else if (global->checkpointsEnabled)
     outBuf << global->checkpointing;
 }
 
@@ -105,7 +107,14 @@ void loadBalSurvey::downReceiveAction()
   DEBUGPR(160,global->globalLoad.dump(ucout,"globalLoad"));
   if (abDown && !(global->aborting))
     global->setupAbort();
-  if (global->checkpointsEnabled)
+  if (global->usingAsyncCheckpoints)
+    {
+      int cpDown = 0;
+      inBuf >> cpDown;
+      DEBUGPR(160,ucout << "cpDown=" << cpDown << endl);
+      global->startAsyncCheckpoint(cpDown);
+    }
+  else if (global->checkpointsEnabled)
     {
       bool cpDown = false;
       inBuf >> cpDown;
@@ -117,13 +126,19 @@ void loadBalSurvey::downReceiveAction()
     {
       outBuf.reset();
       outBuf << global->globalLoad << global->aborting;
-      if (global->checkpointsEnabled)
+      if (global->usingAsyncCheckpoints)
+  outBuf << global->checkpointNumber;
+      else if (global->checkpointsEnabled)
   outBuf << global->checkpointing;
     }
 }
 
 
 // Code for coTree that counts donors/receivers and numbers them.
+// With hub levels, the numbers only run over this round's block.  The
+// up sweep still counts whole subtrees, each block's first hub counts
+// its block on the side, and in the down sweep it numbers its block
+// from that count instead of from what its parent sent.
 
 // Constructor.
 
@@ -165,12 +180,18 @@ void loadBalCount::upRelayAction()
   DEBUGPR(150,ucout << "Up Relay Subtree: " << clusterCount << endl);
   upBuf[0] = clusterCount.donors;
   upBuf[1] = clusterCount.receivers;
+
+  blockCount = balThread->eligible;
+  int n = blockChildren();
+  for (int i=0; i<n; i++)
+    blockCount += childCount[i];
+  DEBUGPR(150,ucout << "Block count: " << blockCount << endl);
 };
 
 void loadBalCount::rootAction()
 {
-  balThread->total = clusterCount;
-  subTreeCount     = clusterCount;
+  balThread->total = blockCount;
+  subTreeCount     = blockCount;
   DEBUGPR(150,ucout << "Root Total: " << balThread->total << endl);
   DEBUGPR(150,ucout << "Root Subtree: " << subTreeCount << endl);
 }
@@ -181,6 +202,11 @@ void loadBalCount::downReceiveAction()
   balThread->total.receivers = downBuf[1];
   subTreeCount.donors        = downBuf[2];
   subTreeCount.receivers     = downBuf[3];
+  if (iAmBlockRoot())
+    {
+      balThread->total = blockCount;
+      subTreeCount     = blockCount;
+    }
   DEBUGPR(150,ucout << "Down Recv Total: " << balThread->total << endl);
   DEBUGPR(150,ucout << "Down Recv Subtree: " << subTreeCount.donors << endl);
 }
@@ -198,7 +224,23 @@ void loadBalCount::downRelayLoopAction(int i)
   childBuf[i][2] = subTreeCount.donors;
   childBuf[i][3] = subTreeCount.receivers;
 
-  subTreeCount -= childCount[i];
+  if (i < blockChildren())
+    subTreeCount -= childCount[i];
+}
+
+
+int loadBalCount::blockChildren()
+{
+  if (balThread->hubTree)
+    return balThread->hubTree->childrenBelowLevel(balThread->blockLevel);
+  return t->numChildren();
+}
+
+
+bool loadBalCount::iAmBlockRoot()
+{
+  return balThread->hubTree && 
+         (balThread->hubTree->level() >= balThread->blockLevel);
 }
 
 
@@ -218,10 +260,10 @@ coTreeReadyPBThread(global_,
         "blue",
         2,150),
 
-tree(global_->cluster, global_->loadBalTreeRadix),
-surveyObject(this,&tree),
-countObject(this,&tree),
-termCheckObject(this,&tree),
+tree(makeTree(global_)),
+surveyObject(this,tree),
+countObject(this,tree),
+termCheckObject(this,tree),
 receiverLoad(global_),
 lbRandom(1),
 bufferSize(computeBufferSize()),
@@ -237,11 +279,42 @@ termChecks(0)
 {
   myState    = start;
   myCluster  = global->clusterNumber();
+  hubTree    = dynamic_cast<blockClusterTree*>(tree);
+  blockLevel = hubTree ? hubTree->numLevels() : 0;
+  blockStart = 0;
   state_flag = ThreadReady;               // Make sure ready to start (?)
   outBufQ.reset(1,bufferSize);
 }
 
 
+// The hub tree: a blockTree of hubs if hub levels are wanted, and
+// otherwise a balanced tree with radix loadBalTreeRadix.
+
+treeTopology* loadBalObj::makeTree(parallelBranching* global_)
+{
+  if (global_->hubLevelRadix >= 2)
+    return new blockClusterTree(global_->cluster,global_->hubLevelRadix);
+  return new nAryClusterTree(global_->cluster,global_->loadBalTreeRadix);
+}
+
+
+// Pick this round's level, cycling from the smallest blocks up to the
+// whole tree, and find the block containing this cluster.  Every hub
+// counts rounds the same way, so they all pick the same level.
+
+void loadBalObj::chooseBlock()
+{
+  if (!hubTree)
+    return;
+  blockLevel = 1 + (roundNumber - 1) % hubTree->numLevels();
+  int size   = hubTree->blockSize(blockLevel);
+  blockStart = myCluster - myCluster % size;
+  DEBUGPR(50,ucout << "Round " << roundNumber << " balances level " 
+	  << blockLevel << ", block of " << size << " starting at cluster "
+	  << blockStart << '\n');
+}
+
+
 //  Auxiliary method used in construction.  Figure out the largest 
 //  Possible input buffer we'll need.
 
@@ -296,7 +369,7 @@ bool loadBalObj::canStart()
 
   DEBUGPR(300,ucout << "Multi-hub canStart check\n");
 
-  if (!tree.isLeaf())             // Otherwise, only leaves control the rate
+  if (!tree->isLeaf())            // Otherwise, only leaves control the rate
     return true;
 
   DEBUGPR(300,ucout << "Not leaf\n");
@@ -319,7 +392,7 @@ bool loadBalObj::canStart()
       return true;
     }
 
-  double wTime = WallClockSeconds();
+  double wTime = CoarseWallClockSeconds();
   double gap   = global->loadBalSeconds;
   if (surveyRestartFlag || !global->clusterLoad.busy())
     gap = gap / global->loadBalIdleIncrease;
@@ -530,8 +603,15 @@ ThreadObj::RunStatus loadBalObj::runWithinLogging(double* controlParam)
         jumpState(startIdleCheck);
       }
 
+    // With work stealing, idle workers fetch their own work, and the
+    // survey only serves to detect termination.
+
+    if (global->workStealing)
+      jumpState(start);
+
     global->decideLoadBalAvailability(eligible);
     DEBUGPR(50,ucout << "Eligible: " << eligible << '\n');
+    chooseBlock();
 
     myState = counting;
     
@@ -550,14 +630,24 @@ ThreadObj::RunStatus loadBalObj::runWithinLogging(double* controlParam)
     lbPairs = std::min(total.donors,total.receivers);
     DEBUGPR(50,ucout << lbPairs 
       << " possible load balancing pairs.\n");
-    if (lbPairs == 0)
+
+    if ((lbPairs == 0) && !hubTree)
       jumpState(start);
 
     {
-      int offset     = lbRandom.asLong() % total.donors;
+      // With a block tree, draw the offsets even if there are no
+      // pairs, so the random streams of all hubs stay in step when
+      // they are in blocks with different numbers of pairs.
+
+      long donorOffset    = lbRandom.asLong();
+      long receiverOffset = lbRandom.asLong();
+      if (lbPairs == 0)
+        jumpState(start);
+
+      int offset     = donorOffset % total.donors;
       DEBUGPR(200,ucout << "offset=" << offset << '\n');
       myID.donors    = (myID.donors + offset) % total.donors;
-      offset         = lbRandom.asLong() % total.receivers;
+      offset         = receiverOffset % total.receivers;
       DEBUGPR(200,ucout << "offset=" << offset << '\n');
       myID.receivers = (myID.receivers + offset) % total.receivers;
       DEBUGPR(50,ucout << "myID: " << myID << '\n');
@@ -565,7 +655,7 @@ ThreadObj::RunStatus loadBalObj::runWithinLogging(double* controlParam)
 
     iAmDonor    = eligible.donors    && (myID.donors    < lbPairs);
     iAmReceiver = eligible.receivers && (myID.receivers < lbPairs);
-    iAmRVPoint  = myCluster < lbPairs;
+    iAmRVPoint  = myCluster - blockStart < lbPairs;
 
 #ifdef ACRO_VALIDATING
     if (iAmDonor)
@@ -592,7 +682,7 @@ ThreadObj::RunStatus loadBalObj::runWithinLogging(double* controlParam)
     // Donor processors must now send their address to the rendezvous
     // point.  If that is the same processor we're on, it's trivial.
 
-    if (myID.donors == myCluster)
+    if (blockStart + myID.donors == myCluster)
       {
         donorProc = myRank();
         DEBUGPR(150,ucout << "Donor is rendezvous point.\n");
@@ -600,11 +690,11 @@ ThreadObj::RunStatus loadBalObj::runWithinLogging(double* controlParam)
     else
       {
         DEBUGPR(150,ucout << "Sending null message to ["
-          << global->hubProc(myID.donors) << "].\n");
+          << global->hubProc(blockStart + myID.donors) << "].\n");
         isend((void*) &myID,      // This address does not matter
         0,                  // Envelope-only message!
         MPI_PACKED,
-        global->hubProc(myID.donors),
+        global->hubProc(blockStart + myID.donors),
         donorRVTag);
       }
     myState = receiverInfo;
@@ -619,7 +709,7 @@ ThreadObj::RunStatus loadBalObj::runWithinLogging(double* controlParam)
     // Receiver processors now send there addressed to the rendezvous
     // point too.  Again, this might be trivial.
 
-    if (myID.receivers == myCluster)
+    if (blockStart + myID.receivers == myCluster)
       {
         receiverProc = myRank();
         receiverLoad = global->clusterLoad;
@@ -630,11 +720,11 @@ ThreadObj::RunStatus loadBalObj::runWithinLogging(double* controlParam)
         PackBuffer* outBufP = outBufQ.getFree();
         *outBufP << global->clusterLoad;
         outBufQ.send(outBufP,
-         global->hubProc(myID.receivers),
+         global->hubProc(blockStart + myID.receivers),
          receiverRVTag);
         DEBUGPR(150,ucout << "Send load " << 
           global->clusterLoad << " to ["
-          << global->hubProc(myID.receivers) << "].\n");
+          << global->hubProc(blockStart + myID.receivers) << "].\n");
       }
     myState = rendezvous;
 
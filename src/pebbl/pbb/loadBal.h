@@ -116,8 +116,15 @@ private:
   loadBalPair             clusterCount;
   BasicArray<loadBalPair> childCount;
   loadBalPair             subTreeCount;
+  loadBalPair             blockCount;
   loadBalObj*             balThread;
 
+  // Children in this round's block, which come first
+
+  int blockChildren();
+
+  bool iAmBlockRoot();
+
   IntVector upBuf;
   IntVector downBuf;
   Basic2DArray<int> childBuf;
@@ -169,6 +176,8 @@ public:
 
   loadBalObj(parallelBranching* global_);
 
+  virtual ~loadBalObj() { delete tree; };
+
   // Cancel the pending messages
 
   void cancelComm() { outBufQ.clear(); }
@@ -194,6 +203,7 @@ public:
     };
 
   int numRounds()          { return roundNumber;     };
+  int numHubLevels()       { return hubTree ? hubTree->numLevels() : 1; };
   int numSurveyRestarts()  { return surveyRestarts;  };
   int numQuiescencePolls() { return quiescencePolls; };
   int numTermChecks()      { return termChecks;      };
@@ -232,11 +242,19 @@ private:
   
   loadBalState myState;
 
-  // Tree information
+  // Tree information.  With hubLevelRadix >= 2, hubTree points to the
+  // same tree, and each round pairs donors and receivers only within
+  // the blocks of one level of that tree.  The blocks are hubTree
+  // subtrees cut off below blockLevel, and the one holding this
+  // cluster starts at blockStart.  Otherwise hubTree is NULL and the
+  // whole tree is one block.
 
-  nAryClusterTree tree;
+  treeTopology*     tree;
+  blockClusterTree* hubTree;
 
   int myCluster;
+  int blockLevel;
+  int blockStart;
 
   // Secondary state machines used for tree-of-clusters operations.
 
@@ -300,6 +318,8 @@ private:
   // Functions used within the class.
 
   int  computeBufferSize();
+  treeTopology* makeTree(parallelBranching* global_);
+  void chooseBlock();
   bool canStart();
   void waitToReceive(MessageID& tag_);
   int  subproblemsProcessed();
@@ -112,7 +112,11 @@ messageTriggeredPBThread::messageTriggeredPBThread(parallelBranching* global_,
 parBranchingThreadObj(global_,name_,shortName,logColor,logLevel_,dbgLevel_),
 bufferSize(uMPI::packSlop(bufferSize_)),
 inBuf(new char[bufferSize],bufferSize,1),
-sender(sender_)
+sender(sender_),
+ringSlots(1),
+ringHead(0),
+ringReceived(0),
+ringWaiting(0)
 {
   request_posted=false;
   tag = tag_;
@@ -122,6 +126,14 @@ sender(sender_)
 }
 
 
+messageTriggeredPBThread::~messageTriggeredPBThread()
+{
+  cancelComm();
+  for (size_t i=0; i<ringBuf.size(); i++)
+    delete[] ringBuf[i];
+}
+
+
 void messageTriggeredPBThread::postRequest()
 {
   irecv((void *) inBuf.buf(),
@@ -136,6 +148,56 @@ void messageTriggeredPBThread::postRequest()
 }
 
 
+// Make and start the ring of persistent receives.  The scheduler
+// watches the slot at the head of the ring.
+
+void messageTriggeredPBThread::startRing()
+{
+  ringBuf.resize(ringSlots);
+  ringRequest.resize(ringSlots);
+  for (int i=0; i<ringSlots; i++)
+    {
+      ringBuf[i] = new char[bufferSize];
+      recvInit((void *) ringBuf[i],
+	       bufferSize,
+	       MPI_PACKED,
+	       sender,
+	       tag,
+	       &(ringRequest[i]));
+      uMPI::start(&(ringRequest[i]));
+    }
+  ringHead = 0;
+  request  = ringRequest[ringHead];
+  DEBUGPR(100,ucout << name << " thread started " << ringSlots
+	  << " receives for tag " << tag << endl);
+  request_posted=true;
+}
+
+
+// Restart the slot just handled, which puts it at the back of the
+// matching order, and move on to the next one.
+
+void messageTriggeredPBThread::restartSlot()
+{
+  uMPI::start(&(ringRequest[ringHead]));
+  ringHead = (ringHead + 1) % ringSlots;
+  request  = ringRequest[ringHead];
+  ringReceived++;
+}
+
+
+void messageTriggeredPBThread::cancelRing()
+{
+  for (int i=0; i<ringSlots; i++)
+    {
+      MPI_Request slotRequest = ringRequest[i];
+      uMPI::killRecvRequest(&slotRequest);
+      uMPI::requestFree(&(ringRequest[i]));
+    }
+  request = MPI_REQUEST_NULL;
+}
+
+
 // This code runs when a message-triggered thread is activated.
 // Gobble and process as many messages as possible, not just the one
 // that caused the thread to be invoked.  There may be many more messages that 
@@ -145,21 +207,31 @@ void messageTriggeredPBThread::postRequest()
 
 // Note that the inBuf.reset call resets InBuf so that its read limit 
 // is the exact length of the message (as gleaned from the status object).
+// With a receive ring, inBuf is pointed at the slot's buffer first.
 
 ThreadObj::RunStatus 
 messageTriggeredPBThread::runWithinLogging(double* controlParam)
 {
   RunStatus returnStatus;
+  bool      another;
 
   do
     {
       DEBUGPR(100,ucout << name << " thread processing message\n");
       messagesReceived++;
+      if (ringSlots > 1)
+	inBuf.setup(ringBuf[ringHead],bufferSize);
       inBuf.reset(&status);
       returnStatus = handleMessage(controlParam);
-      postRequest();
+      if (ringSlots > 1)
+	restartSlot();
+      else
+	postRequest();
+      another = uMPI::test(&request,&status);
+      if (another && (ringSlots > 1))
+	ringWaiting++;
     }
-  while(uMPI::test(&request,&status));
+  while(another);
 
   DEBUGPR(100,ucout << name << " thread done processing messages\n");
 
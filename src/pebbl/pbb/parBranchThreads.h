@@ -31,6 +31,8 @@
 #include <pebbl/comm/coTree.h>
 #include <pebbl/comm/outBufferQ.h>
 
+#include <vector>
+
 
 #ifdef ACRO_HAVE_MPI                     // Compile to stub if no MPI.
 
@@ -240,6 +242,15 @@ public:
 //  The code used to be duplicated all over the place prior to January 1999.
 //  Enhanced to try to devour multiple messages at a time.
 
+//  A derived class may set ringSlots above 1 before startup.  The
+//  thread then keeps that many persistent receives (MPI_Recv_init)
+//  started at once, each with its own buffer, so that messages arriving
+//  while one is being handled go straight into a buffer rather than into
+//  MPI's queue of unexpected messages.  MPI matches receives in the
+//  order they were started, and the slots are handled in that order.
+//  The buffers never grow, so ringSlots should only be set for tags
+//  whose messages have a known maximum size.
+
 class messageTriggeredPBThread : public parBranchingThreadObj
 {
 public:
@@ -257,22 +268,34 @@ public:
 
   void startup() 
     { 
-      postRequest();
+      if (ringSlots > 1)
+	startRing();
+      else
+	postRequest();
       state_flag = ThreadWaiting;
     };
 
   virtual void cancelComm()
 	{
 	if (request_posted) {
-           uMPI::killRecvRequest(&request);
+	   if (ringSlots > 1)
+	      cancelRing();
+	   else
+              uMPI::killRecvRequest(&request);
 	   request_posted = false;
 	   }
 	};
 
-  virtual ~messageTriggeredPBThread() { cancelComm(); };
+  virtual ~messageTriggeredPBThread();
 
   size_t sizeOfBuffer() { return bufferSize; };
 
+  // Messages received through the ring, and how many of those had
+  // already arrived when the one before them was done.
+
+  int ringMessages()     { return ringReceived; };
+  int ringWaitingCount() { return ringWaiting;  };
+
 protected:
 
   RunStatus runWithinLogging(double* controlParam);
@@ -283,10 +306,21 @@ protected:
 
   void postRequest();
 
+  void startRing();
+  void restartSlot();
+  void cancelRing();
+
   size_t       bufferSize;
   UnPackBuffer inBuf;
   int          sender;
   bool         request_posted;
+
+  int                      ringSlots;
+  int                      ringHead;
+  std::vector<char*>       ringBuf;
+  std::vector<MPI_Request> ringRequest;
+  int                      ringReceived;
+  int                      ringWaiting;
 };  
 
 
@@ -50,6 +50,11 @@ void parallelBranching::reset(bool VBFlag)
 
   branching::reset(VBFlag);
 
+  // Load objects size their bound histograms from this
+
+  loadHistBins  = (boundHistBins >= 2) ? boundHistBins : 0;
+  hubHistCutoff = -1;
+
   // Make sure we know how big a token is
 
   spToken::computePackSize();
@@ -91,6 +96,27 @@ void parallelBranching::reset(bool VBFlag)
   rebalanceCount   = 0;
   myHubsRebalCount = 0;
 
+  stealPending      = false;
+  stealFailures     = 0;
+  stealDormantRound = 0;
+  stealRequestCount = 0;
+  stealRefusedCount = 0;
+  spStolenCount     = 0;
+
+  ownerDispatchCount  = 0;
+  nodeDispatchCount   = 0;
+  remoteDispatchCount = 0;
+  spBytesMoved        = 0;
+  spBytesMovedInNode  = 0;
+
+  incumbentFoundTime    = 0;
+  usingRMAIncumbent     = false;
+  rmaIncumbentUnrelayed = false;
+  treeIncumbentCount    = 0;
+  rmaIncumbentCount     = 0;
+  treeIncumbentLatency  = 0;
+  rmaIncumbentLatency   = 0;
+
   messagesReceivedThisProcessor = 0;
   totalMessages                 = 0;
   preprocessMessages            = 0;
@@ -169,6 +195,12 @@ void parallelBranching::reset(bool VBFlag)
       spReceiver = NULL;
     }
 
+  if (stealServer)
+    {
+      delete stealServer;
+      stealServer = NULL;
+    }
+
   if (earlyOutputter)
     {
       delete earlyOutputter;
@@ -193,12 +225,22 @@ void parallelBranching::reset(bool VBFlag)
       llChainer = NULL;
     }
 
+  if (cpWriter)
+    {
+      delete cpWriter;
+      cpWriter = NULL;
+    }
+
   threadsList.clear();
 
-  // Set up cluster tracking
+  // Set up cluster tracking.  Work stealing needs every processor to
+  // be a one-processor cluster whose hub also works.
 
-  cluster.reset(searchRank, searchSize, clusterSize, numClusters, 
-		hubsDontWorkSize);
+  if (workStealing)
+    cluster.reset(searchRank, searchSize, 1, searchSize, 2);
+  else
+    cluster.reset(searchRank, searchSize, clusterSize, numClusters, 
+		  hubsDontWorkSize);
 
   // Initialize outgoing buffer objects
   // Hold two tokens and two acks
@@ -207,6 +249,8 @@ void parallelBranching::reset(bool VBFlag)
 
   workerOutQ.reset(3,hubMessageSize(2,2));  
 
+  stealRequestQ.reset(2,sizeof(int));
+
   // Initialize stuff to do with scattering
 
   DEBUGPR(20,ucout << "hubLoadFac=" << hubLoadFac 
@@ -260,6 +304,16 @@ void parallelBranching::reset(bool VBFlag)
   else if ( breadthFirst )
     workerPool =   // queue
       new doublyLinkedPool<parallelBranchSub,parLoadObject>(false);
+  else if ( boundBuckets )
+    workerPool =
+      new bucketPool<parallelBranchSub,parLoadObject>(bucketWidth);
+  else if ( pressurePlunge )
+    workerPool =
+      new plungePool<parallelBranchSub,parLoadObject>(plungeSPLimit,
+						      plungeMemoryMB,
+						      plungeResumeFraction);
+  else if ( arrayHeap )
+    workerPool = new arrayHeapPool<parallelBranchSub,parLoadObject>();
   else             // heap
     workerPool = new heapPool<parallelBranchSub,parLoadObject,
       DynamicSPCompare<parallelBranchSub> >();
@@ -304,6 +358,10 @@ void parallelBranching::reset(bool VBFlag)
       else if ( breadthFirst )
       	hubPool = 
 	  new doublyLinkedPool<spToken,parLoadObject>(false);  //queue
+      else if ( boundBuckets )
+	hubPool = new bucketPool<spToken,parLoadObject>(bucketWidth);
+      else if ( arrayHeap )
+	hubPool = new arrayHeapPool<spToken,parLoadObject>();
       else
 	hubPool = 
 	  new heapPool<spToken,parLoadObject,DynamicSPCompare<spToken> >();
@@ -422,6 +480,13 @@ void parallelBranching::reset(bool VBFlag)
   checkpointing      = false;
   checkpointNumber   = 0;
   restartCPNum       = 0;
+  restartFileCount   = 0;
+
+  usingAsyncCheckpoints = checkpointsEnabled && canUseAsyncCheckpoints();
+  asyncCPStage          = asyncCPIdle;
+  asyncCPPosted         = 0;
+  asyncCPPending        = false;
+  asyncCPLastDone       = 0;
 
   // Clear abort flag
 
@@ -583,6 +648,7 @@ parallelBranching::parallelBranching(MPI_Comm comm_) :
   mySearchIoProc(-1),
   currentParSP(NULL),
   workerOutQ(&searchComm),           // All buffer queues need communicator
+  stealRequestQ(&searchComm),
   deliverSPBuffers(&searchComm),     //   information.  We supply a pointer to
   auxDeliverSPQ(&searchComm),        //   the search communicator, which will
   dispatchSPBuffers(&searchComm),    //   be set up later
@@ -606,10 +672,12 @@ parallelBranching::parallelBranching(MPI_Comm comm_) :
   loadBalancer      = NULL;
   spServer          = NULL;
   spReceiver        = NULL;
+  stealServer       = NULL;
   earlyOutputter    = NULL;
   reposReceiver     = NULL;
   reposMerger       = NULL;
   llChainer         = NULL;
+  cpWriter          = NULL;
 
   workerOutBuffer   = NULL;
 
@@ -619,7 +687,13 @@ parallelBranching::parallelBranching(MPI_Comm comm_) :
 
   handler = NULL;
 
-  numRefSols = 0;
+  computeSPCount          = 0;
+  computeSliceOpen        = false;
+  computeWorkLimit        = 0;
+  computeWorkUsed         = 0;
+  computeAttention        = false;
+  computeIncumbentPending = false;
+  computeStop             = false;
 
   broadcastTime         = 0;
   broadcastWCTime       = 0;
@@ -662,6 +736,8 @@ void parallelBranching::setDebugLevelWithThreads(int level)
     spServer->setDebug(level);
   if (spReceiver)
     spReceiver->setDebug(level);
+  if (stealServer)
+    stealServer->setDebug(level);
   if (earlyOutputter)
     spReceiver->setDebug(level);
   if (reposReceiver)
@@ -670,6 +746,8 @@ void parallelBranching::setDebugLevelWithThreads(int level)
     reposMerger->setDebug(level);
   if (llChainer)
     reposMerger->setDebug(level);
+  if (cpWriter)
+    cpWriter->setDebug(level);
 }
 
 
@@ -700,6 +778,8 @@ parallelBranching::~parallelBranching()
      delete spServer;
   if (spReceiver)
      delete spReceiver;
+  if (stealServer)
+     delete stealServer;
   if (earlyOutputter) 
     delete earlyOutputter;
   if (reposReceiver)
@@ -708,6 +788,8 @@ parallelBranching::~parallelBranching()
     delete reposMerger;
   if (llChainer)
     delete llChainer;
+  if (cpWriter)
+    delete cpWriter;
 
   if (iAmWorker() && workerOutBuffer)
       delete workerOutBuffer;
@@ -787,6 +869,10 @@ double parallelBranching::parallelSearchFramework(parSPHandler* handler_)
 
   checkpointTriggerTime = baseWallTime + checkpointMinutes*60;
   checkpointTotalTime   = 0;
+#if MPI_VERSION >= 3
+  if (usingAsyncCheckpoints)
+    MPI_Comm_dup(searchComm.myComm(),&asyncCPComm);
+#endif
 
   DEBUGPR(300,ucout << "Preprocessing\n");
   double startPreprocessTime = CPUSeconds();
@@ -875,7 +961,23 @@ double parallelBranching::parallelSearchFramework(parSPHandler* handler_)
   if (rampUpPool > 0)
     {
       prepareCPAbort();
-      sched.execute();
+      if (canUseRMAIncumbent())
+	startRMAIncumbent();
+      if (localDispatch && (searchSize > 1))
+	findProcessorNodes();
+      if (canUseComputeThreads())
+	startComputeThreads();
+      try
+	{
+	  sched.execute();
+	}
+      catch (...)
+	{
+	  stopComputeThreads();
+	  throw;
+	}
+      stopComputeThreads();
+      stopRMAIncumbent();
     }
 
   // Clean up
@@ -893,8 +995,14 @@ double parallelBranching::parallelSearchFramework(parSPHandler* handler_)
 
   UTILIB_IF_LOGGING_EVENTS(1,finishEventLog(););
 
-  if (checkpointNumber > 0)
-    deleteCheckpointFile(checkpointNumber,searchRank);
+  // The abort checkpoint stays behind for a restart
+
+  if (usingAsyncCheckpoints)
+    finishAsyncCheckpoint();
+  int lastCheckpoint = usingAsyncCheckpoints ? asyncCPLastDone :
+                                               checkpointNumber;
+  if ((lastCheckpoint > 0) && (lastCheckpoint != cpAbortNum))
+    deleteCheckpointFile(lastCheckpoint,searchRank);
 
   if (validateLog)
     {
@@ -913,45 +1021,6 @@ double parallelBranching::parallelSearchFramework(parSPHandler* handler_)
 };
 
 
-// Register a solution representation (giving up ownership)
-
-size_type parallelBranching::registerFirstSolution(solution* referenceSolution)
-{
-  clearRegisteredSolutions();
-  return registerSolution(referenceSolution);
-}
-
-
-size_type parallelBranching::registerSolution(solution* referenceSolution)
-{
-  size_type id          = numRefSols++;
-  size_type currentSize = refSolArray.size();
-
-  if (numRefSols > currentSize)
-    refSolArray.resize(currentSize + refSolArrayQuantum);
-
-  refSolArray[id] = referenceSolution;
-  referenceSolution->typeId = id;
-  DEBUGPR(5,ucout << "Registered " 
-	  << referenceSolution->typeDescription()
-	  << " as having type " << id 
-	  << ", with buffer size " << referenceSolution->maxBufferSize()
-	  << endl);
-  return id;
-}
-
-
-// Clear the array of registered solutions
-
-void parallelBranching::clearRegisteredSolutions()
-{
-  DEBUGPR(5,ucout << "Clearing registered solutions\n");
-  for (size_type i=0; i<numRefSols; i++)
-    refSolArray[i]->dispose();
-  numRefSols = 0;
-}
-
-
 // To compute the maximum buffer size we need to receive a solution.
 // It's the maximum buffer size needed among all registed reference
 // solution.
@@ -971,28 +1040,13 @@ int parallelBranching::computeSolBufferSize()
 }
 
 
-// Unpack a solution by using typeId to index into the reference
-// solution array.
-
-solution* parallelBranching::unpackSolution(UnPackBuffer& inBuf)
-{
-  int typeId = -1;
-  inBuf >> typeId;
-  if ((typeId < 0) || ((unsigned) typeId >= numRefSols))
-    EXCEPTION_MNGR(runtime_error,"Unpacked solution type id "
-		   << typeId << " is out of range 0.." << numRefSols-1);
-  solution* sol = refSolArray[typeId]->blankClone();
-  sol->unpack(inBuf);
-  return sol;
-}
-
-
 // To create the scheduler object we need.
 
 void parallelBranching::initializeScheduler()
 {
   sched.reset();
   sched.setDebug(schedulerDebug);
+  sched.setIdleStrategy(idleSpinPolls,idleSleepMax);
   highPriorityGroup = sched.add(new ThreadQueue(round_robin));
   baseGroup         = sched.add(new ThreadQueue(time_weighted_priority));
   placeTasks();
@@ -1050,6 +1104,12 @@ void parallelBranching::placeTasks()
 
   loadBalancer = new loadBalObj(this);
   placeTask(loadBalancer,iAmHub(),highPriorityGroup);
+
+  if (workStealing)
+    {
+      stealServer = new stealServerObj(this);
+      placeTask(stealServer,iAmWorker(),highPriorityGroup);
+    }
   
   workerAux = new workerAuxObj(this);
   placeTask(workerAux,iAmWorker() && !iAmHub(),highPriorityGroup);
@@ -1073,11 +1133,18 @@ void parallelBranching::placeTasks()
 
   if ((loadLogSeconds > 0)      && 
       (loadLogWriteSeconds > 0) && 
+      !loadLogBinary            &&
       (searchSize > 1)    )
     {
       llChainer = new llChainObj(this);
       placeTask(llChainer,true,highPriorityGroup);
     }
+
+  if (usingAsyncCheckpoints)
+    {
+      cpWriter = new cpWriterObj(this);
+      placeTask(cpWriter,true,highPriorityGroup);
+    }
 }
 
 
@@ -1321,16 +1388,19 @@ void parallelBranching::rampUpSearch()
 
   workerPool->insert(makeParRoot());
 
-  while((spCount() > 0) && keepRampingUp())
-    {
-      processSubproblem();
-      if (searchRank == 0)
-	{
-	  loadObject lo = updatedPLoad();
-	  statusPrint(workerLastPrint,workerLastPrintTime,lo,"r");
-	  recordLoadLogIfNeeded();
-	}
-    }
+  if (canPartitionRampUp())
+    partitionedRampUpLoop();
+  else
+    while((spCount() > 0) && keepRampingUp())
+      {
+	processSubproblem();
+	if (searchRank == 0)
+	  {
+	    loadObject lo = updatedPLoad();
+	    statusPrint(workerLastPrint,workerLastPrintTime,lo,"r");
+	    recordLoadLogIfNeeded();
+	  }
+      }
 
   DEBUGPR(1,ucout << "Synchronous ramp-up loop complete.\n");
 
@@ -1342,6 +1412,12 @@ void parallelBranching::rampUpSearch()
   rampUpIncumbentSync();
 
   double aggBoundAtCrossover = workerPool->updatedLoad().aggregateBound;
+
+  // Every processor now has the same incumbent, and all loads are
+  // rebuilt below, so this is where the histogram bins get fixed.
+
+  if (loadHistBins > 0)
+    startBoundHistogram(aggBoundAtCrossover);
   
   // Now pick through the worker pools (all identical, WE HOPE)
   // and place all suproblems destined for this particular processor
@@ -1526,6 +1602,240 @@ void parallelBranching::rampUpSearch()
 }
 
 
+// Collective.  Fix the bound histogram bins: they start at the best
+// bound left in any processor's pool and span the gap to the
+// incumbent, or the magnitude of that bound if there is no incumbent.
+
+void parallelBranching::startBoundHistogram(double poolBound)
+{
+  double myBest = sense*poolBound;
+  double best   = MAXDOUBLE;
+  searchComm.reduceCast(&myBest,&best,1,MPI_DOUBLE,MPI_MIN);
+  rampUpMessages += (!iDoSearchIO);
+  if (best == MAXDOUBLE)
+    return;
+
+  loadHistOrigin = sense*best;
+  loadHistScale  = sense*(fathomValue() - loadHistOrigin);
+  if ((fathomValue() == sense*MAXDOUBLE) || !(loadHistScale > 0))
+    loadHistScale = std::max(fabs(loadHistOrigin),1.0);
+  loadHistActive = true;
+  DEBUGPR(2,ucout << "Bound histogram: " << loadHistBins << " bins from "
+	  << loadHistOrigin << ", scale " << loadHistScale << endl);
+}
+
+
+// Partitioned ramp-up needs more than one processor.  It does not
+// support the repository synchronization used when enumerating, or
+// applications that communicate while ramping up.
+
+bool parallelBranching::canPartitionRampUp()
+{
+  if (!partitionRampUp || (searchSize == 1))
+    return false;
+
+  if (enumerating || collectiveRampUp())
+    {
+      if (iDoSearchIO && !suppressWarnings)
+	{
+	  CommonIO::end_tagging();
+	  ucout << "****** Warning ******** partitionRampUp ignored with "
+		<< (enumerating ? "enumeration" : "this application")
+		<< ".\n";
+	  CommonIO::begin_tagging();
+	}
+      return false;
+    }
+
+  return true;
+}
+
+
+// The ramp-up loop for partitionRampUp.  The pools stay identical on
+// all processors, as in the replicated loop, but each pass takes the
+// whole pool as one level.  Subproblem i of the level is bounded and
+// split only by processor i mod searchSize, which then packs the
+// result (nothing if it was fathomed).  All processors exchange
+// their results, agree on the incumbent, and create every child of
+// the level locally, which keeps subproblem identifiers consistent.
+// Because this bypasses the handler, ramp-up bounding, splitting,
+// and incumbent heuristics must not communicate.
+
+void parallelBranching::partitionedRampUpLoop()
+{
+  DEBUGPR(1,ucout << "Partitioned ramp-up on " << searchSize 
+	  << " processors\n");
+
+  // State counts from the subproblems this processor handled itself.
+  // At the end, everyone adds in the counts from everyone else.
+
+  int ownCount[numStates];
+  for (int s=0; s<numStates; s++)
+    ownCount[s] = 0;
+
+  PackBuffer outBuf;
+  IntVector  gatherInfo(2*searchSize);
+  IntVector  byteCounts(searchSize);
+  IntVector  byteOffsets(searchSize);
+  BasicArray<char> gatherBuf;
+  BasicArray<parallelBranchSub*> level;
+
+  while((spCount() > 0) && keepRampingUp())
+    {
+      int levelSize = workerPool->size();
+      level.resize(levelSize);
+      for (int i=0; i<levelSize; i++)
+	level[i] = workerPool->remove();
+
+      DEBUGPR(10,ucout << "Ramp-up level of " << levelSize 
+	      << " subproblems\n");
+
+      // Work on this processor's share
+
+      int levelStart[numStates];
+      for (int s=0; s<numStates; s++)
+	levelStart[s] = subCount[s];
+
+      outBuf.reset();
+      for (int i=searchRank; i<levelSize; i+=searchSize)
+	{
+	  parallelBranchSub* sp = level[i];
+	  rampUpAdvance(sp);
+	  outBuf << i;
+	  if (sp->canFathom() || (sp->state != separated))
+	    {
+	      outBuf << 0;
+	      sp->recycle();
+	      level[i] = NULL;
+	    }
+	  else
+	    {
+	      outBuf << 1;
+	      sp->packProblem(outBuf);
+	    }
+	}
+
+      int levelCount[numStates];
+      for (int s=0; s<numStates; s++)
+	{
+	  levelCount[s] = subCount[s];
+	  ownCount[s]  += subCount[s] - levelStart[s];
+	}
+
+      // Exchange results.  The probCounter maximum is carried along so
+      // that the children get the same serial numbers everywhere.
+
+      int myInfo[2];
+      myInfo[0] = outBuf.size();
+      myInfo[1] = probCounter;
+      int ierr = MPI_Allgather(myInfo,2,MPI_INT,
+			       gatherInfo.data(),2,MPI_INT,
+			       searchComm.myComm());
+      if (ierr)
+	EXCEPTION_MNGR(runtime_error, "MPI_Allgather returned " << ierr);
+
+      int totalBytes   = 0;
+      int maxCounter   = probCounter;
+      for (int r=0; r<searchSize; r++)
+	{
+	  byteCounts[r]  = gatherInfo[2*r];
+	  byteOffsets[r] = totalBytes;
+	  totalBytes    += byteCounts[r];
+	  maxCounter     = std::max(maxCounter,gatherInfo[2*r + 1]);
+	}
+      gatherBuf.resize(std::max(totalBytes,1));
+
+      ierr = MPI_Allgatherv((void*) outBuf.buf(),outBuf.size(),MPI_PACKED,
+			    gatherBuf.data(),byteCounts.data(),
+			    byteOffsets.data(),MPI_PACKED,
+			    searchComm.myComm());
+      if (ierr)
+	EXCEPTION_MNGR(runtime_error, "MPI_Allgatherv returned " << ierr);
+      rampUpMessages += 2*(searchSize - 1);
+
+      // Replace the other processors' subproblems by their results
+
+      for (int r=0; r<searchSize; r++)
+	{
+	  if (r == searchRank)
+	    continue;
+	  UnPackBuffer inBuf(gatherBuf.data() + byteOffsets[r],
+			     byteCounts[r],
+			     false);
+	  inBuf.reset(byteCounts[r]);
+	  while(inBuf.curr() < (size_type) byteCounts[r])
+	    {
+	      int i     = -1;
+	      int alive = 0;
+	      inBuf >> i >> alive;
+	      level[i]->recycle();
+	      level[i] = NULL;
+	      if (alive)
+		{
+		  level[i] = blankParallelSub();
+		  level[i]->unpackProblem(inBuf);
+		}
+	    }
+	}
+
+      // Unpacking copies does not create or process anything
+
+      for (int s=0; s<numStates; s++)
+	subCount[s] = levelCount[s];
+      probCounter = maxCounter;
+
+      rampUpIncumbentSync();
+      pruneIfNeeded();
+
+      // Form the next level
+
+      for (int i=0; i<levelSize; i++)
+	{
+	  parallelBranchSub* sp = level[i];
+	  if (sp == NULL)
+	    continue;
+	  if (!sp->canFathom())
+	    while(sp->childrenLeft > 0)
+	      workerPool->insert(sp->parallelChild(anyChild));
+	  sp->recycle();
+	}
+
+      if (searchRank == 0)
+	{
+	  loadObject lo = updatedPLoad();
+	  statusPrint(workerLastPrint,workerLastPrintTime,lo,"r");
+	  recordLoadLogIfNeeded();
+	}
+    }
+
+  int allCount[numStates];
+  searchComm.reduceCast(ownCount,allCount,numStates,MPI_INT,MPI_SUM);
+  for (int s=0; s<numStates; s++)
+    subCount[s] += allCount[s] - ownCount[s];
+}
+
+
+// Bound and split one subproblem of a partitioned ramp-up level,
+// stopping if it can be fathomed.
+
+void parallelBranching::rampUpAdvance(parallelBranchSub* sp)
+{
+  while(!sp->canFathom() && 
+	((sp->state == boundable) || (sp->state == beingBounded)))
+    computeBound(sp);
+
+  if (sp->canFathom() || (sp->state != bounded))
+    return;
+
+  if (haveIncumbentHeuristic() && !sp->candidateSolution())
+    sp->incumbentHeuristic();
+
+  while(!sp->canFathom() && 
+	((sp->state == bounded) || (sp->state == beingSeparated)))
+    sp->splitProblem();
+}
+
+
 // JE -- this was looking identical to the code in branching::; try removing
 // void parallelBranching::solve()
 // {
@@ -1624,6 +1934,7 @@ parLoadObject parallelBranching::updatedPLoad()
   DEBUGPR(200,ucout << "updatedPLoad: pool load is " << l << endl);
   if (haveCurrentSP())
     l.addLoad(currentParSP->bound,1);
+  addComputeThreadLoad(l);
 
   DEBUGPR(200,ucout << "updatedPLoad: calculated " << l << endl);
 
@@ -1753,6 +2064,7 @@ loadObject parallelBranching::load()
   parLoadObject l = workerPool->load();
   if (haveCurrentSP())
     l += *currentParSP;
+  addComputeThreadLoad(l);
 
   return l;
 }
@@ -1768,6 +2080,7 @@ for(tptr=threadsList.head(); tptr; tptr=threadsList.next(tptr) )
   tptr->data()->cancelComm();
 
 workerOutQ.clear();
+stealRequestQ.clear();
 deliverSPBuffers.clear();
 auxDeliverSPQ.clear();
 dispatchSPBuffers.clear();
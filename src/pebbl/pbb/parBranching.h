@@ -44,15 +44,21 @@
 #include <pebbl/pbb/incumbCast.h>
 #include <pebbl/pbb/spReceiver.h>
 #include <pebbl/pbb/spServer.h>
+#include <pebbl/pbb/stealServer.h>
 #include <pebbl/pbb/loadBal.h>
 #include <pebbl/pbb/reposThreads.h>
 #include <pebbl/pbb/llChainer.h>
+#include <pebbl/pbb/cpWriter.h>
 #include <pebbl/misc/scatterObj.h>
 #include <pebbl/pbb/workerInHeap.h>
 #include <pebbl/pbb/reposArrayInHeap.h>
 #include <pebbl/pbb/packedSolution.h>
 #include <pebbl/misc/chunkAlloc.h>
 
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+
 
 // John S's magic so we don't need an operator= for GenericHeaps
 
@@ -75,6 +81,7 @@ using utilib::logEvent;
 class parallelBranchSub;  // Forward declarations.
 class spToken;
 class parSPHandler;
+class computeThread;
 
 
 // Extra class for parallel load logging
@@ -110,6 +117,12 @@ class parLoadLogRecord : public loadLogRecord
 		     double        baseTime, 
 		     int           proc = 0);
 
+  // Same for binary logs
+  void writeToRow(double* row,
+		  int     sense,
+		  double  baseTime,
+		  int     proc = 0);
+
   // Pack
   void pack(PackBuffer& pb);
 
@@ -163,11 +176,10 @@ public:
 
   virtual bool setup(int& argc, char**& argv);
 
-  // These are used to write application-dependent state when
-  // checkpointing
+  // Application-dependent checkpoint state is written and read by
+  // appCheckpointWrite() and appCheckpointRead() (see branching);
+  // this merges it when a reconfigure restart reads several files
 
-  virtual void appCheckpointWrite(PackBuffer& outBuf)  { };
-  virtual void appCheckpointRead(UnPackBuffer& inBuf)  { };
   virtual void appMergeGlobalData(UnPackBuffer& inBuf) { };
 
   // Printout methods
@@ -200,18 +212,12 @@ public:
   solution* nextRepositoryMember(int whichProcessor = allProcessors);
 
 
-  // Managing solutions
-
-  BasicArray<solution*> refSolArray;
-  size_type             numRefSols;
-  int                   solBufSize;
+  // Managing solutions (the reference solutions themselves are
+  // registered with branching)
 
-  int       computeSolBufferSize();
-  size_type registerFirstSolution(solution* referenceSolution);
-  size_type registerSolution(solution* referenceSolution);
-  void      clearRegisteredSolutions();
+  int solBufSize;
 
-  solution* unpackSolution(UnPackBuffer& inBuf);
+  int computeSolBufferSize();
 
   // To set up the scheduler.
 
@@ -246,7 +252,7 @@ public:
 
   inline int spCount()
     { 
-      return workerPool->load().count() + haveCurrentSP(); 
+      return workerPool->load().count() + haveCurrentSP() + computeSPCount; 
     };
 
   // Override the base relGap() function that gives the overall gap at
@@ -397,6 +403,18 @@ public:
 
   void rampUpSearch();  
 
+  // The ramp-up loop when partitionRampUp is set: each level of the
+  // tree is divided among the processors, and the results exchanged.
+
+  bool canPartitionRampUp();
+  void partitionedRampUpLoop();
+  void rampUpAdvance(parallelBranchSub* sp);
+
+  // Applications whose ramp-up bounding or splitting uses collective
+  // communication should return true; partitionRampUp is then ignored.
+
+  virtual bool collectiveRampUp() { return false; };
+
   // Makes sure all processors agree on value and location of incumbent.
 
   void rampUpIncumbentSync();
@@ -502,10 +520,12 @@ protected:
   loadBalObj*      loadBalancer;        // ... to balance work between hubs
   spServerObj*     spServer;            // ... to deliver subproblem data
   spReceiverObj*   spReceiver;          // ... to receive subproblem data
+  stealServerObj*  stealServer;         // ... to answer steal requests
   earlyOutputObj*  earlyOutputter;      // ... to help with early output
   reposRecvObj*    reposReceiver;       // ... to manage enumeration
   reposMergeObj*   reposMerger;
   llChainObj*      llChainer;           // ... manage continuous load log writes
+  cpWriterObj*     cpWriter;            // ... finish asynchronous checkpoints
 
   virtual incumbSearchObj* createIncumbentSearchThread()
 	{ return new incumbSearchObj(this); }
@@ -521,11 +541,15 @@ protected:
   friend class incumbCastObj;
   friend class spReceiverObj;
   friend class spServerObj;
+  friend class stealServerObj;
   friend class loadBalObj;
   friend class loadBalSurvey;
   friend class reposRecvObj;
   friend class reposMergeObj;
   friend class llChainObj;
+  friend class cpWriterObj;
+  friend class computeThread;
+  friend class computeSPHandler;
 
   // Handler to be used when doing the search.  This should hide the
   // serial object with the same name in the branching class.
@@ -551,15 +575,13 @@ protected:
   MessageID deliverSolTag;
   MessageID reposAuxTag;
 
-  MessageID reconfigSPTag;      // Used when doing serial checkpoint restarts
-  MessageID reconfigSolTag;
-  MessageID reconfigResizeTag;
-  MessageID reconfigDoneTag;
-
   MessageID llSyncOutTag;       // For writing load logs when no common
   MessageID llSyncBackTag;      // file system
   MessageID llDataTag;          // For sending load log data
   MessageID llTokenTag;         // Supports token ring for load log writing
+  MessageID stealTag;           // Steal requests between workers
+  MessageID deliverBigSPTag;    // Subproblem deliveries too big for a
+                                // receive ring slot
 
   // To store information about general system workload.
 
@@ -724,6 +746,88 @@ protected:
 		     int whichHub,
 		     bool rebalanceFlag = false);
 
+  // Hub-less work stealing (workStealing); see stealServer.h.  A
+  // worker has at most one steal request outstanding.  After
+  // stealRetries refusals in a row, it waits for the load balancer
+  // to start a new survey round before asking again.
+
+  outBufferQueue stealRequestQ;
+  bool stealPending;
+  int  stealFailures;
+  int  stealDormantRound;
+  int  stealRequestCount;
+  int  stealRefusedCount;
+  int  spStolenCount;
+
+  bool wantToSteal();
+  void stealIfIdle();
+  int  chooseStealVictim();
+  void donateStolenWork(int thief,int wanted);
+  void addStolenToWorkerPool(parallelBranchSub* p);
+  void stealRefused();
+
+  // Compute threads (computeThreads > 0); see computeThread.h.  The
+  // scheduler holds workerMutex (its run lock) while it polls and runs
+  // threads, but not while it idles or waits in computeSlice.  The counters and flags below are guarded by
+  // workerMutex.
+
+  BasicArray<computeThread*>   computeThreadObjs;
+  std::mutex                   workerMutex;
+  std::condition_variable      computeWake;    // Compute threads wait here
+  std::condition_variable      schedulerWake;  // The main thread waits here
+
+  int    computeSPCount;        // Subproblems held by compute threads
+  bool   computeSliceOpen;
+  double computeWorkLimit;
+  double computeWorkUsed;       // Since the last slice ended
+  bool   computeAttention;      // A compute thread needs the main thread
+  bool   computeIncumbentPending;
+  bool   computeStop;
+
+  bool usingComputeThreads() { return computeThreadObjs.size() > 0; };
+
+  bool canUseComputeThreads();
+  void startComputeThreads();
+  void stopComputeThreads();
+
+  void computeSlice();
+  bool computeSliceDone();
+  void endSliceIfDone();
+  void callMainThread();
+
+  void announceIncumbent();
+
+  void addComputeThreadLoad(loadObject& l);
+
+  // One-sided incumbent propagation (rmaIncumbent); see pbIncumbent.cpp.
+  // Processor 0 holds a window with the best (value, source) pair and
+  // the time each processor last found an incumbent.  The tree
+  // broadcast still runs alongside it.
+
+  double incumbentFoundTime;    // WallClockSeconds() at the source
+  bool   usingRMAIncumbent;
+  bool   rmaIncumbentUnrelayed; // Learned from the window, not yet relayed
+#if MPI_VERSION >= 3
+  MPI_Win rmaIncumbentWin;
+#endif
+
+  int    treeIncumbentCount;
+  int    rmaIncumbentCount;
+  double treeIncumbentLatency;
+  double rmaIncumbentLatency;
+
+  bool canUseRMAIncumbent();
+  void startRMAIncumbent();
+  void stopRMAIncumbent();
+  void publishRMAIncumbent();
+  void pollRMAIncumbent();
+
+  bool adoptIncumbent(double value,int source);
+
+  std::mutex*  incumbentLock();
+  int          threadNum();
+  branchSubId& lastSPId();
+
   // Stuff needed by the spServer/spReceiver threads.
 
   // Stores data for subproblems controlled by hub.
@@ -819,9 +923,11 @@ protected:
   spToken* tokenToSend(branchPool<spToken,parLoadObject>* thePool);
   int      lowerLoadWorker(int w1,int w2);
   int      worseQualityWorker(int w1,int w2);
-  void     hubSendWorkTo(int w);
+  void     hubSendWorkTo(int w,bool mayRedirect = false);
+  int      localDispatchWorker(int pProc,int w);
   void     repositionWorker(int w);
   void     alertWorkers(int code);
+  void     alertWorkers(int code,int value);
   void     clusterTerminate();
   void     setToInform(int w);
   void     setToInformAll();
@@ -829,6 +935,31 @@ protected:
 
   parLoadObject updatedPLoad();
 
+  // Locality-aware dispatch (localDispatch).  procNode holds, for
+  // each processor, the lowest-numbered processor sharing its node.
+
+  IntVector procNode;
+
+  int    ownerDispatchCount;
+  int    nodeDispatchCount;
+  int    remoteDispatchCount;
+  double spBytesMoved;
+  double spBytesMovedInNode;
+
+  void findProcessorNodes();
+
+  void countBytesMoved(int bytes,int dest)
+    {
+      spBytesMoved += bytes;
+      if (sameNode(searchRank,dest))
+	spBytesMovedInNode += bytes;
+    };
+
+  bool sameNode(int p1,int p2)
+    {
+      return (procNode.size() > 0) && (procNode[p1] == procNode[p2]);
+    };
+
   int workerCount(int w)
     {
       return workerLoadEstimate[w].count();
@@ -839,6 +970,18 @@ protected:
       return workerLoadEstimate[w].aggregateBound;
     };
 
+  // With a bound histogram, the last of its bins that the hub is
+  // spreading over its workers, or -1.
+
+  int hubHistCutoff;
+
+  double workerBestCount(int w)
+    {
+      return workerLoadEstimate[w].histCount(hubHistCutoff);
+    };
+
+  void startBoundHistogram(double poolBound);
+
   // Stuff needed for multiple hubs and load balancing
 
   void fillLoadBalBuffer(PackBuffer& buffer,
@@ -987,29 +1130,16 @@ protected:
 
   int reposArrayCursor;
                              
-  // Checkpointing
+  // Checkpointing (sequence numbers, trigger times, and the planned
+  // abort are kept in branching)
 
   bool restarted;               // Was run was restarted from a checkpoint?
 
-  bool checkpointsEnabled;      // Checkpoints being used on this run
   bool checkpointing;           // Want to write a checkpoint now
   bool writingCheckpoint;       // Actually writing a checkpoint right now
   bool readingCheckpoint;       // Reading a checkpoing now
 
-  int checkpointNumber;         // Sequence number of this checkpoint
-  int restartCPNum;             // Sequence number of checkpoint restarted from
-
   double baseWallTime;          // Wall clock time at start of run
-  double checkpointTriggerTime; // When to start next checkpoint
-  double checkpointStartTime;   // When current checkpoint began
-  double checkpointTotalTime;   // Total time spent writing checkpoints
-
-  int cpAbortNum;               // Number of the checkpoint we will
-                                // abort at (0 if no planned abort)
-
-  // Figures out what checkpoint we should abort at, if any
-
-  void prepareCPAbort();
 
   // Should we start a new checkpoint now?
 
@@ -1017,11 +1147,11 @@ protected:
     {
       if (!checkpointsEnabled)
 	return false;
-      if (checkpointing)
+      if (checkpointing || (asyncCPStage != asyncCPIdle) || asyncCPPending)
 	return false;
       if (outputInProgress)
 	return false;
-      return (WallClockSeconds() >= checkpointTriggerTime);
+      return (CoarseWallClockSeconds() >= checkpointTriggerTime);
     };
 
   // Initiate a checkpoint
@@ -1036,14 +1166,23 @@ protected:
 
   bool restartFromCheckpoint();    // General restart, which is either...
   bool parallelRestart();          // ... one file per processor, or
-  bool reconfigureRestart();       // ... serial read and redistribute work.
+  bool reconfigureRestart();       // ... shared read and redistribute work.
 
   // Subroutines of reconfigureRestart...
 
-  void reconfigureRestartRoot(int filesFound);
-  void reconfigureRestartLeaf(int filesFound);
+  void reconfigureMergeAppData(std::string& appData,int filesFound);
+  void reconfigureSubproblems(std::vector<parallelBranchSub*>& sps);
+  void reconfigureSolutions(std::vector<solution*>& sols);
+  void reconfigureExchange(std::vector<PackBuffer>& out,
+			   std::vector<char>& inData,
+			   std::vector<int>&  inCounts,
+			   std::vector<int>&  inDispls);
+
+  int restartFileCount;            // Files read by a reconfigure restart
+
+  // Files from asynchronous checkpoints can disagree on the incumbent
 
-  void reconfigureBufferCheck(UnPackBuffer& buf,int p,IntVector& rBufSize);
+  void reconcileRestartIncumbent();
 
   // Figure out the global load situation after reading a checkpoint
 
@@ -1059,9 +1198,58 @@ protected:
   int  scanForCheckpointFiles(int processor=MPI_ANY_SOURCE);
   bool checkpointFileMatch(std::string& filename,int& k, int& p);
 
-  static bool stringMatch(std::string& str,int& cursor,const char* pattern);
-  static bool intFromString(std::string& s,int& cursor,int& result);
 
+  // Asynchronous checkpoints (asyncCheckpoint); see pbCheckpoint.cpp.
+  // Each processor snapshots its pools into memory when it first
+  // hears of checkpoint k, from the load balancer, its hub, or another
+  // worker's marker, and then sends a marker to every other worker
+  // on the subproblem delivery channel.  Subproblems that arrive from
+  // a worker before its marker were in flight at the snapshot, and
+  // are added to it.  Once all markers are in, a background thread
+  // writes the file, and a nonblocking reduction over asyncCPComm
+  // tells every processor when all the files are safely written.  The
+  // checkpoint writer thread polls that reduction, and the next
+  // checkpoint may start while it is still pending here.
+
+  enum { asyncCPIdle, asyncCPLogging, asyncCPWriting };
+
+  bool usingAsyncCheckpoints;
+  int  asyncCPStage;
+  int  asyncCPMarkersDue;       // Workers whose markers have not come
+  std::vector<char> asyncCPChannelOpen;  // Indexed by processor
+  int  asyncCPSPCount;          // Subproblems in the snapshot so far
+  std::ostringstream asyncCPSPs;         // ... and their packed data
+  std::string asyncCPHeader;    // Global data: incumbent, counters
+  std::string asyncCPAppData;   // Application data
+  double asyncCPPause;          // Seconds the search stopped for this one
+  double asyncCPWriteStart;
+  std::atomic<bool> asyncCPWritten;      // Set by the writer thread
+  bool   asyncCPFileWritten;    // This checkpoint's file is on disk
+  int    asyncCPPosted;         // Last checkpoint we started agreeing on
+  double asyncCPPostedStart;    // ... and when it started
+  bool   asyncCPPending;        // Its reduction is not yet settled
+  bool   asyncCPAgreed;
+  int    asyncCPLastDone;       // Last checkpoint written everywhere
+  double asyncCPResult[3];      // Pause, write time, failure (maximum)
+  double asyncCPLocal[3];
+#if MPI_VERSION >= 3
+  MPI_Comm    asyncCPComm;
+  MPI_Request asyncCPRequest;
+#endif
+
+  bool canUseAsyncCheckpoints();
+  void startAsyncCheckpoint(int k);
+  void packAsyncCheckpointHeader();
+  void checkpointMarkerReceived(int source,int k);
+  void checkpointInFlight(parallelBranchSub* sp,int source);
+  void beginAsyncCheckpointWrite();
+  bool asyncCheckpointReady();
+  void advanceAsyncCheckpoint();
+  void postAsyncCheckpointAgreement(int k,int failure);
+  void completeAsyncCheckpoint();
+  void settleAsyncCheckpointAgreement();
+  void finishAsyncCheckpoint();
+  bool checkpointAbortDue();
 
   // This is just the 'or' of "checkpointing" and "aborting"
   // It's used in many places, so we have a special shorthand.
@@ -1100,6 +1288,7 @@ protected:
   void loadLogSMPWrite();
   void writeLoadLogPassToken();
   void receiveLLToken();
+  double loadLogTimeShift();
 
   parLoadLogRecord* pLastLog;
   bool              haveLLToken;
@@ -1168,7 +1357,7 @@ protected:
 
   void finishEventLog()
   {
-    if (iDoIO())
+    if (uMPI::iDoIO)
      ucout << "(Writing event log.)\n";
     logEvent::finish();
   }
@@ -1312,6 +1501,8 @@ public:
   void packProblem(PackBuffer& outBuffer)
     {
       DEBUGPRX(160,bGlobal(),"packProblem called.\n");
+      if (pGlobal()->rememberPackSize > 0)
+	outBuffer.reserve(pGlobal()->rememberPackSize);
       packGeneric(outBuffer);
       pack(outBuffer);
     };
@@ -1470,15 +1661,20 @@ class parSPHandler : public parallelPebblBase, virtual public spHandler
   void insertChild()   { pGlobal->workerPool->insert(pc);           };
   void eraseChild()    { pGlobal->workerDisposeSP(pc);              };
 
-  void boundOperation(parallelBranchSub* sp)
+  virtual void boundOperation(parallelBranchSub* sp)
     {
       pGlobal->computeBound(sp);
     };
 
-  void releaseSP(parallelBranchSub* sp,int whichChild)
+  virtual void releaseSP(parallelBranchSub* sp,int whichChild)
     {
       pGlobal->workerRelease(sp,whichChild,1,pGlobal->scatterHub());
     };
+
+  virtual void feedIncumbentThread(parallelBranchSub* sp)
+    {
+      sp->feedToIncumbentThread();
+    };
 };
 
 
@@ -261,6 +261,8 @@ void parLoadObject::write(PackBuffer& buff) const
 #ifdef MEMUTIL_PRESENT
   buff << memUsed;
 #endif
+  for(int i=0; i<pGlobal->loadHistBins; i++)
+    buff << ((i < (int) boundHist.size()) ? boundHist[i] : 0.0);
 }
 
 
@@ -288,6 +290,9 @@ void parLoadObject::read(UnPackBuffer& buff)
 #ifdef MEMUTIL_PRESENT
   buff >> memUsed;
 #endif
+  boundHist.resize(pGlobal->loadHistBins);
+  for(int i=0; i<pGlobal->loadHistBins; i++)
+    buff >> boundHist[i];
 }
 
 void parLoadObject::operator+=(const spToken& sp)
@@ -60,7 +60,8 @@ public:
       terminateSignal,
       startCheckpointSignal,
       writeCheckpointSignal,
-      startAbortSignal
+      startAbortSignal,
+      asyncCheckpointSignal        // Followed by the checkpoint number
     };
 
   /// These signals specify subtypes of messages used to managed the
@@ -77,8 +78,11 @@ public:
   /// Codes that go at the beginning of subproblem delivery messages
   enum
     {
-      spDeliverSignal = 2513,       // Subproblems follow
-      spBufferWarningSignal = 18202 // Just a warning to enlarge receive buffer
+      spDeliverSignal = 2513,        // Subproblems follow
+      spBufferWarningSignal = 18202, // Just a warning to enlarge receive buffer
+      spNoWorkSignal = 7919,         // Steal request refused (workStealing)
+      spCheckpointMarker = 6007      // No more in-flight subproblems for
+                                     // a checkpoint (asyncCheckpoint)
     };
   
 };
@@ -68,6 +68,14 @@ parallelPebblParams::parallelPebblParams()
 		"Ramp-up",
 		ParameterNonnegative<int>());
 
+  partitionRampUp=false;
+  create_categorized_parameter("partitionRampUp",partitionRampUp,
+		"<bool>","false",
+		"Ramp up level by level, with each processor bounding\n\t"
+		"and splitting only its share of each level\n\t"
+		"(base ramp-up only)",
+		"Ramp-up");
+
 /// PARALLEL SEARCH
 
   maxLoadBalRate=false;
@@ -285,6 +293,14 @@ parallelPebblParams::parallelPebblParams()
 		"Parallel Search",
 		ParameterLowerBound<int>(32));
 
+  recvRingSlots=4;
+  create_categorized_parameter("recvRingSlots",recvRingSlots,"<int>","4",
+		"Number of persistent receives kept posted for\n\t"
+		"subproblem deliveries and hub messages; 1 uses\n\t"
+		"a single receive that is reposted each time",
+		"Parallel Search",
+		ParameterLowerBound<int>(1));
+
   minScatterProb=0.05;
   create_categorized_parameter("minScatterProb",minScatterProb,
 		"<double>","0.025",
@@ -359,6 +375,72 @@ parallelPebblParams::parallelPebblParams()
 		"as well as nthe umber of subproblems",
 		"Parallel Search");
 
+  localDispatch=false;
+  create_categorized_parameter("localDispatch",localDispatch,"<bool>","false",
+		"When a hub sends a token to its least loaded worker,\n\t"
+		"send it instead to the worker holding the subproblem,\n\t"
+		"or to one on the same node, if that worker's load is\n\t"
+		"within localDispatchTol",
+		"Parallel Search");
+
+  localDispatchTol=0.25;
+  create_categorized_parameter("localDispatchTol",localDispatchTol,
+		"<double>","0.25",
+		"A worker within this fraction of the least loaded\n\t"
+		"worker's subproblem count (or within one subproblem)\n\t"
+		"may take a token with localDispatch",
+		"Parallel Search",
+		ParameterNonnegative<double>());
+
+  boundHistBins=0;
+  create_categorized_parameter("boundHistBins",boundHistBins,"<int>","0",
+		"If at least 2, loads carry a histogram of subproblem\n\t"
+		"bounds with this many bins, and hubs balance the\n\t"
+		"subproblems with the best bounds rather than\n\t"
+		"the load measure",
+		"Parallel Search",
+		ParameterNonnegative<int>());
+
+  boundHistFraction=0.25;
+  create_categorized_parameter("boundHistFraction",boundHistFraction,
+		"<double>","0.25",
+		"With boundHistBins, the fraction of subproblems,\n\t"
+		"taken from the best bounds, that hubs try to spread\n\t"
+		"evenly",
+		"Parallel Search",
+		ParameterBounds<double>(0.0,1.0));
+
+  workStealing=false;
+  create_categorized_parameter("workStealing",workStealing,"<bool>","false",
+		"Run without hubs: every processor keeps its own\n\t"
+		"subproblems, and idle processors steal work\n\t"
+		"directly from randomly chosen victims",
+		"Parallel Search");
+
+  stealMaxSPs=8;
+  create_categorized_parameter("stealMaxSPs",stealMaxSPs,"<int>","8",
+		"Most subproblems a victim gives up to one steal\n\t"
+		"request (never more than half its pool)",
+		"Parallel Search",
+		ParameterLowerBound<int>(1));
+
+  stealRetries=4;
+  create_categorized_parameter("stealRetries",stealRetries,"<int>","4",
+		"Consecutive failed steal requests after which a\n\t"
+		"processor waits for the next load survey before\n\t"
+		"trying again",
+		"Parallel Search",
+		ParameterLowerBound<int>(1));
+
+  stealNeighborhood=0;
+  create_categorized_parameter("stealNeighborhood",stealNeighborhood,
+		"<int>","0",
+		"If above 1, every other steal request goes to a\n\t"
+		"processor in the same aligned block of this many\n\t"
+		"ranks rather than to a uniformly random one",
+		"Parallel Search",
+		ParameterNonnegative<int>());
+
   clusterLowLoadRatio = 0.0;
   create_categorized_parameter("clusterLowLoadRatio",clusterLowLoadRatio,
 		"<double>","0.0",
@@ -406,6 +488,14 @@ parallelPebblParams::parallelPebblParams()
 		"Branching factor for load balancing tree",
 		"Parallel Search",
 		ParameterLowerBound<int>(1));
+
+  hubLevelRadix=0;
+  create_categorized_parameter("hubLevelRadix",hubLevelRadix,"<int>","0",
+		"If at least 2, organize hubs into levels of blocks\n\t"
+		"of this many, and balance load within one level's\n\t"
+		"blocks per round, cycling through the levels",
+		"Parallel Search",
+		ParameterNonnegative<int>());
 		
   maxLoadBalSize=1024;
   create_categorized_parameter("maxLoadBalSize",maxLoadBalSize,"<int>","1024",
@@ -468,6 +558,15 @@ parallelPebblParams::parallelPebblParams()
 		"Parallel Thread Control",
 		ParameterNonnegative<double>());
 
+  computeThreads=0;
+  create_categorized_parameter("computeThreads",computeThreads,
+		"<int>","0",
+		"If positive, each worker runs this many OS threads\n\t"
+		"that bound subproblems from its pool, while the\n\t"
+		"main thread handles messages and hub duties",
+		"Parallel Thread Control",
+		ParameterNonnegative<int>());
+
   incThreadMaxBias=20.0;
   create_categorized_parameter("incThreadMaxBias",incThreadMaxBias,
 		"<double>","20.0",
@@ -534,6 +633,22 @@ parallelPebblParams::parallelPebblParams()
 		"Parallel Thread Control",
 		ParameterNonnegative<double>());
 
+  idleSpinPolls = 200;
+  create_categorized_parameter("idleSpinPolls",idleSpinPolls,
+		"<int>","200",
+		"Scheduler passes with nothing to run before it\n\t"
+		"starts sleeping between passes",
+		"Parallel Thread Control",
+		ParameterNonnegative<int>());
+
+  idleSleepMax = 0.0;
+  create_categorized_parameter("idleSleepMax",idleSleepMax,
+		"<double>","0.0",
+		"Longest sleep in seconds between idle scheduler\n\t"
+		"passes (0 means never sleep)",
+		"Parallel Thread Control",
+		ParameterNonnegative<double>());
+
   /// Enumeration
 
   rampUpSolQuantum = 16;
@@ -715,54 +830,13 @@ parallelPebblParams::parallelPebblParams()
 
 /// CHECKPOINTING
 
-  checkpointMinutes=0;   // Means checkpoints disabled by default
-  create_categorized_parameter("checkpointMinutes",checkpointMinutes,
-		"<double>","0",
-		"Desired minutes between starting to write checkpoints\n\t"
-		"(0 disables checkpointing)",
-		"Checkpointing",
-		ParameterNonnegative<double>());
-
-  checkpointMinInterval=1;
-  create_categorized_parameter("checkpointMinInterval",checkpointMinInterval,
-		"<double>","0",
-		"Lower bound on computing time between checkpoints",
-		"Checkpointing",
-		ParameterNonnegative<double>());
-
-  const char* envVarName = "PEBBL_CHECKPOINT_DIR";
-  const char* envDir = getenv(envVarName);
-  string explanation("Directory to place checkpoint files\n\tDefault value ");
-  if (envDir != NULL)
-    {
-      checkpointDir = envDir;
-      explanation += "was set from";
-    }
-  else
-    {
-      checkpointDir = "";
-      explanation += "may be set via";
-    }
-  explanation += " environment variable ";
-  explanation += envVarName;
-  create_categorized_parameter("checkpointDir",checkpointDir,"<string>",
-		checkpointDir.c_str(),explanation.c_str(),
-		"Checkpointing"
-		);
-
-  abortCheckpoint = 0;
-  create_categorized_parameter("abortCheckpoint",abortCheckpoint,"<int>","0",
-		"Debug: abort at the checkpoint with this sequence "
-		"number",
-		"Checkpointing",
-		ParameterNonnegative<int>());
-
-  abortCheckpointCount = 0;
-  create_categorized_parameter("abortCheckpointCount",abortCheckpointCount,
-		"<int>","0",
-		"Debug: abort after writing this many checkpoints",
-		"Checkpointing",
-		ParameterNonnegative<int>());
+  asyncCheckpoint=false;
+  create_categorized_parameter("asyncCheckpoint",asyncCheckpoint,
+		"<bool>","false",
+		"Write checkpoints without stopping the search:\n\t"
+		"each processor snapshots its pools, and files\n\t"
+		"are written in the background",
+		"Checkpointing");
 
   cpDebugCount = 0;
   create_categorized_parameter("cpDebugCount",cpDebugCount,"<int>","0",
@@ -770,14 +844,9 @@ parallelPebblParams::parallelPebblParams()
 		"Checkpointing",
 		ParameterNonnegative<int>());
 
-  restart=false;
-  create_categorized_parameter("restart",restart,"<bool>","false",
-		"Restart from a previously saved checkpoint",
-		"Checkpointing");
-
   reconfigure=false;
   create_categorized_parameter("reconfigure",reconfigure,"<bool>","false",
-		"Read checkpoint serially:\n\t"
+		"Read checkpoint, sharing out the files:\n\t"
 		"Allows changes in number of processors.\n\t"
 		"Implies 'restart'.",
 		"Checkpointing");
@@ -791,6 +860,12 @@ parallelPebblParams::parallelPebblParams()
 		"Incumbent",
 		ParameterLowerBound<int>(1));
 
+  rmaIncumbent=false;
+  create_categorized_parameter("rmaIncumbent",rmaIncumbent,"<bool>","false",
+		"Also publish incumbent values in a one-sided MPI\n\t"
+		"window that workers read before pruning",
+		"Incumbent");
+
   incSearchMaxControl=50.0;
   create_categorized_parameter("incSearchMaxControl",incSearchMaxControl,
 		"<double>","50.0",
@@ -799,13 +874,6 @@ parallelPebblParams::parallelPebblParams()
 		"Incumbent",
 		ParameterLowerBound<double>(1.0));
 
-  refSolArrayQuantum=8;
-  create_categorized_parameter("refSolArrayQuantum",refSolArrayQuantum,
-                "<int>","8",
-		"Expansion quantum for array of reference solutions",
-		"Incumbent",
-		ParameterPositive<int>());
-			       
 /// TERMINATION
 
   rampUpOnly=false;
@@ -47,6 +47,7 @@ public:
   int rampUpPoolLimit;
   double rampUpPoolLimitFac;
   int minRampUpSubprobsCreated;
+  bool partitionRampUp;
 
   // Control parameters for clustering.
 
@@ -62,6 +63,8 @@ public:
   double maxWorkerControl;
   double workerThreadBias;
 
+  int    computeThreads;
+
   double incThreadMaxBias;
   double incThreadMinBias;
   double noIncumbentMinBias;
@@ -72,6 +75,9 @@ public:
 
   double incThreadGapSlices;
 
+  int    idleSpinPolls;
+  double idleSleepMax;
+
   // Miscellaneous printout control parameters.
 
   bool workersPrintStatus;
@@ -110,6 +116,7 @@ public:
   int maxDispatchPacking;
   int maxSPPacking;
   int spReceiveBuf;
+  int recvRingSlots;
   double minScatterProb;
   double scatterFac;
   double targetScatterProb;
@@ -119,7 +126,7 @@ public:
   // Incumbent broadcast and related
 
   int incumbTreeRadix;
-  int refSolArrayQuantum;
+  bool rmaIncumbent;
 
   // Worker-hub "rebalancing" 
 
@@ -132,6 +139,23 @@ public:
 
   bool qualityBalance;
 
+  // Locality-aware dispatch of hub tokens.
+
+  bool   localDispatch;
+  double localDispatchTol;
+
+  // Balancing by a histogram of subproblem bounds.
+
+  int    boundHistBins;
+  double boundHistFraction;
+
+  // Hub-less randomized work stealing.
+
+  bool workStealing;
+  int  stealMaxSPs;
+  int  stealRetries;
+  int  stealNeighborhood;
+
   // Multiple hubs and load balancing
 
   double clusterLowLoadRatio;
@@ -142,6 +166,7 @@ public:
   double maxNonLocalScatterProb;
 
   int loadBalTreeRadix;
+  int hubLevelRadix;
   int maxLoadBalSize;
   double loadBalDonorFac;
   double loadBalReceiverFac;
@@ -161,19 +186,11 @@ public:
   double reposMergeSkew;
   bool enumFlowControl;
 
-  // Checkpoint management
-
-  double checkpointMinutes;
-  double checkpointMinInterval;
+  // Checkpoint management (the rest is shared with the serial layer)
 
-  bool restart;
+  bool asyncCheckpoint;
   bool reconfigure;
 
-  std::string checkpointDir;
-
-  int abortCheckpoint;
-  int abortCheckpointCount;
-
   // For debugging and testing purposes
 
   bool rampUpOnly;
@@ -27,6 +27,10 @@
 #include <pebbl/pbb/parBranching.h>
 #include <pebbl/misc/gRandom.h>
 
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
 #ifdef ACRO_HAVE_MPI
 
 using namespace std;
@@ -34,24 +38,16 @@ using namespace utilib;
 
 namespace pebbl {
 
-  // Does a little bookkeeping to set the time of a possible checkpoint abort.
-
-  void parallelBranching::prepareCPAbort()
-  {
-    cpAbortNum = 0;
-    if (abortCheckpointCount > 0)
-      cpAbortNum = checkpointNumber + abortCheckpointCount;
-    if ((abortCheckpoint > checkpointNumber) &&
-	((abortCheckpoint < cpAbortNum) || (cpAbortNum == 0)))
-      cpAbortNum = abortCheckpoint;
-  }
-  
-
   // This declares that a checkpoint has started.  If on a hub, tell workers
-  // too.
+  // too.  Asynchronous checkpoints do not suspend the search.
 
   void parallelBranching::setupCheckpoint()
   {
+    if (usingAsyncCheckpoints)
+      {
+	startAsyncCheckpoint(checkpointNumber + 1);
+	return;
+      }
     checkpointStartTime = WallClockSeconds();
     checkpointNumber++;
     if (iDoSearchIO)
@@ -143,12 +139,12 @@ namespace pebbl {
 
     bstream.write((char *) &rsize,sizeof(int));
 
-    for(int s=1; s<=rsize; s++)   // Loop 1..rsize because we have a heap
+    for(int s=0; s<rsize; s++)
       {
-	reposHeap.member(s)->key().pack(cpBuf);
-	if (s <= cpDebugCount)
+	repository.member(s)->pack(cpBuf);
+	if (s < cpDebugCount)
 	  ucout << "Writing " << cpBuf.curr() << " bytes for solution "
-		<< &(reposHeap.member(s)->key()) << endl;
+		<< repository.member(s) << endl;
 	cpBuf.writeBinary(bstream);
       }
 
@@ -205,65 +201,429 @@ namespace pebbl {
   }
 
 
-  string parallelBranching::checkpointFilename(int k, int p)
+  // Asynchronous checkpoints (asyncCheckpoint).  A checkpoint is a
+  // consistent snapshot in the sense of Chandy and Lamport: each
+  // processor packs its pools into memory when it first hears of
+  // checkpoint k, and each worker then sends a marker to every other
+  // worker on the subproblem delivery tag, behind any deliveries it
+  // has already sent.  A subproblem that reaches a worker after its
+  // own snapshot but before the sender's marker was in flight, and
+  // goes into the snapshot too.  With all markers in, the snapshot is
+  // written by a background thread (branching::writeCheckpointFile),
+  // and a nonblocking reduction tells everyone when every file is on
+  // disk, after which checkpoint k-1 is removed.  The files have the
+  // usual format, but their incumbents may differ, so the restart
+  // code takes the best one that comes with a solution.
+  //
+  // The reduction needs MPI-3, and the solution repository is not
+  // saved, so enumeration uses ordinary checkpoints.
+
+  bool parallelBranching::canUseAsyncCheckpoints()
   {
-    stringstream s;
-    s << checkpointDir;
-    int n = checkpointDir.length();
-    if ((n > 0) && (checkpointDir[n-1] != '/'))
-      s << '/';
-    s << problemName << ".cp" << k << ".p" << p << ".bdat";
-    return s.str();
+    if (!asyncCheckpoint)
+      return false;
+#if MPI_VERSION >= 3
+    if (!enumerating)
+      return true;
+    const char* reason = "when enumerating";
+#else
+    const char* reason = "with an MPI library older than MPI-3";
+#endif
+    if (iDoSearchIO && !suppressWarnings)
+      {
+	CommonIO::end_tagging();
+	ucout << "****** Warning ******** asyncCheckpoint ignored "
+	      << reason << ".\n";
+	CommonIO::begin_tagging();
+      }
+    return false;
   }
 
 
-  void parallelBranching::deleteCheckpointFile(int k, int p)
+  // Take the snapshot for checkpoint k, unless we already have
+
+  void parallelBranching::startAsyncCheckpoint(int k)
   {
-    int code = remove(checkpointFilename(k,p).c_str());
-    if (code) 
-       ucerr << "Could not remove checkpoint file (" << k 
-             << "," << p << ")" << endl;
+    if (k <= checkpointNumber)
+      return;
+
+    // Nobody starts checkpoint k until all of k-1 is on disk, but our
+    // part of the agreement on k-1 may still be pending.  The
+    // checkpoint writer thread settles it later; k is not posted
+    // until it has.
+
+    if (asyncCPStage != asyncCPIdle)
+      EXCEPTION_MNGR(runtime_error,"Checkpoint " << k << " started before "
+		     "checkpoint " << checkpointNumber << " was written");
+
+    UTILIB_LOG_EVENT(1,start,checkpointLogState);
+
+    checkpointStartTime = WallClockSeconds();
+    checkpointNumber    = k;
+    if (iDoSearchIO)
+      ucout << "Starting checkpoint " << checkpointNumber
+	    << " at " << checkpointStartTime << " seconds.\n";
+    DEBUGPR(2,ucout << "Starting asynchronous checkpoint " << k << endl);
+
+    if (iAmHub())
+      alertWorkers(asyncCheckpointSignal,k);
+
+    // Markers go behind everything already packed for delivery
+
+    asyncCPChannelOpen.assign(searchSize,false);
+    asyncCPMarkersDue = 0;
+    if (iAmWorker())
+      {
+	deliverSPBuffers.flush();
+	for (int w=0; w<totalWorkers(); w++)
+	  {
+	    int p = overallWorkerProc(w);
+	    if (p == searchRank)
+	      continue;
+	    PackBuffer* outBuf = auxDeliverSPQ.getFree();
+	    *outBuf << (int) spCheckpointMarker << k;
+	    auxDeliverSPQ.send(outBuf,p,deliverSPTag);
+	    recordMessageSent(spReceiver);
+	    asyncCPChannelOpen[p] = true;
+	    asyncCPMarkersDue++;
+	  }
+      }
+
+    // Snapshot global data, application data, and the pools
+
+    packAsyncCheckpointHeader();
+
+    PackBuffer cpBuf;
+    ostringstream appStream(ios::out | ios::binary);
+    appCheckpointWrite(cpBuf);
+    cpBuf.writeBinary(appStream);
+    asyncCPAppData = appStream.str();
+
+    asyncCPSPs.str(string());
+    asyncCPSPCount = 0;
+    if (iAmWorker())
+      {
+	int wCount = workerPool->size();
+	workerPool->resetScan();
+	for (int i=0; i<wCount; i++)
+	  {
+	    workerPool->scan()->packProblem(cpBuf);
+	    cpBuf.writeBinary(asyncCPSPs);
+	  }
+	int sCount = serverPool.size();
+	serverPool.resetScan();
+	for (int i=0; i<sCount; i++)
+	  {
+	    serverPool.scan()->packProblem(cpBuf);
+	    cpBuf.writeBinary(asyncCPSPs);
+	  }
+	asyncCPSPCount = wCount + sCount;
+      }
+
+    asyncCPStage = asyncCPLogging;
+    asyncCPPause = WallClockSeconds() - checkpointStartTime;
+
+    UTILIB_LOG_EVENT(1,end,checkpointLogState);
+
+    if (asyncCPMarkersDue == 0)
+      beginAsyncCheckpointWrite();
   }
 
 
-  //  Try to match a substring at position 'cursor'.  If it matches
-  //  return true and advance 'cursor' to matach.
+  // Global data.  Only the processor holding the incumbent writes it;
+  // the others record the value and source they know of.
 
-  bool parallelBranching::stringMatch(string& str,
-				      int& cursor,
-				      const char* pattern)
+  void parallelBranching::packAsyncCheckpointHeader()
   {
-    size_type sublen = strlen(pattern);
-    if (str.substr(cursor,sublen) != pattern)
-      return false;
-    cursor += sublen;
-    return true;
+    PackBuffer cpBuf;
+    ostringstream headStream(ios::out | ios::binary);
+    cpBuf << incumbentValue << incumbentSource << probCounter;
+    if (searchRank == incumbentSource)
+      incumbent->pack(cpBuf);
+    cpBuf.writeBinary(headStream);
+    asyncCPHeader = headStream.str();
   }
 
 
-  //  Read an unsigned integer of at most 9 digits starting from
-  //  position "cursor" of a string, and place the result in "result"
-  //  Return true if it worked.
+  void parallelBranching::checkpointMarkerReceived(int source,int k)
+  {
+    recordMessageReceived(spReceiver);
+    startAsyncCheckpoint(k);
+    if ((k != checkpointNumber) || (asyncCPStage != asyncCPLogging) ||
+	!asyncCPChannelOpen[source])
+      EXCEPTION_MNGR(runtime_error,"Unexpected marker for checkpoint " << k
+		     << " from processor " << source);
+    asyncCPChannelOpen[source] = false;
+    if (--asyncCPMarkersDue == 0)
+      beginAsyncCheckpointWrite();
+  }
+
 
-  bool parallelBranching::intFromString(string& s,int& cursor,int& result)
+  // Called for each subproblem delivered by another worker
+
+  void parallelBranching::checkpointInFlight(parallelBranchSub* sp,int source)
+  {
+    if ((asyncCPStage != asyncCPLogging) || !asyncCPChannelOpen[source])
+      return;
+    double startTime = WallClockSeconds();
+    PackBuffer cpBuf;
+    sp->packProblem(cpBuf);
+    cpBuf.writeBinary(asyncCPSPs);
+    asyncCPSPCount++;
+    DEBUGPR(20,ucout << "Checkpoint " << checkpointNumber
+	    << " gets in-flight " << sp << endl);
+    asyncCPPause += WallClockSeconds() - startTime;
+  }
+
+
+  // Assemble the file and start the writer thread
+
+  void parallelBranching::beginAsyncCheckpointWrite()
   {
-    result = 0;
-    int i = cursor;
-    int len = min((int) s.length(),cursor+9);
-    for(; i<len; i++) 
+    double startTime = WallClockSeconds();
+
+    int rsize = 0;
+    checkpointData = asyncCPHeader;
+    checkpointData += asyncCPAppData;
+    checkpointData.append((char *) &asyncCPSPCount,sizeof(int));
+    checkpointData += asyncCPSPs.str();
+    checkpointData.append((char *) &rsize,sizeof(int));
+
+    string().swap(asyncCPHeader);
+    string().swap(asyncCPAppData);
+    asyncCPSPs.str(string());
+
+    if (cpDebugCount > 0)
+      ucout << "Writing " << asyncCPSPCount << " subproblems\n";
+
+    asyncCPWritten   = false;
+    checkpointWriter = std::thread(writeCheckpointFile,
+				   &checkpointData,
+				   checkpointFilename(checkpointNumber,
+						      searchRank),
+				   string(),
+				   &checkpointWriteOK,
+				   &asyncCPWritten);
+
+    asyncCPStage      = asyncCPWriting;
+    asyncCPWriteStart = WallClockSeconds();
+    asyncCPPause     += asyncCPWriteStart - startTime;
+  }
+
+
+  // Used by the checkpoint writer thread to decide if it can run.  A
+  // pending agreement is polled, never waited for, and has to settle
+  // before the next one can be posted.
+
+  bool parallelBranching::asyncCheckpointReady()
+  {
+#if MPI_VERSION >= 3
+    if (asyncCPPending)
+      {
+	if (!asyncCPAgreed)
+	  {
+	    int flag = 0;
+	    MPI_Test(&asyncCPRequest,&flag,MPI_STATUS_IGNORE);
+	    asyncCPAgreed = flag;
+	  }
+	return asyncCPAgreed;
+      }
+#endif
+    return (asyncCPStage == asyncCPWriting) && asyncCPWritten;
+  }
+
+
+  // What the checkpoint writer thread does when it runs: either
+  // everyone's file for the pending agreement is written, or ours for
+  // the current checkpoint is
+
+  void parallelBranching::advanceAsyncCheckpoint()
+  {
+    if (asyncCPPending)
+      completeAsyncCheckpoint();
+    else if (asyncCPStage == asyncCPWriting)
+      {
+	checkpointWriter.join();
+	string().swap(checkpointData);
+	asyncCPFileWritten = checkpointWriteOK;
+	postAsyncCheckpointAgreement(checkpointNumber,
+				     checkpointWriteOK ? 0 : 2);
+      }
+  }
+
+
+  // Start the reduction that decides if checkpoint k is complete.
+  // Failure is 2 if a file could not be written, and 1 if the search
+  // ended before a processor finished its part.
+
+  void parallelBranching::postAsyncCheckpointAgreement(int k,int failure)
+  {
+    asyncCPLocal[0] = asyncCPPause;
+    asyncCPLocal[1] = WallClockSeconds() - asyncCPWriteStart;
+    asyncCPLocal[2] = failure;
+    asyncCPPosted      = k;
+    asyncCPPostedStart = checkpointStartTime;
+    asyncCPPending     = true;
+    asyncCPAgreed      = false;
+    asyncCPStage       = asyncCPIdle;
+#if MPI_VERSION >= 3
+    MPI_Iallreduce(asyncCPLocal,asyncCPResult,3,MPI_DOUBLE,MPI_MAX,
+		   asyncCPComm,&asyncCPRequest);
+#endif
+  }
+
+
+  void parallelBranching::completeAsyncCheckpoint()
+  {
+    int    k       = asyncCPPosted;
+    double endTime = WallClockSeconds();
+
+    asyncCPPending = false;
+    checkpointTriggerTime = max(asyncCPPostedStart + checkpointMinutes*60,
+				endTime + checkpointMinInterval*60);
+
+    if (asyncCPResult[2] > 0)
       {
-	int d = ((int) s[i]) - '0';
-	if ((d < 0) || (d > 9))
-	  break;
-	result = 10*result + d;
+	if (asyncCPFileWritten)
+	  deleteCheckpointFile(k,searchRank);
+	if ((asyncCPResult[2] > 1) && iDoSearchIO && !suppressWarnings)
+	  {
+	    CommonIO::end_tagging();
+	    ucout << "****** Warning ******** Could not write all files "
+		  << "for checkpoint " << k << endl;
+	    CommonIO::begin_tagging();
+	  }
+	if (k == cpAbortNum)
+	  cpAbortNum++;
+	return;
       }
-    if (i == cursor)
+
+    if (asyncCPLastDone > 0)
+      deleteCheckpointFile(asyncCPLastDone,searchRank);
+    asyncCPLastDone      = k;
+    checkpointTotalTime += asyncCPResult[0];
+
+    if (iDoSearchIO)
+      {
+	statusLine(globalLoad,"c");
+	ucout << "Checkpoint " << k << " done -- took "
+	      << endTime - asyncCPPostedStart << " seconds, search paused "
+	      << "at most " << asyncCPResult[0] << " seconds.\n";
+	if (k == cpAbortNum)
+	  {
+	    ucout << "Aborting at checkpoint " << k << endl << Flush;
+	    ofstream flagStream("pebbl-cp-abort.flag",ios::out);
+	    flagStream << "PEBBL run for '" << problemName
+		       << "' aborted at checkpoint " << k
+		       << endl << "Wall clock time was " << endTime
+		       << " seconds, and there were " << globalLoad.count()
+		       << " subproblems\n";
+	  }
+      }
+  }
+
+
+  // Wait for a pending agreement and act on it.  Only for the end of
+  // the search, outside the scheduler; the checkpoint writer thread
+  // polls instead.
+
+  void parallelBranching::settleAsyncCheckpointAgreement()
+  {
+#if MPI_VERSION >= 3
+    if (!asyncCPPending)
+      return;
+    MPI_Wait(&asyncCPRequest,MPI_STATUS_IGNORE);
+    completeAsyncCheckpoint();
+#endif
+  }
+
+
+  // The load balancer aborts the search once the abort checkpoint is
+  // safely written
+
+  bool parallelBranching::checkpointAbortDue()
+  {
+    if (!usingAsyncCheckpoints || (cpAbortNum == 0) ||
+	(asyncCPLastDone < cpAbortNum))
       return false;
-    cursor = i;
+    if (!abortReason)
+      abortReason = "reached abort checkpoint";
     return true;
   }
 
 
+  // Collective, at the end of the search.  Settle any checkpoint still
+  // in progress, so every processor completes the same reductions.  A
+  // processor can be at most one reduction behind another, since none
+  // starts checkpoint k before all have joined the reduction for k-1.
+
+  void parallelBranching::finishAsyncCheckpoint()
+  {
+#if MPI_VERSION >= 3
+    if (asyncCPStage == asyncCPWriting)
+      {
+	settleAsyncCheckpointAgreement();
+	advanceAsyncCheckpoint();
+      }
+
+    int maxPosted = 0;
+    searchComm.reduceCast(&asyncCPPosted,&maxPosted,1,MPI_INT,MPI_MAX);
+
+    if (asyncCPPosted < maxPosted)
+      {
+	settleAsyncCheckpointAgreement();
+	asyncCPPause       = 0;
+	asyncCPWriteStart  = WallClockSeconds();
+	asyncCPFileWritten = false;
+	postAsyncCheckpointAgreement(maxPosted,1);
+      }
+
+    settleAsyncCheckpointAgreement();
+
+    // Drop a snapshot that nobody finished
+
+    asyncCPStage = asyncCPIdle;
+    string().swap(asyncCPHeader);
+    string().swap(asyncCPAppData);
+    asyncCPSPs.str(string());
+
+    MPI_Comm_free(&asyncCPComm);
+#endif
+  }
+
+
+  string parallelBranching::checkpointFilename(int k, int p)
+  {
+    stringstream s;
+    s << checkpointDir;
+    int n = checkpointDir.length();
+    if ((n > 0) && (checkpointDir[n-1] != '/'))
+      s << '/';
+    s << problemName << ".cp" << k << ".p" << p << ".bdat";
+    return s.str();
+  }
+
+
+  // After a reconfigure restart, processor p also removes the old
+  // files it read.
+
+  void parallelBranching::deleteCheckpointFile(int k, int p)
+  {
+    if ((k == restartCPNum) && (restartFileCount > 0))
+      {
+	for (int q=p; q<restartFileCount; q+=searchSize)
+	  if (remove(checkpointFilename(k,q).c_str()))
+	    ucerr << "Could not remove checkpoint file (" << k 
+		  << "," << q << ")" << endl;
+	return;
+      }
+    int code = remove(checkpointFilename(k,p).c_str());
+    if (code) 
+       ucerr << "Could not remove checkpoint file (" << k 
+             << "," << p << ")" << endl;
+  }
+
+
   //  Identify which checkpoint we should be reading and set 
   //  "checkpointNumber".  Return the number of processors found
   //  and the also set the highest processor number found.  
@@ -376,7 +736,8 @@ namespace pebbl {
     if (!ableToRead)
       return false;
 
-    restartCPNum = checkpointNumber;   // Remember starting checkpoint number
+    restartCPNum    = checkpointNumber;   // Remember starting checkpoint number
+    asyncCPLastDone = checkpointNumber;
 
     // Deal with any side effects from an incumbent that might have
     // been loaded with the checkpoint.  Set the pools to think they've
@@ -406,6 +767,16 @@ namespace pebbl {
 
     restartSetLoads();
 
+    // Hubs track their workers in heaps, which ramp-up would
+    // otherwise have set up.
+
+    if (iAmHub())
+      for (int w=0; w<numWorkers(); w++)
+	{
+	  heapOfWorkers.add(workerHeapObj[w]);
+	  qHeapOfWorkers.add(workerQHeapObj[w]);
+	}
+
     if (enumCount > 1)
       syncLastSol();
 
@@ -483,6 +854,7 @@ namespace pebbl {
     cpBuf >> incumbentValue >> incumbentSource >> probCounter;
     if (searchRank == incumbentSource)
       incumbent = unpackSolution(cpBuf);
+    reconcileRestartIncumbent();
     DEBUGPR(10,ucout << "incumbentValue=" << incumbentValue
 	    << " incumbentSource=" << incumbentSource << endl);
 
@@ -554,8 +926,50 @@ namespace pebbl {
   }
 
 
-  // Do a serial read-in of the checkpoint files and distribute the
-  // the contents evenly to all workers.
+  // Collective.  Each processor has just read the incumbent value,
+  // source, and (if it holds it) solution from its own file.  Files
+  // from asynchronous checkpoints can disagree, so use the best value
+  // that comes with a solution, unless a value with no known source
+  // (such as startIncumbent) is better.  Holders of any other solution
+  // discard it.
+
+  void parallelBranching::reconcileRestartIncumbent()
+  {
+    bool holder = (incumbentSource == searchRank);
+
+    struct { double value; int source; } mine, best;  // MPI_DOUBLE_INT
+    mine.value  = holder ? sense*incumbentValue : MAXDOUBLE;
+    mine.source = searchRank;
+    searchComm.reduceCast(&mine,&best,1,MPI_DOUBLE_INT,MPI_MINLOC);
+
+    double unknown = MAXDOUBLE;
+    if (incumbentSource == MPI_ANY_SOURCE)
+      unknown = sense*incumbentValue;
+    double bestUnknown = MAXDOUBLE;
+    searchComm.reduceCast(&unknown,&bestUnknown,1,MPI_DOUBLE,MPI_MIN);
+
+    if (searchRank != 0)
+      rampUpMessages += 4;
+
+    if ((bestUnknown < best.value) || (best.value == MAXDOUBLE))
+      {
+	incumbentValue  = sense*bestUnknown;
+	incumbentSource = MPI_ANY_SOURCE;
+      }
+    else
+      {
+	incumbentValue  = sense*best.value;
+	incumbentSource = best.source;
+      }
+    if (holder && (incumbentSource != searchRank))
+      resetIncumbent();
+  }
+
+
+  // Reconfigure.  Each processor reads every searchSize-th file of the
+  // old run, and the subproblems and solutions are then redistributed
+  // by all-to-all exchanges, so no one processor reads or sends
+  // everything.  Every processor must be able to read every file.
 
   bool parallelBranching::reconfigureRestart()
   {
@@ -580,160 +994,70 @@ namespace pebbl {
 
     searchComm.broadcast(&checkpointNumber,1,MPI_INT,mySearchIoProc);
     rampUpMessages += (!iDoSearchIO);
-
-    // OK, we have some non-zero number of files. The I/O processor
-    // reads these and sends out the work.  The incumbent always
-    // resides on the reading processor.
-
-    incumbentSource = mySearchIoProc;
-
-    if (iDoSearchIO)
-      reconfigureRestartRoot(filesFound);
-    else 
-      reconfigureRestartLeaf(filesFound);
-
-    // All processors start numbering subproblems from the largest
-    // value of all prior counters.  This will prevent overlaps
-    // and complaints from logAnalyze.
-
-    searchComm.broadcast(&probCounter,1,MPI_INT,mySearchIoProc);
-    rampUpMessages += (!(iDoSearchIO));
-
-    DEBUGPR(2,ucout << "reconfigureRestart done\n");
-
-    return true;
-  }
-  
-
-
-  // This is what the IO processor does when we reconfigure
-
-  void parallelBranching::reconfigureRestartRoot(int filesFound)
-  {
-    DEBUGPR(2,ucout << "reconfigureRestartRoot called\n");
-    
+    restartFileCount = filesFound;
+
+    // Read our share of the files.  Keep the best incumbent that comes
+    // with a solution, and the best value without one (both times
+    // sense).
+
+    vector<parallelBranchSub*> sps;
+    vector<solution*>          sols;
+    string                     appData;
+    solution* candidate    = NULL;
+    double    heldValue    = MAXDOUBLE;
+    double    unknownValue = MAXDOUBLE;
     UnPackBuffer cpBuf;
 
-    // The workerList array keeps the processor numbers of all workers.
-    // (Later on, we periodically shuffle its order)
-
-    int wNum = 0;
-    IntVector workerList(totalWorkers());
-    for (int i=0; i<totalWorkers(); i++)
-      workerList[i] = overallWorkerProc(i);
-
-    // We keep track of the buffer sizes of all other processors
-	
-    IntVector rBufSize(searchSize);
-
-    int rBufStart = spPackSize();
-    if (parameter_initialized("spReceiveBuf"))
-      rBufStart = spReceiveBuf;
-    for(int i=0; i<searchSize; i++)
-	  rBufSize[i] = rBufStart;
-
-    // Main loop over checkpoint files.
-
-    for (int p=0; p<filesFound; p++)
+    for (int p=searchRank; p<filesFound; p+=searchSize)
       {
-	// Read the file for old processor p
-
-	ifstream bstream(checkpointFilename(checkpointNumber,p).c_str(),
-			 (ios::in | ios::binary));
-
-	// Get the incumbent value and source.  Broadcast incumbent value if
-	// this is the first file.  If this is the file with the incumbent
-	// itself, read it and keep local.
+	string fileName = checkpointFilename(checkpointNumber,p);
+	ifstream bstream(fileName.c_str(),(ios::in | ios::binary));
+	if (!bstream)
+	  EXCEPTION_MNGR(runtime_error,"Cannot open checkpoint file "
+			 << fileName);
 
 	cpBuf.readBinary(bstream);
-	int oldIncumbentSource;
-	int fileProbCounter;
-	cpBuf >> incumbentValue >> oldIncumbentSource >> fileProbCounter;
-	DEBUGPR(10,ucout << "p=" << p << " incumbentValue=" << incumbentValue
-		<< " oldIncumbentSource=" << oldIncumbentSource << endl);
+	double fileIncumbentValue;
+	int    oldIncumbentSource;
+	int    fileProbCounter;
+	cpBuf >> fileIncumbentValue >> oldIncumbentSource >> fileProbCounter;
+	DEBUGPR(10,ucout << "p=" << p << " incumbentValue=" 
+		<< fileIncumbentValue << " oldIncumbentSource=" 
+		<< oldIncumbentSource << endl);
 	if (fileProbCounter > probCounter)
 	  probCounter = fileProbCounter;
-	if (p == 0)
-	  searchComm.broadcast(&incumbentValue,1,MPI_DOUBLE,mySearchIoProc);
-	if (p == oldIncumbentSource)
-	  incumbent = unpackSolution(cpBuf);
+	if ((oldIncumbentSource == p) && 
+	    (sense*fileIncumbentValue < heldValue))
+	  {
+	    if (candidate)
+	      candidate->dispose();
+	    candidate = unpackSolution(cpBuf);
+	    heldValue = sense*fileIncumbentValue;
+	  }
+	else if (oldIncumbentSource == MPI_ANY_SOURCE)
+	  unknownValue = min(unknownValue,sense*fileIncumbentValue);
 
-	// Application-specific data.  Read it and then replicate
-	// the information to all processors, and do the "merge"
-	// operation.
+	// Application data, to be merged everywhere
 
 	cpBuf.readBinary(bstream);
 	int appDataSize = cpBuf.message_length();
-	searchComm.broadcast(&appDataSize,1,MPI_INT,mySearchIoProc);
-	searchComm.broadcast((void *)cpBuf.buf(),
-		             appDataSize,
-		             MPI_PACKED,
-		             mySearchIoProc);
-	DEBUGPR(10,ucout << "Broadcast " << appDataSize  
-		<< " bytes of application data\n");
-
-	appMergeGlobalData(cpBuf);
-
-	// Adjust buffer tracking to reflect broadcast of application data
-
-	for(int i=0; i<searchSize; i++)
-	  if (rBufSize[i] < appDataSize)
-	    rBufSize[i] = appDataSize;
-
-	// Now read subproblems and send them out
+	appData.append((char *) &appDataSize,sizeof(int));
+	appData.append(cpBuf.buf(),appDataSize);
 
 	int numSPs = -1;
 	bstream.read((char *) &numSPs,sizeof(int));
-	DEBUGPR(10,ucout << numSPs << " subproblems in this file\n");
+	DEBUGPR(10,ucout << numSPs << " subproblems in file " << p << endl);
 
 	for (int i=0; i<numSPs; i++)
 	  {
 	    cpBuf.readBinary(bstream);
+	    parallelBranchSub* sp = blankParallelSub();
+	    sp->unpackProblem(cpBuf);
 	    if (i < cpDebugCount)
-	      ucout << "Subproblem " << i << " has " << cpBuf.message_length()
-		    << " bytes\n";
-	    int wProc = workerList[wNum];
-	    if (wProc == searchRank)
-	      {
-		parallelBranchSub* sp = blankParallelSub();
-		sp->unpackProblem(cpBuf);
-		if (i < cpDebugCount)
-		  ucout << "Keeping " << sp << " local\n";
-		if (sp->canFathom())
-		  sp->recycle();
-		else
-		  workerPool->insert(sp);
-	      }
-	    else
-	      {
-		reconfigureBufferCheck(cpBuf,wProc,rBufSize);
-		if (i < cpDebugCount)
-		  ucout << "Sending to processor " << wProc << endl;
-		searchComm.send((void *) cpBuf.buf(),cpBuf.message_length(),
-		                MPI_PACKED,wProc,reconfigSPTag);
-	      }
-
-	    // Advance so the next subproblem goes to a different worker.
-	    // Wrap around if we are out of workers.  When that happens,
-	    // randomly permute the list of workers.
-
-	    if (++wNum == totalWorkers())
-	      {
-		wNum = 0;
-		for(int k=totalWorkers(); k>1; )
-		  {
-		    int j = (int) floor(gRandom()*k);
-		    k--;
-		    int temp = workerList[j];
-		    workerList[j] = workerList[k];
-		    workerList[k] = temp;
-		  }
-	      }
-	    
+	      ucout << "Read " << sp << " from file " << p << endl;
+	    sps.push_back(sp);
 	  }
 
-	// If enumerating, read any solutions and sent them out.
-
 	if (enumerating)
 	  {
 	    int rsize = -1;
@@ -743,175 +1067,291 @@ namespace pebbl {
 	    for(int s=0; s<rsize; s++)
 	      {
 		cpBuf.readBinary(bstream);
-		solution* sol = unpackSolution(cpBuf);
-		if (s < cpDebugCount)
-		  ucout << "Read solution " << sol << endl;
-		int owner = owningProcessor(sol);
-		if (owner == searchRank)
-		  {
-		    if (s < cpDebugCount)
-		      ucout << "Keeping\n";
-		    assignId(sol);
-		    localReposOffer(sol);
-		  }
-		else
-		  {
-		    reconfigureBufferCheck(cpBuf,owner,rBufSize);
-		    if (s < cpDebugCount)
-		      ucout << "Sending to " << owner << endl;
-		    searchComm.send((void *) cpBuf.buf(),cpBuf.message_length(),
-			            MPI_PACKED,owner,reconfigSolTag);
-		    delete sol;
-		  }
+		sols.push_back(unpackSolution(cpBuf));
 	      }
 	  }
-	
-	// Inform everybody that we are done with this file by sending
-	// an empty, specially-tagged message.
+      }
 
-	DEBUGPR(10,ucout << "Declaring done with file " << p << endl);
+    // The incumbent stays with the processor that read it
 
-	for (int p=0; p<searchSize; p++)
-	  searchComm.send(&p,0,MPI_PACKED,p,reconfigDoneTag);
-	
+    if (candidate && (unknownValue < heldValue))
+      {
+	candidate->dispose();
+	candidate = NULL;
       }
-    
-    DEBUGPR(2,ucout << "reconfigureRestartRoot done\n");
-    
+    resetIncumbent();
+    incumbent       = candidate;
+    incumbentSource = candidate ? searchRank : MPI_ANY_SOURCE;
+    incumbentValue  = sense*(candidate ? heldValue : unknownValue);
+    reconcileRestartIncumbent();
+
+    // All processors start numbering subproblems from the largest
+    // value of all prior counters.  This will prevent overlaps
+    // and complaints from logAnalyze.
+
+    int maxProbCounter = probCounter;
+    searchComm.reduceCast(&probCounter,&maxProbCounter,1,MPI_INT,MPI_MAX);
+    probCounter = maxProbCounter;
+    rampUpMessages += (searchRank != 0);
+
+    reconfigureMergeAppData(appData,filesFound);
+    reconfigureSubproblems(sps);
+    if (enumerating)
+      reconfigureSolutions(sols);
+
+    DEBUGPR(2,ucout << "reconfigureRestart done\n");
+
+    return true;
   }
 
 
-  // This routine is used at te root to make sure leaf processor p has
-  // a sufficiently large buffer to receive the UnPackBuffer 'buf'.
-  // If not, it sends a "please make a bigger buffer" message.
+  // Every processor merges the application data of every file, in
+  // file order.  Processor q's share holds, for each file it read, the
+  // size of the data and then the data.
 
-  void parallelBranching::reconfigureBufferCheck(UnPackBuffer& buf,
-						 int p,
-						 IntVector& rBufSize)
+  void parallelBranching::reconfigureMergeAppData(string& appData,
+						  int filesFound)
   {
-    int thisSize = buf.message_length();
-    if (thisSize > rBufSize[p])
+    int ierr;
+    int mySize = appData.size();
+    vector<int> sizes(searchSize);
+    vector<int> displs(searchSize);
+
+    ierr = MPI_Allgather(&mySize,1,MPI_INT,&sizes[0],1,MPI_INT,
+			 searchComm.myComm());
+    if (ierr)
+       EXCEPTION_MNGR(runtime_error, "MPI_Allgather returned " << ierr);
+
+    int total = 0;
+    for (int q=0; q<searchSize; q++)
+      {
+	displs[q] = total;
+	total    += sizes[q];
+	if ((q != searchRank) && (sizes[q] > 0))
+	  rampUpMessages++;
+      }
+
+    vector<char> allData(total + 1);
+    ierr = MPI_Allgatherv((void *) appData.data(),mySize,MPI_PACKED,
+			  &allData[0],&sizes[0],&displs[0],MPI_PACKED,
+			  searchComm.myComm());
+    if (ierr)
+       EXCEPTION_MNGR(runtime_error, "MPI_Allgatherv returned " << ierr);
+
+    vector<int> start(filesFound);
+    vector<int> length(filesFound);
+    for (int q=0; q<searchSize; q++)
       {
-	PackBuffer auxBuf(sizeof(int));
-	auxBuf << thisSize;
-	DEBUGPR(100,ucout << "Requesting processor " << p
-		<< " to expand its buffer from " << rBufSize[p]
-		<< " to " << thisSize << endl);
-	searchComm.send((void *) auxBuf.buf(),auxBuf.size(),
-	                MPI_PACKED,p,reconfigResizeTag);
-	rBufSize[p] = thisSize;
+	int pos = displs[q];
+	for (int p=q; p<filesFound; p+=searchSize)
+	  {
+	    memcpy(&length[p],&allData[pos],sizeof(int));
+	    start[p] = pos + sizeof(int);
+	    pos      = start[p] + length[p];
+	  }
+      }
+
+    for (int p=0; p<filesFound; p++)
+      {
+	UnPackBuffer appBuf(&allData[start[p]],length[p],false);
+	appBuf.reset(length[p]);
+	DEBUGPR(10,ucout << "Merging " << length[p] 
+		<< " bytes of application data from file " << p << endl);
+	appMergeGlobalData(appBuf);
       }
   }
 
 
-  // This is what all the other processors do in a configuration
-  // restart.
+  // Orders subproblems best bound first
 
-  void parallelBranching::reconfigureRestartLeaf(int filesFound)
+  struct boundOrder
   {
-    DEBUGPR(2,ucout << "reconfigureRestartLeaf called\n");
+    boundOrder(double sense_) : sense(sense_) { };
 
-    int bufSize = spPackSize();
-    if (parameter_initialized("spReceiveBuf"))
-      bufSize = spReceiveBuf;
-    UnPackBuffer cpBuf(bufSize);
+    bool operator()(parallelBranchSub* a,parallelBranchSub* b) const
+    { return sense*a->bound < sense*b->bound; };
 
-    for (int p=0; p<filesFound; p++)
+    double sense;
+  };
+
+
+  // Deal out the subproblems.  Each processor sorts what it read by
+  // bound and deals round-robin to all workers, starting where the
+  // processors before it left off.  Every worker gets about the same
+  // number of subproblems, and a share of each processor's best and
+  // worst.
+
+  void parallelBranching::reconfigureSubproblems
+                                       (vector<parallelBranchSub*>& sps)
+  {
+    size_t kept = 0;
+    for (size_t i=0; i<sps.size(); i++)
       {
-	// Get the incumbent value, but only for the first time
-	// through the loop.
+	if (sps[i]->canFathom())
+	  sps[i]->recycle();
+	else
+	  sps[kept++] = sps[i];
+      }
+    sps.resize(kept);
+
+    sort(sps.begin(),sps.end(),boundOrder(sense));
 
-	if (p == 0)
+    int myCount = sps.size();
+    int before  = 0;
+    int ierr    = MPI_Exscan(&myCount,&before,1,MPI_INT,MPI_SUM,
+			     searchComm.myComm());
+    if (ierr)
+       EXCEPTION_MNGR(runtime_error, "MPI_Exscan returned " << ierr);
+    if (searchRank == 0)
+      before = 0;
+
+    vector<PackBuffer> out(searchSize);
+    for (int i=0; i<myCount; i++)
+      {
+	int q = overallWorkerProc((before + i) % totalWorkers());
+	if (q == searchRank)
+	  workerPool->insert(sps[i]);
+	else
 	  {
-	    searchComm.broadcast(&incumbentValue,1,MPI_DOUBLE,mySearchIoProc);
-	    rampUpMessages++;
-	    DEBUGPR(10,ucout << "Got incumbentValue=" 
-		    << incumbentValue << endl);
+	    sps[i]->packProblem(out[q]);
+	    sps[i]->recycle();
 	  }
-	
-	// Application-specific data.  Receive it and do the "merge"
-	// operation.  But first get the data size and grow the buffer
-	// if necessary
-
-	int appDataSize = -1;
-	searchComm.broadcast(&appDataSize,1,MPI_INT,mySearchIoProc);
-	if (appDataSize > (int) cpBuf.size())
-	  cpBuf.resize(appDataSize);
-	searchComm.broadcast((void *) cpBuf.buf(),
-		             appDataSize,
-		             MPI_PACKED,
-		             mySearchIoProc);
-	cpBuf.reset(appDataSize);
-	DEBUGPR(10,ucout << "Got " << appDataSize << 
-		" bytes of application data, with p=" << p << endl);
-
-	appMergeGlobalData(cpBuf);
-
-	// Now get subproblems (and solutions, if enumerating) until
-	// we receive a "done" tag.
-
-	MPI_Status status;
-
-	do
+      }
+
+    vector<char> inData;
+    vector<int>  inCounts;
+    vector<int>  inDispls;
+    reconfigureExchange(out,inData,inCounts,inDispls);
+
+    for (int q=0; q<searchSize; q++)
+      {
+	if ((q == searchRank) || (inCounts[q] == 0))
+	  continue;
+	UnPackBuffer inBuf(&inData[inDispls[q]],inCounts[q],false);
+	inBuf.reset(inCounts[q]);
+	while (inBuf.data_remaining())
 	  {
-	    searchComm.recv((void *) cpBuf.buf(),
-		            cpBuf.size(),
-		            MPI_PACKED,
-		            mySearchIoProc,
-		            MPI_ANY_TAG,
-		            &status);
-
-	    cpBuf.reset(&status);
-	    rampUpMessages++;
+	    parallelBranchSub* sp = blankParallelSub();
+	    sp->unpackProblem(inBuf);
+	    DEBUGPR(10,ucout << "Got subproblem " << sp << endl);
+	    workerPool->insert(sp);
+	  }
+      }
+  }
 
-	    if (status.MPI_TAG == reconfigSPTag)
-	      {
-		if (iAmWorker())
-		  {
-		    parallelBranchSub* sp = blankParallelSub();
-		    sp->unpackProblem(cpBuf);
-		    DEBUGPR(10,ucout << "Got subproblem " << sp << endl);
-		    if (sp->canFathom())
-		      sp->recycle();
-		    else
-		      workerPool->insert(sp);
-		  }
-		else
-		  EXCEPTION_MNGR(runtime_error, 
-				 "Non-worker got a subproblem during "
-				 "reconfigure");
-	      }
-	    else if (status.MPI_TAG == reconfigResizeTag)
-	      {
-		int newSize = -1;
-		cpBuf >> newSize;
-		if (newSize <= (int) cpBuf.size())
-		   EXCEPTION_MNGR(runtime_error, "Buffer shrinkage during "
-				  "reconfigure");
-		cpBuf.resize(newSize);
-		DEBUGPR(100,ucout << "Buffer expansion to " 
-			<< newSize << endl);
-	      }
-	    else if (enumerating && (status.MPI_TAG == reconfigSolTag))
-	      {
-		solution* sol = unpackSolution(cpBuf);
-		DEBUGPR(10,ucout << "Got solution " << sol << endl);
-		assignId(sol);
-		localReposOffer(sol);
-	      }
-	    else if (status.MPI_TAG != reconfigDoneTag)
-	      EXCEPTION_MNGR(runtime_error, "Bad tag received during "
-			     "reconfigure");
 
+  // Send each solution in the repository to the processor that owns it
+
+  void parallelBranching::reconfigureSolutions(vector<solution*>& sols)
+  {
+    vector<PackBuffer> out(searchSize);
+    for (size_t i=0; i<sols.size(); i++)
+      {
+	int owner = owningProcessor(sols[i]);
+	if (owner == searchRank)
+	  {
+	    assignId(sols[i]);
+	    localReposOffer(sols[i]);
 	  }
-	while(status.MPI_TAG != reconfigDoneTag);
+	else
+	  {
+	    sols[i]->pack(out[owner]);
+	    sols[i]->dispose();
+	  }
+      }
 
-	DEBUGPR(10,ucout << "Done with p=" << p << endl);
+    vector<char> inData;
+    vector<int>  inCounts;
+    vector<int>  inDispls;
+    reconfigureExchange(out,inData,inCounts,inDispls);
 
+    for (int q=0; q<searchSize; q++)
+      {
+	if ((q == searchRank) || (inCounts[q] == 0))
+	  continue;
+	UnPackBuffer inBuf(&inData[inDispls[q]],inCounts[q],false);
+	inBuf.reset(inCounts[q]);
+	while (inBuf.data_remaining())
+	  {
+	    solution* sol = unpackSolution(inBuf);
+	    DEBUGPR(10,ucout << "Got solution " << sol << endl);
+	    assignId(sol);
+	    localReposOffer(sol);
+	  }
       }
+  }
+
 
-    DEBUGPR(2,ucout << "reconfigureRestartLeaf done\n");
+  // All-to-all exchange of packed data: out[q] goes to processor q, and
+  // what processor q sent is the inCounts[q] bytes at inDispls[q].
+  // MPI_Alltoallv takes int counts and displacements, so the sizes are
+  // first exchanged as longs, and if any processor would send or
+  // receive more than INT_MAX bytes in all, every processor throws.
+
+  void parallelBranching::reconfigureExchange(vector<PackBuffer>& out,
+					      vector<char>& inData,
+					      vector<int>&  inCounts,
+					      vector<int>&  inDispls)
+  {
+    int ierr;
+    vector<long> outSizes(searchSize);
+    vector<long> inSizes(searchSize);
+    long outTotal = 0;
+    for (int q=0; q<searchSize; q++)
+      {
+	outSizes[q] = out[q].size();
+	outTotal   += outSizes[q];
+      }
+    ierr = MPI_Alltoall(&outSizes[0],1,MPI_LONG,&inSizes[0],1,MPI_LONG,
+			searchComm.myComm());
+    if (ierr)
+       EXCEPTION_MNGR(runtime_error, "MPI_Alltoall returned " << ierr);
+    long inTotal = 0;
+    for (int q=0; q<searchSize; q++)
+      inTotal += inSizes[q];
+
+    int tooBig    = (outTotal > INT_MAX) || (inTotal > INT_MAX);
+    int anyTooBig = 0;
+    ierr = MPI_Allreduce(&tooBig,&anyTooBig,1,MPI_INT,MPI_MAX,
+			 searchComm.myComm());
+    if (ierr)
+       EXCEPTION_MNGR(runtime_error, "MPI_Allreduce returned " << ierr);
+    if (anyTooBig)
+       EXCEPTION_MNGR(runtime_error, "Reconfigure restart would move more "
+		      "than " << INT_MAX << " bytes to or from one "
+		      "processor; restart on more processors");
+
+    vector<int> outCounts(searchSize);
+    vector<int> outDispls(searchSize);
+    int total = 0;
+    for (int q=0; q<searchSize; q++)
+      {
+	outCounts[q] = outSizes[q];
+	outDispls[q] = total;
+	total       += outCounts[q];
+      }
+    vector<char> outData(total + 1);
+    for (int q=0; q<searchSize; q++)
+      memcpy(&outData[outDispls[q]],out[q].buf(),outCounts[q]);
+
+    inCounts.resize(searchSize);
+    inDispls.resize(searchSize);
+    total = 0;
+    for (int q=0; q<searchSize; q++)
+      {
+	inCounts[q] = inSizes[q];
+	inDispls[q] = total;
+	total      += inCounts[q];
+	if ((q != searchRank) && (inCounts[q] > 0))
+	  rampUpMessages++;
+      }
+    inData.resize(total + 1);
 
+    ierr = MPI_Alltoallv(&outData[0],&outCounts[0],&outDispls[0],MPI_PACKED,
+			 &inData[0],&inCounts[0],&inDispls[0],MPI_PACKED,
+			 searchComm.myComm());
+    if (ierr)
+       EXCEPTION_MNGR(runtime_error, "MPI_Alltoallv returned " << ierr);
   }
 
 
@@ -968,15 +1408,18 @@ namespace pebbl {
 
     PackBuffer loadPackBuf(ploSize);
     parLoadObject myLoad(this,false,false);
-    myLoad = updatedPLoad();
+    if (iAmWorker())                     // Pure hubs have no pools
+      myLoad = updatedPLoad();
     DEBUGPR(10,ucout << "Worker load is " << myLoad << endl);
     loadPackBuf << myLoad;
 
-    // Make a buffer to receive load data
+    // Make a buffer to receive load data.  A pure hub is also in the
+    // gather, ahead of its workers.
 
+    int   hubSlots  = !iAmWorker();
     char* gatherBuf = NULL;
     if (iAmHub())
-      gatherBuf = new char[numWorkers()*ploSizeS];
+      gatherBuf = new char[(hubSlots + numWorkers())*ploSizeS];
 
     // Make a communicator for each cluster
 
@@ -1005,7 +1448,8 @@ namespace pebbl {
 	  clusterLoad += myLoad;
 	for(int i=iAmWorker(); i<numWorkers(); i++)
 	  {
-	    UnPackBuffer upgBuf(gatherBuf + i*ploSizeS,ploSizeS,false);
+	    UnPackBuffer upgBuf(gatherBuf + (hubSlots + i)*ploSizeS,
+				ploSizeS,false);
 	    upgBuf.reset(ploSizeS);
 	    upgBuf >> workerLoadReport[i];
 	    workerLoadEstimate[i] = workerLoadReport[i];
@@ -415,7 +415,7 @@ namespace pebbl {
   {
     if (!needReposMerge)
       return false;
-    double timeSinceLastMerge = WallClockSeconds() - lastMergeTime;
+    double timeSinceLastMerge = CoarseWallClockSeconds() - lastMergeTime;
     if (timeSinceLastMerge >= reposSkewSeconds)
       return true;
     if (childArraysReceived < reposChildren)
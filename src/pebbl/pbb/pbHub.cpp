@@ -50,6 +50,13 @@ int parallelBranching::lowerLoadWorker(int w1, int w2)
 
 int parallelBranching::worseQualityWorker(int w1, int w2)
 {
+  if (hubHistCutoff >= 0)
+    {
+      double c1 = workerTimeFrac(w2)*workerBestCount(w1);
+      double c2 = workerTimeFrac(w1)*workerBestCount(w2);
+      if (c1 != c2)
+	return (c1 < c2) ? -1 : 1;
+    }
   if ( sense*(workerBound(w1) - workerBound(w2)) > 0 )
     return -1;
   else
@@ -297,12 +304,12 @@ void parallelBranching::activateHub()
 
   if (numHubs() == 1)
     {
-      if (shouldAbort(clusterLoad.boundedSPs))
+      if (shouldAbort(clusterLoad.boundedSPs) || checkpointAbortDue())
 	  setupAbort();
       else if ((clusterLoad.count() > 0) && checkpointDue())
 	{
 	  setupCheckpoint();
-	  if (searchSize == 1)
+	  if ((searchSize == 1) && checkpointing)
 	    writeCheckpoint();
 	}
     }
@@ -366,9 +373,25 @@ void parallelBranching::hubDistributeWork()
   if (iAmWorker())
     repositionWorker(0);
 
-  // Try to give out work based on quality
+  // Try to give out work based on quality.  With a bound histogram,
+  // spread the subproblems in its best bins (through hubHistCutoff)
+  // over the workers in proportion to their time fractions.
 
-  if (qualityBalance)
+  if (qualityBalance && (hubHistCutoff >= 0))
+    {
+      double share = clusterLoad.histCount(hubHistCutoff)
+	               / adjustedWorkersInCluster();
+      while(hubPool->size() > 0)
+	{
+	  int w = qHeapOfWorkers.top()->key().w;
+	  if (loadHistBin(hubPool->select()->bound) > hubHistCutoff)
+	    break;
+	  if (workerBestCount(w) >= share*workerTimeFrac(w))
+	    break;
+	  hubSendWorkTo(w);
+	}
+    }
+  else if (qualityBalance)
     while(hubPool->size() > 0)            // Give up if no work
       {
 	int w = qHeapOfWorkers.top()->key().w;
@@ -381,14 +404,18 @@ void parallelBranching::hubDistributeWork()
 
   // Try to give out work based on number of subproblems
 
+  // With work stealing, the only worker is on this processor, and
+  // thieves can only take what is in its pool, so give it everything.
+
   int lowCount = lowWorkerCount();
 
   while(hubPool->size() > 0)                 // Give up if no work
     {
       int w = heapOfWorkers.top()->key().w;
-      if (workerCount(w) > lowCount*workerTimeFrac(w))  // If cannot improve, 
-	  break;                                        // then exit this loop
-      hubSendWorkTo(w);                           // Also reforms worker heaps
+      if (!workStealing &&
+	  (workerCount(w) > lowCount*workerTimeFrac(w)))  // If cannot improve,
+	  break;                                          // then exit this loop
+      hubSendWorkTo(w,localDispatch);             // Also reforms worker heaps
     }
 	
   HUBDEBUG(100,ucout << "Flushing dispatch buffers.\n");
@@ -402,15 +429,28 @@ void parallelBranching::hubDistributeWork()
 }
 
 
-// Sends one subproblem to a worker (or at least buffers it)
+// Sends one subproblem to a worker (or at least buffers it).  If
+// mayRedirect is set, the subproblem may go instead to a worker
+// closer to where it is stored (see localDispatchWorker).
 
-void parallelBranching::hubSendWorkTo(int w)
+void parallelBranching::hubSendWorkTo(int w,bool mayRedirect)
 {
-  int wProc  = workerProc(w);
   spToken* t = tokenToSend(hubPool);
   if (t == 0)      // Should not happen; but if so explain and then seg fault
     ucout << "tokenToSend returns null pointer\n" << Flush;
   int pProc = t->spProcessor;
+  if (mayRedirect)
+    w = localDispatchWorker(pProc,w);
+  int wProc = workerProc(w);
+  if (localDispatch)
+    {
+      if (pProc == wProc)
+	ownerDispatchCount++;
+      else if (sameNode(pProc,wProc))
+	nodeDispatchCount++;
+      else
+	remoteDispatchCount++;
+    }
   workerTransitPool[w].insert(t);
   messages.hubDispatch.sent++;
   HUBDEBUG(100,ucout << "Sending work (" << messages.hubDispatch.sent
@@ -442,6 +482,78 @@ void parallelBranching::hubSendWorkTo(int w)
   repositionWorker(w);
 }  
       
+// Choose the worker to take a token whose subproblem is stored on
+// processor pProc, when w is the least loaded worker.  Prefer pProc
+// itself, so the subproblem never has to be packed, and otherwise the
+// least loaded worker on pProc's node, so it only crosses shared
+// memory.  Either must have at most localDispatchTol times more
+// subproblems than w, or one more, whichever is larger.
+
+int parallelBranching::localDispatchWorker(int pProc,int w)
+{
+  int wProc = workerProc(w);
+  if (pProc == wProc)
+    return w;
+
+  double slack = std::max(1.0,localDispatchTol*workerCount(w));
+  double limit = workerCount(w) + slack;
+
+  if ((whichCluster(pProc) == clusterNumber()) && isWorker(pProc))
+    {
+      int owner = whichWorker(pProc);
+      if (workerCount(owner) <= limit)
+	{
+	  HUBDEBUG(150,ucout << "Dispatching to owner w=" << owner
+		   << " instead of w=" << w << endl);
+	  return owner;
+	}
+    }
+
+  if ((procNode.size() == 0) || sameNode(pProc,wProc))
+    return w;
+
+  int best = -1;
+  for (int c=0; c<numWorkers(); c++)
+    {
+      int cProc = workerProc(c);
+      if ((cProc != pProc) && sameNode(pProc,cProc) &&
+	  ((best < 0) || (workerCount(c) < workerCount(best))))
+	best = c;
+    }
+  if ((best >= 0) && (workerCount(best) <= limit))
+    {
+      HUBDEBUG(150,ucout << "Dispatching to w=" << best << " on the node of "
+	       << pProc << " instead of w=" << w << endl);
+      return best;
+    }
+  return w;
+}
+
+
+// Collective.  Find which processors share a node, so dispatch can
+// prefer them.  Without MPI-3, each processor is its own node.
+
+void parallelBranching::findProcessorNodes()
+{
+  procNode.resize(searchSize);
+#if MPI_VERSION >= 3
+  MPI_Comm nodeComm;
+  MPI_Comm_split_type(searchComm.myComm(),MPI_COMM_TYPE_SHARED,searchRank,
+		      MPI_INFO_NULL,&nodeComm);
+  int nodeLeader = searchRank;
+  MPI_Allreduce(MPI_IN_PLACE,&nodeLeader,1,MPI_INT,MPI_MIN,nodeComm);
+  MPI_Comm_free(&nodeComm);
+  MPI_Allgather(&nodeLeader,1,MPI_INT,procNode.data(),1,MPI_INT,
+		searchComm.myComm());
+#else
+  for (int p=0; p<searchSize; p++)
+    procNode[p] = p;
+#endif
+  DEBUGPR(5,ucout << "Node of this processor is " << procNode[searchRank]
+	  << endl);
+}
+
+
 //  To decide which problem a hub should dispatch from its token pool.
 //  If for some strange reason the pool has fathomable problems, throw
 //  them away.  If this exhausts the pool, return null.
@@ -508,6 +620,16 @@ void parallelBranching::hubCalculateLoads()
   for (int w=0; w<numWorkers(); w++)
     clusterLoad += workerLoadEstimate[w];
   setHubTracking(clusterLoad);
+  if (clusterLoad.histActive())
+    {
+      int cutoff = clusterLoad.histCutoff(boundHistFraction);
+      if (cutoff != hubHistCutoff)
+	{
+	  HUBDEBUG(100,ucout << "Histogram cutoff now bin " << cutoff << endl);
+	  hubHistCutoff = cutoff;
+	  qHeapOfWorkers.reheapify();
+	}
+    }
   HUBDEBUG(150,clusterLoad.dump(ucout,"clusterLoad after "
 	   "adding workerEstimates"));
   if (numHubs() == 1)
@@ -568,6 +690,16 @@ void parallelBranching::decideLoadBalAvailability(loadBalPair& eligible)
   double idealLoad = globalLoad.loadMeasure()
                          * (adjustedWorkersInCluster()/adjustedWorkerCount);
   double cLoad     = clusterLoad.loadMeasure();
+  if (globalLoad.histActive())
+    {
+      // Balance only the subproblems in the best bins of the global
+      // bound histogram
+
+      int cutoff = globalLoad.histCutoff(boundHistFraction);
+      idealLoad  = globalLoad.histCount(cutoff)
+	             * (adjustedWorkersInCluster()/adjustedWorkerCount);
+      cLoad      = clusterLoad.histCount(cutoff);
+    }
   DEBUGPRX(150,loadBalancer,"Global load is " << globalLoad 
 	   << ", ideal load is " << idealLoad 
 	   << ", cluster load is " << cLoad << ".\n");
@@ -606,13 +738,30 @@ void parallelBranching::fillLoadBalBuffer(PackBuffer& buffer,
   int i = 0;
   buffer.reset();
 
+  // With a bound histogram, send only tokens in the best bins of the
+  // global histogram, and compare the counts in those bins.  The
+  // unload order wraps around, so limit how many tokens are looked at.
+
+  bool byHist    = globalLoad.histActive();
+  int  cutoff    = byHist ? globalLoad.histCutoff(boundHistFraction) : 0;
+  int  toExamine = std::min(hubPool->size(),4*maxLoadBalSize);
+
   while ((t) && 
 	 (i < maxLoadBalSize) && 
 	 (hubPool->load().count() >= loadBalMinSourceCount))
     {
+      if (byHist && (loadHistBin(t->bound) > cutoff))
+	{
+	  if (--toExamine <= 0)
+	    break;
+	  t = hubPool->nextToUnload();
+	  continue;
+	}
       receiverLoad += *t;
       donorLoad    -= *t;
-      if (receiverLoad.loadMeasure() > ratio*donorLoad.loadMeasure())
+      if (byHist ? (receiverLoad.histCount(cutoff) >
+		    ratio*donorLoad.histCount(cutoff)) :
+	  (receiverLoad.loadMeasure() > ratio*donorLoad.loadMeasure()))
 	{
 	  t = 0;
 	  break;
@@ -674,6 +823,21 @@ void parallelBranching::alertWorkers(int code)
 };
 
 
+// The same, for signals that carry a number
+
+void parallelBranching::alertWorkers(int code,int value)
+{
+  DEBUGPR(100,ucout << "Called alertWorkers(" << code << ',' << value
+	  << ")\n");
+  for(int w=iAmWorker(); w<numWorkers(); w++)
+    {
+      PackBuffer* outBuffer = hubAuxBufferQ.getFree();
+      *outBuffer << code << value;
+      hubAuxBufferQ.send(outBuffer,workerProc(w),workerTag);
+    }
+};
+
+
 // May not need this any more; use scheduler to start load balancer instead
 
 // //  This method applies only in the case of single hub.  For multiple
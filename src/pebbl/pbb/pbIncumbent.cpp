@@ -0,0 +1,200 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// pbIncumbent.cpp
+//
+// Parallel branching class code for PEBBL -- incumbent values received
+// from other processors, and their one-sided propagation through an
+// MPI-3 window (rmaIncumbent)
+//
+
+
+#include <pebbl_config.h>
+
+#include <pebbl/pbb/parBranching.h>
+
+#ifdef ACRO_HAVE_MPI
+
+using namespace std;
+
+namespace pebbl {
+
+
+// Layout of the window on processor 0: the best incumbent, as the
+// pair type MPI_DOUBLE_INT so MPI_MINLOC/MPI_MAXLOC keep the value and
+// its source together (ties go to the lower rank, as in the tree
+// broadcast), then one WallClockSeconds() per processor.
+
+struct rmaIncumbentPair
+{
+  double value;
+  int    source;
+};
+
+static const MPI_Aint rmaTimeOffset = sizeof(rmaIncumbentPair);
+
+
+// Install an incumbent value found on another processor, if it is
+// better than ours.  Returns true if it was.
+
+bool parallelBranching::adoptIncumbent(double value,int source)
+{
+  if (((value - incumbentValue)*sense >= 0) &&
+      ((value != incumbentValue) || (source >= incumbentSource)))
+    return false;
+
+  resetIncumbent();
+  storeIncumbentValue(value);
+  newIncumbentEffect(value);
+  incumbentSource = source;
+  needPruning     = true;
+  if (iAmHub())
+    needHubPruning = true;
+  DEBUGPR(10,ucout << "Using new incumbent (" 
+	  << incumbentValue 
+	  << ',' 
+	  << incumbentSource
+	  << ")\n");
+  return true;
+}
+
+
+// The window needs MPI-3 and more than one processor.
+
+bool parallelBranching::canUseRMAIncumbent()
+{
+  if (!rmaIncumbent || (searchSize == 1))
+    return false;
+#if MPI_VERSION >= 3
+  return true;
+#else
+  if (iDoSearchIO && !suppressWarnings)
+    {
+      CommonIO::end_tagging();
+      ucout << "****** Warning ******** rmaIncumbent ignored with an "
+	    << "MPI library older than MPI-3.\n";
+      CommonIO::begin_tagging();
+    }
+  return false;
+#endif
+}
+
+
+// Collective.  Create the window after ramp-up, when all processors
+// agree on the incumbent, and keep a passive-target epoch open to
+// processor 0 for the rest of the search.
+
+void parallelBranching::startRMAIncumbent()
+{
+#if MPI_VERSION >= 3
+  MPI_Aint size = 0;
+  if (searchRank == 0)
+    size = rmaTimeOffset + searchSize*sizeof(double);
+
+  void* base = NULL;
+  int ierr = MPI_Win_allocate(size,1,MPI_INFO_NULL,searchComm.myComm(),
+			      &base,&rmaIncumbentWin);
+  if (ierr)
+    EXCEPTION_MNGR(runtime_error, "MPI_Win_allocate returned " << ierr);
+  MPI_Win_lock_all(MPI_MODE_NOCHECK,rmaIncumbentWin);
+
+  if (searchRank == 0)
+    {
+      rmaIncumbentPair pair;
+      pair.value  = incumbentValue;
+      pair.source = incumbentSource;
+      MPI_Put(&pair,1,MPI_DOUBLE_INT,0,0,1,MPI_DOUBLE_INT,rmaIncumbentWin);
+      MPI_Win_flush(0,rmaIncumbentWin);
+    }
+  searchComm.barrier();
+
+  usingRMAIncumbent     = true;
+  rmaIncumbentUnrelayed = false;
+  DEBUGPR(5,ucout << "Incumbent window created\n");
+#endif
+}
+
+
+// Collective.  Called when the search loop is over.
+
+void parallelBranching::stopRMAIncumbent()
+{
+#if MPI_VERSION >= 3
+  if (!usingRMAIncumbent)
+    return;
+  MPI_Win_unlock_all(rmaIncumbentWin);
+  MPI_Win_free(&rmaIncumbentWin);
+  usingRMAIncumbent = false;
+#endif
+}
+
+
+// Write our new incumbent into the window.  The time goes first, so a
+// processor that sees the pair can read when it was found.
+
+void parallelBranching::publishRMAIncumbent()
+{
+#if MPI_VERSION >= 3
+  if (!usingRMAIncumbent)
+    return;
+
+  rmaIncumbentUnrelayed = false;
+
+  MPI_Put(&incumbentFoundTime,1,MPI_DOUBLE,0,
+	  rmaTimeOffset + searchRank*sizeof(double),1,MPI_DOUBLE,
+	  rmaIncumbentWin);
+  MPI_Win_flush(0,rmaIncumbentWin);
+
+  rmaIncumbentPair pair;
+  pair.value  = incumbentValue;
+  pair.source = incumbentSource;
+  MPI_Accumulate(&pair,1,MPI_DOUBLE_INT,0,0,1,MPI_DOUBLE_INT,
+		 (sense == minimization) ? MPI_MINLOC : MPI_MAXLOC,
+		 rmaIncumbentWin);
+  MPI_Win_flush(0,rmaIncumbentWin);
+#endif
+}
+
+
+// Read the window, and take its incumbent if it is better than ours.
+// Called by the worker at the start of each slice, before pruning.
+
+void parallelBranching::pollRMAIncumbent()
+{
+#if MPI_VERSION >= 3
+  if (!usingRMAIncumbent)
+    return;
+
+  rmaIncumbentPair pair;
+  MPI_Get_accumulate(NULL,0,MPI_DOUBLE_INT,
+		     &pair,1,MPI_DOUBLE_INT,
+		     0,0,1,MPI_DOUBLE_INT,MPI_NO_OP,rmaIncumbentWin);
+  MPI_Win_flush(0,rmaIncumbentWin);
+
+  if (!adoptIncumbent(pair.value,pair.source))
+    return;
+
+  MPI_Get(&incumbentFoundTime,1,MPI_DOUBLE,0,
+	  rmaTimeOffset + pair.source*sizeof(double),1,MPI_DOUBLE,
+	  rmaIncumbentWin);
+  MPI_Win_flush(0,rmaIncumbentWin);
+
+  rmaIncumbentUnrelayed = true;
+  rmaIncumbentCount++;
+  rmaIncumbentLatency += WallClockSeconds() - incumbentFoundTime;
+  DEBUGPR(10,ucout << "Incumbent " << incumbentValue 
+	  << " from window, source " << incumbentSource << endl);
+#endif
+}
+
+} // namespace pebbl
+
+#endif
@@ -22,6 +22,7 @@
 #include <pebbl/utilib/mpiUtil.h>
 #include <pebbl/utilib/nicePrint.h>
 #include <pebbl/pbb/parBranching.h>
+#include <pebbl/comm/bufferPool.h>
 
 #ifdef ACRO_HAVE_MPI
 
@@ -220,8 +221,14 @@ ostream* parallelBranching::valLogFile()
   if (validateLog)
     {
       char name[32];
+      ios::openmode mode = restarted ? ios::app : ios::out;
+      if (validateLogBinary)
+	{
+	  sprintf(name,"val%05d.vbin",searchRank);
+	  return new valLogStream(name,mode | ios::binary);
+	}
       sprintf(name,"val%05d.log",searchRank);
-      return new ofstream(name,restarted ? ios::app : ios::out);
+      return new ofstream(name,mode);
     }
   else
     return 0;
@@ -230,6 +237,17 @@ ostream* parallelBranching::valLogFile()
 
 void parallelBranchSub::valLogPackChildPrint()
 {
+  if (valLogBinary())
+    {
+      valLogRecord r(valLogRecord::packChild);
+      r.proc         = pGlobal()->searchRank;
+      r.serial       = bGlobal()->probCounter;
+      r.bound        = bound;
+      r.parentProc   = valLogProc();
+      r.parentSerial = id.serial;
+      valLogWrite(r);
+      return;
+    }
   *vout << "packchild " << pGlobal()->searchRank 
         << ' ' << bGlobal()->probCounter << ' ' << bound << ' ';
   valLogWriteID();
@@ -240,6 +258,12 @@ void parallelBranchSub::valLogPackChildPrint()
 
 void parallelBranchSub::valLogPackPrint()
 {
+  if (valLogBinary())
+    {
+      valLogRecord r = valLogRecordFor(valLogRecord::pack);
+      valLogWrite(r);
+      return;
+    }
   *vout << "pack ";
   valLogWriteID();
   valLogPackExtra();
@@ -249,6 +273,13 @@ void parallelBranchSub::valLogPackPrint()
 
 void parallelBranchSub::valLogUnpackPrint()
 {
+  if (valLogBinary())
+    {
+      valLogRecord r = valLogRecordFor(valLogRecord::unpack);
+      r.count = childrenLeft;
+      valLogWrite(r);
+      return;
+    }
   *vout << "unpack ";
   valLogWriteID(' ');
   *vout << childrenLeft;
@@ -331,14 +362,12 @@ void parallelBranching::startLoadLogIfNeeded()
   lastLog  = pLastLog;
   haveLLToken = true;
   needLLAppend = (searchRank > 0);
-  beginLoadLog();
+  beginLoadLog(searchRank);
 }
 
 
 void parallelBranching::recordLoadLogData(double time)
 {
-  bool recordingBounds = !(depthFirst || breadthFirst);
-
   size_type poolSize = 0;
   double    wBound = -sense*MAXDOUBLE;
 
@@ -379,25 +408,32 @@ void parallelBranching::recordLoadLogData(double time)
   record->releases   = spReleaseCount - pLastLog->releases;
   pLastLog->releases = spReleaseCount;
 
-  if (recordingBounds)
-    {
-      record->globalBound  = globalLoad.aggregateBound;
-      record->clusterBound = clusterLoad.aggregateBound;
-    }
+  record->globalBound  = globalLoad.aggregateBound;
+  record->clusterBound = clusterLoad.aggregateBound;
 
-  if (iAmHub() && recordingBounds)
+  if (iAmHub())
     record->hubBound = hubPool->updatedLoad().aggregateBound;
 
-  if (iAmWorker() && recordingBounds)
+  if (iAmWorker())
     record->serverBound = serverPool.updatedLoad().aggregateBound;
 
   recordSerialLoadData(record,time,poolSize,wBound);
 
-  // If this is processor 0 and it's time to write a chunk of the load
-  // log, write, and then start passing the token around the ring so
-  // everybody else writes in sequence.
+  // With a binary log, each processor writes its own file when it's
+  // time to write a chunk.  Otherwise, if this is processor 0 and
+  // it's time to write a chunk of the load log, write, and then start
+  // passing the token around the ring so everybody else writes in
+  // sequence.
 
-  if ((searchRank == 0) && needToWriteLoadLog(time) && haveLLToken)
+  if (loadLogBinary)
+    {
+      if (needToWriteLoadLog(time))
+	{
+	  lastLLWriteTime = time;
+	  branching::writeLoadLog();
+	}
+    }
+  else if ((searchRank == 0) && needToWriteLoadLog(time) && haveLLToken)
     {
       lastLLWriteTime = time;
       writeLoadLogPassToken();
@@ -463,6 +499,16 @@ void parallelBranching::receiveLLToken()
 
 void parallelBranching::writeLoadLog()
 {
+  // Binary logs are already on disk, one per processor; each just
+  // needs the shift that puts its times on the I/O processor's clock.
+  if (loadLogBinary)
+    {
+      double shift = loadLogTimeShift();
+      if (llWriter)
+	llWriter->setTimeShift(shift);
+      return;
+    }
+
   // See if we can get away with something simple -- either loadLogSMP
   // or writing the file in chunks, which implies each processor has
   // direct file system access.
@@ -581,6 +627,60 @@ void parallelBranching::writeLoadLog()
 }
 
 
+// For binary load logs: the amount to add to this processor's load
+// log times to measure them from the I/O processor's load log start,
+// on its clock.  Each processor estimates its clock offset from the
+// I/O processor's with the round trip of loadLogClockSyncs pings,
+// as above but the other way around.
+
+double parallelBranching::loadLogTimeShift()
+{
+  double ioBaseTime = loadLogBaseTime;
+  searchComm.broadcast(&ioBaseTime,1,MPI_DOUBLE,mySearchIoProc);
+
+  double clockOffset = 0;     // I/O processor's clock minus ours
+
+  if (!loadLogSMP)
+    {
+      MPI_Status status;
+      if (iDoSearchIO)
+	{
+	  for (int p=0; p<searchSize; p++)
+	    if (p != searchRank)
+	      for (int i=0; i<loadLogClockSyncs; i++)
+		{
+		  double localTime = 0;
+		  searchComm.recv(&localTime,0,MPI_DOUBLE,p,
+				  llSyncOutTag,&status);
+		  localTime = WallClockSeconds();
+		  searchComm.send(&localTime,1,MPI_DOUBLE,p,llSyncBackTag);
+		}
+	}
+      else
+	{
+	  double shortestTurn = MAXDOUBLE;
+	  for (int i=0; i<loadLogClockSyncs; i++)
+	    {
+	      double ioTime = 0;
+	      double startTime = WallClockSeconds();
+	      searchComm.send(&ioTime,0,MPI_DOUBLE,mySearchIoProc,
+			      llSyncOutTag);
+	      searchComm.recv(&ioTime,1,MPI_DOUBLE,mySearchIoProc,
+			      llSyncBackTag,&status);
+	      double roundTrip = WallClockSeconds() - startTime;
+	      if (roundTrip < shortestTurn)
+		{
+		  shortestTurn = roundTrip;
+		  clockOffset  = ioTime - (startTime + roundTrip/2);
+		}
+	    }
+	}
+    }
+
+  return loadLogBaseTime + clockOffset - ioBaseTime;
+}
+
+
 // Guts of writing a chunk of the load log file.
 
 void parLoadLogRecord::writeToStream(ostream& os,
@@ -613,6 +713,36 @@ void parLoadLogRecord::writeToStream(ostream& os,
 }
 
 
+void parLoadLogRecord::writeToRow(double* row,
+				  int     /*sense*/,
+				  double  baseTime,
+				  int     proc)
+{
+  row[loadLogColumns::procCol]         = proc;
+  row[loadLogColumns::timeCol]         = time - baseTime;
+  row[loadLogColumns::boundCallsCol]   = boundCalls;
+  row[loadLogColumns::poolCol]         = pool;
+  row[loadLogColumns::hubPoolCol]      = hubPool;
+  row[loadLogColumns::totalPoolCol]    = pool + hubPool;
+  row[loadLogColumns::serverPoolCol]   = serverPool;
+  row[loadLogColumns::gLoadCol]        = gLoad;
+  row[loadLogColumns::cLoadCol]        = cLoad;
+  row[loadLogColumns::releasesCol]     = releases;
+  row[loadLogColumns::boundCol]        = bound;
+  row[loadLogColumns::incumbentCol]    = incVal;
+  row[loadLogColumns::globalBoundCol]  = globalBound;
+  row[loadLogColumns::clusterBoundCol] = clusterBound;
+  row[loadLogColumns::hubBoundCol]     = hubBound;
+  row[loadLogColumns::serverBoundCol]  = serverBound;
+  row[loadLogColumns::offersCol]       = offers;
+  row[loadLogColumns::admitsCol]       = admits;
+  row[loadLogColumns::dispatchCol]     = dispatch;
+  row[loadLogColumns::receptionCol]    = reception;
+  row[loadLogColumns::rebalCol]        = rebal;
+  row[loadLogColumns::lbRoundsCol]     = lbRounds;
+}
+
+
 //  Printout of processor configuration.
 
 void parallelBranching::printConfiguration(ostream& stream)
@@ -681,6 +811,28 @@ void parallelBranching::printSPStatistics(ostream& stream)
   int totalLoadBalanced    = 0;
   if (numHubs() > 1)
     totalLoadBalanced = searchComm.sumReduce(loadBalSPCount);
+  int totalStolen        = 0;
+  int totalStealRequests = 0;
+  int totalStealRefused  = 0;
+  if (workStealing)
+    {
+      totalStolen        = searchComm.sumReduce(spStolenCount);
+      totalStealRequests = searchComm.sumReduce(stealRequestCount);
+      totalStealRefused  = searchComm.sumReduce(stealRefusedCount);
+    }
+  int    totalOwnerDispatch  = 0;
+  int    totalNodeDispatch   = 0;
+  int    totalRemoteDispatch = 0;
+  double totalBytesMoved     = 0;
+  double totalBytesInNode    = 0;
+  if (localDispatch)
+    {
+      totalOwnerDispatch  = searchComm.sumReduce(ownerDispatchCount);
+      totalNodeDispatch   = searchComm.sumReduce(nodeDispatchCount);
+      totalRemoteDispatch = searchComm.sumReduce(remoteDispatchCount);
+      totalBytesMoved     = searchComm.sumReduce(spBytesMoved);
+      totalBytesInNode    = searchComm.sumReduce(spBytesMovedInNode);
+    }
 
   if (iDoSearchIO)
     {
@@ -757,7 +909,15 @@ void parallelBranching::printSPStatistics(ostream& stream)
 		  fieldWidth,
 		  numWidth);
 
-      if (numHubs() > 1)
+      if (workStealing)
+	printSPLine(stream,
+		    totalStolen,
+		    "Stolen by Workers",
+		    spTotal,
+		    fieldWidth,
+		    numWidth);
+
+      if ((numHubs() > 1) && !workStealing)
 	{
 	  printSPLine(stream,
 		      globalLoad.messages.nonLocalScatter.sent,
@@ -773,6 +933,18 @@ void parallelBranching::printSPStatistics(ostream& stream)
 		      numWidth);
 	}
 
+      if (workStealing)
+	stream << '\n' << totalStealRequests << " steal request"
+	       << plural(totalStealRequests) << ", " << totalStealRefused 
+	       << " refused\n";
+
+      if (localDispatch)
+	stream << '\n' << "Dispatches: " << totalOwnerDispatch
+	       << " to owner, " << totalNodeDispatch << " within a node, "
+	       << totalRemoteDispatch << " remote; "
+	       << totalBytesMoved/1024 << " KB of subproblems moved, "
+	       << totalBytesInNode/1024 << " KB within a node\n";
+
       stream << '\n';
       CommonIO::begin_tagging();
     }
@@ -843,6 +1015,30 @@ void parallelBranching::printTimings(ostream& stream)
   double idleProcTime;
   double procThreadTime;
   sched.timing(searchTime,idleProcTime,procThreadTime);
+
+  int    idlePolls, idleSleeps, idleWakeups;
+  double idleSleepTime;
+  sched.idleStats(idlePolls,idleSleeps,idleWakeups,idleSleepTime);
+  idlePolls     = searchComm.sumReduce(idlePolls);
+  idleSleeps    = searchComm.sumReduce(idleSleeps);
+  idleWakeups   = searchComm.sumReduce(idleWakeups);
+  idleSleepTime = searchComm.sumReduce(idleSleepTime);
+
+  int    treeIncCount = searchComm.sumReduce(treeIncumbentCount);
+  int    rmaIncCount  = searchComm.sumReduce(rmaIncumbentCount);
+  double treeIncTime  = searchComm.sumReduce(treeIncumbentLatency);
+  double rmaIncTime   = searchComm.sumReduce(rmaIncumbentLatency);
+
+  packBufferPool& pool = bufferPool();
+  int    poolRequests  = searchComm.sumReduce(pool.requests);
+  int    poolReuses    = searchComm.sumReduce(pool.reuses);
+  int    poolAllocs    = searchComm.sumReduce(pool.allocations);
+  double poolBytes     = searchComm.sumReduce(pool.bytesAllocated);
+  int    poolDiscards  = searchComm.sumReduce(pool.discards);
+  int    ringMsgs      = searchComm.sumReduce(hub->ringMessages()
+					      + spReceiver->ringMessages());
+  int    ringWaiting   = searchComm.sumReduce(hub->ringWaitingCount()
+					      + spReceiver->ringWaitingCount());
   double schedProcTime = searchTime - procThreadTime - idleProcTime;
   if (schedProcTime < 0)
     schedProcTime = 0;
@@ -886,14 +1082,41 @@ void parallelBranching::printTimings(ostream& stream)
 	  int r = loadBalancer->numRounds();
 	  int s = loadBalancer->numSurveyRestarts();
 	  stream << r << " load balancing round" << plural(r) << ", "
-	    << s << " survey restart" << plural(s) << ".\n";
+	    << s << " survey restart" << plural(s);
+	  int l = loadBalancer->numHubLevels();
+	  if (l > 1)
+	    stream << ", cycling through " << l << " hub levels";
+	  stream << ".\n";
 	}
 
       {
 	int qp = loadBalancer->numQuiescencePolls();
 	int tc = loadBalancer->numTermChecks();
 	stream << qp << " quiescence poll" << plural(qp) << ", "
-	       << tc << " termination check" << plural(tc) << ".\n\n";
+	       << tc << " termination check" << plural(tc) << ".\n";
+	stream << idlePolls << " idle scheduler poll" << plural(idlePolls)
+	       << ", " << idleSleeps << " sleep" << plural(idleSleeps)
+	       << " (" << idleSleepTime/searchSize << " seconds average), "
+	       << idleWakeups << " wakeup" << plural(idleWakeups) 
+	       << ".\n";
+	if (rmaIncumbent && (searchSize > 1))
+	  stream << "Incumbents received: " 
+		 << treeIncCount << " by tree, average latency "
+		 << 1000*treeIncTime/max(treeIncCount,1) << " ms; "
+		 << rmaIncCount << " from window, average latency "
+		 << 1000*rmaIncTime/max(rmaIncCount,1) << " ms.\n";
+	if (searchSize > 1)
+	  {
+	    stream << "Send buffers: " << poolRequests << " requested, "
+		   << poolReuses << " reused, " << poolAllocs 
+		   << " allocated (" << poolBytes/1024 << " KB), "
+		   << poolDiscards << " discarded.\n";
+	    if (recvRingSlots > 1)
+	      stream << "Receive rings: " << ringMsgs << " message"
+		     << plural(ringMsgs) << ", " << ringWaiting
+		     << " already received when the previous one was done.\n";
+	  }
+	stream << '\n';
       }
 
       timingPrintText(stream,' ',' ',
@@ -975,11 +1198,14 @@ void parallelBranching::printTimings(ostream& stream)
     {
       if (checkpointsEnabled)
 	{
-	  int cpsWritten = checkpointNumber - restartCPNum;
+	  int cpsWritten = (usingAsyncCheckpoints ? asyncCPLastDone :
+			                            checkpointNumber) - restartCPNum;
 	  stream << endl << cpsWritten 
 		 << " checkpoint" << plural(cpsWritten)
-		 << " written, consuming " << checkpointTotalTime 
-		 << " seconds.\n";
+		 << " written, "
+		 << (usingAsyncCheckpoints ? "pausing the search for " :
+		                             "consuming ")
+		 << checkpointTotalTime << " seconds.\n";
 	}
       stream.setf(ios::fixed,ios::floatfield);
       stream.precision(2);
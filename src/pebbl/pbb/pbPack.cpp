@@ -94,7 +94,7 @@ void parallelBranchSub::packChildGeneric(PackBuffer& outBuffer)
   // The state.  Currently use branchSub default in milpNode constructors
   outBuffer << (int) boundable; 
   // This is where creation is recorded
-  bGlobal()->subCount[boundable]++;
+  bGlobal()->bumpCounter(bGlobal()->subCount[boundable]);
   outBuffer << depth + 1;
   outBuffer << 0;                          // totalChildren
   outBuffer << 0;                          // childrenLeft
@@ -118,6 +118,8 @@ void parallelBranchSub::unpackGeneric(UnPackBuffer& inBuffer)
 
 void spToken::pack(PackBuffer& outBuffer)
 {
+  if (packedSize > 0)
+    outBuffer.reserve(packedSize);
   outBuffer << bound;
   outBuffer << integralityMeasure;
   outBuffer << (int) state;
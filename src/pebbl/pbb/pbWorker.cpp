@@ -23,6 +23,7 @@
 #include <pebbl/utilib/mpiUtil.h>
 #include <pebbl/utilib/seconds.h>
 #include <pebbl/pbb/parBranching.h>
+#include <pebbl/pbb/computeThread.h>
 #include <pebbl/comm/packPointer.h>
 #include <pebbl/misc/gRandom.h>
 
@@ -39,19 +40,43 @@ namespace pebbl {
 
 
 // This overloads the signalIncumbent operation and makes it also
-// initiate a broadcast of the new information.
+// initiate a broadcast of the new information.  Compute threads may
+// not communicate, so they leave the broadcast to the main thread.
 
 void parallelBranching::signalIncumbent()
 {
+  if (computeThread::current())
+    {
+      branching::signalIncumbent();
+      incumbentSource = searchRank;
+      computeIncumbentPending = true;
+      callMainThread();
+      return;
+    }
+
   UTILIB_LOG_EVENT(1,start,foundIncLogState);
 
   branching::signalIncumbent();
   incumbentSource = searchRank;
 
+  announceIncumbent();
+};
+
+
+// The part of signalIncumbent that tells the other processors.
+
+void parallelBranching::announceIncumbent()
+{
   WORKERDEBUG(1,ucout << "New incumbent found: value=" << incumbentValue 
 	      << ", source=" << incumbentSource 
 	      << ", time=" << CPUSeconds() - baseTime << endl);
 
+  // An asynchronous checkpoint still collecting in-flight subproblems
+  // must carry this incumbent; see pbCheckpoint.cpp.
+
+  if (asyncCPStage == asyncCPLogging)
+    packAsyncCheckpointHeader();
+
   if (iAmHub() && !rampingUp())
     {
       setToInformAll();
@@ -59,7 +84,11 @@ void parallelBranching::signalIncumbent()
     }
 
   if (!rampingUp())
-    incumbentCaster->initiateBroadcast();
+    {
+      incumbentFoundTime = WallClockSeconds();
+      publishRMAIncumbent();
+      incumbentCaster->initiateBroadcast();
+    }
 
   UTILIB_LOG_EVENT(1,end,foundIncLogState);
 
@@ -118,13 +147,26 @@ void parallelBranching::workerExecute(double* controlParam)
 	      << workerPool->size() << '\n');
   WORKERDEBUG(20,ucout << "Incumbent is " << incumbentValue << '\n');
   forceWorkerToRun = false;
+  pollRMAIncumbent();
   pruneIfNeeded();
   workLeft = *controlParam;
   workUsed = 0;
 
   UTILIB_LOG_EVENT(1,start,workerLogState);
 
-  if (!suspending())
+  if (usingComputeThreads())
+    {
+      if (!suspending())
+	computeSlice();
+      workerPool->load().update();
+      if (workersPrintStatus)
+	statusPrint(workerLastPrint,
+		    workerLastPrintTime,
+		    workerPool->load(),
+		    "w");
+      recordLoadLogIfNeeded();
+    }
+  else if (!suspending())
     {
       do
 	{
@@ -151,6 +193,8 @@ void parallelBranching::workerExecute(double* controlParam)
   else if (!didARebalance && shouldCommunicateWithHub(localScatterQuantum))
     workerCommunicateWithHub();
 
+  stealIfIdle();
+
   UTILIB_LOG_EVENT(1,end,workerLogState);
   
   WORKERDEBUG(40,ucout << "Worker slice done at " << 
@@ -197,7 +241,7 @@ void parSPHandler::heuristic()
     {
       pp->quickIncumbentHeuristic();
       if (pGlobal->incumbentThreadExists)
-	pp->feedToIncumbentThread();
+	feedIncumbentThread(pp);
     }
 }
 
@@ -219,7 +263,7 @@ bool parEagerHandler::boundSubHandler()
     {
       pbp->quickIncumbentHeuristic();
       if (pGlobal->haveIncumbentHeuristic())
-	pbp->feedToIncumbentThread();
+	feedIncumbentThread(pbp);
     }
   if((pbp->state == bounded) && shouldRelease())
     {
@@ -315,7 +359,9 @@ void parallelBranching::deliverSP(branchSubId& id,
       else
 	{
 	  PackBuffer* outBuf = startPackingSP(bound,destProcessor,hubAddress);
+	  int startSize = outBuf->size();
 	  p->packProblem(*outBuf);
+	  countBytesMoved(outBuf->size() - startSize,destProcessor);
 	  finishDeliverSP(outBuf,destProcessor);
 	  WORKERDEBUG(100,ucout << "'Self' token sent to [" 
 		      << destProcessor << "].\n");
@@ -334,7 +380,9 @@ void parallelBranching::deliverSP(branchSubId& id,
       else
 	{
 	  PackBuffer* outBuf = startPackingSP(bound,destProcessor,hubAddress);
+	  int startSize = outBuf->size();
 	  p->packChild(*outBuf,p->chooseChild(whichChild));
+	  countBytesMoved(outBuf->size() - startSize,destProcessor);
 	  finishDeliverSP(outBuf,destProcessor);
 	  WORKERDEBUG(100,ucout << "Child " << whichChild 
 		      << " sent to [" << destProcessor 
@@ -412,6 +460,14 @@ void parallelBranching::finishDeliverSP(PackBuffer* outBuf,int dest)
 	  *auxBuf << (int) spBufferWarningSignal;
 	  *auxBuf << bsize;
 	  auxDeliverSPQ.send(auxBuf,dest,deliverSPTag);
+	  if (recvRingSlots > 1)
+	    {
+	      // Ring slots don't grow, so the receiver takes this
+	      // message by itself, on its own tag.
+	      deliverSPBuffers.sendOnly(dest,deliverBigSPTag);
+	      spDeliverCount++;
+	      return;
+	    }
 	  knownBufferSize[dest] = bsize;
 	}
       DEBUGPR(100,ucout << "Forcing spDeliver message now...\n");
@@ -655,7 +711,10 @@ void parallelBranching::workerRelease(parallelBranchSub* p,
 	  if (releaseProbCount == maxTokensInHubMsg) {
 	    WORKERDEBUG(100,ucout << "Sending to my hub, count=" 
 			<< releaseProbCount << '\n');
-	    workerCommunicateWithHub(rebalanceFlag);
+	    if (computeThread::current())
+	      callMainThread();        // It sends after the slice
+	    else
+	      workerCommunicateWithHub(rebalanceFlag);
 	  }
 	}
     }
@@ -733,7 +792,7 @@ bool parallelBranching::shouldScatterToRandom()
 
 bool parallelBranching::workerShouldRelease()
 {
-  if (rampingUp())
+  if (rampingUp() || workStealing)
     return false;
 
   releaseTestCount++;
@@ -869,7 +928,7 @@ void parallelBranching::getLoadInfoFromHub(UnPackBuffer& inBuf)
 
 int parallelBranching::rebalanceIfNeeded()
 {
-  if (!rebalancing)
+  if (!rebalancing || workStealing)
     return 0;
 
   WORKERDEBUG(150,ucout << "\n\n\nrebalanceIfNeeded() activated.\n");
@@ -972,6 +1031,183 @@ int parallelBranching::rebalanceIfNeeded()
 }
 
 
+//  Work stealing.  A worker tries to steal when its own pool is empty
+//  but the last survey found work elsewhere.  Once it has been refused
+//  stealRetries times in a row, it waits for the next survey round.
+
+bool parallelBranching::wantToSteal()
+{
+  if (!workStealing || (searchSize == 1) || stealPending ||
+      rampingUp() || suspending() || (spCount() > 0))
+    return false;
+  if (stealFailures >= stealRetries)
+    {
+      if (loadBalancer->numRounds() <= stealDormantRound)
+	return false;
+      stealFailures = 0;
+    }
+  return globalLoad.count() > 0;
+}
+
+
+//  Send a steal request if the worker is idle.  The answer comes back
+//  to the spReceiver thread.
+
+void parallelBranching::stealIfIdle()
+{
+  if (!wantToSteal())
+    return;
+
+  int victim = chooseStealVictim();
+  WORKERDEBUG(20,ucout << "Asking [" << victim << "] for work, "
+	      << stealFailures << " refusals so far.\n");
+  PackBuffer* outBuf = stealRequestQ.getFree();
+  *outBuf << stealMaxSPs;
+  stealRequestQ.send(outBuf,victim,stealTag);
+  recordMessageSent(worker);
+  stealPending = true;
+  stealRequestCount++;
+}
+
+
+//  Pick a processor other than this one.  With stealNeighborhood > 1,
+//  every other request stays within this processor's aligned block
+//  of stealNeighborhood ranks.
+
+int parallelBranching::chooseStealVictim()
+{
+  int first = 0;
+  int range = searchSize;
+  if ((stealNeighborhood > 1) && (stealRequestCount % 2 == 0))
+    {
+      first = (searchRank/stealNeighborhood)*stealNeighborhood;
+      range = std::min(stealNeighborhood,searchSize - first);
+      if (range < 2)
+	{
+	  first = 0;
+	  range = searchSize;
+	}
+    }
+  int victim = first + std::min((int) floor(gRandom()*(range - 1)),range - 2);
+  if (victim >= searchRank)
+    victim++;
+  return victim;
+}
+
+
+//  Answer a steal request.  Give the thief at most half of the pool,
+//  taken the way rebalancing takes subproblems, and never the best
+//  one.  A separated subproblem gives up one child at a time.  If
+//  there is nothing to give, say so, so the thief can try elsewhere.
+
+void parallelBranching::donateStolenWork(int thief,int wanted)
+{
+  int startingPoolSize = workerPool->size();
+  int limit            = std::min(wanted,startingPoolSize/2);
+  if (rampingUp() || suspending())
+    limit = 0;
+
+  int sent             = 0;
+  int scanned          = 0;
+  parallelBranchSub* p = (limit > 0) ? workerPool->firstToUnload() : NULL;
+
+  while(p && (scanned < startingPoolSize) && (sent < limit))
+    {
+      scanned++;
+      if (!p->canTokenize() || p->canFathom() ||
+	  ((p->state == separated) && (p->childrenLeft <= p->tokenCount)))
+	{
+	  p = workerPool->nextToUnload();
+	  continue;
+	}
+
+      PackBuffer* outBuf = startPackingSP(p->bound,thief,NULL);
+      if (p->state == separated)
+	{
+	  WORKERDEBUG(100,ucout << "Giving a child of " << p << " to ["
+		      << thief << "].\n");
+	  p->packChild(*outBuf,p->chooseChild(anyChild));
+	  if (p->childrenLeft <= p->tokenCount)
+	    {
+	      workerPool->remove(p);
+	      workerDisposeSP(p);
+	    }
+	}
+      else
+	{
+	  WORKERDEBUG(100,ucout << "Giving " << p << " to ["
+		      << thief << "].\n");
+	  workerPool->remove(p);
+	  p->packProblem(*outBuf);
+	  workerDisposeSP(p);
+	}
+      finishDeliverSP(outBuf,thief);
+      recordMessageSent(stealServer);
+      sent++;
+
+      p = workerPool->nextToUnload();
+    }
+
+  if (sent > 0)
+    {
+      if (deliverSPBuffers.segCount(thief) > 0)
+	deliverSPBuffers.sendOnly(thief);
+      WORKERDEBUG(20,ucout << "Gave " << sent << " subproblems to ["
+		  << thief << "], " << workerPool->size() << " left.\n");
+    }
+  else
+    {
+      WORKERDEBUG(20,ucout << "Refusing steal request from [" 
+		  << thief << "].\n");
+      PackBuffer* outBuf = auxDeliverSPQ.getFree();
+      *outBuf << (int) spNoWorkSignal;
+      auxDeliverSPQ.send(outBuf,thief,deliverSPTag);
+      recordMessageSent(stealServer);
+    }
+}
+
+
+//  Stolen subproblems arrive without a token, so there is no hub to
+//  acknowledge.
+
+void parallelBranching::addStolenToWorkerPool(parallelBranchSub* p)
+{
+  recordMessageReceived(spReceiver);
+  spStolenCount++;
+  stealPending  = false;
+  stealFailures = 0;
+
+  if (p->canFathom())
+    {
+      WORKERDEBUG(20,ucout << "Destroying fathomable stolen problem " 
+		  << p << '\n');
+      p->recycle();
+    }
+  else
+    {
+      WORKERDEBUG(20,ucout << "Inserting stolen " << p 
+		  << " into worker pool.\n");
+      workerPool->insert(p);
+    }
+  forceWorkerToRun = true;
+}
+
+
+void parallelBranching::stealRefused()
+{
+  recordMessageReceived(spReceiver);
+  stealPending = false;
+  stealRefusedCount++;
+  if (++stealFailures >= stealRetries)
+    {
+      stealDormantRound = loadBalancer->numRounds();
+      WORKERDEBUG(20,ucout << "Steal requests refused " << stealFailures
+		  << " times; waiting past round " << stealDormantRound 
+		  << ".\n");
+    }
+}
+
+
 //  This sets the bias of the incumbent thread.  It's the default 
 //  implementation and can be overriden.
 
@@ -49,6 +49,7 @@ messageTriggeredPBThread(global_,
   inBuf.resize(bufferSize);
   DEBUGPRX(50,global,name << " buffer size overridden to " 
 	   << bufferSize << endl);
+  ringSlots = global_->recvRingSlots;
 }
 
 
@@ -67,7 +68,16 @@ int spReceiverObj::computeBufferSize(parallelBranching* global_)
 //  immediately fathom it,  place it in the worker pool.  
 //  We now also check if we got a buffer enlargement warning instead
 //  of a set of packed subproblems.  In that case, enlarge the buffer
-//  and go back to receiving.
+//  and go back to receiving.  With a receive ring, the slots cannot be
+//  enlarged, so the sender follows the warning with the subproblems on
+//  deliverBigSPTag, and we receive them right away.  With work
+//  stealing, the message may instead refuse a steal request, and
+//  stolen subproblems come with a null hub address.  With
+//  asyncCheckpoint, another worker's checkpoint marker comes this way,
+//  behind everything it sent before its snapshot.
+//
+//  Subproblems are unpacked straight from the buffer the message was
+//  received into.
 
 ThreadObj::RunStatus spReceiverObj::handleMessage(double* controlParam)
 {
@@ -84,7 +94,9 @@ ThreadObj::RunStatus spReceiverObj::handleMessage(double* controlParam)
       inBuf >> wantBufSize;
       DEBUGPR(100,ucout << "Want buffer of " << bufferSize 
 	      << " expanded to " << wantBufSize << endl);
-      if ((int) bufferSize < wantBufSize)
+      if (ringSlots > 1)
+	receiveBigMessage(status.MPI_SOURCE,wantBufSize);
+      else if ((int) bufferSize < wantBufSize)
 	{
 	  inBuf.resize(wantBufSize);
 	  bufferSize = wantBufSize;
@@ -93,21 +105,77 @@ ThreadObj::RunStatus spReceiverObj::handleMessage(double* controlParam)
       return RunOK;
     }
 
+  if (signal == spNoWorkSignal)
+    {
+      DEBUGPR(20,ucout << "Steal request refused by [" 
+	      << status.MPI_SOURCE << "].\n");
+      global->stealRefused();
+      return RunOK;
+    }
+
+  if (signal == spCheckpointMarker)
+    {
+      int k = 0;
+      inBuf >> k;
+      DEBUGPR(20,ucout << "Checkpoint " << k << " marker from ["
+	      << status.MPI_SOURCE << "].\n");
+      global->checkpointMarkerReceived(status.MPI_SOURCE,k);
+      return RunOK;
+    }
+
   if (signal != spDeliverSignal)
      EXCEPTION_MNGR(runtime_error, "spReceiver got undecipherable signal");
 
+  unpackSubproblems(inBuf,status.MPI_SOURCE);
+  return RunOK;
+}
+
+
+void spReceiverObj::unpackSubproblems(UnPackBuffer& buf,int source)
+{
   do 
     {
-      spToken* hubAddress = (spToken*) unpackPointer(inBuf);
+      spToken* hubAddress = (spToken*) unpackPointer(buf);
       double bound;
-      inBuf >> bound;
+      buf >> bound;
       DEBUGPRX(100,global,"Bound of arriving problem is " << bound << '\n');
       parallelBranchSub* p = global->blankParallelSub();
-      p->unpackProblem(inBuf);
+      p->unpackProblem(buf);
       DEBUGPRXP(20,global,"Received subproblem " << p);
-      global->addToWorkerPool(p,bound,hubAddress);
-    } while(multiOutBufferQueue::segmentsLeft(inBuf));
-  return RunOK;
+      global->checkpointInFlight(p,source);
+      if (hubAddress)
+	global->addToWorkerPool(p,bound,hubAddress);
+      else
+	global->addStolenToWorkerPool(p);      // No token: it was stolen
+    } while(multiOutBufferQueue::segmentsLeft(buf));
+}
+
+
+// Receive and unpack a delivery that did not fit in a ring slot.  The
+// sender has already started it, right after the warning.
+
+void spReceiverObj::receiveBigMessage(int source,int size)
+{
+  if ((int) bigBuf.size() < size)
+    bigBuf.resize(size);
+  MPI_Status bigStatus;
+  recv((void *) bigBuf.buf(),
+       size,
+       MPI_PACKED,
+       source,
+       global->deliverBigSPTag,
+       &bigStatus);
+  messagesReceived++;
+  bigBuf.reset(&bigStatus);
+  DEBUGPR(100,ucout << "Received " << size << "-byte delivery from "
+	  << source << " on its own tag\n");
+
+  int signal = -1;
+  bigBuf >> signal;
+  if (signal != spDeliverSignal)
+     EXCEPTION_MNGR(runtime_error, "spReceiver got undecipherable signal "
+		    "in oversized delivery");
+  unpackSubproblems(bigBuf,source);
 }
 
 } // namespace pebbl
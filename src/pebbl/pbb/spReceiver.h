@@ -38,6 +38,16 @@ public:
   RunStatus handleMessage(double* controlParam);
 
   int computeBufferSize(parallelBranching* global_);
+
+protected:
+
+  void unpackSubproblems(UnPackBuffer& buf,int source);
+
+  void receiveBigMessage(int source,int size);
+
+  // For deliveries too big for a ring slot
+
+  UnPackBuffer bigBuf;
 };
 
 } // namespace pebbl
@@ -0,0 +1,57 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+//
+// stealServer.cpp
+//
+// This thread receives steal requests from idle workers, and answers
+// them with subproblems from the local pool.
+//
+
+#include <pebbl_config.h>
+#include <pebbl/pbb/parBranching.h>
+
+#ifdef ACRO_HAVE_MPI
+
+using namespace std;
+
+namespace pebbl {
+
+
+//  Constructor.  A request is a single integer: the most subproblems
+//  the thief wants.
+
+stealServerObj::stealServerObj(parallelBranching* global_) :
+messageTriggeredPBThread(global_,
+			 "Steal Server",
+			 "Steal",
+			 "khaki",
+			 3,100,
+			 sizeof(int),
+			 global_->stealTag)
+{ }
+
+
+//  Run method.  The parallelBranching object decides what to give up.
+
+ThreadObj::RunStatus stealServerObj::handleMessage(double* /*controlParam*/)
+{
+  global->recordMessageReceived(this);
+  int wanted = 0;
+  inBuf >> wanted;
+  DEBUGPR(100,ucout << "Steal request for " << wanted << " from ["
+	  << status.MPI_SOURCE << "].\n");
+  global->donateStolenWork(status.MPI_SOURCE,wanted);
+  return RunOK;
+}
+
+} // namespace pebbl
+
+#endif
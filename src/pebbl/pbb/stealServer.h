@@ -0,0 +1,53 @@
+/*  _________________________________________________________________________
+ *
+ *  Acro: A Common Repository for Optimizers
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README.txt file in the top Acro directory.
+ *  _________________________________________________________________________
+ */
+
+/**
+ * \file stealServer.h
+ *
+ * This thread answers steal requests when workStealing is set.  In
+ * that mode every processor is its own one-processor cluster, workers
+ * never release subproblems to hubs, and hubs do no load balancing.
+ * Instead, a worker whose pool runs dry asks a randomly chosen
+ * processor for work.  The victim answers on the subproblem delivery
+ * channel, either with up to half of its pool, packed exactly as
+ * spServer packs subproblems, or with a refusal.  Requests and
+ * answers are counted as general messages, so the usual survey and
+ * termination check of the load balancer also covers work in flight.
+ */
+
+#ifndef pebbl_stealServer_h
+#define pebbl_stealServer_h
+
+#include <pebbl_config.h>
+
+#include <pebbl/pbb/parBranchThreads.h>
+
+
+#ifdef ACRO_HAVE_MPI
+
+namespace pebbl {
+
+
+class stealServerObj : public messageTriggeredPBThread
+{
+public:
+
+  stealServerObj(parallelBranching* global_);
+
+  RunStatus handleMessage(double* controlParam);
+
+};
+
+} // namespace pebbl
+
+#endif
+
+#endif
@@ -138,6 +138,16 @@ ThreadObj::RunStatus workerAuxObj::handleMessage(double* controlParam)
       DEBUGPR(150,ucout << "write checkpoint signal.\n");
       global->writeCheckpoint();
       break;
+
+    case asyncCheckpointSignal:
+
+      {
+	int k = 0;
+	inBuf >> k;
+	DEBUGPR(150,ucout << "asynchronous checkpoint " << k << " signal.\n");
+	global->startAsyncCheckpoint(k);
+      }
+      break;
       
     case startAbortSignal:
 
@@ -59,6 +59,10 @@ bool workerThreadObj::ready()
     toReturn = true;
   else if (global->forceWorkerToRun)
     toReturn = true;
+  else if (global->computeSPCount > 0)  // Compute threads are busy
+    toReturn = true;
+  else if (global->wantToSteal())       // Idle, but work exists elsewhere
+    toReturn = true;
   else if (!global->iAmHub() && 
 	   (shouldComm = global->shouldCommunicateWithHub()))
     toReturn = true;
@@ -20,6 +20,9 @@
 #include <pebbl/utilib/mpiUtil.h>
 #include <pebbl/sched/Scheduler.h>
 
+#include <chrono>
+#include <thread>
+
 using namespace std;
 using namespace utilib;
 
@@ -27,6 +30,9 @@ namespace pebbl {
 
 #define MIN_TAG_VALUE -1
 
+// First sleep of an idle stretch, in seconds
+#define IDLE_SLEEP_START 1e-5
+
 //
 // Scheduler static data
 //
@@ -45,10 +51,18 @@ Scheduler::Scheduler(const int numTags)
 #ifdef ACRO_HAVE_MPI
    , num_requests(0)
 #endif
+   , idle_spin_polls(0),
+   idle_sleep_max(0.0),
+   run_lock(0),
+   run_guard(0)
 { 
   total_time=0.0;
   partial_time=0.0;
   run_time=0.0;
+  idle_polls=0;
+  idle_sleeps=0;
+  idle_wakeups=0;
+  idle_sleep_time=0.0;
 }
 
 
@@ -91,6 +105,10 @@ void Scheduler::reset()
   total_time=0.0;
   partial_time=0.0;
   run_time=0.0;
+  idle_polls=0;
+  idle_sleeps=0;
+  idle_wakeups=0;
+  idle_sleep_time=0.0;
 }
 
 
@@ -208,6 +226,12 @@ int Scheduler::execute()
 size_type group_ndx=0;
 termination_flag = false;
 double ttime=getTime();
+int idle_count=0;
+double idle_sleep=IDLE_SLEEP_START;
+std::unique_lock<std::mutex> guard;
+if (run_lock)
+   guard = std::unique_lock<std::mutex>(*run_lock);
+run_guard = &guard;
 
 
 //
@@ -270,6 +294,11 @@ while (!termination_flag) {
   // a blocked list or ready queue
   //
   if (group_ndx < threadGroup.size()) {
+     if (idle_count > 0) {
+        idle_wakeups++;
+        idle_count=0;
+        idle_sleep=IDLE_SLEEP_START;
+        }
      ThreadObj* thread;
      double priority;
      threadGroup[group_ndx]->remove(thread,priority);	// remove from queue
@@ -293,10 +322,16 @@ while (!termination_flag) {
      DEBUGPR(3, dump());
      } 
   else {
+     if (!state_changed) {
+        if (run_lock) guard.unlock();
+        idle(idle_count,idle_sleep);
+        if (run_lock) guard.lock();
+        }
      partial_time += getTime() - itime;
      }
   }
 
+run_guard = 0;
 total_time = getTime() - ttime;
 return 0;
 }
@@ -389,6 +424,30 @@ switch (thread->state()) {
 }
 
 
+//
+// Scheduler idle method
+//
+// Called after a pass that found nothing to run and changed nothing.
+// Keeps polling for the first idle_spin_polls passes, so a busy
+// processor answers messages as quickly as before, then backs off
+// exponentially to idle_sleep_max.
+//
+void Scheduler::idle(int& consecutive, double& sleep)
+{
+idle_polls++;
+if ((++consecutive <= idle_spin_polls) || (idle_sleep_max <= 0.0))
+   return;
+
+sleep = std::min(sleep,idle_sleep_max);
+double sleep_start = WallClockSeconds();
+std::this_thread::sleep_for(std::chrono::duration<double>(sleep));
+idle_sleep_time += WallClockSeconds() - sleep_start;
+idle_sleeps++;
+DEBUGPR(10, ucout << "Scheduler: idle, slept " << sleep << endl);
+sleep = std::min(2*sleep,idle_sleep_max);
+}
+
+
 //
 // Scheduler getTime method
 //
@@ -38,6 +38,8 @@
 #include <pebbl/sched/ThreadObj.h>
 #include <pebbl/sched/ThreadQueue.h>
 
+#include <mutex>
+
 namespace pebbl {
 
 using utilib::LinkedList;
@@ -77,6 +79,37 @@ public:
   void timing(double& total, double& partial, double& runtime)
 	{total=total_time; partial=partial_time; runtime=run_time;}
 
+  //
+  // Idle strategy.  After spinPolls consecutive passes that find no
+  // thread to run, the scheduler sleeps between passes, doubling the
+  // sleep each time up to sleepMax seconds.  Blocked threads may be
+  // waiting for a timer, so the sleep is always bounded.  A sleepMax
+  // of zero polls continuously.
+  //
+  void setIdleStrategy(int spinPolls, double sleepMax)
+	{idle_spin_polls=spinPolls; idle_sleep_max=sleepMax;}
+
+  //
+  // Lock shared with other operating-system threads.  If set, the
+  // scheduler holds it while it polls for messages, checks the state
+  // of threads or runs one, and releases it while it is idle.  A
+  // running thread may wait on runGuard() to release it.
+  //
+  void setRunLock(std::mutex* lock) {run_lock=lock;}
+
+  std::unique_lock<std::mutex>& runGuard() {return *run_guard;}
+
+  //
+  // Idle statistics
+  //	polls		Passes that found no thread to run
+  //	sleeps		Number of those passes followed by a sleep
+  //	wakeups		Idle stretches ended by a thread becoming ready
+  //	sleepTime	Wall-clock seconds spent sleeping
+  //
+  void idleStats(int& polls, int& sleeps, int& wakeups, double& sleepTime)
+	{polls=idle_polls; sleeps=idle_sleeps; wakeups=idle_wakeups;
+	 sleepTime=idle_sleep_time;}
+
 
 protected:
 
@@ -115,6 +148,17 @@ protected:
 
   double total_time, partial_time, run_time;
 
+  int idle_spin_polls;
+  double idle_sleep_max;
+
+  int idle_polls, idle_sleeps, idle_wakeups;
+  double idle_sleep_time;
+
+  void idle(int& consecutive, double& sleep);
+
+  std::mutex* run_lock;
+  std::unique_lock<std::mutex>* run_guard;
+
   int state_changed;
   
   double getTime();
@@ -923,6 +923,8 @@ inline utilib::PackBuffer& operator<<(utilib::PackBuffer& os,
 {
 os << obj.size();
 T* tmp = obj.data();
+if (utilib::packBlock(os,tmp,obj.size()))
+   return os;
 for (size_type i=0; i<obj.size(); i++, tmp++)
   os << *tmp;
 return os;
@@ -955,6 +957,8 @@ is >> len;
 obj.resize(len);
 
 T* tmp = obj.data();
+if (utilib::unpackBlock(is,tmp,len))
+   return is;
 for (size_type i=0; i<len; i++, tmp++)
   is >> *tmp;
 return is;
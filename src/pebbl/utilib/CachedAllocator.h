@@ -95,15 +95,16 @@ public:
 
 protected:
 
-  /// The list of unused objects
-  static CacheList<TYPE>* unused_list;
+  /// The list of unused objects.  The lists are kept per thread, so
+  /// that threads allocating concurrently do not corrupt them.
+  static thread_local CacheList<TYPE>* unused_list;
 
   /// The length of the unused_list.
   //static int unused_len;
 
   /// A list of CacheList objects that have been allocated but are not in use.
   /// These objects have an empty 'data' field.
-  static CacheList<TYPE>* tmp_list;
+  static thread_local CacheList<TYPE>* tmp_list;
 
   /// The length of the tmp_list.
   //static int tmp_len;
@@ -139,10 +140,10 @@ template <class TYPE>
 bool CachedAllocator<TYPE>::cache_enabled = true;
 
 template <class TYPE>
-CacheList<TYPE>* CachedAllocator<TYPE>::unused_list = 0;
+thread_local CacheList<TYPE>* CachedAllocator<TYPE>::unused_list = 0;
 
 template <class TYPE>
-CacheList<TYPE>* CachedAllocator<TYPE>::tmp_list = 0;
+thread_local CacheList<TYPE>* CachedAllocator<TYPE>::tmp_list = 0;
 
 //template <class TYPE>
 //int CachedAllocator<TYPE>::unused_len = 0;
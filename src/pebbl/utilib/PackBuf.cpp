@@ -29,6 +29,13 @@ using namespace std;
 namespace utilib {
 
 
+#ifdef UTILIB_USE_MPI_PACK
+bool PackBuffer::use_mpi_pack = true;
+#else
+bool PackBuffer::use_mpi_pack = false;
+#endif
+
+
 PackBuffer::PackBuffer(UnPackBuffer& copyBuf)
 {
   Size   = copyBuf.message_length();
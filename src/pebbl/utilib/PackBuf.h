@@ -21,16 +21,21 @@
 /**
  * \class utilib::PackBuffer
  *
- * A class that provides a facility for packing messages, using the MPI 
- * packing facilities. The PackBuffer class dynamically resizes the
- * internal buffer to contain enough memory to pack the entire object.  When 
- * deleted, the PackBuffer object deletes this internal buffer.
+ * A class that provides a facility for packing messages. The PackBuffer 
+ * class dynamically resizes the internal buffer to contain enough memory 
+ * to pack the entire object.  When deleted, the PackBuffer object deletes 
+ * this internal buffer.
+ *
+ * Values are packed by copying their bytes, which assumes that every
+ * processor uses the same data representation.  If 
+ * PackBuffer::use_mpi_pack is true (the default when built with 
+ * enable_mpi_pack), the MPI packing facilities are used instead.
  */
 /**
  * \class utilib::UnPackBuffer
  *
- * A class that provides a facility for unpacking messages, using the MPI 
- * packing facilities.
+ * A class that provides a facility for unpacking messages made by
+ * PackBuffer.
  */
 
  
@@ -38,6 +43,7 @@
 #define utilib_PackBuf_h
 
 #include <memory.h>
+#include <type_traits>
 #include <pebbl_config.h>
 #include <pebbl/utilib/std_headers.h>
 #include <pebbl/utilib/mpi_utilib.h>
@@ -89,9 +95,23 @@ public:
   /// Returns the number of bytes that have been packed into the buffer.
   size_type curr() {return Index;}
 
+  /// The number of bytes allocated for the internal buffer.
+  size_type capacity() const {return Size;}
+
   /// Resets the buffer index in order to reuse the internal buffer.
   void reset() {Index=0;}
 
+  /// Makes sure that another \a bytes bytes can be packed without
+  /// resizing the internal buffer.
+  void reserve(size_type bytes)
+	{if ((Index+bytes) >= Size) resize(bytes);}
+
+  /// If \c true, pack and unpack with MPI_Pack and MPI_Unpack rather
+  /// than copying bytes.  This must have the same value on every
+  /// processor, and may only be changed when no packed messages are
+  /// outstanding.
+  static bool use_mpi_pack;
+
 #ifdef UTILIB_HAVE_MEMBER_TEMPLATES
   /// Pack a list of objects
   template <class TYPE>
@@ -207,6 +227,15 @@ protected:
   /// Resizes the internal buffer
   void resize(const size_type newsize);
 
+  /// Copies \a bytes bytes into the buffer
+  void packBytes(const void* data, size_type bytes)
+	{
+	reserve(bytes);
+	if (bytes > 0)
+	   memcpy(&buffer[Index], data, bytes);
+	Index += bytes;
+	}
+
 };
  
  
@@ -459,6 +488,22 @@ protected:
   /// If true, then the last operation was successful.
   bool status_flag;
 
+  /// Copies \a bytes bytes out of the buffer
+  void unpackBytes(void* data, size_type bytes)
+	{
+	if (Index < MessageLength) {
+	   if ((Index+bytes) > MessageLength)
+	      EXCEPTION_MNGR(std::runtime_error, "UnPackBuffer::unpack - Unpack operation started within the message but ended beyond it");
+	   memcpy(data, &buffer[Index], bytes);
+	   Index += bytes;
+	   status_flag = true;
+	   }
+	else {
+	   memset(data, 0, bytes);
+	   status_flag = false;
+	   }
+	}
+
 };
  
  
@@ -521,6 +566,12 @@ for (int i=0; i<num; i++) {
 template <class TYPE>
 inline void PackBuffer::pack(const TYPE* data, size_type num)
 {
+if (num == 0)
+   return;
+if (!use_mpi_pack) {
+   packBytes(data, num*sizeof(TYPE));
+   return;
+   }
 resize(PackSize(data[0],num));
 int index = static_cast<int>(Index);
 if (data)
@@ -537,13 +588,7 @@ template <class TYPE>
 inline
 #endif
 void PackBuffer::pack(const TYPE* data, const size_type num)
-{ 
-size_t curr = sizeof(TYPE);
-resize(curr*num);
-
-memcpy(&buffer[Index], data, curr*num);
-Index += curr;
-}
+{ packBytes(data, num*sizeof(TYPE)); }
 
 #endif
 
@@ -559,6 +604,10 @@ if (num == 0) {
    status_flag = true;
    return;
    }
+if (!PackBuffer::use_mpi_pack) {
+   unpackBytes(data, num*sizeof(TYPE));
+   return;
+   }
 if (Index < MessageLength) {
    data[0] = 0;		// A simple test to make sure this isn't const data
    int index=static_cast<int>(Index);
@@ -571,6 +620,7 @@ if (Index < MessageLength) {
    }
 else
   {
+    memset(data, 0, num*sizeof(TYPE));
     status_flag = false;
   }
 }
@@ -591,21 +641,7 @@ void UnPackBuffer::unpack(TYPE* data, const size_type num)
       status_flag = true;
       return;
     }
-  if (Index < MessageLength) 
-    {
-      data[0] = 0;
-      size_t curr = num*sizeof(TYPE);
-      memcpy((void*)data, &(buffer[Index]), curr);
-      Index += curr;
-      status_flag = (Index <= MessageLength);
-      if (Index > MessageLength)
-         EXCEPTION_MNGR(std::runtime_error, "UnPackBuffer::unpack - Unpack operation started within message length but ended beyond it");
-    }
-  else
-    {
-      status_flag = false;
-    }
-  
+  unpackBytes(data, num*sizeof(TYPE));
 }
 
 #endif
@@ -618,6 +654,8 @@ void UnPackBuffer::unpack(TYPE* data, const size_type num)
 #define UTILIB_PACKBUF(TYPE)\
 inline void PackBuffer::pack(const TYPE* data, const int num)\
 {\
+if (num == 0)\
+   return;\
 resize(PackSize(data[0],num));\
 MPI_Pack((void*)data, num, mpi_datatype<TYPE>(),\
 			buffer, Size, &Index, MPI_COMM_WORLD);\
@@ -628,11 +666,13 @@ MPI_Pack((void*)data, num, mpi_datatype<TYPE>(),\
 #define UTILIB_PACKBUF(TYPE)\
 inline void PackBuffer::pack(const TYPE* data, const int num)\
 { \
+if (num == 0)\
+   return;\
 size_t curr = sizeof(TYPE);\
 resize(curr*num);\
 \
 memcpy(&buffer[Index], data, curr*num);\
-Index += curr;\
+Index += curr*num;\
 }
 
 #endif
@@ -717,6 +757,42 @@ UTILIB_UNPACKBUF(float)
 #endif 
 
 
+//
+// Packing arrays in one block.  These pack or unpack num values with a
+// single call when TYPE is arithmetic, and return false without doing
+// anything otherwise, so that containers can fall back on the stream
+// operators of their elements.
+//
+
+template <class TYPE>
+inline bool packBlock(PackBuffer& buff, const TYPE* data, size_type num,
+                      std::true_type)
+{buff.pack(data,num); return true;}
+
+template <class TYPE>
+inline bool packBlock(PackBuffer&, const TYPE*, size_type, std::false_type)
+{return false;}
+
+/// Pack an array of arithmetic values in one call
+template <class TYPE>
+inline bool packBlock(PackBuffer& buff, const TYPE* data, size_type num)
+{return packBlock(buff,data,num,std::is_arithmetic<TYPE>());}
+
+template <class TYPE>
+inline bool unpackBlock(UnPackBuffer& buff, TYPE* data, size_type num,
+                        std::true_type)
+{buff.unpack(data,num); return true;}
+
+template <class TYPE>
+inline bool unpackBlock(UnPackBuffer&, TYPE*, size_type, std::false_type)
+{return false;}
+
+/// Unpack an array of arithmetic values in one call
+template <class TYPE>
+inline bool unpackBlock(UnPackBuffer& buff, TYPE* data, size_type num)
+{return unpackBlock(buff,data,num,std::is_arithmetic<TYPE>());}
+
+
 } // namespace utilib
 
 /// Stream operator to pack a void*
@@ -0,0 +1,339 @@
+/*  _________________________________________________________________________
+ *
+ *  UTILIB: A utility library for developing portable C++ codes.
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README file in the top UTILIB directory.
+ *  _________________________________________________________________________
+ */
+
+/**
+ * \file eventTrace.cpp
+ *
+ * Per-thread event rings and the Chrome trace writer.
+ */
+
+#include <pebbl_config.h>
+#include <pebbl/utilib/eventTrace.h>
+
+#ifdef UTILIB_HAVE_MPI
+
+#include <pebbl/utilib/mpiUtil.h>
+#include <pebbl/utilib/exception_mngr.h>
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace utilib {
+
+namespace {
+
+typedef std::chrono::steady_clock traceClock;
+
+struct traceRecord
+{
+  double time;
+  int    event;
+};
+
+// One thread's records.  Only the owning thread writes count and the
+// records; they are read after the threads have stopped logging.
+
+struct traceRing
+{
+  traceRing(size_t capacity,int threadNum_,bool isMain_) :
+    records(capacity),
+    count(0),
+    threadNum(threadNum_),
+    isMain(isMain_)
+  { };
+
+  std::vector<traceRecord> records;
+  size_t count;
+  int    threadNum;
+  bool   isMain;
+};
+
+std::mutex               traceMutex;
+std::vector<traceRing*>  rings;
+std::vector<std::string> names;
+std::vector<bool>        isPoint;
+std::atomic<bool>        tracing(false);
+std::atomic<unsigned>    generation(0);
+size_t                   ringSize = 0;
+traceClock::time_point   baseTime;
+std::thread::id          mainThread;
+
+thread_local traceRing*  myRing = 0;
+thread_local unsigned    myGeneration = 0;
+
+
+int defineName(const char* name,bool point)
+{
+  std::lock_guard<std::mutex> lock(traceMutex);
+  if (names.empty())
+    {
+      names.push_back("");
+      isPoint.push_back(false);
+    }
+  for (size_t k=1; k<names.size(); k++)
+    if ((names[k] == name) && (isPoint[k] == point))
+      return (int) k;
+  names.push_back(name);
+  isPoint.push_back(point);
+  return (int) names.size() - 1;
+}
+
+
+traceRing* registerRing()
+{
+  std::lock_guard<std::mutex> lock(traceMutex);
+  bool isMain = (std::this_thread::get_id() == mainThread);
+  traceRing* ring = new traceRing(ringSize,rings.size(),isMain);
+  rings.push_back(ring);
+  return ring;
+}
+
+
+void appendQuoted(std::string& s,const std::string& text)
+{
+  s += '"';
+  for (size_t i=0; i<text.size(); i++)
+    {
+      char c = text[i];
+      if ((c == '"') || (c == '\\'))
+	s += '\\';
+      if ((unsigned char) c >= ' ')
+	s += c;
+    }
+  s += '"';
+}
+
+
+// Each entry of the trace starts with ",\n"; the writer drops the
+// first comma.
+
+void appendEntry(std::string& s,const char* phase,const std::string& name,
+		 int tid,double time)
+{
+  char buf[64];
+  s += ",\n{\"name\":";
+  appendQuoted(s,name);
+  s += ",\"ph\":\"";
+  s += phase;
+  std::snprintf(buf,sizeof(buf),"\",\"pid\":%d,\"tid\":%d",uMPI::rank,tid);
+  s += buf;
+  if (phase[0] == 'M')
+    return;
+  std::snprintf(buf,sizeof(buf),",\"ts\":%.3f",1e6*time);
+  s += buf;
+  if (phase[0] == 'i')
+    s += ",\"s\":\"t\"";
+  s += '}';
+}
+
+
+void appendThreadName(std::string& s,int tid,const std::string& name)
+{
+  appendEntry(s,"M","thread_name",tid,0);
+  s += ",\"args\":{\"name\":";
+  appendQuoted(s,name);
+  s += "}}";
+}
+
+} // namespace
+
+
+void eventTrace::start(size_t records)
+{
+  stop();
+  uMPI::barrier();
+  std::lock_guard<std::mutex> lock(traceMutex);
+  ringSize   = (records > 0) ? records : 1;
+  mainThread = std::this_thread::get_id();
+  baseTime   = traceClock::now();
+  generation++;
+  tracing = true;
+}
+
+
+bool eventTrace::active()
+{
+  return tracing;
+}
+
+
+int eventTrace::defineState(const char* name)
+{
+  return defineName(name,false);
+}
+
+
+int eventTrace::definePoint(const char* name)
+{
+  return defineName(name,true);
+}
+
+
+void eventTrace::record(int event)
+{
+  if (!tracing || (event < 2))
+    return;
+  if ((myRing == 0) || (myGeneration != generation))
+    {
+      myRing       = registerRing();
+      myGeneration = generation;
+    }
+  traceRing* ring = myRing;
+  traceRecord& r = ring->records[ring->count % ring->records.size()];
+  r.time  = std::chrono::duration<double>(traceClock::now() - baseTime).count();
+  r.event = event;
+  ring->count++;
+}
+
+
+long eventTrace::writeMerged(const char* fileName)
+{
+  // Turn this processor's rings into trace entries
+
+  std::string text;
+  long dropped = 0;
+  {
+    std::lock_guard<std::mutex> lock(traceMutex);
+
+    char procName[32];
+    std::snprintf(procName,sizeof(procName),"rank %d",uMPI::rank);
+    appendEntry(text,"M","process_name",0,0);
+    text += ",\"args\":{\"name\":";
+    appendQuoted(text,procName);
+    text += "}}";
+    appendEntry(text,"M","process_sort_index",0,0);
+    std::snprintf(procName,sizeof(procName),",\"args\":{\"sort_index\":%d}}",
+		  uMPI::rank);
+    text += procName;
+
+    for (size_t t=0; t<rings.size(); t++)
+      {
+	traceRing* ring = rings[t];
+	int tid = ring->threadNum;
+	if (ring->isMain)
+	  appendThreadName(text,tid,"main");
+	else
+	  {
+	    char threadName[32];
+	    std::snprintf(threadName,sizeof(threadName),"thread %d",tid);
+	    appendThreadName(text,tid,threadName);
+	  }
+
+	size_t n     = ring->records.size();
+	size_t first = 0;
+	if (ring->count > n)
+	  {
+	    first    = ring->count - n;
+	    dropped += first;
+	  }
+	// Ends whose beginnings were overwritten (or came before start())
+	// are skipped, so the viewers do not close the wrong state
+	std::vector<size_t> open(names.size(),0);
+	for (size_t i=first; i<ring->count; i++)
+	  {
+	    const traceRecord& r = ring->records[i % n];
+	    size_t k = r.event/2;
+	    if (k >= names.size())
+	      continue;
+	    const char* phase = "i";
+	    if (!isPoint[k])
+	      {
+		if (r.event % 2)
+		  {
+		    if (open[k] == 0)
+		      continue;
+		    open[k]--;
+		    phase = "E";
+		  }
+		else
+		  {
+		    open[k]++;
+		    phase = "B";
+		  }
+	      }
+	    appendEntry(text,phase,names[k],tid,r.time);
+	  }
+      }
+  }
+
+  // Gather to processor 0.  The gather counts are ints, so every
+  // processor checks the total size first and all of them give up
+  // together if it is too big, rather than leaving the others waiting
+  // in the gather.
+
+  long myLength = text.size();
+  long totalLength = 0;
+  uMPI::errorCode = MPI_Allreduce(&myLength,&totalLength,1,MPI_LONG,
+				  MPI_SUM,uMPI::comm);
+  if (totalLength > (long) INT_MAX)
+    EXCEPTION_MNGR(std::runtime_error,"Event trace is too big to "
+		   "gather; reduce traceRecords");
+
+  int myCount = (int) myLength;
+  std::vector<int> lengths(uMPI::size);
+  uMPI::errorCode = MPI_Gather(&myCount,1,MPI_INT,&lengths[0],1,MPI_INT,
+			       0,uMPI::comm);
+  long totalDropped = 0;
+  uMPI::errorCode = MPI_Reduce(&dropped,&totalDropped,1,MPI_LONG,MPI_SUM,
+			       0,uMPI::comm);
+
+  std::vector<int> displs(uMPI::size,0);
+  std::vector<char> all;
+  if (uMPI::rank == 0)
+    {
+      int total = 0;
+      for (int p=0; p<uMPI::size; p++)
+	{
+	  displs[p] = total;
+	  total    += lengths[p];
+	}
+      all.resize(total + 1);
+    }
+  uMPI::errorCode = MPI_Gatherv(&text[0],myCount,MPI_CHAR,
+				all.empty() ? 0 : &all[0],
+				&lengths[0],&displs[0],MPI_CHAR,0,uMPI::comm);
+
+  if (uMPI::rank == 0)
+    {
+      std::ofstream out(fileName);
+      if (!out)
+	EXCEPTION_MNGR(std::runtime_error,"Cannot open event trace file "
+		       << fileName);
+      // Skip the comma before the first entry
+      out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+      out.write(&all[1],all.size() - 2);
+      out << "\n]}\n";
+    }
+
+  return totalDropped;
+}
+
+
+void eventTrace::stop()
+{
+  std::lock_guard<std::mutex> lock(traceMutex);
+  tracing = false;
+  for (size_t t=0; t<rings.size(); t++)
+    delete rings[t];
+  rings.clear();
+}
+
+
+} // namespace utilib
+
+#endif
@@ -0,0 +1,84 @@
+/*  _________________________________________________________________________
+ *
+ *  UTILIB: A utility library for developing portable C++ codes.
+ *  Copyright (c) 2008 Sandia Corporation.
+ *  This software is distributed under the BSD License.
+ *  Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+ *  the U.S. Government retains certain rights in this software.
+ *  For more information, see the README file in the top UTILIB directory.
+ *  _________________________________________________________________________
+ */
+
+/**
+ * \file eventTrace.h
+ *
+ * Defines the utilib::eventTrace class, the event logging backend used
+ * by logEvent.h when MPE is not available.
+ *
+ * Each operating-system thread that logs an event gets its own ring
+ * of (time, event) records, written without locks; when a ring is
+ * full, the oldest records are overwritten, and the ends of states
+ * whose beginnings were lost are left out.  At the end, the rings of
+ * all processors are gathered to processor 0 and written as one file
+ * in the Chrome trace event JSON format, which chrome://tracing and
+ * the Perfetto UI both read.  Each processor is a process in the
+ * trace and each of its threads a track.  Times are measured from a
+ * barrier in start(), so processors on different nodes line up only
+ * as well as that barrier does.
+ */
+
+#ifndef utilib_eventTrace_h
+#define utilib_eventTrace_h
+
+#include <pebbl_config.h>
+
+#if     defined(HAVE_MPI) && !defined(UTILIB_HAVE_MPI)
+#define UTILIB_HAVE_MPI
+#endif
+
+#ifdef UTILIB_HAVE_MPI
+
+#include <cstddef>
+
+namespace utilib {
+
+
+class eventTrace
+{
+public:
+
+  /// Start tracing, with room for \c records records per thread.
+  /// Collective over uMPI::comm.
+  static void start(size_t records);
+
+  /// Is tracing on?
+  static bool active();
+
+  /// Return the number of a state called \c name, defining it if
+  /// needed.  The state starts with event 2*n and ends with 2*n+1.
+  static int defineState(const char* name);
+
+  /// Return the number of a point event called \c name; it is logged
+  /// as event 2*n.
+  static int definePoint(const char* name);
+
+  /// Log \c event on the calling thread.  Events below 2 are ignored.
+  static void record(int event);
+
+  /// Gather the records of all processors and write them to \c
+  /// fileName on processor 0.  Collective over uMPI::comm.  Returns
+  /// the number of records lost to full rings, on processor 0.  If
+  /// the trace is too big to gather, every processor throws.
+  static long writeMerged(const char* fileName);
+
+  /// Stop tracing and free the rings.
+  static void stop();
+
+};
+
+
+} // namespace utilib
+
+#endif
+
+#endif
@@ -12,7 +12,8 @@
 /**
  * \file logEvent.cpp
  *
- * Routines for doing event logging/tracing of parallel codes using MPE.
+ * Routines for doing event logging/tracing of parallel codes, using
+ * MPE or eventTrace.
  *
  * \author Jonathan Eckstein
  */
@@ -47,6 +48,44 @@ namespace utilib {
   };
 
 
+#elif defined(UTILIB_HAVE_MPI)
+
+  logEvent::logEvent() :
+    eventLog(0),
+    traceFile("pebbl_trace.json"),
+    traceRecords(100000)
+  {
+    create_categorized_parameter("eventLog",eventLog, 
+				 "<int>","0",
+				 "Event tracing level",
+				 "Debugging",
+				 ParameterNonnegative<int>());
+
+    create_categorized_parameter("traceFile",traceFile,
+				 "<string>","pebbl_trace.json",
+				 "File for the event trace (Chrome trace format)",
+				 "Debugging");
+
+    create_categorized_parameter("traceRecords",traceRecords,
+				 "<int>","100000",
+				 "Event trace records kept per thread; "
+				 "older ones are overwritten",
+				 "Debugging",
+				 ParameterPositive<int>());
+  };
+
+
+  void logEvent::finish()
+  {
+    long dropped = eventTrace::writeMerged(traceFile.c_str());
+    eventTrace::stop();
+    if ((uMPI::rank == 0) && (dropped > 0))
+      ucout << "****** Warning ******** " << dropped 
+	    << " event trace records were overwritten; "
+	    << "increase traceRecords to keep them\n";
+  }
+
+
 #endif
 
 } // namespace utilib
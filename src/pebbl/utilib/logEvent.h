@@ -12,7 +12,9 @@
 /**
  * \file logEvent.h
  *
- * Definess the utilib::logEvent class.
+ * Definess the utilib::logEvent class.  With MPE in a validating
+ * build, events go to MPE; otherwise, in any MPI build, they go to
+ * utilib::eventTrace.
  *
  * \author Jonathan Eckstein
  */
@@ -108,8 +110,111 @@ protected:
 
 };
 
+} // namespace utilib
+
+/// Indicates that the logging macros are not empty.
+#define EVENT_LOGGING_PRESENT 1
+
+#elif defined(UTILIB_HAVE_MPI)
 
-/// Code that is executed if MPE logging is in use.
+#include <pebbl/utilib/eventTrace.h>
+#include <pebbl/utilib/ParameterSet.h>
+#include <string>
+
+namespace utilib {
+
+/**
+ * Helper class for keeping track of states, traced by eventTrace.
+ * Colors are left to the trace viewer.
+ */
+
+  class logStateObject 
+  {
+  public:
+
+    int start;
+    int end;
+
+  logStateObject() :
+    start(0),
+      end(0)
+	{ };
+
+    void define(const char* description,const char* /* color */)
+    {
+      int n = eventTrace::defineState(description);
+      start = 2*n;
+      end   = 2*n + 1;
+    }
+
+  };
+
+
+/**
+ * Routines for doing event logging/tracing of parallel codes without
+ * MPE.  Events go to per-thread rings in memory, and finish() writes
+ * them as one Chrome trace file (see eventTrace.h).
+ */
+class logEvent : virtual public ParameterSet
+{
+public:
+
+  /// Constructor (defined in .cpp file)
+  logEvent();
+
+  /// Starts tracing.  Collective.
+  void init()
+   {
+     eventTrace::start(traceRecords);
+   };
+
+  static void defineEvent(int*        eNumAddress,
+			  const char* description,
+			  const char* /* color */)
+  {
+    *eNumAddress = 2*eventTrace::definePoint(description);
+  };
+
+  /// Log event \c eventNumber.
+  static void event(int eventNumber) 
+  { 
+    eventTrace::record(eventNumber);
+  };
+
+  /// Writes the trace file and stops tracing.  Collective.
+  void finish();
+
+  
+protected:
+
+  /// The event logging level
+
+  int eventLog;
+
+  /// Where the trace goes
+
+  std::string traceFile;
+
+  /// Records kept per thread
+
+  int traceRecords;
+
+};
+
+} // namespace utilib
+
+/// Indicates that the logging macros are not empty.
+#define EVENT_LOGGING_PRESENT 1
+
+/// Indicates that events may be logged from any thread.
+#define EVENT_LOGGING_THREAD_SAFE 1
+
+#endif
+
+
+#ifdef EVENT_LOGGING_PRESENT
+
+/// Code that is executed if event logging is in use.
 #define UTILIB_IF_LOGGING_COMPILED(arbitraryCode) arbitraryCode
 
 /// Executes \p action if the event log is greater or equal to \p level.
@@ -149,11 +254,6 @@ protected:
 
   // Create "point" versions of the last two above later if needed.
 
-/// Indicates that the logging macros are not empty.
-#define EVENT_LOGGING_PRESENT 1
-
-} // namespace utilib
-
 #else
 
 
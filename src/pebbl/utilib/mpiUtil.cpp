@@ -46,14 +46,25 @@ void uMPI::init(int* argcP, char*** argvP, MPI_Comm comm_)
 {
   if (!running())
     {
-      errorCode = MPI_Init(argcP,argvP);
+      // Threads other than the main one never make MPI calls
+      int provided;
+      errorCode = MPI_Init_thread(argcP,argvP,MPI_THREAD_FUNNELED,&provided);
       if (errorCode)
-         ucerr << "MPI_Init failed, code " << errorCode << endl;
+         ucerr << "MPI_Init_thread failed, code " << errorCode << endl;
     }
   init(comm_);
 }
 
 
+int uMPI::threadLevel()
+{
+  int level = MPI_THREAD_SINGLE;
+  if (running())
+    MPI_Query_thread(&level);
+  return level;
+}
+
+
 // The version below is presumed to be an old temporary version working around some
 // Weird MPICH bug.  Not used at present.
 
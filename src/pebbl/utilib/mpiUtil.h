@@ -123,6 +123,9 @@ public:
   /// Initializes MPI.
   static void init(int* argcP,char*** argv, MPI_Comm comm_=MPI_COMM_WORLD);
 
+  /// The thread support MPI provides (MPI_THREAD_SINGLE if not running).
+  static int threadLevel();
+
   /// Initializes MPI with a comm object (assumes that MPI is running)
   static void init(MPI_Comm comm_=MPI_COMM_WORLD);
   
@@ -266,6 +269,15 @@ public:
 								<< errorCode);
     	}
 
+  /// Start a persistent request.
+  static void start(MPI_Request* request)
+    	{
+      	errorCode = MPI_Start(request);
+      	if (errorCode)
+	   EXCEPTION_MNGR(std::runtime_error, "MPI_Start failed, code "
+								<< errorCode);
+    	}
+
   /// Perform an Issend.
   static void issend(void* buffer,int count,MPI_Datatype datatype,int dest,
 		     int tag,MPI_Request* request)
@@ -251,6 +251,60 @@ double ElapsedWallClockSeconds(void)
 return(WallClockSeconds() - WallClock_start_time);
 }
 
+/*
+ * CoarseWallClockSeconds - A wall-clock reading that is cheap enough
+ *  to take for every subproblem.  On Linux CLOCK_REALTIME_COARSE is
+ *  served from the vDSO without entering the kernel, and shares the
+ *  epoch of gettimeofday, so its values can be compared with those of
+ *  WallClockSeconds().
+ */
+static bool coarse_timing = true;
+
+void setCoarseTiming(bool flag)
+{
+coarse_timing = flag;
+}
+
+bool coarseTiming()
+{
+return coarse_timing;
+}
+
+double CoarseWallClockSeconds(void)
+  {
+#if defined(CLOCK_REALTIME_COARSE)
+   if (coarse_timing)
+      {
+      struct timespec ts;
+      if (clock_gettime(CLOCK_REALTIME_COARSE, &ts) == 0)
+         return ((double)ts.tv_sec + 1.0e-9*ts.tv_nsec);
+      }
+#endif
+   return WallClockSeconds();
+  }
+
+/*
+ * CoarseCPUSeconds - CPUSeconds() costs a system call, so each thread
+ *  keeps the last value and only asks again once the coarse wall clock
+ *  has ticked.  Between ticks the value stands still; a CPU-bound
+ *  thread sees it advance by whole ticks, which over many calls adds
+ *  up to the exact figure.
+ */
+double CoarseCPUSeconds(void)
+  {
+   static thread_local double last_wall = -1.0;
+   static thread_local double last_cpu  = 0.0;
+   if (!coarse_timing)
+      return CPUSeconds();
+   double wall = CoarseWallClockSeconds();
+   if (wall != last_wall)
+      {
+      last_wall = wall;
+      last_cpu  = CPUSeconds();
+      }
+   return last_cpu;
+  }
+
 /*
  * CurrentTime
  *
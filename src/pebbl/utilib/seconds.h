@@ -47,6 +47,24 @@ double ElapsedWallClockSeconds();
 /// which is useful for initializing RNGs.  This is the same as WallClockSeconds().
 double CurrentTime();
 
+/// A cheap reading of \c WallClockSeconds(), which may lag it by a
+/// clock tick (a few milliseconds).  Where the system has a coarse
+/// clock this avoids a system call, so it suits tests that are repeated
+/// for every subproblem.
+double CoarseWallClockSeconds();
+
+/// A cheap reading of \c CPUSeconds().  The value is cached by each
+/// thread and only refreshed when \c CoarseWallClockSeconds() advances,
+/// so over many calls it averages out to the exact CPU time.
+double CoarseCPUSeconds();
+
+/// Turns the coarse clocks on or off; when off they return the exact
+/// values.  They are on by default.
+void setCoarseTiming(bool flag);
+
+/// Whether the coarse clocks are in use.
+bool coarseTiming();
+
 /// The smallest amount of time (in seconds) that the timer on this
 /// system can distinguish from zero (experimental)
 double timerGranularitySeconds();
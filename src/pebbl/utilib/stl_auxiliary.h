@@ -37,6 +37,24 @@ while (curr != end) {
   }
 }
 
+/// Pack a vector of arithmetic values in one call
+template <class TYPE>
+inline bool packBlock(PackBuffer& buff, const std::vector<TYPE>& vec)
+{return packBlock(buff,vec.data(),vec.size());}
+
+/// A vector<bool> has no array to pack from
+inline bool packBlock(PackBuffer&, const std::vector<bool>&)
+{return false;}
+
+/// Unpack a vector of arithmetic values in one call
+template <class TYPE>
+inline bool unpackBlock(UnPackBuffer& buff, std::vector<TYPE>& vec)
+{return unpackBlock(buff,vec.data(),vec.size());}
+
+/// A vector<bool> has no array to unpack into
+inline bool unpackBlock(UnPackBuffer&, std::vector<bool>&)
+{return false;}
+
 ///
 /// Extensions to STL
 ///
@@ -274,7 +292,7 @@ template <class TYPE>
 utilib::PackBuffer& operator<<(utilib::PackBuffer& os, const std::vector<TYPE>& vec)
 {
 os << vec.size();
-if (vec.size() > 0) {
+if (vec.size() > 0 && !utilib::packBlock(os,vec)) {
    typename std::vector<TYPE>::const_iterator curr = vec.begin();
    typename std::vector<TYPE>::const_iterator last = vec.end();
    while (curr != last) {
@@ -322,7 +340,11 @@ utilib::UnPackBuffer& operator>>(utilib::UnPackBuffer& is, std::vector<TYPE>& ve
    is >> tmp;
 
    vec.resize(tmp);
-   if (vec.size() > 0) {
+   if (vec.size() > 0 && utilib::unpackBlock(is,vec)) {
+      EXCEPTION_TEST( !is, std::runtime_error, 
+                      "operator>> - cannot read vector elements from UnPackBuffer");
+      }
+   else if (vec.size() > 0) {
       typename std::vector<TYPE>::iterator curr = vec.begin();
       typename std::vector<TYPE>::iterator last = vec.end();
       while (curr != last) {